@@ -10,6 +10,7 @@
 #include "api/api.hh"
 #include "api/api-doc/cache_service.json.hh"
 #include "column_family.hh"
+#include "db/config.hh"
 
 namespace api {
 using namespace json;
@@ -17,10 +18,9 @@ using namespace seastar::httpd;
 namespace cs = httpd::cache_service_json;
 
 void set_cache_service(http_context& ctx, sharded<replica::database>& db, routes& r) {
-    cs::get_row_cache_save_period_in_seconds.set(r, [](std::unique_ptr<http::request> req) {
-        // We never save the cache
+    cs::get_row_cache_save_period_in_seconds.set(r, [&db](std::unique_ptr<http::request> req) {
         // Origin uses 0 for never
-        return make_ready_future<json::json_return_type>(0);
+        return make_ready_future<json::json_return_type>(db.local().get_config().row_cache_save_period());
     });
 
     cs::set_row_cache_save_period_in_seconds.set(r, [](std::unique_ptr<http::request> req) {
@@ -56,10 +56,8 @@ void set_cache_service(http_context& ctx, sharded<replica::database>& db, routes
         return make_ready_future<json::json_return_type>(json_void());
     });
 
-    cs::get_row_cache_keys_to_save.set(r, [](std::unique_ptr<http::request> req) {
-        // TBD
-        unimplemented();
-        return make_ready_future<json::json_return_type>(0);
+    cs::get_row_cache_keys_to_save.set(r, [&db](std::unique_ptr<http::request> req) {
+        return make_ready_future<json::json_return_type>(db.local().get_config().row_cache_keys_to_save());
     });
 
     cs::set_row_cache_keys_to_save.set(r, [](std::unique_ptr<http::request> req) {
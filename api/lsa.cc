@@ -9,6 +9,8 @@
 #include "api/api-doc/lsa.json.hh"
 #include "api/lsa.hh"
 
+#include <seastar/core/map_reduce.hh>
+#include <seastar/core/smp.hh>
 #include <seastar/http/exception.hh>
 #include "utils/logalloc.hh"
 #include "utils/log.hh"
@@ -27,6 +29,24 @@ void set_lsa(http_context& ctx, routes& r) {
             return json::json_return_type(json::json_void());
         });
     });
+
+    httpd::lsa_json::get_huge_page_stats.set(r, [](std::unique_ptr<request> req) {
+        return seastar::map_reduce(this_smp_all_shards(), [] (shard_id shard) {
+            return smp::submit_to(shard, [] {
+                return logalloc::shard_tracker().huge_page_statistics();
+            });
+        }, logalloc::tracker::huge_page_stats{}, [] (logalloc::tracker::huge_page_stats a, const logalloc::tracker::huge_page_stats& b) {
+            return a += b;
+        }).then([] (logalloc::tracker::huge_page_stats stats) {
+            httpd::lsa_json::huge_page_stats res;
+            res.huge_page_size = logalloc::huge_page_size;
+            res.segment_size = logalloc::segment_size;
+            res.owned_segments = stats.owned_segments;
+            res.fully_owned_huge_pages = stats.fully_owned_huge_pages;
+            res.partially_owned_huge_pages = stats.partially_owned_huge_pages;
+            return json::json_return_type(res);
+        });
+    });
 }
 
 }
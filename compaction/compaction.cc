@@ -707,6 +707,9 @@ class compaction {
         cfg.run_identifier = _run_identifier;
         cfg.replay_position = _rp;
         cfg.sstable_level = _sstable_level;
+        // Compaction output is large enough to train a compression dict on.
+        cfg.train_compression_dict = true;
+        cfg.compression_offload = _cdata.compression_offload;
         return cfg;
     }
 
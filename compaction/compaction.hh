@@ -20,6 +20,10 @@
 #include <seastar/core/abort_source.hh>
 #include "sstables/basic_info.hh"
 
+namespace sstables {
+class compression_offload;
+}
+
 namespace compaction {
 
 bool is_eligible_for_compaction(const sstables::shared_sstable& sst) noexcept;
@@ -54,6 +58,8 @@ struct compaction_data {
     abort_source abort;
     utils::UUID compaction_uuid;
     unsigned compaction_fan_in = 0;
+    // If set, output sstables are compressed with the help of other shards.
+    sstables::compression_offload* compression_offload = nullptr;
     struct replacement {
         const std::vector<sstables::shared_sstable> removed;
         const std::vector<sstables::shared_sstable> added;
@@ -930,6 +930,7 @@ compaction_task_executor::state compaction_task_executor::switch_state(state new
         ++_cm._stats.completed_tasks;
         break;
     }
+    _cm._cpu_offload.set_running_compactions(_cm._stats.active_tasks);
     cmlog.debug("{}: switch_state: {} -> {}: pending={} active={} done={} errors={}", *this, old_state, new_state,
             _cm._stats.pending_tasks, _cm._stats.active_tasks, _cm._stats.completed_tasks, _cm._stats.errors);
     return old_state;
@@ -965,6 +966,9 @@ future<semaphore_units<named_semaphore_exception_factory>> compaction_task_execu
 
 void compaction_task_executor::setup_new_compaction(sstables::run_id output_run_id) {
     _compaction_data = _cm.create_compaction_data();
+    if (_cm._cpu_offload.enabled()) {
+        _compaction_data.compression_offload = &_cm._cpu_offload;
+    }
     _output_run_identifier = output_run_id;
     switch_state(state::active);
 }
@@ -1045,6 +1049,7 @@ compaction_manager::compaction_manager(config cfg, abort_source& as, tasks::task
         cmlog.info("Updating max shares to {}", max_shares);
         _compaction_controller.set_max_shares(max_shares);
     }))
+    , _cpu_offload(_cfg.cpu_offload_shards, [this] () -> cpu_offload& { return container().local()._cpu_offload; })
     , _strategy_control(std::make_unique<strategy_control>(*this))
 {
     tm.register_module(_task_manager_module->get_name(), _task_manager_module);
@@ -1061,6 +1066,7 @@ compaction_manager::compaction_manager(tasks::task_manager& tm)
     , _update_compaction_static_shares_action([] { return make_ready_future<>(); })
     , _compaction_static_shares_observer(_cfg.static_shares.observe(_update_compaction_static_shares_action.make_observer()))
     , _compaction_max_shares_observer(_cfg.max_shares.observe([] (const float& max_shares) {}))
+    , _cpu_offload(_cfg.cpu_offload_shards)
     , _strategy_control(std::make_unique<strategy_control>(*this))
 {
     tm.register_module(_task_manager_module->get_name(), _task_manager_module);
@@ -1094,6 +1100,14 @@ void compaction_manager::register_metrics() {
                        sm::description("Holds the sum of normalized compaction backlog for all tables in the system. Backlog is normalized by dividing backlog by shard's available memory.")),
         sm::make_counter("validation_errors", [this] { return _validation_errors; },
                        sm::description("Holds the number of encountered validation errors.")).set_skip_when_empty(),
+        sm::make_counter("offloaded_chunks", [this] { return _cpu_offload.get_stats().offloaded_chunks; },
+                       sm::description("Holds the number of output chunks of this shard's compactions compressed on other shards.")).set_skip_when_empty(),
+        sm::make_counter("offload_borrowed_cpu_ms", [this] { return std::chrono::duration_cast<std::chrono::milliseconds>(_cpu_offload.get_stats().borrowed_cpu_time).count(); },
+                       sm::description("Holds the CPU time other shards spent compressing output of this shard's compactions, in milliseconds.")).set_skip_when_empty(),
+        sm::make_counter("offload_declined_chunks", [this] { return _cpu_offload.get_stats().declined_chunks; },
+                       sm::description("Holds the number of output chunks of this shard's compactions which other shards declined to compress.")).set_skip_when_empty(),
+        sm::make_counter("offload_lent_cpu_ms", [this] { return std::chrono::duration_cast<std::chrono::milliseconds>(_cpu_offload.get_stats().lent_cpu_time).count(); },
+                       sm::description("Holds the CPU time this shard spent compressing output of other shards' compactions, in milliseconds.")).set_skip_when_empty(),
     });
 }
 
@@ -1298,6 +1312,7 @@ future<> compaction_manager::really_do_stop() noexcept {
         on_fatal_internal_error(cmlog, format("{} tasks still exist after being stopped", _tasks.size()));
     }
     co_await stop_postponed_compactions();
+    co_await _cpu_offload.close();
     co_await _sys_ks.close();
     _weight_tracker.clear();
     _compaction_submission_timer.cancel();
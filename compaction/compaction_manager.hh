@@ -35,6 +35,7 @@
 #include "tombstone_gc.hh"
 #include "utils/pluggable.hh"
 #include "compaction/compaction_reenabler.hh"
+#include "compaction/cpu_offload.hh"
 #include "utils/disk_space_monitor.hh"
 
 namespace db {
@@ -84,6 +85,7 @@ class compaction_manager: public peering_sharded_service<compaction_manager> {
         utils::updateable_value<float> max_shares = utils::updateable_value<float>(0);
         utils::updateable_value<uint32_t> throughput_mb_per_sec = utils::updateable_value<uint32_t>(0);
         std::chrono::seconds flush_all_tables_before_major = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::days(1));
+        utils::updateable_value<uint32_t> cpu_offload_shards = utils::updateable_value<uint32_t>(0);
     };
 
 public:
@@ -163,6 +165,7 @@ class compaction_manager: public peering_sharded_service<compaction_manager> {
     utils::observer<float> _compaction_static_shares_observer;
     utils::observer<float> _compaction_max_shares_observer;
     uint64_t _validation_errors = 0;
+    cpu_offload _cpu_offload;
 
     class strategy_control;
     std::unique_ptr<strategy_control> _strategy_control;
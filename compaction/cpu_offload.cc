@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/util/defer.hh>
+
+#include "compaction/cpu_offload.hh"
+
+namespace compaction {
+
+cpu_offload::cpu_offload(utils::updateable_value<uint32_t> max_shards, local_fn local)
+    : _max_shards(std::move(max_shards))
+    , _local(std::move(local))
+    , _siblings(smp::count)
+{
+}
+
+unsigned cpu_offload::candidate_shards() const noexcept {
+    if (!_local || _gate.is_closed()) {
+        return 0;
+    }
+    return std::min<unsigned>(_max_shards(), smp::count - 1);
+}
+
+std::optional<shard_id> cpu_offload::pick_shard() {
+    // Borrow from the next candidate_shards() shards, round-robin, so that
+    // skewed shards far apart don't compete for the same siblings.
+    auto n = candidate_shards();
+    auto now = lowres_clock::now();
+    for (unsigned i = 0; i < n; ++i) {
+        _next = (_next + 1) % n;
+        shard_id shard = (this_shard_id() + 1 + _next) % smp::count;
+        auto& s = _siblings[shard];
+        if (s.chunks_in_flight < max_lent_chunks && s.declined_until <= now) {
+            ++s.chunks_in_flight;
+            return shard;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::chrono::steady_clock::duration> cpu_offload::lend(const noncopyable_function<void ()>& compress) {
+    if (_running_compactions || _gate.is_closed()) {
+        return std::nullopt;
+    }
+    auto start = std::chrono::steady_clock::now();
+    compress();
+    auto cpu_time = std::chrono::steady_clock::now() - start;
+    _stats.lent_cpu_time += cpu_time;
+    return cpu_time;
+}
+
+future<bool> cpu_offload::compress_on(shard_id shard, const noncopyable_function<void ()>& compress) {
+    auto release = defer([this, shard] () noexcept { --_siblings[shard].chunks_in_flight; });
+    auto holder = _gate.hold();
+    auto cpu_time = co_await smp::submit_to(shard, [this, &compress] {
+        return _local().lend(compress);
+    });
+    if (!cpu_time) {
+        ++_stats.declined_chunks;
+        _siblings[shard].declined_until = lowres_clock::now() + retry_period;
+        co_return false;
+    }
+    ++_stats.offloaded_chunks;
+    _stats.borrowed_cpu_time += *cpu_time;
+    co_return true;
+}
+
+size_t cpu_offload::max_chunks_in_flight() const noexcept {
+    // Enough to keep all candidates busy, plus one compressed locally.
+    return candidate_shards() * max_lent_chunks + 1;
+}
+
+future<> cpu_offload::close() noexcept {
+    return _gate.close();
+}
+
+}
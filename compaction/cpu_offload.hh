@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include "sstables/compress.hh"
+#include "utils/updateable_value.hh"
+
+namespace compaction {
+
+// Lets the compactions of a shard borrow the CPU of sibling shards which run
+// no compaction of their own, to compress and checksum their output.
+//
+// When one shard owns a hot tablet, its compaction backlog grows while the
+// other shards' compaction scheduling groups sit idle. The Data.db writers
+// of its compactions then send chunks to be compressed to idle siblings
+// (see sstables::compression_offload), which do the work in their own
+// compaction scheduling group, so it is still subject to its shares and
+// yields to their foreground work. The owning shard keeps reading the input,
+// merging, writing the output and committing the compaction.
+//
+// Each shard keeps its own state. A shard lends its CPU only while it runs
+// no compaction, which it checks itself when a chunk reaches it; a borrower
+// whose chunk was declined compresses it locally and leaves that shard alone
+// for retry_period. A borrower has at most max_lent_chunks chunks in flight
+// on each shard.
+class cpu_offload final : public sstables::compression_offload {
+public:
+    struct stats {
+        // Chunks of this shard's compactions compressed on other shards.
+        uint64_t offloaded_chunks = 0;
+        // Chunks other shards declined to compress.
+        uint64_t declined_chunks = 0;
+        std::chrono::steady_clock::duration borrowed_cpu_time{};
+        // CPU time this shard spent compressing chunks of other shards' compactions.
+        std::chrono::steady_clock::duration lent_cpu_time{};
+    };
+
+    static constexpr uint32_t max_lent_chunks = 2;
+    static constexpr auto retry_period = std::chrono::milliseconds(100);
+
+    // Returns the cpu_offload of the shard it is called on.
+    using local_fn = noncopyable_function<cpu_offload& ()>;
+private:
+    utils::updateable_value<uint32_t> _max_shards;
+    local_fn _local;
+    unsigned _next = 0;
+    uint64_t _running_compactions = 0;
+    struct sibling {
+        uint32_t chunks_in_flight = 0;
+        // After a declined chunk, the time until which not to send more.
+        lowres_clock::time_point declined_until;
+    };
+    std::vector<sibling> _siblings;
+    // Held by chunks sent to other shards.
+    gate _gate;
+    stats _stats;
+
+    unsigned candidate_shards() const noexcept;
+    std::optional<std::chrono::steady_clock::duration> lend(const noncopyable_function<void ()>& compress);
+public:
+    // Without local, the shard never offloads (e.g. when not sharded).
+    cpu_offload(utils::updateable_value<uint32_t> max_shards, local_fn local = {});
+
+    bool enabled() const noexcept {
+        return candidate_shards() > 0;
+    }
+
+    void set_running_compactions(uint64_t n) noexcept {
+        _running_compactions = n;
+    }
+
+    virtual std::optional<shard_id> pick_shard() override;
+    virtual future<bool> compress_on(shard_id shard, const noncopyable_function<void ()>& compress) override;
+    virtual size_t max_chunks_in_flight() const noexcept override;
+
+    // Waits for the chunks sent to other shards, and stops sending more.
+    future<> close() noexcept;
+
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+}
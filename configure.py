@@ -580,6 +580,7 @@ scylla_tests = set([
     'test/boost/file_stream_test',
     'test/boost/flush_queue_test',
     'test/boost/fragmented_temporary_buffer_test',
+    'test/boost/frequency_sketch_test',
     'test/boost/frozen_mutation_test',
     'test/boost/generic_server_test',
     'test/boost/gossiping_property_file_snitch_test',
@@ -690,6 +691,8 @@ scylla_tests = set([
     'test/perf/perf_commitlog',
     'test/perf/perf_cql_parser',
     'test/perf/perf_hash',
+    'test/perf/perf_logstor_scan',
+    'test/perf/perf_memtable_flush',
     'test/perf/perf_mutation',
     'test/perf/perf_collection',
     'test/perf/perf_row_cache_reads',
@@ -706,11 +709,13 @@ scylla_tests = set([
 perf_tests = set([
     'test/perf/perf_mutation_readers',
     'test/perf/perf_checksum',
+    'test/perf/perf_bloom_filter',
     'test/perf/perf_mutation_fragment',
     'test/perf/perf_idl',
     'test/perf/perf_vint',
     'test/perf/perf_big_decimal',
     'test/perf/perf_bti_key_translation',
+    'test/perf/perf_bti_index',
     'test/perf/perf_sort_by_proximity',
 ])
 
@@ -907,9 +912,11 @@ scylla_core = (['message/messaging_service.cc',
                 'replica/multishard_query.cc',
                 'replica/mutation_dump.cc',
                 'replica/querier.cc',
+                'replica/logstor/index_checkpoint.cc',
                 'replica/logstor/segment_io.cc',
                 'replica/logstor/segment_manager.cc',
                 'replica/logstor/logstor.cc',
+                'replica/logstor/record_cache.cc',
                 'replica/logstor/write_buffer.cc',
                 'mutation/atomic_cell.cc',
                 'mutation/canonical_mutation.cc',
@@ -986,6 +993,7 @@ scylla_core = (['message/messaging_service.cc',
                 'compaction/compaction_manager.cc',
                 'compaction/incremental_compaction_strategy.cc',
                 'compaction/incremental_backlog_tracker.cc',
+                'compaction/cpu_offload.cc',
                 'sstables/integrity_checked_file_impl.cc',
                 'sstables/object_storage_client.cc',
                 'sstables/prepended_input_stream.cc',
@@ -1158,6 +1166,7 @@ scylla_core = (['message/messaging_service.cc',
                 'db/per_partition_rate_limit_options.cc',
                 'db/rate_limiter.cc',
                 'db/row_cache.cc',
+                'db/row_cache_saver.cc',
                 'db/schema_applier.cc',
                 'db/schema_tables.cc',
                 'db/size_estimates_virtual_reader.cc',
@@ -1187,6 +1196,7 @@ scylla_core = (['message/messaging_service.cc',
                 'utils/UUID_gen.cc',
                 'utils/i_filter.cc',
                 'utils/bloom_filter.cc',
+                'utils/binary_fuse_filter.cc',
                 'utils/bloom_calculations.cc',
                 'utils/rate_limiter.cc',
                 'utils/file_lock.cc',
@@ -1642,6 +1652,8 @@ tests_not_using_seastar_test_framework = set([
     'test/perf/perf_cache_eviction',
     'test/perf/perf_cql_parser',
     'test/perf/perf_hash',
+    'test/perf/perf_logstor_scan',
+    'test/perf/perf_memtable_flush',
     'test/perf/perf_mutation',
     'test/perf/perf_collection',
     'test/perf/logalloc',
@@ -1784,6 +1796,7 @@ deps['test/boost/allocation_strategy_test'] = ['test/boost/allocation_strategy_t
 deps['test/boost/log_heap_test'] = ['test/boost/log_heap_test.cc']
 deps['test/boost/rolling_max_tracker_test'] = ['test/boost/rolling_max_tracker_test.cc']
 deps['test/boost/estimated_histogram_test'] = ['test/boost/estimated_histogram_test.cc']
+deps['test/boost/frequency_sketch_test'] = ['test/boost/frequency_sketch_test.cc']
 deps['test/boost/summary_test'] = ['test/boost/summary_test.cc']
 deps['test/boost/anchorless_list_test'] = ['test/boost/anchorless_list_test.cc']
 deps['test/perf/perf_commitlog'] += ['test/perf/perf.cc', 'seastar/tests/perf/linux_perf_event.cc']
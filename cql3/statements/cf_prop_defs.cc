@@ -24,6 +24,7 @@
 #include "db/per_partition_rate_limit_options.hh"
 #include "db/tablet_options.hh"
 #include "utils/bloom_calculations.hh"
+#include "utils/i_filter.hh"
 #include "utils/overloaded_functor.hh"
 #include "db/config.hh"
 
@@ -61,6 +62,7 @@ const sstring cf_prop_defs::KW_TABLETS = "tablets";
 
 const sstring cf_prop_defs::KW_STORAGE_ENGINE = "storage_engine";
 const sstring cf_prop_defs::KW_LARGE_DATA_GUARDRAILS_ENABLED = "large_data_guardrails_enabled";
+const sstring cf_prop_defs::KW_SSTABLE_FILTER_FORMAT = "sstable_filter_format";
 
 schema::extensions_map cf_prop_defs::make_schema_extensions(const db::extensions& exts) const {
     schema::extensions_map er;
@@ -111,6 +113,7 @@ void cf_prop_defs::validate(const data_dictionary::database db, sstring ks_name,
         KW_SYNCHRONOUS_UPDATES, KW_TABLETS,
         KW_STORAGE_ENGINE,
         KW_LARGE_DATA_GUARDRAILS_ENABLED,
+        KW_SSTABLE_FILTER_FORMAT,
     });
     static std::set<sstring> obsolete_keywords({
         sstring("index_interval"),
@@ -151,6 +154,15 @@ void cf_prop_defs::validate(const data_dictionary::database db, sstring ks_name,
         }
         compression_parameters cp(*compression_options);
         cp.validate(compression_parameters::dicts_feature_enabled(bool(db.features().sstable_compression_dicts)));
+        if (cp.per_sstable_dict() && !db.features().sstable_compression_per_sstable_dicts) {
+            throw exceptions::configuration_exception(format("The '{}' compression option is not supported yet by the whole cluster",
+                    compression_parameters::PER_SSTABLE_DICT));
+        }
+    }
+
+    auto caching = get_caching_options();
+    if (caching && caching->frequency_admission() && !db.features().row_cache_frequency_admission) {
+        throw exceptions::configuration_exception(format("'admission': 'FREQUENCY' in '{}' cannot be used until all nodes in the cluster enable this feature", KW_CACHING));
     }
 
     auto per_partition_rate_limit_options = get_per_partition_rate_limit_options(schema_extensions);
@@ -218,6 +230,20 @@ void cf_prop_defs::validate(const data_dictionary::database db, sstring ks_name,
             throw exceptions::configuration_exception("large_data_guardrails_enabled cannot be used until all nodes in the cluster enable this feature");
         }
     }
+
+    if (has_property(KW_SSTABLE_FILTER_FORMAT)) {
+        auto filter_format = get_string(KW_SSTABLE_FILTER_FORMAT, "");
+        if (!filter_format.empty()) {
+            if (!db.features().sstable_filter_format) {
+                throw exceptions::configuration_exception(format("{} cannot be used until all nodes in the cluster enable this feature", KW_SSTABLE_FILTER_FORMAT));
+            }
+            try {
+                utils::filter_format_from_string(filter_format);
+            } catch (const std::invalid_argument&) {
+                throw exceptions::configuration_exception(format("Illegal value for '{}': must be one of 'bloom', 'split_block' or 'binary_fuse', or empty for the node default", KW_SSTABLE_FILTER_FORMAT));
+            }
+        }
+    }
 }
 
 std::map<sstring, sstring> cf_prop_defs::get_compaction_type_options() const {
@@ -413,6 +439,9 @@ void cf_prop_defs::apply_to_builder(schema_builder& builder, schema::extensions_
     if (has_property(KW_LARGE_DATA_GUARDRAILS_ENABLED)) {
         builder.set_large_data_guardrails_enabled(get_boolean(KW_LARGE_DATA_GUARDRAILS_ENABLED, false));
     }
+    if (has_property(KW_SSTABLE_FILTER_FORMAT)) {
+        builder.set_sstable_filter_format(get_string(KW_SSTABLE_FILTER_FORMAT, ""));
+    }
 }
 
 void cf_prop_defs::validate_minimum_int(const sstring& field, int32_t minimum_value, int32_t default_value) const
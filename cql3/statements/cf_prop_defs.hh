@@ -66,6 +66,7 @@ class cf_prop_defs : public property_definitions {
 
     static const sstring KW_STORAGE_ENGINE;
     static const sstring KW_LARGE_DATA_GUARDRAILS_ENABLED;
+    static const sstring KW_SSTABLE_FILTER_FORMAT;
 
     // FIXME: In origin the following consts are in CFMetaData.
     static constexpr int32_t DEFAULT_DEFAULT_TIME_TO_LIVE = 0;
@@ -14,8 +14,11 @@
 #include "mutation/partition_version.hh"
 #include "mutation/mutation_cleaner.hh"
 #include "utils/cached_file_stats.hh"
+#include "utils/chunked_vector.hh"
+#include "utils/frequency_sketch.hh"
 #include "sstables/partition_index_cache_stats.hh"
 
+#include <seastar/core/lowres_clock.hh>
 #include <seastar/core/metrics_registration.hh>
 
 #include <stdint.h>
@@ -73,6 +76,8 @@ class cache_tracker final {
         uint64_t row_tombstone_reads;
         uint64_t rows_compacted;
         uint64_t rows_compacted_away;
+        uint64_t partition_admissions;
+        uint64_t partition_rejections;
 
         uint64_t active_reads() const {
             return reads - reads_done;
@@ -89,10 +94,19 @@ class cache_tracker final {
     mutation_cleaner _memtable_cleaner;
     mutation_application_stats& _app_stats;
     utils::updateable_value<double> _index_cache_fraction;
+    // Access frequencies of partitions of tables with frequency-based admission.
+    utils::frequency_sketch _admission_sketch;
+    uint64_t _row_evictions_seen = 0;
+    seastar::lowres_clock::time_point _last_eviction_seen;
 private:
     void setup_metrics();
+    bool under_eviction_pressure() noexcept;
 public:
     using register_metrics = bool_class<class register_metrics_tag>;
+    struct hot_partition {
+        table_id table;
+        dht::decorated_key key;
+    };
     cache_tracker(utils::updateable_value<double> index_cache_fraction, mutation_application_stats&, register_metrics);
     cache_tracker(utils::updateable_value<double> index_cache_fraction, register_metrics);
     cache_tracker();
@@ -119,6 +133,19 @@ class cache_tracker final {
     void on_row_miss() noexcept;
     void on_miss_already_populated() noexcept;
     void on_mispopulate() noexcept;
+    // Records an access to a cached partition, for the purpose of admission
+    // of partitions of tables with frequency-based admission.
+    void on_partition_access(const schema&, const dht::decorated_key&) noexcept;
+    // Decides whether a read which missed the given partition should populate
+    // cache with it, and records the access.
+    //
+    // Always true for tables which don't use frequency-based admission
+    // (see caching_options::frequency_admission()). For other tables, when
+    // cache is evicting, a partition is admitted only if it was accessed
+    // at least admission_min_frequency times recently. This prevents one-off
+    // scans from evicting the working set of point reads.
+    bool admit(const schema&, const dht::decorated_key&);
+    static constexpr unsigned admission_min_frequency = 2;
     void on_row_processed_from_memtable() noexcept { ++_stats.rows_processed_from_memtable; }
     void on_row_dropped_from_memtable() noexcept { ++_stats.rows_dropped_from_memtable; }
     void on_row_merged_from_memtable() noexcept { ++_stats.rows_merged_from_memtable; }
@@ -140,6 +167,11 @@ class cache_tracker final {
     cached_file_stats& get_index_cached_file_stats() { return _index_cached_file_stats; }
     partition_index_cache_stats& get_partition_index_cache_stats() { return _partition_index_cache_stats; }
     seastar::memory::reclaiming_result evict_from_lru_shallow() noexcept;
+    // Returns keys of at most max_partitions distinct cached partitions, ordered
+    // from the most recently used one, based on positions of their rows in the LRU.
+    // Visits at most max_rows LRU entries, in bounded batches between which it may defer.
+    // Entries touched after the walk started are not visited.
+    future<utils::chunked_vector<hot_partition>> hottest_partitions(size_t max_partitions, size_t max_rows);
 };
 
 inline
@@ -28,6 +28,7 @@
 #include <seastar/core/future-util.hh>
 #include <seastar/core/file.hh>
 #include <seastar/core/rwlock.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/fstream.hh>
 #include <seastar/core/memory.hh>
@@ -48,6 +49,8 @@
 #include "db/extensions.hh"
 #include "utils/assert.hh"
 #include "utils/crc.hh"
+#include "utils/estimated_histogram.hh"
+#include "utils/histogram_metrics_helper.hh"
 #include "utils/runtime.hh"
 #include "utils/flush_queue.hh"
 #include "utils/log.hh"
@@ -103,11 +106,24 @@ db::commitlog::config db::commitlog::config::from_db_config(const db::config& cf
     c.commitlog_total_space_in_mb = cfg.commitlog_total_space_in_mb() >= 0 ? cfg.commitlog_total_space_in_mb() : (shard_available_memory * this_smp_shard_count()) >> 20;
     c.commitlog_segment_size_in_mb = cfg.commitlog_segment_size_in_mb();
     c.commitlog_sync_period_in_ms = cfg.commitlog_sync_period_in_ms();
-    c.mode = cfg.commitlog_sync() == "batch" ? sync_mode::BATCH : sync_mode::PERIODIC;
+    c.mode = cfg.commitlog_sync() == "batch" ? sync_mode::BATCH
+            : cfg.commitlog_sync() == "group" ? sync_mode::GROUP
+            : sync_mode::PERIODIC;
+    c.commitlog_sync_group_latency_budget = std::chrono::microseconds(cfg.commitlog_sync_group_latency_budget_in_us());
     c.extensions = &cfg.extensions();
     c.use_o_dsync = cfg.commitlog_use_o_dsync();
     c.allow_going_over_size_limit = false;
 
+    const auto& compression = cfg.commitlog_compression();
+    if (compression == "lz4") {
+        c.compression = compressor::algorithm::lz4;
+    } else if (compression == "zstd") {
+        c.compression = compressor::algorithm::zstd;
+    } else if (compression != "none") {
+        throw std::invalid_argument(fmt::format("Invalid commitlog_compression: {}", compression));
+    }
+    c.compression_max_entry_size = size_t(cfg.commitlog_compression_max_entry_size_in_kb()) * 1024;
+
     if (cfg.commitlog_flush_threshold_in_mb() >= 0) {
         c.commitlog_flush_threshold_in_mb = cfg.commitlog_flush_threshold_in_mb();
     }
@@ -401,6 +417,10 @@ class db::commitlog::segment_manager : public ::enable_shared_from_this<segment_
         uint64_t requests_blocked_memory = 0;
         uint64_t blocked_on_new_segment = 0;
         uint64_t active_allocations = 0;
+        uint64_t compressed_entries = 0;
+        uint64_t uncompressible_entries = 0;
+        uint64_t compression_saved_bytes = 0;
+        std::chrono::steady_clock::duration compression_time{};
     };
 
     class scope_increment_counter {
@@ -416,7 +436,67 @@ class db::commitlog::segment_manager : public ::enable_shared_from_this<segment_
         }
     };
 
+    /**
+     * Sizes the window a group commit waits for more writes before it
+     * flushes, in GROUP mode.
+     *
+     * After each group commit, the window moves by a fraction of the
+     * difference between the latency budget and the time the first write of
+     * the group waited for durability, so it settles where writes wait about
+     * the budget. It is capped by the budget minus the average flush latency.
+     * When writes arrive further apart than the window, waiting would not
+     * gather any, so the group flushes immediately. A buffer holding a single
+     * write closes the window: a lone writer only waits for its own sync.
+     */
+    class group_commit_controller {
+    public:
+        using clock = std::chrono::steady_clock;
+    private:
+        // Weight of a new sample in the moving averages.
+        static constexpr double alpha = 0.2;
+        // Fraction of the latency error applied to the window per commit.
+        static constexpr double gain = 0.25;
+
+        double _interarrival_us = 0;
+        double _flush_latency_us = 0;
+        double _window_us = 0;
+        std::optional<clock::time_point> _last_arrival;
+    public:
+        void on_arrival(clock::time_point now) noexcept {
+            if (_last_arrival) {
+                double us = std::chrono::duration<double, std::micro>(now - *_last_arrival).count();
+                _interarrival_us += alpha * (us - _interarrival_us);
+            }
+            _last_arrival = now;
+        }
+        std::chrono::microseconds window() const noexcept {
+            if (_interarrival_us >= _window_us) {
+                return std::chrono::microseconds(0);
+            }
+            return std::chrono::microseconds(uint64_t(_window_us));
+        }
+        void on_commit(std::chrono::microseconds budget, clock::duration wait, clock::duration flush_latency, uint64_t writes) noexcept {
+            double flush_us = std::chrono::duration<double, std::micro>(flush_latency).count();
+            _flush_latency_us += alpha * (flush_us - _flush_latency_us);
+            if (writes < 2) {
+                _window_us = 0;
+                return;
+            }
+            double error = budget.count() - std::chrono::duration<double, std::micro>(wait).count();
+            auto limit = std::max(budget.count() - _flush_latency_us, 0.0);
+            _window_us = std::clamp(_window_us + gain * error, 0.0, limit);
+        }
+    };
+
     stats totals;
+    group_commit_controller group_commit;
+    // Compresses entries, if enabled by cfg.compression.
+    compressor_ptr entry_compressor;
+    // Number of allocations covered by each flush.
+    utils::estimated_histogram_with_max<65536> flush_batch_sizes;
+    // Time from the allocation of a synced write to its flush, in microseconds.
+    utils::estimated_histogram_with_max<16777216> sync_wait_us;
+    uint64_t allocations_at_last_flush = 0;
     byte_flow<uint64_t> last_bytes;
     byte_flow<double> bytes_rate;
 
@@ -653,6 +733,39 @@ T read(Input& in) {
     return net::ntoh(in.template read<T>().value());
 }
 
+// Entries are compressed in independent blocks of this size, so that neither
+// writing nor replaying them needs contiguous buffers for a whole entry.
+static constexpr size_t compression_block_size = 64 * 1024;
+
+// The on-disk IDs of the algorithms of compressed entries.
+static uint32_t compression_id(compressor::algorithm algo) {
+    switch (algo) {
+    case compressor::algorithm::lz4: return 1;
+    case compressor::algorithm::zstd: return 2;
+    default:
+        throw std::invalid_argument(fmt::format("Unsupported commitlog compression: {}", compression_parameters::algorithm_to_name(algo)));
+    }
+}
+
+static compressor::algorithm compression_algorithm(uint32_t id) {
+    switch (id) {
+    case 1: return compressor::algorithm::lz4;
+    case 2: return compressor::algorithm::zstd;
+    default:
+        throw std::runtime_error(fmt::format("Unknown commitlog compression ID: {}", id));
+    }
+}
+
+static compressor_ptr make_entry_compressor(compressor::algorithm algo) {
+    if (algo == compressor::algorithm::none) {
+        return nullptr;
+    }
+    return make_compressor_without_dicts(compression_parameters({
+        {compression_parameters::SSTABLE_COMPRESSION, sstring(compression_parameters::algorithm_to_name(algo))},
+        {compression_parameters::CHUNK_LENGTH_KB, fmt::to_string(compression_block_size / 1024)},
+    }));
+}
+
 detail::sector_split_iterator::sector_split_iterator(const sector_split_iterator&) noexcept = default;
 
 detail::sector_split_iterator::sector_split_iterator()
@@ -764,6 +877,7 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
     using sseg_ptr = segment_manager::sseg_ptr;
     using clock_type = segment_manager::clock_type;
     using time_point = segment_manager::time_point;
+    using group_commit_controller = segment_manager::group_commit_controller;
 
     using base_ostream_type = memory_output_stream<detail::sector_split_iterator>;
     using frag_ostream_type = typename base_ostream_type::fragmented;
@@ -779,6 +893,13 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
 
     uint64_t _num_allocs = 0;
 
+    // The group commit of the buffer at file_pos, in GROUP mode.
+    struct group_sync {
+        uint64_t file_pos;
+        shared_promise<> done;
+    };
+    lw_shared_ptr<group_sync> _group_sync;
+
     std::unordered_set<table_schema_version> _known_schema_versions;
 
     friend sstring format_as(const segment& s) {
@@ -837,6 +958,11 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
     static constexpr uint32_t segment_magic = ('S'<<24) |('C'<< 16) | ('L' << 8) | 'C';
     static constexpr uint32_t multi_entry_size_magic = 0xffffffff;
     static constexpr uint32_t fragmented_entry_size_magic = 0xfffffffe;
+    static constexpr uint32_t compressed_entry_size_magic = 0xfffffffd;
+    // The compressed entry overhead in bytes (magic, length, compression ID,
+    // uncompressed length, head checksum), followed by the compressed blocks,
+    // each prefixed by its length.
+    static constexpr size_t compressed_entry_overhead_size = 5 * sizeof(uint32_t);
 
     // The commit log (chained) sync marker/header size in bytes (int: length + int: checksum [segmentId, position])
     static constexpr size_t sync_marker_size = 2 * sizeof(uint32_t);
@@ -909,7 +1035,7 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
     }
 
     bool must_sync() {
-        if (_segment_manager->cfg.mode == sync_mode::BATCH) {
+        if (_segment_manager->cfg.mode != sync_mode::PERIODIC) {
             return false;
         }
         auto now = clock_type::now();
@@ -1036,6 +1162,8 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             // we fast-fail the whole commit.
             _flush_pos = std::max(pos, _flush_pos);
             ++_segment_manager->totals.flush_count;
+            auto allocs = _segment_manager->totals.allocation_count;
+            _segment_manager->flush_batch_sizes.add(allocs - std::exchange(_segment_manager->allocations_at_last_flush, allocs));
             clogger.trace("{} synced to {}", *this, _flush_pos);
         } catch (...) {
             clogger.error("Failed to flush commits to disk: {}", std::current_exception());
@@ -1245,6 +1373,45 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         co_return me;
     }
 
+    /**
+     * Syncs the buffer at file position fp as a group commit: the first
+     * write of the buffer waits for the group commit window, so that other
+     * writes join the buffer, then syncs it, and the other writes of the
+     * buffer wait for its sync.
+     */
+    future<> group_commit(uint64_t fp, group_commit_controller::clock::time_point start) {
+        if (_group_sync && _group_sync->file_pos == fp) {
+            co_await _group_sync->done.get_shared_future();
+            co_return;
+        }
+        auto me = shared_from_this();
+        auto g = make_lw_shared<group_sync>(fp);
+        _group_sync = g;
+        std::exception_ptr ex;
+        try {
+            auto& controller = _segment_manager->group_commit;
+            if (auto window = controller.window(); window.count() > 0) {
+                co_await seastar::sleep(window);
+            }
+            // Writes in the buffer this sync cycles.
+            auto writes = _num_allocs;
+            auto flush_start = group_commit_controller::clock::now();
+            co_await sync();
+            auto now = group_commit_controller::clock::now();
+            controller.on_commit(_segment_manager->cfg.commitlog_sync_group_latency_budget, now - start, now - flush_start, writes);
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        if (_group_sync == g) {
+            _group_sync = nullptr;
+        }
+        if (ex) {
+            g->done.set_exception(ex);
+            co_return coroutine::exception(std::move(ex));
+        }
+        g->done.set_value();
+    }
+
     future<sseg_ptr> batch_cycle(timeout_clock::time_point timeout) {
         /**
          * For batch mode we force a write "immediately".
@@ -1256,6 +1423,10 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
          */
         auto me = shared_from_this();
         auto fp = _file_pos;
+        auto start = group_commit_controller::clock::now();
+        if (_segment_manager->cfg.mode == sync_mode::GROUP) {
+            _segment_manager->group_commit.on_arrival(start);
+        }
         try {
             co_await _pending_ops.wait_for_pending(timeout);
             if (fp != _file_pos) {
@@ -1267,12 +1438,14 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
                 replay_position rp(_desc.id, position_type(fp));
                 co_await _pending_ops.wait_for_pending(rp, timeout);
                 
-                SCYLLA_ASSERT(_segment_manager->cfg.mode != sync_mode::BATCH || _flush_pos > fp);
+                SCYLLA_ASSERT(_segment_manager->cfg.mode == sync_mode::PERIODIC || _flush_pos > fp);
                 if (_flush_pos <= fp) {
                     // previous op we were waiting for was not sync one, so it did not flush
                     // force flush here
                     co_await do_flush(fp);
                 }
+            } else if (_segment_manager->cfg.mode == sync_mode::GROUP) {
+                co_await with_timeout(timeout, group_commit(fp, start));
             } else {
                 // It is ok to leave the sync behind on timeout because there will be at most one
                 // such sync, all later allocations will block on _pending_ops until it is done.
@@ -1286,6 +1459,7 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             me->_closed = true; // just mark segment as closed, no writes will be done.
             throw;
         };
+        _segment_manager->sync_wait_us.add(group_commit_controller::clock::now() - start);
         co_return me;
     }
 
@@ -1311,6 +1485,66 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             ; // total size
     }
 
+    // An entry serialized ahead of being added to the buffer, to compress it.
+    struct serialized_entry {
+        // The entry, in compression_block_size fragments.
+        std::vector<temporary_buffer<char>> data;
+        // The compressed blocks, empty if compressing didn't save space.
+        std::vector<temporary_buffer<char>> blocks;
+        // Size of the compressed blocks, with their length prefixes.
+        size_t compressed_size = 0;
+    };
+
+    bool should_compress(const entry_writer& writer, size_t size) const {
+        return _segment_manager->entry_compressor
+            && writer.num_entries == 1
+            && !writer.fragmented
+            && size >= _segment_manager->cfg.compression_min_entry_size
+            && size <= _segment_manager->cfg.compression_max_entry_size;
+    }
+
+    serialized_entry serialize_and_compress(entry_writer& writer, size_t size) {
+        serialized_entry e;
+        auto n_blocks = align_up(size, compression_block_size) / compression_block_size;
+        // The output stream needs all buffers to be the same size.
+        auto buffer_size = n_blocks == 1 ? size : compression_block_size;
+        e.data.reserve(n_blocks);
+        for (size_t i = 0; i < n_blocks; ++i) {
+            e.data.emplace_back(buffer_size);
+        }
+        output out(typename output::fragmented(detail::sector_split_iterator(e.data.begin(), e.data.end(), buffer_size, 0), size));
+        writer.write(*this, out, 0);
+
+        auto& totals = _segment_manager->totals;
+        const auto& comp = *_segment_manager->entry_compressor;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            e.blocks.reserve(n_blocks);
+            auto rem = size;
+            for (const auto& block : e.data) {
+                auto len = std::min(rem, compression_block_size);
+                temporary_buffer<char> c(comp.compress_max_size(len));
+                c.trim(comp.compress(block.get(), len, c.get_write(), c.size()));
+                e.compressed_size += sizeof(uint32_t) + c.size();
+                e.blocks.emplace_back(std::move(c));
+                rem -= len;
+            }
+        } catch (...) {
+            clogger.warn("Failed to compress entry of {} bytes, writing it uncompressed: {}", size, std::current_exception());
+            e.blocks.clear();
+        }
+        totals.compression_time += std::chrono::steady_clock::now() - start;
+
+        if (e.blocks.empty() || e.compressed_size + compressed_entry_overhead_size >= size + entry_overhead_size) {
+            ++totals.uncompressible_entries;
+            e.blocks.clear();
+        } else {
+            ++totals.compressed_entries;
+            totals.compression_saved_bytes += (size + entry_overhead_size) - (e.compressed_size + compressed_entry_overhead_size);
+        }
+        return e;
+    }
+
     /**
      * Add a "mutation" to the segment.
      * Should only be called from "allocate_when_possible". "this" must be secure in a shared_ptr that will not
@@ -1331,7 +1565,7 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         if (!is_still_allocating() || next_position(s) > _segment_manager->max_size) { // would we make the file too big?
             return write_result::no_space;
         } else if (!_buffer.empty() && (s > _buffer_ostream.size())) {  // enough data?
-            if (_segment_manager->cfg.mode == sync_mode::BATCH || writer.sync) {
+            if (_segment_manager->cfg.mode != sync_mode::PERIODIC || writer.sync) {
                 // TODO: this could cause starvation if we're really unlucky.
                 // If we run batch mode and find ourselves not fit in a non-empty
                 // buffer, we must force a cycle and wait for it (to keep flush order)
@@ -1349,6 +1583,13 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             throw std::runtime_error("commitlog: Cannot add data to a closed segment");
         }
 
+        // Sizes above are upper bounds for compressed entries, which are
+        // only written compressed when that is smaller.
+        std::optional<serialized_entry> serialized;
+        if (should_compress(writer, size)) {
+            serialized = serialize_and_compress(writer, size);
+        }
+
         auto pos = buffer_position();
         auto& out = _buffer_ostream;
 
@@ -1383,6 +1624,33 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
 
             crc32_nbo crc;
 
+            if (serialized && !serialized->blocks.empty()) {
+                // compressed entry:
+                //      magic : uint32_t
+                //      size  : uint32_t - including this header
+                //      compression : uint32_t
+                //      uncompressed size : uint32_t
+                //      crc   : uint32_t - crc of the above
+                // -> { length : uint32_t, compressed block }[]
+                auto ces = uint32_t(serialized->compressed_size + compressed_entry_overhead_size);
+                auto compression = compression_id(_segment_manager->cfg.compression);
+                write<uint32_t>(out, compressed_entry_size_magic);
+                write<uint32_t>(out, ces);
+                write<uint32_t>(out, compression);
+                write<uint32_t>(out, uint32_t(entry_size));
+                crc.process(uint32_t(compressed_entry_size_magic));
+                crc.process(uint32_t(ces));
+                crc.process(uint32_t(compression));
+                crc.process(uint32_t(entry_size));
+                write<uint32_t>(out, crc.checksum());
+                for (const auto& block : serialized->blocks) {
+                    write<uint32_t>(out, uint32_t(block.size()));
+                    out.write(block.get(), block.size());
+                }
+                writer.result(entry, std::move(h));
+                continue;
+            }
+
             if (writer.fragmented) {
                 auto off = uint32_t(writer.frag_offset(entry));
                 auto rem = uint32_t(writer.frag_remaining(entry));
@@ -1407,7 +1675,17 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
 
             // actual data
             auto entry_out = out.write_substream(entry_size);
-            writer.write(*this, entry_out, entry);
+            if (serialized) {
+                // Serialized for compression, which didn't save space.
+                auto rem = entry_size;
+                for (const auto& block : serialized->data) {
+                    auto len = std::min(rem, compression_block_size);
+                    entry_out.write(block.get(), len);
+                    rem -= len;
+                }
+            } else {
+                writer.write(*this, entry_out, entry);
+            }
             writer.result(entry, std::move(h));
         }
 
@@ -1417,13 +1695,20 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         // When released (notify_memory_written), it will be based on bytes on disk.
         // Do this account based on "disk bytes" (buffer really), i.e. accounting for
         // sector boundaries and CRC overhead.
-        auto buf_memory = npos - pos - permit.release(); /* size in permit was already subtracted from sem count - ignore it here */
-        _segment_manager->account_memory_usage(buf_memory);
+        // size in permit was already subtracted from sem count - ignore it here.
+        // A compressed entry can take less than that.
+        auto written = npos - pos;
+        auto permitted = permit.release();
+        if (written >= permitted) {
+            _segment_manager->account_memory_usage(written - permitted);
+        } else {
+            _segment_manager->notify_memory_written(permitted - written);
+        }
 
         ++_segment_manager->totals.allocation_count;
         ++_num_allocs;
 
-        if (_segment_manager->cfg.mode == sync_mode::BATCH || writer.sync) {
+        if (_segment_manager->cfg.mode != sync_mode::PERIODIC || writer.sync) {
             return write_result::ok_need_batch_sync;
         } else {
             // If this buffer alone is too big, potentially bigger than the maximum allowed size,
@@ -1983,6 +2268,8 @@ db::commitlog::segment_manager::segment_manager(config c)
             cfg.commit_log_location, max_disk_size / (1024 * 1024),
             this_smp_shard_count());
 
+    entry_compressor = make_entry_compressor(cfg.compression);
+
     if (!cfg.metrics_category_name.empty()) {
         create_counters(cfg.metrics_category_name);
     }
@@ -2197,6 +2484,29 @@ void db::commitlog::segment_manager::create_counters(const sstring& metrics_cate
 
         sm::make_gauge("active_allocations", totals.active_allocations,
                        sm::description("Current number of active allocations.")),
+
+        sm::make_histogram("flush_batch_size", [this] { return to_metrics_histogram(flush_batch_sizes); },
+                       sm::description("Histogram of the number of allocations covered by each flush.")),
+
+        sm::make_histogram("sync_wait", [this] { return to_metrics_histogram(sync_wait_us); },
+                       sm::description("Histogram of the time in microseconds from the allocation of a write which waits for its flush, e.g. in batch and group mode, to the flush. "
+                                       "In group mode, the flush is delayed to batch writes while this stays within commitlog_sync_group_latency_budget_in_us.")),
+
+        sm::make_gauge("group_commit_window", [this] { return group_commit.window().count(); },
+                       sm::description("Holds the current time in microseconds a group commit waits for other writes before flushing, in group mode.")),
+
+        sm::make_counter("compressed_entries", totals.compressed_entries,
+                       sm::description("Counts number of entries written compressed, see commitlog_compression.")),
+
+        sm::make_counter("uncompressible_entries", totals.uncompressible_entries,
+                       sm::description("Counts number of entries written uncompressed because compressing them did not save space.")),
+
+        sm::make_counter("compression_saved_bytes", totals.compression_saved_bytes,
+                       sm::description("Counts number of bytes saved by compressing entries. "
+                                       "Add bytes_written to this value to get the number of bytes which would have been written without compression.")),
+
+        sm::make_counter("compression_time_us", [this] { return std::chrono::duration_cast<std::chrono::microseconds>(totals.compression_time).count(); },
+                       sm::description("Counts the time in microseconds spent compressing entries, including those which did not compress well.")),
     });
 }
 
@@ -2985,7 +3295,7 @@ void db::commitlog::segment_manager::on_timer() {
     // without waiting for them, so segement_manager could be shut down
     // while they are running.
     (void)seastar::with_gate(_gate, [this] {
-        if (cfg.mode != sync_mode::BATCH) {
+        if (cfg.mode == sync_mode::PERIODIC) {
             sync();
         }
 
@@ -3449,6 +3759,8 @@ db::commitlog::read_log_file(const replay_state& state, sstring filename, sstrin
         bool failed = false;
         fragmented_temporary_buffer::reader frag_reader;
         fragmented_temporary_buffer buffer, initial;
+        compressor_ptr decompressor;
+        uint32_t decompressor_id = 0;
 
         work(file f, descriptor din, commit_load_reader_func fn, replay_state::impl& sn, position_type o = 0)
                 : f(f), d(din), func(std::move(fn)), fin(make_file_input_stream(f, make_file_input_stream_options())), state(sn), start_off(o) {
@@ -3881,6 +4193,43 @@ db::commitlog::read_log_file(const replay_state& state, sstring filename, sstrin
                     state.fragment_state.erase(id);
                 }
 
+                co_return;
+            } else if (size == segment::compressed_entry_size_magic) {
+                auto actual_size = checksum;
+
+                // really small read...
+                buf = co_await read_data(segment::compressed_entry_overhead_size - entry_header_size);
+                in = buf.get_istream();
+
+                auto compression = read<uint32_t>(in);
+                auto uncompressed_size = read<uint32_t>(in);
+                checksum = read<uint32_t>(in);
+
+                crc.process(actual_size);
+                crc.process(compression);
+                crc.process(uncompressed_size);
+
+                if (actual_size < segment::compressed_entry_overhead_size || crc.checksum() != checksum
+                        || next_pos(actual_size - segment::compressed_entry_overhead_size) > next) {
+                    auto slack = next - pos;
+                    clogger.debug("Compressed segment entry at {} has broken header. Skipping to next chunk ({} bytes)", rp, slack);
+                    corrupt_size += slack;
+                    co_await skip_to_chunk(next);
+                    co_return;
+                }
+
+                buf = co_await read_data(actual_size - segment::compressed_entry_overhead_size);
+
+                fragmented_temporary_buffer data;
+                try {
+                    data = decompress(compression, buf, uncompressed_size);
+                } catch (...) {
+                    clogger.debug("Compressed segment entry at {} cannot be decompressed: {}", rp, std::current_exception());
+                    corrupt_size += actual_size;
+                    co_return;
+                }
+
+                co_await func({std::move(data), rp});
                 co_return;
             }
 
@@ -3900,6 +4249,32 @@ db::commitlog::read_log_file(const replay_state& state, sstring filename, sstrin
             co_await func({std::move(buf), rp});
         }
 
+        // Decompresses the blocks of a compressed entry.
+        fragmented_temporary_buffer decompress(uint32_t compression, const fragmented_temporary_buffer& buf, size_t size) {
+            if (!decompressor || decompressor_id != compression) {
+                decompressor = make_entry_compressor(compression_algorithm(compression));
+                decompressor_id = compression;
+            }
+            std::vector<temporary_buffer<char>> blocks;
+            blocks.reserve(align_up(size, compression_block_size) / compression_block_size);
+            auto in = buf.get_istream();
+            bytes_ostream linearization_buffer;
+            for (size_t rem = size; rem > 0;) {
+                auto len = std::min(rem, compression_block_size);
+                auto compressed_len = read<uint32_t>(in);
+                auto compressed = in.read_bytes_view(compressed_len, linearization_buffer).value();
+                temporary_buffer<char> block(len);
+                auto n = decompressor->uncompress(reinterpret_cast<const char*>(compressed.data()), compressed.size(), block.get_write(), len);
+                if (n != len) {
+                    throw std::runtime_error(fmt::format("Compressed block decompressed to {} bytes, expected {}", n, len));
+                }
+                blocks.emplace_back(std::move(block));
+                linearization_buffer.clear();
+                rem -= len;
+            }
+            return fragmented_temporary_buffer(std::move(blocks), size);
+        }
+
         future<> read_file() {
             std::exception_ptr p;
             try {
@@ -3983,6 +4358,10 @@ uint64_t db::commitlog::get_flush_count() const {
     return _segment_manager->totals.flush_count;
 }
 
+std::chrono::microseconds db::commitlog::get_group_commit_window() const {
+    return _segment_manager->group_commit.window();
+}
+
 uint64_t db::commitlog::get_pending_tasks() const {
     return _segment_manager->totals.pending_flushes;
 }
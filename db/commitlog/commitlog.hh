@@ -18,6 +18,7 @@
 #include "db/timeout_clock.hh"
 #include "gc_clock.hh"
 #include "utils/fragmented_temporary_buffer.hh"
+#include "sstables/compressor.hh"
 
 namespace seastar { class file; }
 
@@ -51,6 +52,12 @@ class extensions;
  * In BATCH mode, every write to the log will also send the data to disk
  * + issue a flush and wait for both to complete.
  *
+ * In GROUP mode, writes are acknowledged after a flush, like in BATCH
+ * mode, but the first write of a buffer waits for a short window before
+ * flushing it, so concurrent writes share the flush. The window is sized
+ * from the rate of writes and the flush latency, to keep the time writes
+ * wait for durability within a latency budget.
+ *
  * In PERIODIC mode, most writes will only add to the internal memory
  * buffers. If the mem buffer is saturated, data is sent to disk, but we
  * don't wait for the write to complete. However, if periodic (timer)
@@ -83,7 +90,7 @@ class commitlog {
     ::shared_ptr<segment_manager> _segment_manager;
 public:
     enum class sync_mode {
-        PERIODIC, BATCH
+        PERIODIC, BATCH, GROUP
     };
     using force_sync = db::commitlog_force_sync;
     struct config {
@@ -99,6 +106,8 @@ class commitlog {
         std::optional<uint64_t> commitlog_data_max_lifetime_in_seconds = {};
         uint64_t commitlog_segment_size_in_mb = 32;
         uint64_t commitlog_sync_period_in_ms = 10 * 1000; //TODO: verify default!
+        // Target time from a write to its flush in GROUP mode.
+        std::chrono::microseconds commitlog_sync_group_latency_budget = std::chrono::microseconds(2000);
         // Max number of segments to keep in pre-alloc reserve.
         // Not (yet) configurable from scylla.conf.
         uint64_t max_reserve_segments = 12;
@@ -107,6 +116,14 @@ class commitlog {
         uint64_t max_active_flushes = 0;
 
         sync_mode mode = sync_mode::PERIODIC;
+        // Algorithm used to compress entries, none to write them as is.
+        // Compressed entries are read back regardless of this setting.
+        compressor::algorithm compression = compressor::algorithm::none;
+        // Entries smaller than this are not worth compressing.
+        size_t compression_min_entry_size = 1024;
+        // Entries larger than this are written uncompressed, so that
+        // compressing a single entry doesn't stall the reactor.
+        size_t compression_max_entry_size = 128 * 1024;
         std::string fname_prefix = descriptor::FILENAME_PREFIX;
         // Optional tag appended before the file extension
         // (e.g. entry_tag="variant" produces "CommitLog-4-12345.variant.log").
@@ -332,6 +349,8 @@ class commitlog {
     uint64_t get_num_segments_destroyed() const;
     uint64_t get_num_blocked_on_new_segment() const;
     uint64_t get_num_active_allocations() const;
+    // The current group commit window, in GROUP mode.
+    std::chrono::microseconds get_group_commit_window() const;
 
 
     /**
@@ -15,8 +15,13 @@
 #include <ranges>
 #include "utils/chunked_vector.hh"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/sharded.hh>
+#include <seastar/coroutine/exception.hh>
 
 #include "commitlog.hh"
 #include "commitlog_replayer.hh"
@@ -39,12 +44,35 @@ class db::commitlog_replayer::impl {
         future<> stop() { return make_ready_future<>(); }
     };
 
+    // Progress of the replay of the segments of a shard, exported as metrics
+    // while the replay runs.
+    struct progress {
+        uint64_t bytes_replayed = 0;
+        uint64_t mutations_replayed = 0;
+        uint64_t batches_applied = 0;
+        seastar::metrics::metric_groups metrics;
+
+        progress() {
+            namespace sm = seastar::metrics;
+            metrics.add_group("commitlog_replay", {
+                sm::make_counter("bytes", bytes_replayed,
+                        sm::description("Counts bytes of commitlog entries read by the commitlog replay of segments of this shard.")),
+                sm::make_counter("mutations", mutations_replayed,
+                        sm::description("Counts mutations applied by the commitlog replay of segments of this shard.")),
+                sm::make_counter("batches", batches_applied,
+                        sm::description("Counts batches of mutations sent to their shards by the commitlog replay of segments of this shard.")),
+            });
+        }
+        future<> stop() { return make_ready_future<>(); }
+    };
+
     // we want the processing methods to be const, since they use
     // shard-sharing of data -> read only
     // this one is special since it is thread local.
     // Should actually make sharded::local a const function (it does
     // not modify content), but...
     mutable seastar::sharded<column_mappings> _column_mappings;
+    mutable seastar::sharded<progress> _progress;
 
     friend class db::commitlog_replayer;
 public:
@@ -59,6 +87,7 @@ class db::commitlog_replayer::impl {
         uint64_t corrupt_bytes = 0;
         uint64_t truncated_at = 0;
         uint64_t broken_files = 0;
+        uint64_t bytes_replayed = 0;
 
         stats& operator+=(const stats& s) {
             invalid_mutations += s.invalid_mutations;
@@ -66,6 +95,7 @@ class db::commitlog_replayer::impl {
             applied_mutations += s.applied_mutations;
             corrupt_bytes += s.corrupt_bytes;
             broken_files += s.broken_files;
+            bytes_replayed += s.bytes_replayed;
             return *this;
         }
         stats operator+(const stats& s) const {
@@ -78,13 +108,63 @@ class db::commitlog_replayer::impl {
     // move start/stop of the thread local bookkeep to "top level"
     // and also make sure to SCYLLA_ASSERT on it actually being started.
     future<> start() {
-        return _column_mappings.start();
+        co_await _column_mappings.start();
+        co_await _progress.start();
     }
     future<> stop() {
-        return _column_mappings.stop();
+        co_await _progress.stop();
+        co_await _column_mappings.stop();
     }
 
-    future<> process(stats*, detail::commitlog_entry_serialization_format, commitlog::buffer_and_replay_position buf_rp) const;
+    // A mutation read from a segment, to be applied on a shard.
+    struct pending_mutation {
+        // Shared by the batches of all the shards the mutation is applied on.
+        // Only the replaying shard touches the reference count.
+        lw_shared_ptr<const frozen_mutation> fm;
+        // Points into the column mappings of the replaying shard.
+        const column_mapping* cm;
+        replay_position rp;
+    };
+    using mutation_batch = utils::chunked_vector<pending_mutation>;
+
+    // Applies the mutations of the segments replayed by a shard in batches
+    // per target shard, in the background, so that reading and decoding the
+    // next entries overlaps with applying the previous ones, on all the
+    // target shards concurrently. Mutations commute, so the order in which
+    // they are applied doesn't matter.
+    //
+    // The memory of the mutations which are batched or being applied is
+    // limited, and the reader waits for batches to complete when it runs out.
+    class replay_pipeline {
+        // A batch is sent to its shard when it holds this many bytes.
+        static constexpr size_t batch_size = 1024 * 1024;
+        // Limits the memory of the mutations in batches, per replaying shard.
+        static constexpr size_t max_memory = 16 * 1024 * 1024;
+
+        const impl& _impl;
+        stats& _stats;
+        std::vector<mutation_batch> _batches;
+        std::vector<size_t> _batch_bytes;
+        semaphore _memory{max_memory};
+        gate _gate;
+
+        void dispatch(shard_id shard);
+    public:
+        replay_pipeline(const impl& i, stats& s);
+
+        // Adds a mutation to the batches of the given shards. Waits for
+        // memory if needed.
+        future<> add(lw_shared_ptr<const frozen_mutation> fm, const column_mapping& cm, replay_position rp, const dht::shard_replica_set& shards);
+
+        // Sends the remaining batches and waits for all of them to be applied.
+        future<> close();
+    };
+
+    // Applies a batch of mutations read by another shard on this shard.
+    // Returns the number of applied and invalid mutations.
+    future<std::pair<uint64_t, uint64_t>> apply_batch(replica::database& db, const mutation_batch& batch) const;
+
+    future<> process(replay_pipeline&, stats*, detail::commitlog_entry_serialization_format, commitlog::buffer_and_replay_position buf_rp) const;
     future<stats> recover(const commitlog::descriptor&, const commitlog::replay_state&) const;
     detail::commitlog_entry_serialization_format get_entry_format(const commitlog::descriptor&) const;
 
@@ -183,35 +263,157 @@ db::commitlog_replayer::impl::recover(const commitlog::descriptor& d, const comm
 
     if (rp.id < gp.id) {
         rlogger.debug("skipping replay of fully-flushed {}", f);
-        return make_ready_future<stats>();
+        co_return stats();
     }
     position_type p = 0;
     if (rp.id == gp.id) {
         p = gp.pos;
     }
 
-    auto s = make_lw_shared<stats>();
+    stats s;
     auto& exts = _db.local().extensions();
     auto entry_format = get_entry_format(d);
+    replay_pipeline pipeline(*this, s);
 
-    return db::commitlog::read_log_file(rpstate, f, d.filename_prefix,
-            std::bind(&impl::process, this, s.get(), entry_format, std::placeholders::_1),
-            p, &exts).then_wrapped([s](future<> f) {
+    std::exception_ptr ex;
+    try {
+        co_await db::commitlog::read_log_file(rpstate, f, d.filename_prefix, [&] (commitlog::buffer_and_replay_position buf_rp) {
+            return process(pipeline, &s, entry_format, std::move(buf_rp));
+        }, p, &exts);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    // The mutations read before an error are still applied.
+    co_await pipeline.close();
+    if (ex) {
         try {
-            f.get();
+            std::rethrow_exception(ex);
         } catch (commitlog::segment_data_corruption_error& e) {
-            s->corrupt_bytes += e.bytes();
+            s.corrupt_bytes += e.bytes();
         } catch (commitlog::segment_truncation& e) {
-            s->truncated_at = e.position();
+            s.truncated_at = e.position();
         } catch (commitlog::header_checksum_error&) {
-            ++s->broken_files;
-        } catch (...) {
-            throw;
+            ++s.broken_files;
         }
-        return make_ready_future<stats>(*s);
+    }
+    co_return s;
+}
+
+db::commitlog_replayer::impl::replay_pipeline::replay_pipeline(const impl& i, stats& s)
+    : _impl(i)
+    , _stats(s)
+    , _batches(smp::count)
+    , _batch_bytes(smp::count)
+{ }
+
+future<> db::commitlog_replayer::impl::replay_pipeline::add(lw_shared_ptr<const frozen_mutation> fm, const column_mapping& cm,
+        replay_position rp, const dht::shard_replica_set& shards) {
+    auto size = std::min(fm->representation().size(), max_memory / smp::count);
+    for (auto shard : shards) {
+        if (_memory.available_units() < ssize_t(size)) {
+            // The memory may be held by batches which were not sent yet.
+            for (shard_id s = 0; s < smp::count; ++s) {
+                dispatch(s);
+            }
+        }
+        co_await _memory.wait(size);
+        _batches[shard].push_back(pending_mutation{fm, &cm, rp});
+        _batch_bytes[shard] += size;
+        if (_batch_bytes[shard] >= batch_size) {
+            dispatch(shard);
+        }
+    }
+}
+
+void db::commitlog_replayer::impl::replay_pipeline::dispatch(shard_id shard) {
+    if (_batches[shard].empty()) {
+        return;
+    }
+    auto batch = make_lw_shared<mutation_batch>(std::exchange(_batches[shard], {}));
+    auto bytes = std::exchange(_batch_bytes[shard], 0);
+    ++_impl._progress.local().batches_applied;
+    // The batch is only referenced by this shard, the target shard reads it.
+    // The memory is returned within the gate, since close() lets the
+    // pipeline be destroyed as soon as the gate is closed.
+    (void)with_gate(_gate, [this, shard, batch, bytes] {
+        return _impl._db.invoke_on(shard, [this, b = batch.get()] (replica::database& db) {
+            return _impl.apply_batch(db, *b);
+        }).then_wrapped([this, batch] (future<std::pair<uint64_t, uint64_t>> f) {
+            try {
+                auto [applied, invalid] = f.get();
+                _stats.applied_mutations += applied;
+                _stats.invalid_mutations += invalid;
+                _impl._progress.local().mutations_replayed += applied;
+            } catch (...) {
+                _stats.invalid_mutations += batch->size();
+                rlogger.warn("error replaying: {}", std::current_exception());
+            }
+        }).finally([this, bytes] {
+            _memory.signal(bytes);
+        });
     });
 }
 
+future<> db::commitlog_replayer::impl::replay_pipeline::close() {
+    for (shard_id s = 0; s < smp::count; ++s) {
+        dispatch(s);
+    }
+    co_await _gate.close();
+    if (_memory.available_units() != ssize_t(max_memory)) {
+        on_internal_error(rlogger, format("commitlog replay: {} bytes of mutation memory not returned after all batches were applied",
+                ssize_t(max_memory) - _memory.available_units()));
+    }
+}
+
+future<std::pair<uint64_t, uint64_t>>
+db::commitlog_replayer::impl::apply_batch(replica::database& db, const mutation_batch& batch) const {
+    uint64_t applied = 0;
+    uint64_t invalid = 0;
+    for (const auto& m : batch) {
+        const auto& fm = *m.fm;
+        auto rp = m.rp;
+        try {
+            // TODO: might need better verification that the deserialized mutation
+            // is schema compatible. My guess is that just applying the mutation
+            // will not do this.
+            auto& cf = db.find_column_family(fm.column_family_id());
+
+            if (rlogger.is_enabled(logging::log_level::debug)) {
+                rlogger.debug("replaying at {} v={} {}:{} at {}", fm.column_family_id(), fm.schema_version(),
+                        cf.schema()->ks_name(), cf.schema()->cf_name(), rp);
+            }
+            if (const auto err = validation::is_cql_key_invalid(*cf.schema(), fm.key()); err) {
+                throw std::runtime_error(fmt::format("found entry with invalid key {} at {} v={} {}:{} at {}: {}.", fm.key(), fm.column_family_id(),
+                        fm.schema_version(), cf.schema()->ks_name(), cf.schema()->cf_name(), rp, *err));
+            }
+            // Removed forwarding "new" RP. Instead give none/empty.
+            // This is what origin does, and it should be fine.
+            // The end result should be that once sstables are flushed out
+            // their "replay_position" attribute will be empty, which is
+            // lower than anything the new session will produce.
+            if (cf.schema()->version() != fm.schema_version()) {
+                auto& local_cm = _column_mappings.local().map;
+                auto cm_it = local_cm.try_emplace(fm.schema_version(), *m.cm).first;
+                const column_mapping& cm = cm_it->second;
+                mutation mut(cf.schema(), fm.decorated_key(*cf.schema()));
+                converting_mutation_partition_applier v(cm, *cf.schema(), mut.partition());
+                fm.partition().accept(cm, v);
+                co_await db.apply_in_memory(mut, cf, db::rp_handle(), db::no_timeout);
+            } else {
+                co_await db.apply_in_memory(fm, cf.schema(), db::rp_handle(), db::no_timeout, db::noop_large_data_guardrail::instance());
+            }
+            ++applied;
+        } catch (replica::no_such_column_family&) {
+            // No such CF now? Origin just ignores this.
+        } catch (...) {
+            ++invalid;
+            // TODO: write mutation to file like origin.
+            rlogger.warn("error replaying: {}", std::current_exception());
+        }
+    }
+    co_return std::pair(applied, invalid);
+}
+
 detail::commitlog_entry_serialization_format db::commitlog_replayer::impl::get_entry_format(const commitlog::descriptor& d) const {
     if (!d.descriptor_tag.empty()) {
         SCYLLA_ASSERT(d.descriptor_tag == detail::variant_format_tag);
@@ -220,14 +422,16 @@ detail::commitlog_entry_serialization_format db::commitlog_replayer::impl::get_e
     return detail::commitlog_entry_serialization_format::mutation;
 }
 
-future<> db::commitlog_replayer::impl::process(
+future<> db::commitlog_replayer::impl::process(replay_pipeline& pipeline,
         stats* s, detail::commitlog_entry_serialization_format entry_format, commitlog::buffer_and_replay_position buf_rp) const {
     auto&& buf = buf_rp.buffer;
     auto&& rp = buf_rp.position;
+    s->bytes_replayed += buf.size_bytes();
+    _progress.local().bytes_replayed += buf.size_bytes();
     try {
 
-        commitlog_entry_reader cer(buf, entry_format);
-        const auto& read_entry = cer.entry().item;
+        auto entry = commitlog_entry_reader(buf, entry_format).entry();
+        auto& read_entry = entry.item;
 
         if (std::holds_alternative<raft_commitlog_entry>(read_entry)) {
             const auto& raft_entry = std::get<raft_commitlog_entry>(read_entry);
@@ -236,9 +440,9 @@ future<> db::commitlog_replayer::impl::process(
             _raft_buffer->local().add(raft_entry.group_id, raft_entry.entry);
             co_return;
         } else if (std::holds_alternative<mutation_entry>(read_entry)) {
-            const auto& mut_entry = std::get<mutation_entry>(read_entry);
+            auto& mut_entry = std::get<mutation_entry>(read_entry);
 
-            auto& fm = mut_entry.mutation();
+            const auto& fm = mut_entry.mutation();
 
             auto& local_cm = _column_mappings.local().map;
             auto cm_it = local_cm.find(fm.schema_version());
@@ -279,56 +483,13 @@ future<> db::commitlog_replayer::impl::process(
                 co_return;
             }
 
-            auto apply = [&] (seastar::shard_id shard) {
-                return _db.invoke_on(shard, [this, &fm, &src_cm, rp] (replica::database& db) mutable -> future<> {
-                    // TODO: might need better verification that the deserialized mutation
-                    // is schema compatible. My guess is that just applying the mutation
-                    // will not do this.
-                    auto& cf = db.find_column_family(fm.column_family_id());
-
-                    if (rlogger.is_enabled(logging::log_level::debug)) {
-                        rlogger.debug("replaying at {} v={} {}:{} at {}", fm.column_family_id(), fm.schema_version(),
-                                cf.schema()->ks_name(), cf.schema()->cf_name(), rp);
-                    }
-                    if (const auto err = validation::is_cql_key_invalid(*cf.schema(), fm.key()); err) {
-                        throw std::runtime_error(fmt::format("found entry with invalid key {} at {} v={} {}:{} at {}: {}.", fm.key(), fm.column_family_id(),
-                                fm.schema_version(), cf.schema()->ks_name(), cf.schema()->cf_name(), rp, *err));
-                    }
-                    // Removed forwarding "new" RP. Instead give none/empty.
-                    // This is what origin does, and it should be fine.
-                    // The end result should be that once sstables are flushed out
-                    // their "replay_position" attribute will be empty, which is
-                    // lower than anything the new session will produce.
-                    if (cf.schema()->version() != fm.schema_version()) {
-                        auto& local_cm = _column_mappings.local().map;
-                        auto cm_it = local_cm.try_emplace(fm.schema_version(), src_cm).first;
-                        const column_mapping& cm = cm_it->second;
-                        mutation m(cf.schema(), fm.decorated_key(*cf.schema()));
-                        converting_mutation_partition_applier v(cm, *cf.schema(), m.partition());
-                        fm.partition().accept(cm, v);
-                        return do_with(std::move(m), [&db, &cf] (const mutation& m) {
-                            return db.apply_in_memory(m, cf, db::rp_handle(), db::no_timeout);
-                        });
-                    } else {
-                        return db.apply_in_memory(fm, cf.schema(), db::rp_handle(), db::no_timeout, db::noop_large_data_guardrail::instance());
-                    }
-                }).then_wrapped([s] (future<> f) {
-                    try {
-                        f.get();
-                        s->applied_mutations++;
-                    } catch (...) {
-                        s->invalid_mutations++;
-                        // TODO: write mutation to file like origin.
-                        rlogger.warn("error replaying: {}", std::current_exception());
-                    }
-                });
-            };
             auto shards = table.get_effective_replication_map()->shard_for_writes(schema, token);
             if (shards.empty()) {
                 rlogger.debug("no shard for token {} in table {}", token, uuid);
                 s->skipped_mutations++;
             } else {
-                co_await seastar::parallel_for_each(shards, apply);
+                auto m = make_lw_shared<const frozen_mutation>(std::move(mut_entry).mutation());
+                co_await pipeline.add(std::move(m), src_cm, rp, shards);
             }
         } else {
             on_fatal_internal_error(rlogger, fmt::format("Unknown variant type in commitlog entry at replay position {}", rp));
@@ -389,14 +550,16 @@ future<> db::commitlog_replayer::recover(std::vector<sstring> files, sstring fna
 
     co_await _impl->start();
     std::exception_ptr e;
+    auto start = std::chrono::steady_clock::now();
     try {
         auto totals = co_await map_reduce(this_smp_all_shards(), [&](unsigned id) -> future<impl::stats> {
             co_return co_await smp::submit_to(id, [&] () -> future<impl::stats> {
                 impl::stats total;
                 std::unordered_map<unsigned, commitlog::replay_state> states;
-                // TODO: or something. For now, we do this serialized per shard,
-                // to reduce mutation congestion. We could probably (says avi)
-                // do 2 segments in parallel or something, but lets use this first.
+                // Segments are read one at a time per shard, in ID order, which
+                // keeps fragmented entries cheap. The mutations of a segment are
+                // applied in the background by the replay_pipeline, overlapping
+                // with reading the next entries.
                 auto it = map.find(id);
                 if (it == map.end()) {
                     co_return total;
@@ -414,11 +577,12 @@ future<> db::commitlog_replayer::recover(std::vector<sstring> files, sstring fna
                     if (stats.broken_files != 0) {
                         rlogger.warn("Corrupted file header: {}. Skipped.", f);
                     }
-                    rlogger.debug("Log replay of {} complete, {} replayed mutations ({} invalid, {} skipped)"
+                    rlogger.debug("Log replay of {} complete, {} replayed mutations ({} invalid, {} skipped), {} bytes"
                                     , f
                                     , stats.applied_mutations
                                     , stats.invalid_mutations
                                     , stats.skipped_mutations
+                                    , stats.bytes_replayed
                     );
                     total += stats;
                 }
@@ -426,10 +590,14 @@ future<> db::commitlog_replayer::recover(std::vector<sstring> files, sstring fna
             });
         }, impl::stats(), std::plus<impl::stats>());
             
-        rlogger.info("Log replay complete, {} replayed mutations ({} invalid, {} skipped)"
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rlogger.info("Log replay complete, {} replayed mutations ({} invalid, {} skipped) in {:.3f}s, {:.2f} MB/s, {:.0f} mutations/s"
                         , totals.applied_mutations
                         , totals.invalid_mutations
                         , totals.skipped_mutations
+                        , seconds
+                        , seconds > 0 ? totals.bytes_replayed / seconds / (1024 * 1024) : 0.0
+                        , seconds > 0 ? totals.applied_mutations / seconds : 0.0
         );
 
     } catch (...) {
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <ranges>
 #include <unordered_map>
 
 #include "replay_position.hh"
@@ -49,6 +51,14 @@ class rp_set {
     const usage_map& usage() const {
         return _usage;
     }
+
+    // Returns true if any of the positions is in a segment
+    // which starts before rp.
+    bool has_positions_before(const replay_position& rp) const {
+        return std::ranges::any_of(_usage | std::views::keys, [&rp] (segment_id_type id) {
+            return replay_position(id, 0) < rp;
+        });
+    }
 private:
     usage_map _usage;
 };
@@ -767,7 +767,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "The directory where materialized-view updates are stored while a view replica is unreachable.")
     , logstor_directory(this, "logstor_directory", value_status::Used, "",
         "The directory where data files for logstor storage are stored.")
-    , saved_caches_directory(this, "saved_caches_directory", value_status::Unused, "",
+    , saved_caches_directory(this, "saved_caches_directory", value_status::Used, "",
         "The directory location where table key and row caches are stored.")
     /**
     * @Group Commonly used properties
@@ -912,6 +912,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "The method that Scylla uses to acknowledge writes in milliseconds:\n"
         "* periodic: Used with commitlog_sync_period_in_ms (Default: 10000 - 10 seconds ) to control how often the commit log is synchronized to disk. Periodic syncs are acknowledged immediately.\n"
         "* batch: Used with commitlog_sync_batch_window_in_ms (Default: disabled ``**``) to control how long Scylla waits for other writes before performing a sync. When using this method, writes are not acknowledged until fsynced to disk.\n"
+        "* group: Like batch, but the sync waits for other writes for a window sized from the rate of writes and the sync latency, to keep the time writes wait for the sync within commitlog_sync_group_latency_budget_in_us. When using this method, writes are not acknowledged until fsynced to disk.\n"
         "\n"
         "Related information: Durability")
     , commitlog_segment_size_in_mb(this, "commitlog_segment_size_in_mb", value_status::Used, 64,
@@ -928,6 +929,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     /* Note: does not exist on the listing page other than in above comment, wtf? */
     , commitlog_sync_batch_window_in_ms(this, "commitlog_sync_batch_window_in_ms", value_status::Used, 10000,
         "Controls how long the system waits for other writes before performing a sync in ``batch`` mode.")
+    , commitlog_sync_group_latency_budget_in_us(this, "commitlog_sync_group_latency_budget_in_us", value_status::Used, 2000,
+        "The target time from a write to its sync in ``group`` mode. A sync waits for other writes for a window which is adjusted to keep this time within the budget, and doesn't wait when the sync latency alone exceeds it.")
     , commitlog_max_data_lifetime_in_seconds(this, "commitlog_max_data_lifetime_in_seconds", liveness::LiveUpdate, value_status::Used, 24*60*60,
         "Controls how long data remains in commit log before the system tries to evict it to sstable, regardless of usage pressure. (0 disables)")
     , commitlog_total_space_in_mb(this, "commitlog_total_space_in_mb", value_status::Used, -1,
@@ -945,6 +948,16 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Whether or not to use a hard size limit for commitlog disk usage. Default is true. Enabling this can cause latency spikes, whereas disabling this can lead to occasional disk usage peaks.\n")
     , commitlog_use_fragmented_entries(this, "commitlog_use_fragmented_entries", value_status::Used, true,
         "Whether or not to allow commitlog entries to fragment across segments, allowing for larger entry sizes.\n")
+    , commitlog_compression(this, "commitlog_compression", value_status::Used, "none",
+        "Compresses commitlog entries of at least 1KiB which compress well, trading CPU for commitlog disk bandwidth. Useful when writes carry large compressible values. One of:\n"
+        "* none: Entries are written uncompressed.\n"
+        "* lz4: Fast compression with a moderate ratio.\n"
+        "* zstd: Better ratio at a higher CPU cost.\n"
+        "\n"
+        "Compressed entries are replayed regardless of this setting, but versions which do not support commitlog compression cannot replay them.")
+    , commitlog_compression_max_entry_size_in_kb(this, "commitlog_compression_max_entry_size_in_kb", value_status::Used, 128,
+        "Commitlog entries larger than this are written uncompressed, see commitlog_compression. Entries are compressed in the write path, "
+        "so this bounds the time a single write spends compressing.")
     /**
     * @Group Compaction settings
     * @GroupDescription Related information: Configuring compaction
@@ -978,6 +991,27 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Maximum delay in milliseconds for logstor separator debt control.")
     , logstor_separator_max_memory_in_mb(this, "logstor_separator_max_memory_in_mb", value_status::Used, 256,
         "Maximum memory in megabytes for logstor separator memory buffers.")
+    , logstor_index_checkpoint_interval_in_s(this, "logstor_index_checkpoint_interval_in_s", liveness::LiveUpdate, value_status::Used, 600,
+        "Interval in seconds between checkpoints of the logstor index, which let recovery skip the segments written before the checkpoint. 0 disables checkpoints.")
+    , logstor_compact_index(this, "logstor_compact_index", value_status::Used, false,
+        "Keep only the token and a short fingerprint of each key in the in-memory logstor index, instead of the whole key. "
+        "Saves memory for large partition keys, at the cost of verifying the key of each record read against its header.")
+    , logstor_compaction_segregate_cold_data(this, "logstor_compaction_segregate_cold_data", liveness::LiveUpdate, value_status::Used, true,
+        "Make logstor compaction write records which outlived a full pass over the live data to separate segments, "
+        "and choose the segments to compact by cost-benefit, so that cold records aren't rewritten along with frequently overwritten ones.")
+    , logstor_enable_record_cache(this, "logstor_enable_record_cache", liveness::LiveUpdate, value_status::Used, true,
+        "Cache the records read from logstor tables in memory shared with the row cache, so that reads of hot keys don't go to disk.")
+    , logstor_scan_readahead_partitions(this, "logstor_scan_readahead_partitions", liveness::LiveUpdate, value_status::Used, 256,
+        "Number of partitions whose records a range scan of a logstor table reads ahead together, ordered by their location on disk, "
+        "so that nearby records are read with a single read.")
+    , logstor_scan_readahead_kb(this, "logstor_scan_readahead_kb", liveness::LiveUpdate, value_status::Used, 1024,
+        "Maximum size, in KB, of the records a range scan of a logstor table reads ahead together. The records read ahead "
+        "are accounted to the memory of the read.")
+    , logstor_scan_max_concurrent_reads(this, "logstor_scan_max_concurrent_reads", liveness::LiveUpdate, value_status::Used, 8,
+        "Maximum number of concurrent disk reads issued by a range scan of a logstor table.")
+    , logstor_max_delta_chain_length(this, "logstor_max_delta_chain_length", liveness::LiveUpdate, value_status::Used, 16,
+        "Maximum number of delta records (partial updates) of a partition of a logstor table. A write which makes the chain that long "
+        "starts folding it into a full record in the background, so that reads of the partition don't have to read and merge an unbounded number of records.")
     , file_cache_size_in_mb(this, "file_cache_size_in_mb", value_status::Unused, 512,
         "Total memory to use for SSTable-reading buffers.")
     , memtable_flush_queue_size(this, "memtable_flush_queue_size", value_status::Unused, 4,
@@ -1075,12 +1109,12 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , key_cache_size_in_mb(this, "key_cache_size_in_mb", value_status::Unused, 100,
         "A global cache setting for tables. It is the maximum size of the key cache in memory. To disable set to 0.\n"
         "Related information: nodetool setcachecapacity.")
-    , row_cache_keys_to_save(this, "row_cache_keys_to_save", value_status::Unused, 0,
-        "Number of keys from the row cache to save.")
+    , row_cache_keys_to_save(this, "row_cache_keys_to_save", liveness::LiveUpdate, value_status::Used, 100000,
+        "Number of keys of the most recently used partitions, per shard, to save from the row cache. The saved keys are read into the cache on startup. (0: none)")
     , row_cache_size_in_mb(this, "row_cache_size_in_mb", value_status::Unused, 0,
         "Maximum size of the row cache in memory. Row cache can save more time than key_cache_size_in_mb, but is space-intensive because it contains the entire row. Use the row cache only for hot rows or static rows. If you reduce the size, you may not get you hottest keys loaded on start up.")
-    , row_cache_save_period(this, "row_cache_save_period", value_status::Unused, 0,
-        "Duration in seconds that rows are saved in cache. Caches are saved to saved_caches_directory.")
+    , row_cache_save_period(this, "row_cache_save_period", liveness::LiveUpdate, value_status::Used, 0,
+        "Period in seconds of saving the keys of the hottest partitions of the row cache to saved_caches_directory, so that they can be read into the cache on startup. Saved keys are also written on shutdown. (0: disabled)")
     , memory_allocator(this, "memory_allocator", value_status::Invalid, "NativeAllocator",
         "The off-heap memory allocator. In addition to caches, this property affects storage engine meta data. Supported values:\n"
         "* NativeAllocator\n"
@@ -1113,6 +1147,9 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , query_page_size_in_bytes(this, "query_page_size_in_bytes", liveness::LiveUpdate, value_status::Used, 1 << 20,
         "The size of pages in bytes, after a page accumulates this much data, the page is cut and sent to the client."
         " Setting a too large value increases the risk of OOM.")
+    , query_prefetch_partitions(this, "query_prefetch_partitions", liveness::LiveUpdate, value_status::Used, 16,
+        "The maximum number of partitions of a multi-partition query (e.g. SELECT ... WHERE pk IN (...)) whose reads are started ahead of time,"
+        " concurrently with the partition being read. Read-ahead also stays within the row and partition limits of the page, and stops once the read uses up its result size limit in memory. Set to 0 to read partitions one at a time.")
     , group0_tombstone_gc_refresh_interval_in_ms(this, "group0_tombstone_gc_refresh_interval_in_ms", value_status::Used,
               std::chrono::duration_cast<std::chrono::milliseconds>(60min).count(),
               "The interval in milliseconds at which we update the time point for safe tombstone expiration in group0 tables.")
@@ -1446,6 +1483,10 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , force_gossip_generation(this, "force_gossip_generation", liveness::LiveUpdate, value_status::Used, -1 , "Force gossip to use the generation number provided by user.")
     , experimental_features(this, "experimental_features", value_status::Used, {}, experimental_features_help_string())
     , lsa_reclamation_step(this, "lsa_reclamation_step", value_status::Used, 1, "Minimum number of segments to reclaim in a single step.")
+    , lsa_background_reclaim_min_free_memory(this, "lsa_background_reclaim_min_free_memory", value_status::Used, 60'000'000,
+        "Amount of free memory, in bytes, below which LSA memory is released in the background, ahead of allocations which would otherwise have to reclaim it synchronously.")
+    , lsa_background_reclaim_lead_time_ms(this, "lsa_background_reclaim_lead_time_ms", value_status::Used, 0,
+        "When non-zero, the free memory kept by background reclaim is raised above lsa_background_reclaim_min_free_memory, to cover this many milliseconds of LSA allocations at the recently observed peak rate. This reduces reclaim stalls under write or cache-miss bursts, at the cost of keeping more memory idle.")
     , prometheus_port(this, "prometheus_port", value_status::Used, 9180, "Prometheus port, set to zero to disable.")
     , prometheus_address(this, "prometheus_address", value_status::Used, {/* listen_address */}, "Prometheus listening address, defaulting to listen_address if not explicitly set.")
     , prometheus_prefix(this, "prometheus_prefix", value_status::Used, "scylla", "Set the prefix of the exported Prometheus metrics. Changing this will break Scylla's dashboard compatibility, do not change unless you know what you are doing.")
@@ -1476,6 +1517,15 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , enable_sstables_mc_format(this, "enable_sstables_mc_format", value_status::Unused, true, "Enable SSTables 'mc' format to be used as the default file format.  Deprecated, please use \"sstable_format\" instead.")
     , enable_sstables_md_format(this, "enable_sstables_md_format", value_status::Unused, true, "Enable SSTables 'md' format to be used as the default file format.  Deprecated, please use \"sstable_format\" instead.")
     , sstable_format(this, "sstable_format", liveness::LiveUpdate, value_status::Used, "me", "Default sstable file format", {"md", "me", "ms", "mt"})
+    , sstable_filter_format(this, "sstable_filter_format", liveness::LiveUpdate, value_status::Used, "bloom",
+        "Format of the partition key filter (the Filter component) of newly written sstables. "
+        "'bloom' is the classic Bloom filter. 'split_block' is a split block Bloom filter, which answers a lookup "
+        "with a single cache line access, at the cost of a slightly larger filter for the same false positive chance. "
+        "'binary_fuse' is a static filter built when the sstable is sealed, which needs about 20% less memory than "
+        "'bloom' for the same false positive chance; sstables with too many partitions to build it within 5% of the "
+        "shard's memory fall back to 'bloom'. "
+        "Nodes which do not support 'split_block' or 'binary_fuse' treat such filters as always matching. "
+        "Can be overridden per table with the sstable_filter_format table property.", {"bloom", "split_block", "binary_fuse"})
     , sstable_compression_user_table_options(this, "sstable_compression_user_table_options", value_status::Used, compression_parameters{compression_parameters::algorithm::lz4_with_dicts},
         "Server-global user table compression options. If enabled, all user tables"
         "will be compressed using the provided options, unless overridden"
@@ -1790,6 +1840,10 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "true: auto-adjust memtable shares for flush processes")
     , memtable_flush_static_shares(this, "memtable_flush_static_shares", liveness::LiveUpdate, value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the memtable shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity.")
+    , memtable_flush_sub_ranges(this, "memtable_flush_sub_ranges", value_status::Used, 1,
+        "Number of token sub-ranges the memtable of each vnode table is split into, rounded up to a power of 2 and capped at 256. Under memory pressure only the largest sub-range is flushed, "
+        "so its memory is released sooner and writes are throttled less on shards with large memtable space, at the cost of producing more, smaller sstables. "
+        "Tables using tablets are not affected.")
     , compaction_static_shares(this, "compaction_static_shares", liveness::LiveUpdate, value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the compaction shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity.")
     , compaction_max_shares(this, "compaction_max_shares", liveness::LiveUpdate, value_status::Used, default_compaction_maximum_shares,
@@ -1800,6 +1854,9 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Set the minimum interval in seconds between flushing all tables before each major compaction (default is 86400)."
         "This option is useful for maximizing tombstone garbage collection by releasing all active commitlog segments."
         "Set to 0 to disable automatic flushing all tables before major compaction.")
+    , compaction_cpu_offload_shards(this, "compaction_cpu_offload_shards", liveness::LiveUpdate, value_status::Used, 0,
+        "The number of sibling shards a shard's compactions may borrow CPU from, to compress and checksum their output, while those shards run no compaction of their own. "
+        "This helps shards with a compaction backlog, such as those owning a hot tablet, while other shards are idle. Set to 0 (default) to compact strictly on the owning shard.")
     , maintenance_io_throughput_mb_per_sec(this, "maintenance_io_throughput_mb_per_sec", liveness::LiveUpdate, value_status::Used, 0,
         "Throttles background I/O to the specified total throughput (in MiBs/s) across the entire system. Background I/O includes the one performed by repair and both RBNO and legacy topology operations such as adding or removing a node. Setting the value to 0 disables background IO throttling. It is recommended to set the value for this parameter to be 75% of network bandwidth")
     , backup_io_throughput_mb_per_sec(this, "backup_io_throughput_mb_per_sec", liveness::LiveUpdate, value_status::Used, 0,
@@ -256,6 +256,7 @@ class config final : public utils::config_file {
     named_value<uint32_t> schema_commitlog_segment_size_in_mb;
     named_value<uint32_t> commitlog_sync_period_in_ms;
     named_value<uint32_t> commitlog_sync_batch_window_in_ms;
+    named_value<uint32_t> commitlog_sync_group_latency_budget_in_us;
     named_value<uint32_t> commitlog_max_data_lifetime_in_seconds;
     named_value<int64_t> commitlog_total_space_in_mb;
     named_value<bool> commitlog_reuse_segments; // unused. retained for upgrade compat
@@ -263,6 +264,8 @@ class config final : public utils::config_file {
     named_value<bool> commitlog_use_o_dsync;
     named_value<bool> commitlog_use_hard_size_limit;
     named_value<bool> commitlog_use_fragmented_entries;
+    named_value<sstring> commitlog_compression;
+    named_value<uint32_t> commitlog_compression_max_entry_size_in_kb;
     named_value<bool> compaction_preheat_key_cache;
     named_value<uint32_t> concurrent_compactors;
     named_value<uint32_t> in_memory_compaction_limit_in_mb;
@@ -275,6 +278,14 @@ class config final : public utils::config_file {
     named_value<uint32_t> logstor_file_size_in_mb;
     named_value<uint32_t> logstor_separator_delay_limit_ms;
     named_value<uint32_t> logstor_separator_max_memory_in_mb;
+    named_value<uint32_t> logstor_index_checkpoint_interval_in_s;
+    named_value<bool> logstor_compact_index;
+    named_value<bool> logstor_compaction_segregate_cold_data;
+    named_value<bool> logstor_enable_record_cache;
+    named_value<uint32_t> logstor_scan_readahead_partitions;
+    named_value<uint32_t> logstor_scan_readahead_kb;
+    named_value<uint32_t> logstor_scan_max_concurrent_reads;
+    named_value<uint32_t> logstor_max_delta_chain_length;
     named_value<uint32_t> file_cache_size_in_mb;
     named_value<uint32_t> memtable_flush_queue_size;
     named_value<uint32_t> memtable_flush_writers;
@@ -318,6 +329,7 @@ class config final : public utils::config_file {
     named_value<uint32_t> tombstone_failure_threshold;
     named_value<uint64_t> query_tombstone_page_limit;
     named_value<uint64_t> query_page_size_in_bytes;
+    named_value<uint32_t> query_prefetch_partitions;
     named_value<uint32_t> group0_tombstone_gc_refresh_interval_in_ms;
     named_value<uint32_t> range_request_timeout_in_ms;
     named_value<uint32_t> read_request_timeout_in_ms;
@@ -431,6 +443,8 @@ class config final : public utils::config_file {
     named_value<int32_t> force_gossip_generation;
     named_value<std::vector<enum_option<experimental_features_t>>> experimental_features;
     named_value<size_t> lsa_reclamation_step;
+    named_value<size_t> lsa_background_reclaim_min_free_memory;
+    named_value<uint32_t> lsa_background_reclaim_lead_time_ms;
     named_value<uint16_t> prometheus_port;
     named_value<sstring> prometheus_address;
     named_value<sstring> prometheus_prefix;
@@ -453,6 +467,7 @@ class config final : public utils::config_file {
     named_value<bool> enable_sstables_mc_format;
     named_value<bool> enable_sstables_md_format;
     named_value<sstring> sstable_format;
+    named_value<sstring> sstable_filter_format;
 
     // NOTE: Do not use this option directly.
     // Use get_sstable_compression_user_table_options() instead.
@@ -662,10 +677,12 @@ class config final : public utils::config_file {
     named_value<double> background_writer_scheduling_quota;
     named_value<bool> auto_adjust_flush_quota;
     named_value<float> memtable_flush_static_shares;
+    named_value<uint32_t> memtable_flush_sub_ranges;
     named_value<float> compaction_static_shares;
     named_value<float> compaction_max_shares;
     named_value<bool> compaction_enforce_min_threshold;
     named_value<uint32_t> compaction_flush_all_tables_before_major_seconds;
+    named_value<uint32_t> compaction_cpu_offload_shards;
 
     named_value<uint32_t> maintenance_io_throughput_mb_per_sec;
     named_value<uint32_t> backup_io_throughput_mb_per_sec;
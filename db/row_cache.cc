@@ -14,6 +14,7 @@
 #include <seastar/core/thread.hh>
 #include <seastar/core/coroutine.hh>
 #include <seastar/coroutine/as_future.hh>
+#include <seastar/coroutine/maybe_yield.hh>
 #include <seastar/util/defer.hh>
 #include "replica/memtable.hh"
 #include <boost/version.hpp>
@@ -30,6 +31,9 @@
 #include "utils/updateable_value.hh"
 #include "utils/labels.hh"
 #include "utils/chunked_vector.hh"
+#include "utils/fragment_range.hh"
+#include <unordered_map>
+#include <unordered_set>
 
 namespace cache {
 
@@ -68,11 +72,18 @@ cache_tracker::cache_tracker(utils::updateable_value<double> index_cache_fractio
 
 static thread_local cache_tracker* current_tracker;
 
+// Sized for partitions of 8KiB on average, which takes two counter bits per
+// partition, so at most 1/32768 of memory.
+static size_t admission_sketch_items() {
+    return std::clamp<size_t>(memory::stats().total_memory() / 8192, 1024, 4 << 20);
+}
+
 cache_tracker::cache_tracker(utils::updateable_value<double> index_cache_fraction, mutation_application_stats& app_stats, register_metrics with_metrics)
     : _garbage(_region, this, app_stats)
     , _memtable_cleaner(_region, nullptr, app_stats)
     , _app_stats(app_stats)
     , _index_cache_fraction(std::move(index_cache_fraction))
+    , _admission_sketch(admission_sketch_items())
 {
     if (with_metrics) {
         setup_metrics();
@@ -133,6 +144,111 @@ memory::reclaiming_result cache_tracker::evict_from_lru_shallow() noexcept {
     });
 }
 
+namespace {
+
+// Marks how far a walk over the LRU got. It stays in place when the entries
+// around it are touched or evicted, and is evicted itself only once all
+// entries less recently used than it are gone.
+class lru_cursor final : public evictable {
+public:
+    void on_evicted() noexcept override {}
+};
+
+}
+
+future<utils::chunked_vector<cache_tracker::hot_partition>> cache_tracker::hottest_partitions(size_t max_partitions, size_t max_rows) {
+    utils::chunked_vector<hot_partition> result;
+    if (!max_partitions || !max_rows) {
+        co_return result;
+    }
+
+    // Rows are visited in batches under a reclaim lock, so that entries
+    // don't move while their keys are copied. Nothing is allocated under the
+    // lock: keys are copied into a buffer reserved up front, and turned into
+    // partition keys after the lock is released.
+    struct batch_entry {
+        table_id table;
+        dht::token token;
+        size_t offset;
+        size_t size;
+    };
+    constexpr size_t rows_per_batch = 128;
+    // Large enough for any partition key, which is at most 64KiB.
+    constexpr size_t key_buffer_size = 128 * 1024;
+    std::vector<batch_entry> batch;
+    batch.reserve(rows_per_batch);
+    std::vector<bytes::value_type> key_buffer;
+    key_buffer.reserve(key_buffer_size);
+    std::unordered_map<table_id, std::unordered_set<bytes>> seen;
+
+    lru_cursor cursor;
+    _lru.add(cursor);
+    auto unlink_cursor = defer([&] () noexcept {
+        if (cursor.is_linked()) {
+            _lru.remove(cursor);
+        }
+    });
+
+    size_t visited = 0;
+    while (visited < max_rows && result.size() < max_partitions && cursor.is_linked()) {
+        batch.clear();
+        key_buffer.clear();
+        {
+            logalloc::reclaim_lock rl(_region);
+            evictable* last = nullptr;
+            size_t batch_rows = 0;
+            _lru.for_each_less_recent(cursor, [&] (evictable& e) {
+                if (visited == max_rows || batch_rows == rows_per_batch) {
+                    return false;
+                }
+                // Only rows of the data cache can lead us to a partition.
+                if (!e.is_index() && !e.is_logstor_record()) {
+                    auto& row = static_cast<rows_entry&>(e);
+                    mutation_partition_v2::rows_type::iterator it(&row);
+                    auto& pv = partition_version::container_of(mutation_partition_v2::container_of(*it.tree_of()));
+                    // Older versions don't link back to their cache_entry, but the partition
+                    // is still found through the rows of its latest version.
+                    if (pv.is_referenced_from_entry()) {
+                        const cache_entry& ce = cache_entry::container_of(partition_entry::container_of(pv));
+                        if (!ce.is_dummy_entry()) {
+                            auto key = ce.key().key().representation();
+                            if (key_buffer.size() + key.size() > key_buffer.capacity()) {
+                                return false;
+                            }
+                            batch.push_back(batch_entry{ce.schema()->id(), ce.key().token(), key_buffer.size(), key.size()});
+                            for (bytes_view frag : fragment_range(key)) {
+                                key_buffer.insert(key_buffer.end(), frag.begin(), frag.end());
+                            }
+                        }
+                    }
+                }
+                ++visited;
+                ++batch_rows;
+                last = &e;
+                return true;
+            });
+            if (!last) {
+                break;
+            }
+            _lru.remove(cursor);
+            _lru.add_before(*last, cursor);
+        }
+
+        for (const auto& be : batch) {
+            auto key = bytes_view(key_buffer.data() + be.offset, be.size);
+            if (!seen[be.table].emplace(key).second) {
+                continue;
+            }
+            result.push_back(hot_partition{be.table, dht::decorated_key(be.token, partition_key::from_bytes(key))});
+            if (result.size() == max_partitions) {
+                break;
+            }
+        }
+        co_await coroutine::maybe_yield();
+    }
+    co_return result;
+}
+
 void cache_tracker::set_compaction_scheduling_group(seastar::scheduling_group sg) {
     _memtable_cleaner.set_scheduling_group(sg);
     _garbage.set_scheduling_group(sg);
@@ -189,6 +305,10 @@ cache_tracker::setup_metrics() {
             sm::description("total amount of attempts to compact expired rows during read")),
         sm::make_counter("rows_compacted_away", _stats.rows_compacted_away,
             sm::description("total amount of compacted and removed rows during read")),
+        sm::make_counter("partition_admissions", _stats.partition_admissions,
+            sm::description("number of partitions missing in cache which were populated by reads of tables with frequency-based admission")),
+        sm::make_counter("partition_rejections", _stats.partition_rejections,
+            sm::description("number of partitions missing in cache which were not populated by reads of tables with frequency-based admission, because they were not accessed frequently enough")),
     });
     sstables::register_index_page_cache_metrics(_metrics, _index_cached_file_stats);
     sstables::register_index_page_metrics(_metrics, _partition_index_cache_stats);
@@ -277,6 +397,44 @@ void cache_tracker::on_miss_already_populated() noexcept {
     ++_stats.concurrent_misses_same_key;
 }
 
+static uint64_t admission_hash(const schema& s, const dht::decorated_key& key) noexcept {
+    return uint64_t(key.token().raw()) ^ std::hash<table_id>()(s.id());
+}
+
+void cache_tracker::on_partition_access(const schema& s, const dht::decorated_key& key) noexcept {
+    if (s.caching_options().frequency_admission()) {
+        _admission_sketch.increment(admission_hash(s, key));
+    }
+}
+
+bool cache_tracker::under_eviction_pressure() noexcept {
+    // Admission is restricted only while cache is full. Consider it full for
+    // a while after the last observed eviction, so that it doesn't flip on
+    // every eviction round.
+    static constexpr auto pressure_period = std::chrono::seconds(10);
+    auto now = seastar::lowres_clock::now();
+    if (_stats.row_evictions != _row_evictions_seen) {
+        _row_evictions_seen = _stats.row_evictions;
+        _last_eviction_seen = now;
+        return true;
+    }
+    return _row_evictions_seen && now - _last_eviction_seen < pressure_period;
+}
+
+bool cache_tracker::admit(const schema& s, const dht::decorated_key& key) {
+    if (!s.caching_options().frequency_admission()) {
+        return true;
+    }
+    auto hash = admission_hash(s, key);
+    _admission_sketch.increment(hash);
+    if (under_eviction_pressure() && _admission_sketch.frequency(hash) < admission_min_frequency) {
+        ++_stats.partition_rejections;
+        return false;
+    }
+    ++_stats.partition_admissions;
+    return true;
+}
+
 void cache_tracker::pinned_dirty_memory_overload(uint64_t bytes) noexcept {
     _stats.pinned_dirty_memory_overload += bytes;
 }
@@ -426,21 +584,25 @@ class single_partition_populating_reader final : public mutation_reader::impl {
           return _read_context->underlying().underlying()().then([this, phase] (auto&& mfopt) {
             if (!mfopt) {
                 if (phase == _cache.phase_of(_read_context->range().start()->value())) {
-                    _cache._read_section(_cache._tracker.region(), [this] {
-                        _cache.find_or_create_missing(_read_context->key());
-                    });
+                    if (_cache.admit(_read_context->key())) {
+                        _cache._read_section(_cache._tracker.region(), [this] {
+                            _cache.find_or_create_missing(_read_context->key());
+                        });
+                    }
                 } else {
                     _cache._tracker.on_mispopulate();
                 }
                 _end_of_stream = true;
-            } else if (phase == _cache.phase_of(_read_context->range().start()->value())) {
+            } else if (phase != _cache.phase_of(_read_context->range().start()->value())) {
+                _cache._tracker.on_mispopulate();
+                _reader = read_directly_from_underlying(*_read_context, std::move(*mfopt));
+            } else if (!_cache.admit(mfopt->as_partition_start().key())) {
+                _reader = read_directly_from_underlying(*_read_context, std::move(*mfopt));
+            } else {
                 _reader = _cache._read_section(_cache._tracker.region(), [&] {
                     cache_entry& e = _cache.find_or_create_incomplete(mfopt->as_partition_start(), phase);
                     return e.read(_cache, *_read_context, phase);
                 });
-            } else {
-                _cache._tracker.on_mispopulate();
-                _reader = read_directly_from_underlying(*_read_context, std::move(*mfopt));
             }
           });
         });
@@ -496,8 +658,13 @@ void cache_tracker::clear_continuity(cache_entry& ce) noexcept {
     ce.set_continuous(false);
 }
 
-void row_cache::on_partition_hit() {
+void row_cache::on_partition_hit(const dht::decorated_key& key) {
     _tracker.on_partition_hit();
+    _tracker.on_partition_access(*_schema, key);
+}
+
+bool row_cache::admit(const dht::decorated_key& key) {
+    return _tracker.admit(*_schema, key);
 }
 
 void row_cache::on_partition_miss() {
@@ -577,7 +744,11 @@ class range_populating_reader {
                 _cache.on_partition_miss();
                 const partition_start& ps = mfopt->as_partition_start();
                 const dht::decorated_key& key = ps.key();
-                if (_reader.creation_phase() == _cache.phase_of(key)) {
+                bool can_populate = _reader.creation_phase() == _cache.phase_of(key);
+                if (!can_populate) {
+                    _cache._tracker.on_mispopulate();
+                }
+                if (can_populate && _cache.admit(key)) {
                     return _cache._read_section(_cache._tracker.region(), [&] {
                         cache_entry& e = _cache.find_or_create_incomplete(ps, _reader.creation_phase(),
                                                                this->can_set_continuity() ? &*_last_key : nullptr);
@@ -585,7 +756,7 @@ class range_populating_reader {
                         return make_ready_future<mutation_reader_opt>(e.read(_cache, _read_context, _reader.creation_phase()));
                     });
                 } else {
-                    _cache._tracker.on_mispopulate();
+                    // Not inserting the partition breaks continuity with the next one.
                     _last_key = row_cache::previous_entry_pointer(key);
                     return make_ready_future<mutation_reader_opt>(read_directly_from_underlying(_read_context, std::move(*mfopt)));
                 }
@@ -625,7 +796,7 @@ class scanning_and_populating_reader final : public mutation_reader::impl {
 private:
     mutation_reader read_from_entry(cache_entry& ce) {
         _cache.upgrade_entry(ce);
-        _cache.on_partition_hit();
+        _cache.on_partition_hit(ce.key());
         return ce.read(_cache, *_read_context);
     }
 
@@ -797,7 +968,7 @@ row_cache::make_reader_opt(schema_ptr s,
             if (hint.match) {
                 cache_entry& e = *i;
                 upgrade_entry(e);
-                on_partition_hit();
+                on_partition_hit(e.key());
                 return e.read(*this, make_context());
             } else if (i->continuous()) {
                 return {};
@@ -261,8 +261,10 @@ class row_cache final {
     logalloc::allocating_section _read_section;
     mutation_reader create_underlying_reader(cache::read_context&, mutation_source&, const dht::partition_range&);
     mutation_reader make_scanning_reader(const dht::partition_range&, std::unique_ptr<cache::read_context>);
-    void on_partition_hit();
+    void on_partition_hit(const dht::decorated_key&);
     void on_partition_miss();
+    // Decides whether a read which missed the partition may populate it.
+    bool admit(const dht::decorated_key&);
     void on_row_hit();
     void on_row_miss();
     void on_static_row_insert();
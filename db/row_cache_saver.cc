@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include <ranges>
+
+#include <seastar/core/byteorder.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/coroutine/maybe_yield.hh>
+#include <seastar/coroutine/parallel_for_each.hh>
+#include <seastar/util/closeable.hh>
+
+#include "db/row_cache_saver.hh"
+#include "replica/database.hh"
+#include "utils/fragment_range.hh"
+#include "utils/log.hh"
+
+namespace db {
+
+static logging::logger rcslogger("row_cache_saver");
+
+// File layout: a sequence of records, each being
+//   table id (16 bytes, most significant bits first)
+//   partition key length (4 bytes, big-endian)
+//   partition key representation
+// Files are written to a temporary name and renamed, so a file is either
+// complete or absent.
+static constexpr size_t record_header_size = 2 * sizeof(int64_t) + sizeof(uint32_t);
+
+// How many LRU entries to visit per key to save, to bound the time spent
+// walking the LRU when partitions have many cached rows.
+static constexpr size_t rows_visited_per_key = 16;
+
+row_cache_saver::row_cache_saver(replica::database& db, config cfg)
+    : _db(db)
+    , _cfg(std::move(cfg))
+{
+    setup_metrics();
+}
+
+void row_cache_saver::setup_metrics() {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("cache", {
+        sm::make_counter("saved_keys", _stats.keys_saved,
+            sm::description("total number of hot partition keys saved to saved_caches_directory")),
+        sm::make_counter("preloaded_keys", _stats.keys_loaded,
+            sm::description("total number of saved partition keys read into cache on startup")),
+        sm::make_counter("preload_skipped_keys", _stats.keys_skipped,
+            sm::description("total number of saved partition keys skipped on startup because their table is gone or doesn't use cache")),
+        sm::make_counter("preload_failures", _stats.load_failures,
+            sm::description("total number of failed reads while pre-populating cache from saved keys")),
+    });
+}
+
+std::filesystem::path row_cache_saver::file_for(unsigned shard) const {
+    return _cfg.directory / fmt::format("row_cache-{}.keys", shard);
+}
+
+future<> row_cache_saver::start() {
+    if (!_cfg.save_period_in_seconds()) {
+        rcslogger.debug("Saving row cache is disabled");
+    }
+    _loader = with_gate(_gate, [this] {
+        return with_scheduling_group(_cfg.sched_group, [this] {
+            return load();
+        });
+    }).handle_exception([] (std::exception_ptr ep) {
+        rcslogger.warn("Failed to pre-populate row cache from saved keys: {}", ep);
+    });
+    _saver = run_saver();
+    return make_ready_future<>();
+}
+
+future<> row_cache_saver::stop() {
+    _as.request_abort();
+    co_await std::exchange(_saver, make_ready_future<>());
+    co_await _gate.close();
+    co_await std::exchange(_loader, make_ready_future<>());
+    if (_cfg.save_period_in_seconds() && _cfg.keys_to_save()) {
+        try {
+            co_await save();
+        } catch (...) {
+            rcslogger.warn("Failed to save row cache keys on shutdown: {}", std::current_exception());
+        }
+    }
+}
+
+future<> row_cache_saver::run_saver() {
+    while (!_as.abort_requested()) {
+        // A period of 0 disables saving, but it is live-updateable, so keep polling.
+        auto period = std::chrono::seconds(_cfg.save_period_in_seconds());
+        try {
+            co_await sleep_abortable(period.count() ? period : std::chrono::seconds(60), _as);
+        } catch (const sleep_aborted&) {
+            break;
+        }
+        if (!_cfg.save_period_in_seconds() || !_cfg.keys_to_save()) {
+            continue;
+        }
+        try {
+            co_await with_scheduling_group(_cfg.sched_group, [this] { return save(); });
+        } catch (...) {
+            rcslogger.warn("Failed to save row cache keys: {}", std::current_exception());
+        }
+    }
+}
+
+future<> row_cache_saver::save() {
+    size_t limit = _cfg.keys_to_save();
+    auto hot = co_await _db.row_cache_tracker().hottest_partitions(limit, limit * rows_visited_per_key);
+
+    auto path = file_for(this_shard_id());
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    auto f = co_await open_file_dma(tmp_path.native(), open_flags::wo | open_flags::create | open_flags::truncate);
+    auto out = co_await make_file_output_stream(std::move(f));
+    std::exception_ptr ex;
+    try {
+        std::array<char, record_header_size> header;
+        for (const auto& hp : hot) {
+            auto key = hp.key.key().representation();
+            write_be<int64_t>(header.data(), hp.table.uuid().get_most_significant_bits());
+            write_be<int64_t>(header.data() + sizeof(int64_t), hp.table.uuid().get_least_significant_bits());
+            write_be<uint32_t>(header.data() + 2 * sizeof(int64_t), key.size());
+            co_await out.write(header.data(), header.size());
+            for (bytes_view frag : fragment_range(key)) {
+                co_await out.write(reinterpret_cast<const char*>(frag.data()), frag.size());
+            }
+        }
+        co_await out.flush();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await out.close();
+    if (ex) {
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_await rename_file(tmp_path.native(), path.native());
+    co_await sync_directory(_cfg.directory.native());
+
+    ++_stats.saves;
+    _stats.keys_saved += hot.size();
+    rcslogger.debug("Saved {} row cache keys to {}", hot.size(), path.native());
+}
+
+future<utils::chunked_vector<row_cache_saver::saved_key>> row_cache_saver::read_file(std::filesystem::path path) {
+    utils::chunked_vector<saved_key> keys;
+    auto f = co_await open_file_dma(path.native(), open_flags::ro);
+    auto in = make_file_input_stream(std::move(f));
+    std::exception_ptr ex;
+    try {
+        while (true) {
+            auto header = co_await in.read_exactly(record_header_size);
+            if (header.size() != record_header_size) {
+                if (!header.empty()) {
+                    rcslogger.warn("Truncated record in {}, ignoring the rest of the file", path.native());
+                }
+                break;
+            }
+            auto msb = read_be<int64_t>(header.get());
+            auto lsb = read_be<int64_t>(header.get() + sizeof(int64_t));
+            auto len = read_be<uint32_t>(header.get() + 2 * sizeof(int64_t));
+            auto key = co_await in.read_exactly(len);
+            if (key.size() != len) {
+                rcslogger.warn("Truncated record in {}, ignoring the rest of the file", path.native());
+                break;
+            }
+            keys.push_back(saved_key{table_id(utils::UUID(msb, lsb)), bytes(reinterpret_cast<const int8_t*>(key.get()), key.size())});
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await in.close();
+    if (ex) {
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_return keys;
+}
+
+future<> row_cache_saver::load() {
+    if (!_cfg.save_period_in_seconds()) {
+        co_return;
+    }
+    // Shard s is responsible for files of shards s, s + smp::count, ...
+    // so that keys saved with a different shard count are not lost.
+    for (unsigned file_shard = this_shard_id(); !_as.abort_requested(); file_shard += smp::count) {
+        auto path = file_for(file_shard);
+        if (!co_await file_exists(path.native())) {
+            break;
+        }
+        auto keys = co_await read_file(path);
+        rcslogger.info("Pre-populating row cache with {} keys from {}", keys.size(), path.native());
+
+        std::vector<utils::chunked_vector<saved_key>> per_shard(smp::count);
+        for (auto& k : keys) {
+            auto t = _db.get_tables_metadata().get_table_if_exists(k.table);
+            if (!t) {
+                ++_stats.keys_skipped;
+                continue;
+            }
+            auto dk = dht::decorate_key(*t->schema(), partition_key::from_bytes(managed_bytes(k.key)));
+            per_shard[t->shard_for_reads(dk.token())].push_back(std::move(k));
+            co_await coroutine::maybe_yield();
+        }
+        co_await coroutine::parallel_for_each(std::views::iota(0u, smp::count), [&] (unsigned shard) {
+            return container().invoke_on(shard, [keys = std::move(per_shard[shard])] (row_cache_saver& saver) mutable {
+                return saver.populate(std::move(keys));
+            });
+        });
+
+        if (file_shard >= smp::count) {
+            // Not going to be overwritten by any shard.
+            co_await remove_file(path.native());
+        }
+    }
+}
+
+future<> row_cache_saver::populate(utils::chunked_vector<saved_key> keys) {
+    auto holder = _gate.hold();
+    co_await with_scheduling_group(_cfg.sched_group, [this, &keys] {
+        return max_concurrent_for_each(keys, load_concurrency, [this] (const saved_key& k) -> future<> {
+            if (_as.abort_requested()) {
+                co_return;
+            }
+            auto t = _db.get_tables_metadata().get_table_if_exists(k.table);
+            if (!t || !t->cache_enabled()) {
+                ++_stats.keys_skipped;
+                co_return;
+            }
+            auto s = t->schema();
+            auto pr = dht::partition_range::make_singular(dht::decorate_key(*s, partition_key::from_bytes(managed_bytes(k.key))));
+            try {
+                auto permit = co_await _db.obtain_reader_permit(*t, "row_cache_preload", db::no_timeout, {});
+                // Reading through the table populates the cache on the way.
+                auto rd = t->make_mutation_reader(s, std::move(permit), pr, s->full_slice());
+                co_await with_closeable(std::move(rd), [] (mutation_reader& rd) {
+                    return rd.consume_pausable([] (mutation_fragment_v2) {
+                        return stop_iteration::no;
+                    });
+                });
+                ++_stats.keys_loaded;
+            } catch (...) {
+                ++_stats.load_failures;
+                rcslogger.debug("Failed to pre-populate {}.{} key {}: {}", s->ks_name(), s->cf_name(), pr, std::current_exception());
+            }
+        });
+    });
+}
+
+}
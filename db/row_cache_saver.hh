@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include <filesystem>
+
+#include <seastar/core/sharded.hh>
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/metrics_registration.hh>
+
+#include "utils/chunked_vector.hh"
+#include "utils/updateable_value.hh"
+#include "schema/schema_fwd.hh"
+#include "bytes.hh"
+
+using namespace seastar;
+
+namespace replica {
+class database;
+}
+
+namespace db {
+
+// Makes restarts warm by persisting the row cache hot set.
+//
+// Every row_cache_save_period seconds, each shard saves the keys of the
+// row_cache_keys_to_save most recently used partitions of its row cache
+// (see cache_tracker::hottest_partitions()) to its own file in
+// saved_caches_directory. On startup, the saved keys are routed to the
+// shards which currently own them and read through the regular, populating,
+// cache read path, with bounded concurrency and in the maintenance
+// scheduling group, so that the node rejoins with its working set resident.
+//
+// Saved keys of tables which no longer exist, or which are no longer owned
+// by this node, are skipped.
+class row_cache_saver : public peering_sharded_service<row_cache_saver> {
+public:
+    struct config {
+        std::filesystem::path directory;
+        utils::updateable_value<uint32_t> keys_to_save;
+        utils::updateable_value<uint32_t> save_period_in_seconds;
+        seastar::scheduling_group sched_group;
+    };
+
+    struct saved_key {
+        table_id table;
+        bytes key; // partition_key representation
+    };
+
+    struct stats {
+        uint64_t saves = 0;
+        uint64_t keys_saved = 0;
+        uint64_t keys_loaded = 0;
+        uint64_t keys_skipped = 0;
+        uint64_t load_failures = 0;
+    };
+
+    // Maximum number of concurrent populating reads per shard issued while loading.
+    static constexpr size_t load_concurrency = 4;
+private:
+    replica::database& _db;
+    config _cfg;
+    stats _stats;
+    abort_source _as;
+    gate _gate;
+    future<> _saver = make_ready_future<>();
+    future<> _loader = make_ready_future<>();
+    seastar::metrics::metric_groups _metrics;
+
+    std::filesystem::path file_for(unsigned shard) const;
+    future<> save();
+    future<> run_saver();
+    future<> load();
+    future<utils::chunked_vector<saved_key>> read_file(std::filesystem::path);
+    future<> populate(utils::chunked_vector<saved_key>);
+    void setup_metrics();
+public:
+    row_cache_saver(replica::database&, config);
+
+    // Starts pre-populating the cache from the saved keys in the background,
+    // and the periodic saving of the hot set.
+    future<> start();
+    // Saves the hot set one last time, if enabled, and stops background work.
+    future<> stop();
+
+    const stats& get_stats() const noexcept { return _stats; }
+};
+
+}
@@ -323,6 +323,7 @@ schema_ptr scylla_tables(schema_features features) {
 
         sb.with_column("storage_engine", utf8_type);
         sb.with_column("large_data_guardrails_enabled", boolean_type);
+        sb.with_column("sstable_filter_format", utf8_type);
 
         sb.with_hash_version();
         s = sb.build();
@@ -1688,6 +1689,11 @@ mutation make_scylla_tables_mutation(schema_ptr table, api::timestamp_type times
         m.set_clustered_cell(ckey, guardrails_cdef,
                              atomic_cell::make_live(*boolean_type, timestamp, boolean_type->decompose(true)));
     }
+    // Like large_data_guardrails_enabled, written only when set, which
+    // the CQL validation allows only once all nodes support the column.
+    if (!table->sstable_filter_format().empty()) {
+        m.set_clustered_cell(ckey, "sstable_filter_format", table->sstable_filter_format(), timestamp);
+    }
     // In-memory tables are deprecated since scylla-2024.1.0
     // FIXME: delete the column when there's no live version supporting it anymore.
     // Writing it here breaks upgrade rollback to versions that do not support the in_memory schema_feature
@@ -1942,6 +1948,16 @@ utils::chunked_vector<mutation> make_update_table_mutations(service::storage_pro
         m.set_clustered_cell(ckey, guardrails_cdef, atomic_cell::make_dead(timestamp, gc_clock::now()));
         mutations.emplace_back(std::move(m));
     }
+    // Likewise when sstable_filter_format is reset to the node default.
+    if (!old_table->sstable_filter_format().empty() && new_table->sstable_filter_format().empty()) {
+        schema_ptr s = tables();
+        auto pkey = partition_key::from_singular(*s, new_table->ks_name());
+        auto ckey = clustering_key::from_singular(*s, new_table->cf_name());
+        mutation m(scylla_tables(), pkey);
+        auto& cdef = *scylla_tables()->get_column_definition("sstable_filter_format");
+        m.set_clustered_cell(ckey, cdef, atomic_cell::make_dead(timestamp, gc_clock::now()));
+        mutations.emplace_back(std::move(m));
+    }
 
     make_update_columns_mutations(std::move(old_table), std::move(new_table), timestamp, mutations);
 
@@ -2205,6 +2221,9 @@ static void prepare_builder_from_scylla_tables_row(const schema_ctxt& ctxt, sche
     }
     auto guardrails_enabled = table_row.get<bool>("large_data_guardrails_enabled");
     builder.set_large_data_guardrails_enabled(guardrails_enabled.value_or(false));
+    if (auto filter_format = table_row.get<sstring>("sstable_filter_format")) {
+        builder.set_sstable_filter_format(*filter_format);
+    }
 }
 
 schema_ptr create_table_from_mutations(const schema_ctxt& ctxt, schema_mutations sm, const data_dictionary::user_types_storage& user_types, schema_ptr cdc_schema, std::optional<table_schema_version> version)
@@ -187,6 +187,9 @@ class feature_service final : public peering_sharded_service<feature_service> {
     gms::feature view_building_tasks_min_task_id { *this, "VIEW_BUILDING_TASKS_MIN_TASK_ID"sv };
     gms::feature quiesce_topology_enhanced { *this, "QUIESCE_TOPOLOGY_ENHANCED"sv };
     gms::feature tablet_pow2_convergence { *this, "TABLET_POW2_CONVERGENCE"sv };
+    gms::feature sstable_filter_format { *this, "SSTABLE_FILTER_FORMAT"sv };
+    gms::feature sstable_compression_per_sstable_dicts { *this, "SSTABLE_COMPRESSION_PER_SSTABLE_DICTS"sv };
+    gms::feature row_cache_frequency_admission { *this, "ROW_CACHE_FREQUENCY_ADMISSION"sv };
 public:
 
     const std::unordered_map<sstring, std::reference_wrapper<feature>>& registered_features() const;
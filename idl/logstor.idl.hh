@@ -21,6 +21,47 @@ class log_record_header {
     replica::logstor::primary_index_key key;
     api::timestamp_type timestamp;
     table_id table;
+    bool delta [[version 2026.3]];
+};
+
+struct log_segment_id {
+    uint32_t value;
+};
+
+struct log_location {
+    replica::logstor::log_segment_id segment;
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct index_entry {
+    replica::logstor::log_location location;
+    api::timestamp_type timestamp;
+    bool delta [[version 2026.3]];
+};
+
+struct segment_sequence {
+    uint64_t value;
+};
+
+struct index_checkpoint_entry {
+    replica::logstor::primary_index_key key;
+    replica::logstor::index_entry entry;
+    replica::logstor::segment_sequence segment_seq;
+};
+
+struct compact_index_checkpoint_entry {
+    int64_t token;
+    uint32_t fingerprint;
+    replica::logstor::index_entry entry;
+    replica::logstor::segment_sequence segment_seq;
+};
+
+struct index_checkpoint_chunk {
+    table_id table;
+    std::vector<replica::logstor::index_checkpoint_entry> entries;
+    std::vector<replica::logstor::compact_index_checkpoint_entry> compact_entries;
+    std::vector<replica::logstor::index_checkpoint_entry> delta_entries [[version 2026.3]];
 };
 
 }
@@ -125,6 +125,7 @@
 #include "message/shared_dict.hh"
 #include "message/dictionary_service.hh"
 #include "sstable_dict_autotrainer.hh"
+#include "db/row_cache_saver.hh"
 #include "utils/disk_space_monitor.hh"
 #include "auth/cache.hh"
 #include "utils/labels.hh"
@@ -821,6 +822,9 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
     // inherit Seastar's CPU affinity masks. We want this thread to be free
     // to migrate between CPUs; we think that's what makes the most sense.
     auto rpc_dict_training_worker = utils::alien_worker(startlog, 19, "rpc-dict");
+    // Trains per-sstable compression dicts for compaction, apart from the
+    // RPC dicts so that neither has to wait behind the other.
+    auto sstable_dict_training_worker = utils::alien_worker(startlog, 19, "sst-dict");
 
     return app.run(ac, av, [&] () -> future<int> {
 
@@ -850,7 +854,7 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
         return seastar::async([&app, cfg, ext, &disk_space_monitor_shard0, &cm, &sstm, &db, &qp, &bm, &proxy, &mapreduce_service, &mm, &mm_notifier, &ctx, &opts, &dirs,
                 &prometheus_server, &cf_cache_hitrate_calculator, &load_meter, &feature_service, &gossiper, &snitch,
                 &token_metadata, &erm_factory, &snapshot_ctl, &messaging, &sst_dir_semaphore, &raft_gr, &service_memory_limiter,
-                &repair, &sst_loader, &auth_cache, &ss, &lifecycle_notifier, &stream_manager, &task_manager, &rpc_dict_training_worker, &vector_store_client] {
+                &repair, &sst_loader, &auth_cache, &ss, &lifecycle_notifier, &stream_manager, &task_manager, &rpc_dict_training_worker, &sstable_dict_training_worker, &vector_store_client] {
           try {
               if (opts.contains("relabel-config-file") && !opts["relabel-config-file"].as<sstring>().empty()) {
                   // calling update_relabel_config_from_file can cause an exception that would stop startup
@@ -986,6 +990,8 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
                 st_cfg.defragment_on_idle = cfg->defragment_memory_on_idle();
                 st_cfg.abort_on_lsa_bad_alloc = cfg->abort_on_lsa_bad_alloc();
                 st_cfg.lsa_reclamation_step = cfg->lsa_reclamation_step();
+                st_cfg.background_reclaim_min_free_memory = cfg->lsa_background_reclaim_min_free_memory();
+                st_cfg.background_reclaim_lead_time = std::chrono::milliseconds(cfg->lsa_background_reclaim_lead_time_ms());
                 st_cfg.background_reclaim_sched_group = background_reclaim_scheduling_group;
                 st_cfg.sanitizer_report_backtrace = cfg->sanitizer_report_backtrace();
                 logalloc::shard_tracker().configure(st_cfg);
@@ -1173,6 +1179,7 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
             utils::directories::set dir_set;
             dir_set.add(cfg->commitlog_directory());
             dir_set.add(cfg->schema_commitlog_directory());
+            dir_set.add(cfg->saved_caches_directory());
             dirs.emplace(cfg->developer_mode());
             dirs->create_and_verify(std::move(dir_set)).get();
 
@@ -1292,6 +1299,7 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
                     .max_shares = cfg->compaction_max_shares,
                     .throughput_mb_per_sec = cfg->compaction_throughput_mb_per_sec,
                     .flush_all_tables_before_major = cfg->compaction_flush_all_tables_before_major_seconds() * 1s,
+                    .cpu_offload_shards = cfg->compaction_cpu_offload_shards,
                 };
             });
             cm.start(std::move(get_cm_cfg), std::ref(stop_signal.as_sharded_abort_source()), std::ref(task_manager)).get();
@@ -1361,6 +1369,14 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
             auto stop_compressor_factory = defer_verbose_shutdown("sstable_compressor_factory", [&sstable_compressor_factory] {
                 sstable_compressor_factory.stop().get();
             });
+            // Per-sstable dicts are trained by compaction, on a worker of their own.
+            sstable_compressor_factory.invoke_on_all([&sstable_dict_training_worker] (default_sstable_compressor_factory& local) {
+                local.set_train_dict_callback([&sstable_dict_training_worker] (std::vector<std::vector<std::byte>> sample, size_t max_size) {
+                    return sstable_dict_training_worker.submit<std::vector<std::byte>>([sample = std::move(sample), max_size] {
+                        return netw::zdict_train(sample, {.max_dict_size = max_size});
+                    });
+                });
+            }).get();
 
             checkpoint(stop_signal, "starting database");
 
@@ -2640,6 +2656,21 @@ To start the scylla server proper, simply invoke as: scylla server (or just scyl
             );
             cf_cache_hitrate_calculator.local().run_on(this_shard_id());
 
+            checkpoint(stop_signal, "starting row cache saver");
+            static sharded<db::row_cache_saver> row_cache_saver;
+            row_cache_saver.start(std::ref(db), sharded_parameter([&] {
+                return db::row_cache_saver::config{
+                    .directory = std::filesystem::path(cfg->saved_caches_directory()),
+                    .keys_to_save = cfg->row_cache_keys_to_save,
+                    .save_period_in_seconds = cfg->row_cache_save_period,
+                    .sched_group = dbcfg.maintenance_scheduling_group,
+                };
+            })).get();
+            row_cache_saver.invoke_on_all(&db::row_cache_saver::start).get();
+            auto stop_row_cache_saver = defer_verbose_shutdown("row cache saver", [] {
+                row_cache_saver.stop().get();
+            });
+
             checkpoint(stop_signal, "starting view update backlog broker");
             static sharded<service::view_update_backlog_broker> view_backlog_broker;
             view_backlog_broker.start(std::ref(proxy), std::ref(gossiper)).get();
@@ -121,27 +121,60 @@ compare_atomic_cell_for_merge(atomic_cell_view left, atomic_cell_view right) {
     return std::strong_ordering::equal;
 }
 
-atomic_cell_or_collection atomic_cell_or_collection::copy(const abstract_type& type) const {
-    if (_data.empty()) {
-        return atomic_cell_or_collection();
+void atomic_cell_or_collection::set(managed_bytes_view data) {
+    if (data.size() <= max_inline_size) {
+        auto out = _u.inline_data;
+        for (bytes_view frag : fragment_range(data)) {
+            out = std::copy(frag.begin(), frag.end(), out);
+        }
+        _inline_size = data.size();
+    } else {
+        std::construct_at(&_u.external, data);
+        _inline_size = -1;
+    }
+}
+
+void atomic_cell_or_collection::set(managed_bytes&& data) noexcept {
+    if (data.size() <= max_inline_size) {
+        // Cannot throw, inline storage is never allocated.
+        set(managed_bytes_view(data));
+    } else {
+        std::construct_at(&_u.external, std::move(data));
+        _inline_size = -1;
     }
-    return atomic_cell_or_collection(managed_bytes(_data));
+}
+
+void atomic_cell_or_collection::move_from(atomic_cell_or_collection& o) noexcept {
+    if (o.is_inline()) {
+        std::copy_n(o._u.inline_data, o._inline_size, _u.inline_data);
+        _inline_size = o._inline_size;
+    } else {
+        std::construct_at(&_u.external, std::move(o._u.external));
+        _inline_size = -1;
+    }
+    o.reset();
+}
+
+atomic_cell_or_collection atomic_cell_or_collection::copy(const abstract_type& type) const {
+    atomic_cell_or_collection ret;
+    ret.set(data());
+    return ret;
 }
 
 atomic_cell_or_collection::atomic_cell_or_collection(const abstract_type& type, atomic_cell_view acv)
-    : _data(acv._view)
 {
+    set(acv._view);
 }
 
 bool atomic_cell_or_collection::equals(const abstract_type& type, const atomic_cell_or_collection& other) const
 {
-    if (_data.empty() || other._data.empty()) {
-        return _data.empty() && other._data.empty();
+    if (!*this || !other) {
+        return !*this && !other;
     }
 
     if (type.is_atomic()) {
-        auto a = atomic_cell_view::from_bytes(_data);
-        auto b = atomic_cell_view::from_bytes(other._data);
+        auto a = atomic_cell_view::from_bytes(data());
+        auto b = atomic_cell_view::from_bytes(other.data());
         if (a.timestamp() != b.timestamp()) {
             return false;
         }
@@ -173,7 +206,7 @@ bool atomic_cell_or_collection::equals(const abstract_type& type, const atomic_c
 
 size_t atomic_cell_or_collection::external_memory_usage(const abstract_type& t) const
 {
-    return _data.external_memory_usage();
+    return is_inline() ? 0 : _u.external.external_memory_usage();
 }
 
 auto fmt::formatter<atomic_cell_view>::format(const atomic_cell_view& acv, fmt::format_context& ctx) const
@@ -223,7 +256,7 @@ auto fmt::formatter<atomic_cell_view::printer>::format(const atomic_cell_view::p
 auto fmt::formatter<atomic_cell_or_collection::printer>::format(const atomic_cell_or_collection::printer& p, fmt::format_context& ctx) const
         -> decltype(ctx.out()) {
     auto out = ctx.out();
-    if (p._cell._data.empty()) {
+    if (!p._cell) {
         return fmt::format_to(out, "{{ null atomic_cell_or_collection }}");
     }
     out = fmt::format_to(out, "{{");
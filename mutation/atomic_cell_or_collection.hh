@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "atomic_cell.hh"
 #include "collection_mutation.hh"
 #include "schema/schema.hh"
@@ -16,25 +18,73 @@
 // Which type is stored is determined by the schema.
 // Has an "empty" state.
 // Objects moved-from are left in an empty state.
+//
+// Small cells are stored inline, larger ones in managed_bytes. The inline
+// storage fits live cells of up to 14 bytes without TTL (e.g. bigint, double,
+// timestamp or short text) as well as dead cells, which would otherwise not
+// fit into the inline storage of managed_bytes and need a separate LSA
+// allocation, whose header and alignment dominate the footprint of such cells.
 class atomic_cell_or_collection final {
-    managed_bytes _data;
+    static constexpr size_t max_inline_size = 23;
+
+    union storage {
+        storage() noexcept {}
+        ~storage() {}
+        bytes_view::value_type inline_data[max_inline_size];
+        managed_bytes external;
+    } _u;
+    // >= 0 -> the data is stored inline and this is its size.
+    // -1 -> the data is stored in _u.external.
+    int8_t _inline_size = 0;
 private:
-    atomic_cell_or_collection(managed_bytes&& data) : _data(std::move(data)) {}
+    bool is_inline() const noexcept {
+        return _inline_size >= 0;
+    }
+    // Must be called in the empty state.
+    void set(managed_bytes_view data);
+    void set(managed_bytes&& data) noexcept;
+    void move_from(atomic_cell_or_collection& o) noexcept;
+    void reset() noexcept {
+        if (!is_inline()) {
+            std::destroy_at(&_u.external);
+        }
+        _inline_size = 0;
+    }
+    managed_bytes_view data() const noexcept {
+        if (is_inline()) {
+            return managed_bytes_view(bytes_view(_u.inline_data, _inline_size));
+        }
+        return managed_bytes_view(_u.external);
+    }
+    managed_bytes_mutable_view mutable_data() noexcept {
+        if (is_inline()) {
+            return managed_bytes_mutable_view(bytes_mutable_view(_u.inline_data, _inline_size));
+        }
+        return managed_bytes_mutable_view(_u.external);
+    }
+    atomic_cell_or_collection(managed_bytes&& data) noexcept { set(std::move(data)); }
 public:
-    atomic_cell_or_collection() = default;
-    atomic_cell_or_collection(atomic_cell_or_collection&&) = default;
+    atomic_cell_or_collection() noexcept = default;
+    atomic_cell_or_collection(atomic_cell_or_collection&& o) noexcept { move_from(o); }
     atomic_cell_or_collection(const atomic_cell_or_collection&) = delete;
-    atomic_cell_or_collection& operator=(atomic_cell_or_collection&&) = default;
+    atomic_cell_or_collection& operator=(atomic_cell_or_collection&& o) noexcept {
+        if (this != &o) {
+            reset();
+            move_from(o);
+        }
+        return *this;
+    }
     atomic_cell_or_collection& operator=(const atomic_cell_or_collection&) = delete;
-    atomic_cell_or_collection(atomic_cell ac) : _data(std::move(ac._data)) {}
+    ~atomic_cell_or_collection() { reset(); }
+    atomic_cell_or_collection(atomic_cell ac) noexcept { set(std::move(ac._data)); }
     atomic_cell_or_collection(const abstract_type& at, atomic_cell_view acv);
     static atomic_cell_or_collection from_atomic_cell(atomic_cell data) { return { std::move(data._data) }; }
-    atomic_cell_view as_atomic_cell(const column_definition& cdef) const { return atomic_cell_view::from_bytes(_data); }
-    atomic_cell_mutable_view as_mutable_atomic_cell(const column_definition& cdef) { return atomic_cell_mutable_view::from_bytes(_data); }
-    atomic_cell_or_collection(collection_mutation cm) : _data(std::move(cm).data()) { }
+    atomic_cell_view as_atomic_cell(const column_definition& cdef) const { return atomic_cell_view::from_bytes(data()); }
+    atomic_cell_mutable_view as_mutable_atomic_cell(const column_definition& cdef) { return atomic_cell_mutable_view::from_bytes(mutable_data()); }
+    atomic_cell_or_collection(collection_mutation cm) noexcept { set(std::move(cm).data()); }
     atomic_cell_or_collection copy(const abstract_type&) const;
     explicit operator bool() const {
-        return !_data.empty();
+        return _inline_size != 0;
     }
     static constexpr bool can_use_mutable_view() {
         return true;
@@ -59,6 +109,8 @@ class atomic_cell_or_collection final {
     friend fmt::formatter<printer>;
 };
 
+static_assert(sizeof(atomic_cell_or_collection) == 24);
+
 template <>
 struct fmt::formatter<atomic_cell_or_collection::printer> : fmt::formatter<string_view> {
     auto format(const atomic_cell_or_collection::printer&, fmt::format_context& ctx) const -> decltype(ctx.out());
@@ -36,7 +36,7 @@ collection_mutation::operator collection_mutation_view() const
 }
 
 collection_mutation_view atomic_cell_or_collection::as_collection_mutation() const {
-    return collection_mutation_view{managed_bytes_view(_data)};
+    return collection_mutation_view{data()};
 }
 
 namespace {
@@ -14,6 +14,7 @@
 #include <seastar/core/coroutine.hh>
 #include <seastar/coroutine/maybe_yield.hh>
 #include <seastar/core/metrics.hh>
+#include <bit>
 #include <utility>
 
 #include "reader_concurrency_semaphore.hh"
@@ -1129,6 +1130,48 @@ void reader_concurrency_semaphore::signal(const resources& r) noexcept {
     maybe_wake_execution_loop();
 }
 
+std::unique_ptr<char[]> reader_concurrency_semaphore::take_cached_buffer(size_t size) noexcept {
+    if (!std::has_single_bit(size) || std::countr_zero(size) > max_cached_buffer_size_log2) {
+        return nullptr;
+    }
+    auto& free = _cached_buffers[std::countr_zero(size)];
+    if (free.empty()) {
+        return nullptr;
+    }
+    auto buf = std::move(free.back());
+    free.pop_back();
+    _cached_buffer_bytes -= size;
+    signal({0, ssize_t(size)});
+    return buf;
+}
+
+void reader_concurrency_semaphore::cache_buffer(std::unique_ptr<char[]> buf, size_t size) noexcept {
+    if (!std::has_single_bit(size) || std::countr_zero(size) > max_cached_buffer_size_log2
+            || _stopped || !_wait_list.empty()
+            || _resources.memory < ssize_t(size)
+            || _cached_buffer_bytes + ssize_t(size) > std::min(_initial_resources.memory / 16, max_cached_buffer_bytes)) {
+        return;
+    }
+    try {
+        _cached_buffers[std::countr_zero(size)].push_back(std::move(buf));
+    } catch (...) {
+        // Just free it.
+        return;
+    }
+    _cached_buffer_bytes += size;
+    _resources.memory -= size;
+}
+
+void reader_concurrency_semaphore::drop_cached_buffers() noexcept {
+    if (!_cached_buffer_bytes) {
+        return;
+    }
+    for (auto& free : _cached_buffers) {
+        free.clear();
+    }
+    signal({0, std::exchange(_cached_buffer_bytes, 0)});
+}
+
 namespace sm = seastar::metrics;
 static const sm::label class_label("class");
 
@@ -1377,6 +1420,7 @@ future<> reader_concurrency_semaphore::stop() noexcept {
     _stopped = true;
     clear_inactive_reads();
     co_await _permit_gate.close();
+    drop_cached_buffers();
     // Gate for closing readers is only closed after waiting for all reads, as the evictable
     // readers might take the inactive registration path and find the gate closed.
     co_await _close_readers_gate.close();
@@ -1487,6 +1531,7 @@ future<> reader_concurrency_semaphore::enqueue_waiter(reader_permit::impl& permi
         ++_stats.reads_enqueued_for_memory;
     }
     ++_stats.waiters;
+    drop_cached_buffers();
     return fut;
 }
 
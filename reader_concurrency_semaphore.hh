@@ -8,8 +8,10 @@
 
 #pragma once
 
+#include <array>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <boost/intrusive/list.hpp>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
@@ -316,6 +318,13 @@ class reader_concurrency_semaphore {
     std::optional<future<>> _execution_loop_future;
     reader_permit::impl* _blessed_permit = nullptr;
 
+    // Free buffers kept for reads to reuse, by log2 of their size. Their
+    // memory is consumed from the semaphore.
+    static constexpr size_t max_cached_buffer_size_log2 = 20;
+    static constexpr ssize_t max_cached_buffer_bytes = 1 << 20;
+    std::array<std::vector<std::unique_ptr<char[]>>, max_cached_buffer_size_log2 + 1> _cached_buffers;
+    ssize_t _cached_buffer_bytes = 0;
+
 private:
     void do_detach_inactive_reader(reader_permit::impl&, evict_reason reason) noexcept;
     [[nodiscard]] mutation_reader detach_inactive_reader(reader_permit::impl&, evict_reason reason) noexcept;
@@ -624,6 +633,28 @@ class reader_concurrency_semaphore {
         return _initial_resources - _resources;
     }
 
+    /// Take a free buffer of \p size bytes kept by the semaphore.
+    ///
+    /// Returns a null pointer if there is none. Only sizes which are powers
+    /// of two are kept. The memory of the buffer is no longer consumed by the
+    /// semaphore, so the caller has to account it to its permit.
+    std::unique_ptr<char[]> take_cached_buffer(size_t size) noexcept;
+
+    /// Give back a buffer of \p size bytes which a read no longer uses.
+    ///
+    /// The semaphore keeps it for reuse, consuming its memory, as long as
+    /// it isn't stopped, no read waits for admission or memory and the kept
+    /// buffers fit in a 16th of the memory of the semaphore, and in 1MiB.
+    /// Otherwise the buffer is freed. Kept buffers are freed as soon as a
+    /// read has to wait, and when the semaphore is stopped.
+    void cache_buffer(std::unique_ptr<char[]> buf, size_t size) noexcept;
+
+    void drop_cached_buffers() noexcept;
+
+    ssize_t cached_buffer_bytes() const noexcept {
+        return _cached_buffer_bytes;
+    }
+
     void broken(std::exception_ptr ex = {});
 
     /// Dump diagnostics printout
@@ -11,6 +11,7 @@
 #include <seastar/core/rwlock.hh>
 
 #include "database_fwd.hh"
+#include "db/commitlog/replay_position.hh"
 #include "compaction/compaction_descriptor.hh"
 #include "compaction/compaction_backlog_manager.hh"
 #include "compaction/compaction_strategy_state.hh"
@@ -177,6 +178,9 @@ class compaction_group {
     future<> flush() noexcept;
     bool can_flush() const;
     bool needs_flush() const;
+    // Returns true if the memtables hold data written to commitlog
+    // segments which start before rp.
+    bool has_commitlog_data_before(const db::replay_position& rp) const;
 
     const dht::token_range& token_range() const noexcept {
         return _token_range;
@@ -304,6 +308,7 @@ class compaction_group {
     const logstor::compaction_manager& get_logstor_compaction_manager() const noexcept;
 
     logstor::primary_index& get_logstor_index() noexcept;
+    logstor::table_gc_stats& get_logstor_gc_stats() noexcept;
 
     future<> split(compaction::compaction_type_options::split opt, tasks::task_info tablet_split_task_info);
 
@@ -42,6 +42,7 @@
 #include <seastar/coroutine/as_future.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/metrics.hh>
+#include <seastar/core/bitops.hh>
 #include "sstables/sstables.hh"
 #include "sstables/sstables_manager.hh"
 #include <boost/container/static_vector.hpp>
@@ -386,6 +387,7 @@ static auto configure_sstables_manager(const db::config& cfg, const database_con
         .data_file_directories = cfg.data_file_directories(),
         .format = cfg.sstable_format,
         .large_data_records_per_sstable = cfg.compaction_large_data_records_per_sstable,
+        .filter_format = cfg.sstable_filter_format,
         .ignore_component_digest_mismatch = cfg.ignore_component_digest_mismatch(),
         .enable_dangerous_direct_import_of_cassandra_counters = cfg.enable_dangerous_direct_import_of_cassandra_counters(),
     };
@@ -624,6 +626,12 @@ database::setup_metrics() {
         sm::make_gauge("failed_flushes", _cf_stats.failed_memtables_flushes_count,
                        sm::description("Holds the number of failed memtable flushes. "
                                        "High value in this metric may indicate a permanent failure to flush a memtable.")),
+        sm::make_counter("flushed_bytes", _cf_stats.flushed_memtables_bytes,
+                       sm::description("Holds the total number of memtable bytes written to sstables and released by completed flushes. "
+                                       "Its rate shows how fast flushes release memory back to writers.")),
+        sm::make_counter("sub_range_flushes", _cf_stats.sub_range_memtables_flushes,
+                       sm::description("Holds the number of flushes that sealed only the memtable of a single token sub-range, "
+                                       "leaving the other sub-ranges of the table active (see memtable_flush_sub_ranges).")),
     });
 
     _metrics.add_group("database", {
@@ -966,10 +974,18 @@ database::init_logstor() {
             .separator_sg = _dbcfg.memtable_scheduling_group,
             .separator_delay_limit_ms = _cfg.logstor_separator_delay_limit_ms(),
             .max_separator_memory = _cfg.logstor_separator_max_memory_in_mb() * 1024ull * 1024ull,
+            .index_checkpoint_interval_in_s = _cfg.logstor_index_checkpoint_interval_in_s,
+            .compaction_segregate_cold_data = _cfg.logstor_compaction_segregate_cold_data,
         },
         .flush_sg = _dbcfg.commitlog_scheduling_group,
+        .compact_index = _cfg.logstor_compact_index(),
+        .enable_record_cache = _cfg.logstor_enable_record_cache,
+        .scan_readahead_partitions = _cfg.logstor_scan_readahead_partitions,
+        .scan_readahead_kb = _cfg.logstor_scan_readahead_kb,
+        .scan_max_concurrent_reads = _cfg.logstor_scan_max_concurrent_reads,
+        .max_delta_chain_length = _cfg.logstor_max_delta_chain_length,
     };
-    _logstor = std::make_unique<logstor::logstor>(std::move(cfg));
+    _logstor = std::make_unique<logstor::logstor>(std::move(cfg), _row_cache_tracker);
 
     _logstor->set_trigger_compaction_hook([this] {
         trigger_logstor_compaction(false);
@@ -1639,6 +1655,8 @@ keyspace::make_column_family_config(const schema& s, const database& db) const {
     cfg.enable_metrics_reporting = db_config.enable_keyspace_column_family_metrics();
     cfg.enable_node_aggregated_table_metrics = db_config.enable_node_aggregated_table_metrics();
     cfg.tombstone_warn_threshold = db_config.tombstone_warn_threshold();
+    cfg.query_prefetch_partitions = db_config.query_prefetch_partitions;
+    cfg.memtable_sub_ranges_log2 = log2ceil(std::clamp(db_config.memtable_flush_sub_ranges(), 1u, 256u));
     cfg.view_update_memory_semaphore_limit = _config.view_update_memory_semaphore_limit;
     cfg.data_listeners = &db.data_listeners();
     cfg.enable_compacting_data_for_streaming_and_repair = db_config.enable_compacting_data_for_streaming_and_repair;
@@ -2179,18 +2197,56 @@ future<> memtable_list::flush() {
     }
 }
 
+future<> memtable_list::flush_sub_range(const memtable& mt) {
+    _dirty_memory_manager->start_extraneous_flush();
+    auto finish = defer([this] { _dirty_memory_manager->finish_extraneous_flush(); });
+    auto permit = co_await _dirty_memory_manager->get_flush_permit();
+    co_await _dirty_memory_manager->flush_one(*this, std::move(permit), &mt);
+}
+
 lw_shared_ptr<memtable> memtable_list::new_memtable() {
     return make_lw_shared<memtable>(_current_schema(), *_dirty_memory_manager,
             _table_shared_data,
             _table_stats, this, _compaction_scheduling_group, _shared_gc_state);
 }
 
-// Synchronously swaps the active memtable with a new, empty one,
+memtable& memtable_list::active_memtable(const schema& s, partition_key_view key) {
+    if (!_sub_ranges_log2) {
+        return *_active.front();
+    }
+    return active_memtable(dht::get_token(s, key));
+}
+
+bool memtable_list::replace_active_memtable(const shared_memtable& old) {
+    auto it = std::ranges::find(_active, old);
+    if (it == _active.end()) {
+        return false;
+    }
+    auto mt = new_memtable();
+    _memtables.push_back(mt);
+    *it = std::move(mt);
+    return true;
+}
+
+future<> memtable_list::seal_sub_range(const memtable& mt, flush_permit&& permit) noexcept {
+    auto it = std::ranges::find(_active, &mt, &shared_memtable::get);
+    if (it == _active.end()) {
+        return seal_active_memtable(std::move(permit));
+    }
+    return _seal_immediate_fn(std::move(permit), {*it});
+}
+
+// Synchronously swaps the active memtables with new, empty ones,
 // returning the old memtables list.
 // Exception safe.
 std::vector<replica::shared_memtable> memtable_list::clear_and_add() {
     std::vector<replica::shared_memtable> new_memtables;
-    new_memtables.emplace_back(new_memtable());
+    new_memtables.reserve(sub_ranges());
+    for (size_t i = 0; i < sub_ranges(); ++i) {
+        new_memtables.emplace_back(new_memtable());
+    }
+    auto active = new_memtables;
+    _active = std::move(active);
     return std::exchange(_memtables, std::move(new_memtables));
 }
 
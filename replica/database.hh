@@ -207,15 +207,25 @@ class global_table_ptr;
 //
 // If we are going to have different methods, better have different instances
 // of a common class.
+//
+// The active memtable can be split into several memtables, each covering a
+// contiguous token sub-range (see dht::compaction_group_of()). Every sub-range
+// memtable is a separate LSA region, so under memory pressure the
+// dirty_memory_manager can seal and flush just the largest sub-range, releasing
+// its memory without waiting for the rest of the data to be written out.
 class memtable_list {
 public:
-    using seal_immediate_fn_type = std::function<future<> (flush_permit&&)>;
+    // Seals and flushes the given active memtables, one after another.
+    using seal_immediate_fn_type = std::function<future<> (flush_permit&&, std::vector<shared_memtable>)>;
     using intrusive_memtable_list = bi::list<
             memtable,
             bi::base_hook<bi::list_base_hook<bi::link_mode<bi::auto_unlink>>>,
             bi::constant_time_size<false>>;
 private:
     std::vector<shared_memtable> _memtables;
+    // The active memtable of each token sub-range, all of them also in _memtables.
+    std::vector<shared_memtable> _active;
+    unsigned _sub_ranges_log2;
     intrusive_memtable_list _flushed_memtables_with_active_reads;
     seal_immediate_fn_type _seal_immediate_fn;
     std::function<schema_ptr()> _current_schema;
@@ -236,8 +246,10 @@ class memtable_list {
             memtable_table_shared_data& table_shared_data,
             replica::table_stats& table_stats,
             seastar::scheduling_group compaction_scheduling_group = seastar::current_scheduling_group(),
-            shared_tombstone_gc_state* shared_gc_state = nullptr)
+            shared_tombstone_gc_state* shared_gc_state = nullptr,
+            unsigned sub_ranges_log2 = 0)
         : _memtables({})
+        , _sub_ranges_log2(sub_ranges_log2)
         , _seal_immediate_fn(seal_immediate_fn)
         , _current_schema(cs)
         , _dirty_memory_manager(dirty_memory_manager)
@@ -246,7 +258,11 @@ class memtable_list {
         , _table_stats(table_stats)
         , _shared_gc_state(shared_gc_state)
     {
-        add_memtable();
+        _active.reserve(sub_ranges());
+        for (size_t i = 0; i < sub_ranges(); ++i) {
+            _active.push_back(new_memtable());
+            _memtables.push_back(_active.back());
+        }
     }
 
     memtable_list(std::function<schema_ptr()> cs, dirty_memory_manager* dirty_memory_manager,
@@ -296,7 +312,7 @@ class memtable_list {
         _flushed_memtables_with_active_reads.push_back(*element);
     }
 
-    // Synchronously swaps the active memtable with a new, empty one,
+    // Synchronously swaps the active memtables with new, empty ones,
     // returning the old memtables list.
     // Exception safe.
     std::vector<replica::shared_memtable> clear_and_add();
@@ -305,10 +321,23 @@ class memtable_list {
         return _memtables.size();
     }
 
+    size_t sub_ranges() const noexcept {
+        return size_t(1) << _sub_ranges_log2;
+    }
+
+    // Seals and flushes the active memtables of all sub-ranges.
     future<> seal_active_memtable(flush_permit&& permit) noexcept {
-        return _seal_immediate_fn(std::move(permit));
+        return _seal_immediate_fn(std::move(permit), _active);
     }
 
+    // Seals and flushes only the sub-range whose active memtable is mt.
+    // Falls back to sealing all sub-ranges if mt is no longer active.
+    future<> seal_sub_range(const memtable& mt, flush_permit&& permit) noexcept;
+
+    // Explicitly flushes only the sub-range whose active memtable is mt,
+    // like the dirty_memory_manager does under memory pressure.
+    future<> flush_sub_range(const memtable& mt);
+
     auto begin() noexcept {
         return _memtables.begin();
     }
@@ -325,14 +354,26 @@ class memtable_list {
         return _memtables.end();
     }
 
-    memtable& active_memtable() noexcept {
-        return *_memtables.back();
+    const std::vector<shared_memtable>& active_memtables() const noexcept {
+        return _active;
     }
 
-    void add_memtable() {
-        _memtables.emplace_back(new_memtable());
+    memtable& active_memtable(dht::token t) noexcept {
+        return *_active[sub_range_of(t)];
     }
 
+    memtable& active_memtable(const schema& s, partition_key_view key);
+
+    bool is_active(const shared_memtable& mt) const noexcept {
+        return std::ranges::find(_active, mt) != _active.end();
+    }
+
+    // Replaces the active memtable old with a new, empty one covering the
+    // same token sub-range. Returns false if old is no longer active, e.g.
+    // because it was sealed concurrently.
+    // Exception safe.
+    bool replace_active_memtable(const shared_memtable& old);
+
     dirty_memory_manager_logalloc::region_group& region_group() noexcept {
         return _dirty_memory_manager->region_group();
     }
@@ -344,6 +385,10 @@ class memtable_list {
     future<> flush();
 private:
     lw_shared_ptr<memtable> new_memtable();
+
+    size_t sub_range_of(dht::token t) const noexcept {
+        return _sub_ranges_log2 ? dht::compaction_group_of(_sub_ranges_log2, t) : 0;
+    }
 };
 
 class distributed_loader;
@@ -358,6 +403,8 @@ struct cf_stats {
     int64_t pending_memtables_flushes_count = 0;
     int64_t pending_memtables_flushes_bytes = 0;
     int64_t failed_memtables_flushes_count = 0;
+    uint64_t flushed_memtables_bytes = 0;
+    uint64_t sub_range_memtables_flushes = 0;
 
     // number of time the clustering filter was executed
     int64_t clustering_filter_count = 0;
@@ -415,6 +462,10 @@ struct table_stats {
     int64_t memtable_range_tombstone_reads = 0;
     int64_t memtable_row_tombstone_reads = 0;
     int64_t tablet_count = 0;
+    /** Number of ranges of multi-partition queries read ahead, see query_prefetch_partitions */
+    uint64_t query_prefetched_ranges = 0;
+    /** Number of ranges read ahead that were dropped unread when the page ended */
+    uint64_t query_prefetched_ranges_dropped = 0;
     mutation_application_stats memtable_app_stats;
     utils::timed_rate_moving_average_summary_and_histogram reads{256};
     utils::timed_rate_moving_average_summary_and_histogram writes{256};
@@ -479,7 +530,10 @@ class table : public enable_lw_shared_from_this<table>
         size_t view_update_memory_semaphore_limit;
         db::data_listeners* data_listeners = nullptr;
         uint32_t tombstone_warn_threshold{0};
+        utils::updateable_value<uint32_t> query_prefetch_partitions{0};
         unsigned x_log2_compaction_groups{0};
+        // Log2 of the number of token sub-ranges the active memtable of a vnode table is split into.
+        unsigned memtable_sub_ranges_log2{0};
         utils::updateable_value<bool> enable_compacting_data_for_streaming_and_repair;
         utils::updateable_value<bool> enable_tombstone_gc_for_streaming_and_repair;
         db::guardrail_config guardrail_config;
@@ -553,6 +607,7 @@ class table : public enable_lw_shared_from_this<table>
 
     logstor::logstor* _logstor = nullptr;
     std::unique_ptr<logstor::primary_index> _logstor_index;
+    logstor::table_gc_stats _logstor_gc_stats;
 
     std::unique_ptr<cell_locker> _counter_cell_locks; // Memory-intensive; allocate only when needed.
 
@@ -902,6 +957,10 @@ class table : public enable_lw_shared_from_this<table>
         return *_logstor_index;
     }
 
+    logstor::table_gc_stats& logstor_gc_stats() noexcept {
+        return _logstor_gc_stats;
+    }
+
     size_t get_logstor_memory_usage() const;
 
     // Creates a mutation reader which covers all data sources for this column family.
@@ -1403,7 +1462,13 @@ class table : public enable_lw_shared_from_this<table>
     //
     // The function never fails.
     // It either succeeds eventually after retrying or aborts.
-    future<> seal_active_memtable(compaction_group& cg, flush_permit&&) noexcept;
+    //
+    // Seals the given active memtables of cg (one per token sub-range) and
+    // flushes them one after another, reusing the flush permit.
+    future<> seal_active_memtable(compaction_group& cg, flush_permit&&, std::vector<shared_memtable> memtables) noexcept;
+    future<> seal_memtable(compaction_group& cg, shared_memtable old, flush_permit& permit) noexcept;
+    // Highest replay position below which all writes are flushed once sealed is.
+    db::replay_position flushed_replay_position_bound(const memtable& sealed);
 
     void check_valid_rp(const db::replay_position&) const;
 
@@ -256,8 +256,9 @@ future<> dirty_memory_manager::shutdown() {
     });
 }
 
-future<> dirty_memory_manager::flush_one(replica::memtable_list& mtlist, flush_permit&& permit) noexcept {
-    return mtlist.seal_active_memtable(std::move(permit)).handle_exception([schema = mtlist.back()->schema()] (std::exception_ptr ep) {
+future<> dirty_memory_manager::flush_one(replica::memtable_list& mtlist, flush_permit&& permit, const replica::memtable* sub_range) noexcept {
+    auto f = sub_range ? mtlist.seal_sub_range(*sub_range, std::move(permit)) : mtlist.seal_active_memtable(std::move(permit));
+    return std::move(f).handle_exception([schema = mtlist.back()->schema()] (std::exception_ptr ep) {
         auto level = log_level::error;
         if (try_catch<gate_closed_exception>(ep)) {
             level = log_level::warn;
@@ -293,7 +294,9 @@ future<> dirty_memory_manager::flush_when_needed() {
                 // But during pressure condition, we'll just pick the CF that holds the largest
                 // memtable. The advantage of doing this is that this is objectively the one that will
                 // release the biggest amount of memory and is less likely to be generating tiny
-                // SSTables.
+                // SSTables. If the memtables of the CF are split into token sub-ranges, only the
+                // sub-range holding the largest memtable is flushed, so its memory is released
+                // without waiting for the other sub-ranges to be written out.
                 memtable& candidate_memtable = memtable::from_region(*(this->_region_group.get_largest_region()));
                 memtable_list& mtlist = *(candidate_memtable.get_memtable_list());
 
@@ -307,7 +310,7 @@ future<> dirty_memory_manager::flush_when_needed() {
                 // Do not wait. The semaphore will protect us against a concurrent flush. But we
                 // want to start a new one as soon as the permits are destroyed and the semaphore is
                 // made ready again, not when we are done with the current one.
-                (void)this->flush_one(mtlist, std::move(permit)).handle_exception([] (std::exception_ptr ex) {
+                (void)this->flush_one(mtlist, std::move(permit), &candidate_memtable).handle_exception([] (std::exception_ptr ex) {
                     dblog.error("Flushing memtable returned unexpected error: {}", ex);
                 });
                 return make_ready_future<>();
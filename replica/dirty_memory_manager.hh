@@ -526,7 +526,9 @@ class dirty_memory_manager {
         return _region_group.unspooled_throttle_threshold();
     }
 
-    future<> flush_one(replica::memtable_list& cf, flush_permit&& permit) noexcept;
+    // Seals and flushes the active memtables of cf, or only the token
+    // sub-range whose active memtable is sub_range, when given.
+    future<> flush_one(replica::memtable_list& cf, flush_permit&& permit, const replica::memtable* sub_range = nullptr) noexcept;
 
     future<flush_permit> get_flush_permit() noexcept {
         return get_units(_background_work_flush_serializer, 1).then([this] (auto&& units) {
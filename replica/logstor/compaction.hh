@@ -12,6 +12,7 @@
 #include "write_buffer.hh"
 #include "utils/log_heap.hh"
 #include <seastar/coroutine/maybe_yield.hh>
+#include <span>
 #include "mutation_writer/token_group_based_splitting_writer.hh"
 
 namespace replica {
@@ -35,6 +36,14 @@ struct segment_descriptor : public log_heap_hook<segment_descriptor_hist_options
     size_t record_count{0};
     segment_set* owner{nullptr}; // non-owning, set when added to a segment_set
     int ref_count{0};
+    // sequence number of the data in the segment, set when the segment is
+    // opened for writing or recovered. Not reset when the segment is freed.
+    segment_sequence seq{0};
+    // Estimated sequence number of the segment the data was first written
+    // to, which compaction uses as the age of the data. The same as seq,
+    // except for segments written by compaction and the separator, which
+    // inherit it from the segments they rewrite. Not persisted.
+    segment_sequence data_seq{0};
 
     void reset(size_t segment_size) noexcept {
         free_space = segment_size;
@@ -66,6 +75,41 @@ struct segment_descriptor : public log_heap_hook<segment_descriptor_hist_options
 
 using segment_descriptor_hist = log_heap<segment_descriptor, segment_descriptor_hist_options>;
 
+// Write amplification of logstor compaction for a table.
+struct table_gc_stats {
+    // Record bytes written by user writes.
+    uint64_t bytes_written{0};
+    // Record bytes rewritten by compaction.
+    uint64_t compaction_bytes_written{0};
+
+    double write_amplification() const noexcept {
+        return bytes_written ? double(bytes_written + compaction_bytes_written) / bytes_written : 1.0;
+    }
+};
+
+// A segment considered for compaction, with the age of its data.
+struct compaction_candidate {
+    log_segment_id id;
+    const segment_descriptor* desc;
+    // Segments written since the data of the segment was first written.
+    uint64_t data_age;
+    // The live records of cold segments are rewritten to segments of cold
+    // data, so that they aren't rewritten again with the hot ones.
+    bool cold;
+};
+
+// Chooses the segments to compact together out of pool, the emptiest
+// segments of a compaction group in that order, as the prefix which frees
+// the most segments. When segregating cold data, the pool is first ranked
+// by cost-benefit, and the hot and cold records are accounted as written to
+// separate segments.
+std::vector<compaction_candidate> select_compaction_victims(std::vector<compaction_candidate> pool,
+        size_t segment_size, size_t max_segments, bool segregate);
+
+// Index of the compaction buffer the live records of a victim are rewritten
+// to: 0 for hot data and 1 for cold data.
+size_t compaction_buffer_index(std::span<const compaction_candidate> victims, log_segment_id);
+
 struct segment_set {
     segment_descriptor_hist _segments;
     size_t _segment_count{0};
@@ -9,12 +9,20 @@
 
 #include "dht/decorated_key.hh"
 #include "dht/ring_position.hh"
+#include <seastar/core/preempt.hh>
 #include <seastar/coroutine/maybe_yield.hh>
 #include "types.hh"
 #include "utils/bptree.hh"
 #include "utils/double-decker.hh"
+#include "utils/fragment_range.hh"
 #include "utils/phased_barrier.hh"
+#include "utils/small_vector.hh"
+#include "utils/xx_hasher.hh"
+#include <algorithm>
+#include <map>
+#include <ranges>
 #include <utility>
+#include <variant>
 
 namespace replica::logstor {
 
@@ -49,31 +57,195 @@ class primary_index_entry {
     friend dht::ring_position_view ring_position_view_to_compare(const primary_index_entry& e) { return e._key; }
 };
 
+// The position of a partition in the compact index: its token and a 32-bit
+// fingerprint of its key. A non-zero weight positions before (-1) or after (1)
+// all the partitions of the token, and the fingerprint is then ignored.
+struct compact_index_key {
+    int64_t token;
+    uint32_t fingerprint = 0;
+    int8_t weight = 0;
+
+    static uint32_t fingerprint_of(const partition_key& key) noexcept {
+        utils::xx_hasher h;
+        for (bytes_view frag : fragment_range(key.representation())) {
+            h.update(reinterpret_cast<const char*>(frag.data()), frag.size());
+        }
+        return uint32_t(h.finalize_uint64());
+    }
+
+    static compact_index_key from(const dht::decorated_key& dk) noexcept {
+        return compact_index_key{dk.token().raw(), fingerprint_of(dk.key())};
+    }
+
+    // Bound for a ring position. Fingerprints don't follow key order, so a
+    // position with a key is widened to the given side of its token.
+    static compact_index_key bound(const dht::ring_position_view& pos, int8_t keyed_weight) noexcept {
+        int8_t weight = pos.key() ? keyed_weight : (pos.weight() > 0 ? 1 : -1);
+        return compact_index_key{pos.token().raw(), 0, weight};
+    }
+};
+
+class compact_primary_index_entry {
+    int64_t _token;
+    uint32_t _fingerprint;
+    struct {
+        bool _head : 1;
+        bool _tail : 1;
+        bool _train : 1;
+    } _flags{};
+    index_entry _e;
+public:
+    compact_primary_index_entry(compact_index_key key, index_entry e)
+        : _token(key.token)
+        , _fingerprint(key.fingerprint)
+        , _e(std::move(e))
+    { }
+
+    compact_primary_index_entry(compact_primary_index_entry&&) noexcept = default;
+
+    bool is_head() const noexcept { return _flags._head; }
+    void set_head(bool v) noexcept { _flags._head = v; }
+    bool is_tail() const noexcept { return _flags._tail; }
+    void set_tail(bool v) noexcept { _flags._tail = v; }
+    bool with_train() const noexcept { return _flags._train; }
+    void set_train(bool v) noexcept { _flags._train = v; }
+
+    compact_index_key key() const noexcept { return compact_index_key{_token, _fingerprint}; }
+    const index_entry& entry() const noexcept { return _e; }
+
+    friend class primary_index;
+    friend struct compact_index_compare;
+};
+
+struct compact_index_less {
+    bool operator()(int64_t k1, int64_t k2) const noexcept {
+        return dht::tri_compare_raw(k1, k2) < 0;
+    }
+    bool operator()(const compact_index_key& k1, int64_t k2) const noexcept {
+        return dht::tri_compare_raw(k1.token, k2) < 0;
+    }
+    bool operator()(int64_t k1, const compact_index_key& k2) const noexcept {
+        return dht::tri_compare_raw(k1, k2.token) < 0;
+    }
+    int64_t simplify_key(const compact_index_key& k) const noexcept {
+        return k.token;
+    }
+    int64_t simplify_key(int64_t k) const noexcept {
+        return k;
+    }
+};
+
+struct compact_index_compare {
+    std::strong_ordering operator()(const compact_primary_index_entry& e, const compact_index_key& k) const noexcept {
+        if (auto c = dht::tri_compare_raw(e._token, k.token); c != 0) {
+            return c;
+        }
+        if (k.weight) {
+            return 0 <=> int(k.weight);
+        }
+        return e._fingerprint <=> k.fingerprint;
+    }
+    std::strong_ordering operator()(const compact_index_key& k, const compact_primary_index_entry& e) const noexcept {
+        return 0 <=> (*this)(e, k);
+    }
+    std::strong_ordering operator()(const compact_primary_index_entry& a, const compact_primary_index_entry& b) const noexcept {
+        return (*this)(a, b.key());
+    }
+};
+
+// Maps the partition keys of a logstor table to the location of their
+// latest record.
+//
+// In compact mode the index keeps only the token and a fingerprint of each
+// key instead of the decorated key, which takes a fraction of the memory for
+// all but the smallest keys and doesn't allocate per key. A lookup then
+// finds the record of any key with the same token and fingerprint, so the
+// key is verified against the record header when it is read (see
+// verify_key()). Two keys colliding on both would share an entry, and a
+// write of one would replace the other, but with 64-bit tokens and 32-bit
+// fingerprints this is not expected to happen in practice. Entries of a
+// token are ordered by fingerprint rather than by key, so the iteration
+// order is only the ring order up to the token.
+//
+// A key may also have delta records, which hold partial updates of the
+// partition and are merged with its full record on read. The entry of the key
+// points to its full record, or to a delta record if the key has no full
+// record, and the other delta records are kept in a separate map by their
+// full key, in both modes, so keys without delta records don't pay for them.
+// A full record replaces the delta records older than it, and a delta record
+// older than the full record is dropped, so the chain of a key doesn't depend
+// on the order its records were inserted in, which recovery relies on.
 class primary_index final {
 public:
     using partitions_type = double_decker<int64_t, primary_index_entry,
                             dht::raw_token_less_comparator, dht::ring_position_comparator,
                             16, bplus::key_search::linear>;
+    using compact_partitions_type = double_decker<int64_t, compact_primary_index_entry,
+                            compact_index_less, compact_index_compare,
+                            16, bplus::key_search::linear>;
+
+    // Position of an entry, from which iteration can resume after the index changed.
+    using position = std::variant<dht::decorated_key, compact_index_key>;
+
+    struct entry_view {
+        // Null in compact mode.
+        const dht::decorated_key* key;
+        compact_index_key compact_key;
+        const index_entry& entry;
+    };
+
+    // The delta records of a key, other than the one its entry points to, in
+    // insertion order.
+    using delta_chain = utils::small_vector<index_entry, 2>;
+
+    struct insert_result {
+        bool inserted;
+        // The entry replaced by the inserted one, or the newer entry which
+        // prevented the insertion.
+        std::optional<index_entry> prev_entry;
+        // Delta records older than the inserted full record, dropped from the chain.
+        delta_chain dropped_deltas;
+    };
 private:
+    using deltas_type = std::map<dht::decorated_key, delta_chain, dht::decorated_key::less_comparator>;
+
     partitions_type _partitions;
+    compact_partitions_type _compact_partitions;
+    deltas_type _deltas;
     schema_ptr _schema;
+    bool _compact;
     size_t _key_count = 0;
+    size_t _delta_count = 0;
 
     mutable utils::phased_barrier _reads_phaser{"logstor_primary_index"};
 
 public:
-    explicit primary_index(schema_ptr schema)
+    explicit primary_index(schema_ptr schema, bool compact = false)
         : _partitions(dht::raw_token_less_comparator{})
+        , _compact_partitions(compact_index_less{})
+        , _deltas(dht::decorated_key::less_comparator(schema))
         , _schema(std::move(schema))
+        , _compact(compact)
         {}
 
+    bool is_compact() const noexcept {
+        return _compact;
+    }
+
+    const schema_ptr& schema() const noexcept {
+        return _schema;
+    }
+
     void set_schema(schema_ptr s) {
         _schema = std::move(s);
     }
 
     void clear() {
         _partitions.clear();
+        _compact_partitions.clear();
+        _deltas.clear();
         _key_count = 0;
+        _delta_count = 0;
     }
 
     utils::phased_barrier::operation start_read() const {
@@ -84,96 +256,377 @@ class primary_index final {
         return _reads_phaser.advance_and_await();
     }
 
-    std::optional<index_entry> get(const primary_index_key& key) const {
-        auto it = _partitions.find(key.dk, dht::ring_position_comparator(*_schema));
-        if (it != _partitions.end()) {
-            return it->_e;
+    using entry_cmp_fn = std::function<std::strong_ordering(const index_entry&, const index_entry&)>;
+
+    static std::strong_ordering default_entry_cmp(const index_entry& a, const index_entry& b) noexcept {
+        return a.timestamp <=> b.timestamp;
+    }
+
+private:
+    // Calls func(partitions, it, less) with the iterator to the entry of key,
+    // or to the end of partitions, in the container of the index mode.
+    template <typename Func>
+    decltype(auto) with_entry(const primary_index_key& key, Func&& func) {
+        if (_compact) {
+            return func(_compact_partitions, _compact_partitions.find(compact_index_key::from(key.dk), compact_index_compare{}), compact_index_less{});
         }
-        return std::nullopt;
+        return func(_partitions, _partitions.find(key.dk, dht::ring_position_comparator(*_schema)), dht::raw_token_less_comparator{});
     }
 
-    bool is_record_alive(const primary_index_key& key, log_location location) {
-        auto it = _partitions.find(key.dk, dht::ring_position_comparator(*_schema));
-        if (it != _partitions.end()) {
-            return it->_e.location == location;
-        } else {
-            return false;
+    void add_delta(const dht::decorated_key& dk, const index_entry& e) {
+        auto it = _deltas.find(dk);
+        if (it == _deltas.end()) {
+            it = _deltas.emplace(dk, delta_chain{}).first;
         }
+        it->second.push_back(e);
+        ++_delta_count;
     }
 
-    bool update_record_location(const primary_index_key& key, log_location old_location, log_location new_location) {
-        auto it = _partitions.find(key.dk, dht::ring_position_comparator(*_schema));
-        if (it != _partitions.end()) {
-            if (it->_e.location == old_location) {
-                it->_e.location = new_location;
+    // Removes the delta records of dk older than timestamp from the chain.
+    delta_chain drop_deltas_before(const dht::decorated_key& dk, api::timestamp_type timestamp) {
+        delta_chain dropped;
+        auto it = _deltas.find(dk);
+        if (it == _deltas.end()) {
+            return dropped;
+        }
+        auto& chain = it->second;
+        auto to_drop = std::ranges::remove_if(chain, [&] (const index_entry& e) {
+            if (e.timestamp < timestamp) {
+                dropped.push_back(e);
                 return true;
             }
+            return false;
+        });
+        chain.erase(to_drop.begin(), to_drop.end());
+        _delta_count -= dropped.size();
+        if (chain.empty()) {
+            _deltas.erase(it);
         }
-        return false;
+        return dropped;
     }
 
-    using entry_cmp_fn = std::function<std::strong_ordering(const index_entry&, const index_entry&)>;
+    // dk is null when the entry is restored from a compact checkpoint entry,
+    // which is always a full record or the only delta record of its key.
+    template <typename Partitions, typename Key, typename Compare>
+    insert_result do_insert(Partitions& partitions, const Key& key, int64_t token, Compare key_cmp, const dht::decorated_key* dk,
+            index_entry new_entry, const entry_cmp_fn& cmp) {
+        typename Partitions::bound_hint hint;
+        auto i = partitions.lower_bound(key, key_cmp, hint);
+        if (!hint.match) {
+            partitions.emplace_before(i, token, hint, key, std::move(new_entry));
+            ++_key_count;
+            return {true, std::nullopt};
+        }
+        auto& e = i->_e;
+        if (!dk || (!e.delta && !new_entry.delta)) {
+            if (cmp(e, new_entry) > 0) {
+                return {false, e};
+            }
+            auto old_entry = std::exchange(e, std::move(new_entry));
+            insert_result res{true, old_entry};
+            if (dk) {
+                res.dropped_deltas = drop_deltas_before(*dk, e.timestamp);
+            }
+            return res;
+        }
+        if (new_entry.delta) {
+            if (!e.delta && e.timestamp > new_entry.timestamp) {
+                return {false, e};
+            }
+            add_delta(*dk, new_entry);
+            return {true, std::nullopt};
+        }
+        // A full record of a key whose entry points to a delta record.
+        insert_result res{true};
+        auto old_entry = std::exchange(e, std::move(new_entry));
+        if (old_entry.timestamp >= e.timestamp) {
+            add_delta(*dk, old_entry);
+        } else {
+            res.prev_entry = old_entry;
+        }
+        res.dropped_deltas = drop_deltas_before(*dk, e.timestamp);
+        return res;
+    }
 
-    static std::strong_ordering default_entry_cmp(const index_entry& a, const index_entry& b) noexcept {
-        return a.timestamp <=> b.timestamp;
+    template <typename Partitions, typename Key, typename Compare, typename Less>
+    future<> do_erase(Partitions& partitions, const Key& start, const Key& end, Compare cmp, Less less) {
+        auto it = partitions.lower_bound(start, cmp);
+        auto end_it = partitions.lower_bound(end, cmp);
+        while (it != end_it) {
+            auto prev = it;
+            ++it;
+            prev.erase(less);
+            --_key_count;
+            co_await coroutine::maybe_yield();
+        }
     }
 
-    std::pair<bool, std::optional<index_entry>> insert(const primary_index_key& key, index_entry new_entry, entry_cmp_fn cmp = default_entry_cmp) {
-        partitions_type::bound_hint hint;
-        auto i = _partitions.lower_bound(key.dk, dht::ring_position_comparator(*_schema), hint);
-        if (hint.match) {
-            if (cmp(i->_e, new_entry) <= 0) {
-                auto old_entry = i->_e;
-                i->_e = std::move(new_entry);
-                return {true, std::make_optional(old_entry)};
+    future<> erase_deltas(dht::ring_position_view start, dht::ring_position_view end) {
+        dht::ring_position_comparator cmp(*_schema);
+        auto it = _deltas.begin();
+        while (it != _deltas.end() && cmp(it->first, end) < 0) {
+            if (cmp(it->first, start) >= 0) {
+                _delta_count -= it->second.size();
+                it = _deltas.erase(it);
             } else {
-                return {false, std::make_optional(i->_e)};
+                ++it;
+            }
+            if (it != _deltas.end() && need_preempt()) {
+                // The map may change while yielding, so resume from the key.
+                auto next = it->first;
+                co_await coroutine::maybe_yield();
+                it = _deltas.lower_bound(next);
             }
-        } else {
-            _partitions.emplace_before(i, key.dk.token().raw(), hint, key.dk, std::move(new_entry));
-            ++_key_count;
-            return {true, std::nullopt};
         }
     }
+public:
+    std::optional<index_entry> get(const primary_index_key& key) const {
+        return const_cast<primary_index*>(this)->with_entry(key, [] (auto& partitions, auto it, auto) -> std::optional<index_entry> {
+            if (it != partitions.end()) {
+                return it->_e;
+            }
+            return std::nullopt;
+        });
+    }
+
+    // Returns the delta records of key other than the one its entry points
+    // to, or null if it has none.
+    const delta_chain* get_deltas(const primary_index_key& key) const {
+        auto it = _deltas.find(key.dk);
+        return it != _deltas.end() ? &it->second : nullptr;
+    }
+
+    // Returns whether key has delta records, including the one its entry may point to.
+    bool has_deltas(const primary_index_key& key, const index_entry& entry) const {
+        return entry.delta || get_deltas(key);
+    }
+
+    // Checks that the record read for key belongs to it. Always true in
+    // full mode, where the index keeps the key.
+    bool verify_key(const primary_index_key& key, const log_record_header& header) const {
+        return !_compact || header.key.dk.equal(*_schema, key.dk);
+    }
+
+    bool is_record_alive(const primary_index_key& key, log_location location) {
+        bool alive = with_entry(key, [location] (auto& partitions, auto it, auto) {
+            return it != partitions.end() && it->_e.location == location;
+        });
+        if (!alive && !_deltas.empty()) {
+            if (auto chain = get_deltas(key)) {
+                alive = std::ranges::contains(*chain, location, &index_entry::location);
+            }
+        }
+        return alive;
+    }
+
+    bool update_record_location(const primary_index_key& key, log_location old_location, log_location new_location) {
+        bool updated = with_entry(key, [old_location, new_location] (auto& partitions, auto it, auto) {
+            if (it != partitions.end()) {
+                if (it->_e.location == old_location) {
+                    it->_e.location = new_location;
+                    return true;
+                }
+            }
+            return false;
+        });
+        if (!updated && !_deltas.empty()) {
+            if (auto it = _deltas.find(key.dk); it != _deltas.end()) {
+                for (auto& e : it->second) {
+                    if (e.location == old_location) {
+                        e.location = new_location;
+                        return true;
+                    }
+                }
+            }
+        }
+        return updated;
+    }
+
+    insert_result insert(const primary_index_key& key, index_entry new_entry, entry_cmp_fn cmp = default_entry_cmp) {
+        if (_compact) {
+            return do_insert(_compact_partitions, compact_index_key::from(key.dk), key.dk.token().raw(), compact_index_compare{}, &key.dk,
+                    std::move(new_entry), cmp);
+        }
+        return do_insert(_partitions, key.dk, key.dk.token().raw(), dht::ring_position_comparator(*_schema), &key.dk, std::move(new_entry), cmp);
+    }
+
+    // Compact mode only, for entries restored without their key.
+    insert_result insert(const compact_index_key& key, index_entry new_entry, entry_cmp_fn cmp = default_entry_cmp) {
+        return do_insert(_compact_partitions, key, key.token, compact_index_compare{}, nullptr, std::move(new_entry), cmp);
+    }
+
+    // The timestamp of a full record folded from the given records. It's the
+    // latest one, so that a full record older than some of the folded delta
+    // records doesn't replace the folded record and lose them.
+    static api::timestamp_type fold_timestamp(const index_entry& base, const delta_chain& deltas) noexcept {
+        auto ts = base.timestamp;
+        for (const auto& e : deltas) {
+            ts = std::max(ts, e.timestamp);
+        }
+        return ts;
+    }
+
+    // Replaces the records of key with a full record merged from them, which
+    // were the given entry and delta records when they were read, with the
+    // timestamp given by fold_timestamp(). The delta records inserted since stay
+    // in the chain. Fails, and changes nothing, if any of the records was
+    // replaced or moved in the meantime, or if one of the delta records
+    // inserted since is older than the folded record, since it would be
+    // dropped by the folded record on recovery.
+    bool fold(const primary_index_key& key, const index_entry& base, const delta_chain& deltas, index_entry folded) {
+        auto it = _deltas.find(key.dk);
+        if (!deltas.empty()) {
+            if (it == _deltas.end() || it->second.size() < deltas.size() || !std::ranges::equal(deltas, it->second | std::views::take(deltas.size()))) {
+                return false;
+            }
+        }
+        if (it != _deltas.end()) {
+            for (const auto& e : it->second | std::views::drop(deltas.size())) {
+                if (e.timestamp < folded.timestamp) {
+                    return false;
+                }
+            }
+        }
+        bool replaced = with_entry(key, [&] (auto& partitions, auto i, auto) {
+            if (i == partitions.end() || i->_e != base) {
+                return false;
+            }
+            i->_e = folded;
+            return true;
+        });
+        if (!replaced) {
+            return false;
+        }
+        if (!deltas.empty()) {
+            auto& chain = it->second;
+            chain.erase(chain.begin(), chain.begin() + deltas.size());
+            _delta_count -= deltas.size();
+            if (chain.empty()) {
+                _deltas.erase(it);
+            }
+        }
+        return true;
+    }
 
     bool erase(const primary_index_key& key, log_location loc) {
-        auto it = _partitions.find(key.dk, dht::ring_position_comparator(*_schema));
-        if (it != _partitions.end() && it->_e.location == loc) {
-            it.erase(dht::raw_token_less_comparator{});
+        bool erased = with_entry(key, [loc] (auto& partitions, auto it, auto less) {
+            if (it != partitions.end() && it->_e.location == loc) {
+                it.erase(less);
+                return true;
+            }
+            return false;
+        });
+        if (erased) {
             --_key_count;
-            return true;
         }
-        return false;
+        return erased;
     }
 
     future<> erase(const dht::partition_range& pr) {
-        dht::ring_position_comparator cmp(*_schema);
-        auto it = _partitions.lower_bound(dht::ring_position_view::for_range_start(pr), cmp);
-        auto end_it = _partitions.lower_bound(dht::ring_position_view::for_range_end(pr), cmp);
-        while (it != end_it) {
-            auto prev = it;
-            ++it;
-            prev.erase(dht::raw_token_less_comparator{});
-            --_key_count;
-            co_await coroutine::maybe_yield();
+        auto start = dht::ring_position_view::for_range_start(pr);
+        auto end = dht::ring_position_view::for_range_end(pr);
+        co_await erase_deltas(start, end);
+        if (_compact) {
+            co_await do_erase(_compact_partitions, compact_index_key::bound(start, -1), compact_index_key::bound(end, 1),
+                    compact_index_compare{}, compact_index_less{});
+        } else {
+            co_await do_erase(_partitions, start, end, dht::ring_position_comparator(*_schema), dht::raw_token_less_comparator{});
+        }
+    }
+
+    // Calls func with an entry_view of each of the first max entries after
+    // the given position, or from the first entry, in index order. Returns
+    // the position of the last one, or nullopt if the end of the index was
+    // reached.
+    template <typename Func>
+    requires std::invocable<Func, const entry_view&>
+    std::optional<position> visit_after(const std::optional<position>& after, size_t max, Func func) const {
+        if (_compact) {
+            auto it = after ? _compact_partitions.upper_bound(std::get<compact_index_key>(*after), compact_index_compare{}) : _compact_partitions.begin();
+            compact_index_key last_key{};
+            for (size_t n = 0; it != _compact_partitions.end() && n < max; ++it, ++n) {
+                last_key = it->key();
+                func(entry_view{nullptr, last_key, it->_e});
+            }
+            if (it == _compact_partitions.end()) {
+                return std::nullopt;
+            }
+            return position(last_key);
+        }
+        auto it = after ? upper_bound(std::get<dht::decorated_key>(*after)) : begin();
+        const dht::decorated_key* last_key = nullptr;
+        for (size_t n = 0; it != end() && n < max; ++it, ++n) {
+            last_key = &it->_key;
+            func(entry_view{last_key, compact_index_key{it->_key.token().raw()}, it->_e});
+        }
+        if (it == end()) {
+            return std::nullopt;
+        }
+        return position(*last_key);
+    }
+
+    // Like visit_after(), for the delta records in the chains of the keys,
+    // other than the ones the entries of the keys point to.
+    template <typename Func>
+    requires std::invocable<Func, const dht::decorated_key&, const index_entry&>
+    std::optional<dht::decorated_key> visit_deltas_after(const std::optional<dht::decorated_key>& after, size_t max, Func func) const {
+        auto it = after ? _deltas.upper_bound(*after) : _deltas.begin();
+        const dht::decorated_key* last_key = nullptr;
+        for (size_t n = 0; it != _deltas.end() && n < max; ++it) {
+            last_key = &it->first;
+            for (const auto& e : it->second) {
+                func(it->first, e);
+            }
+            n += it->second.size();
+        }
+        if (it == _deltas.end()) {
+            return std::nullopt;
+        }
+        return *last_key;
+    }
+
+    // Compact mode only: the token of the first entry at or after bound, and
+    // the entries of that token.
+    std::optional<std::pair<int64_t, utils::small_vector<index_entry, 1>>> token_entries(const compact_index_key& bound) const {
+        auto it = _compact_partitions.lower_bound(bound, compact_index_compare{});
+        if (it == _compact_partitions.end()) {
+            return std::nullopt;
+        }
+        auto token = it->_token;
+        utils::small_vector<index_entry, 1> entries;
+        for (; it != _compact_partitions.end() && it->_token == token; ++it) {
+            entries.push_back(it->_e);
         }
+        return std::make_pair(token, std::move(entries));
     }
 
+    // Full mode only.
     auto begin() const noexcept { return _partitions.begin(); }
     auto end() const noexcept { return _partitions.end(); }
 
-    bool empty() const noexcept { return _partitions.empty(); }
+    bool empty() const noexcept { return _key_count == 0; }
 
     size_t get_key_count() const noexcept { return _key_count; }
 
-    size_t get_memory_usage() const noexcept { return _key_count * sizeof(index_entry); }
+    // The number of delta records in the chains, other than the ones the
+    // entries of the keys point to.
+    size_t get_delta_count() const noexcept { return _delta_count; }
+
+    size_t get_memory_usage() const noexcept {
+        // Approximates the map node overhead with three pointers and a color.
+        constexpr size_t delta_node_size = sizeof(deltas_type::value_type) + 4 * sizeof(void*);
+        return _key_count * (_compact ? sizeof(compact_primary_index_entry) : sizeof(primary_index_entry))
+                + _deltas.size() * delta_node_size + _delta_count * sizeof(index_entry);
+    }
 
     // First entry with key >= pos (for positioning at range start)
+    // Full mode only.
     partitions_type::const_iterator lower_bound(const dht::ring_position_view& pos) const {
         return _partitions.lower_bound(pos, dht::ring_position_comparator(*_schema));
     }
 
     // First entry with key strictly > key (for advancing past a key after a yield)
+    // Full mode only.
     partitions_type::const_iterator upper_bound(const dht::decorated_key& key) const {
         return _partitions.upper_bound(key, dht::ring_position_comparator(*_schema));
     }
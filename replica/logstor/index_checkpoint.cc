@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include "replica/logstor/index_checkpoint.hh"
+
+#include <seastar/core/byteorder.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/coroutine/exception.hh>
+#include <seastar/util/log.hh>
+
+#include "bytes_ostream.hh"
+#include "idl/logstor.dist.hh"
+#include "idl/logstor.dist.impl.hh"
+#include "serializer_impl.hh"
+#include "utils/crc.hh"
+
+namespace replica::logstor {
+
+extern seastar::logger logstor_logger;
+
+namespace {
+
+constexpr uint32_t checkpoint_magic = 0x4c534943; // "LSIC"
+constexpr uint8_t checkpoint_version = 1;
+
+constexpr size_t header_size = 32;
+constexpr size_t header_crc_offset = 24;
+constexpr size_t frame_header_size = 2 * sizeof(uint32_t);
+
+// Larger chunks are rejected as corruption rather than allocated.
+constexpr size_t max_chunk_size = 64 * 1024 * 1024;
+
+uint32_t checksum(const char* data, size_t size) {
+    utils::crc32 c;
+    c.process(reinterpret_cast<const uint8_t*>(data), size);
+    return c.get();
+}
+
+}
+
+index_checkpoint_writer::index_checkpoint_writer(std::filesystem::path path, output_stream<char> out)
+    : _path(std::move(path))
+    , _out(std::move(out))
+{ }
+
+static std::filesystem::path tmp_path_for(const std::filesystem::path& path) {
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    return tmp_path;
+}
+
+future<index_checkpoint_writer> index_checkpoint_writer::create(std::filesystem::path path, size_t segment_size, segment_sequence watermark) {
+    auto f = co_await open_file_dma(tmp_path_for(path).native(), open_flags::wo | open_flags::create | open_flags::truncate);
+    index_checkpoint_writer w(std::move(path), co_await make_file_output_stream(std::move(f)));
+
+    std::array<char, header_size> header{};
+    write_le<uint32_t>(header.data(), checkpoint_magic);
+    write_le<uint8_t>(header.data() + 4, checkpoint_version);
+    write_le<uint64_t>(header.data() + 8, segment_size);
+    write_le<uint64_t>(header.data() + 16, watermark.value);
+    write_le<uint32_t>(header.data() + header_crc_offset, checksum(header.data(), header_crc_offset));
+
+    std::exception_ptr ex;
+    try {
+        co_await w._out.write(header.data(), header.size());
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        co_await w.abort();
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_return std::move(w);
+}
+
+future<> index_checkpoint_writer::write(const index_checkpoint_chunk& chunk) {
+    bytes_ostream payload;
+    ser::serialize(payload, chunk);
+
+    utils::crc32 c;
+    for (bytes_view frag : payload) {
+        c.process(reinterpret_cast<const uint8_t*>(frag.data()), frag.size());
+    }
+    std::array<char, frame_header_size> frame;
+    write_le<uint32_t>(frame.data(), payload.size());
+    write_le<uint32_t>(frame.data() + sizeof(uint32_t), c.get());
+
+    co_await _out.write(frame.data(), frame.size());
+    for (bytes_view frag : payload) {
+        co_await _out.write(reinterpret_cast<const char*>(frag.data()), frag.size());
+    }
+    ++_chunk_count;
+    _entry_count += chunk.entries.size() + chunk.compact_entries.size() + chunk.delta_entries.size();
+}
+
+future<> index_checkpoint_writer::commit() {
+    std::array<char, frame_header_size> end;
+    write_le<uint32_t>(end.data(), 0);
+    write_le<uint32_t>(end.data() + sizeof(uint32_t), _chunk_count);
+
+    std::exception_ptr ex;
+    try {
+        co_await _out.write(end.data(), end.size());
+        co_await _out.flush();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await _out.close();
+    if (ex) {
+        co_await remove_file(tmp_path_for(_path).native()).handle_exception([] (std::exception_ptr) {
+            // Removed by the next recovery.
+        });
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_await rename_file(tmp_path_for(_path).native(), _path.native());
+    co_await sync_directory(_path.parent_path().native());
+}
+
+future<> index_checkpoint_writer::abort() noexcept {
+    try {
+        co_await _out.close();
+    } catch (...) {
+        logstor_logger.debug("Failed to close aborted index checkpoint {}: {}", _path.native(), std::current_exception());
+    }
+    try {
+        co_await remove_file(tmp_path_for(_path).native());
+    } catch (...) {
+        // Removed by the next recovery.
+        logstor_logger.debug("Failed to remove aborted index checkpoint {}: {}", _path.native(), std::current_exception());
+    }
+}
+
+index_checkpoint_reader::index_checkpoint_reader(input_stream<char> in, segment_sequence watermark)
+    : _in(std::move(in))
+    , _watermark(watermark)
+{ }
+
+future<index_checkpoint_reader> index_checkpoint_reader::open(std::filesystem::path path, size_t segment_size) {
+    auto f = co_await open_file_dma(path.native(), open_flags::ro);
+    auto in = make_file_input_stream(std::move(f));
+
+    std::exception_ptr ex;
+    std::optional<segment_sequence> watermark;
+    try {
+        auto header = co_await in.read_exactly(header_size);
+        if (header.size() != header_size) {
+            throw std::runtime_error(fmt::format("Truncated index checkpoint {}", path.native()));
+        }
+        if (read_le<uint32_t>(header.get()) != checkpoint_magic
+                || read_le<uint32_t>(header.get() + header_crc_offset) != checksum(header.get(), header_crc_offset)) {
+            throw std::runtime_error(fmt::format("Corrupted header in index checkpoint {}", path.native()));
+        }
+        if (auto version = read_le<uint8_t>(header.get() + 4); version != checkpoint_version) {
+            throw std::runtime_error(fmt::format("Unsupported index checkpoint version {} in {}", version, path.native()));
+        }
+        if (auto size = read_le<uint64_t>(header.get() + 8); size != segment_size) {
+            throw std::runtime_error(fmt::format("Index checkpoint {} was written with segment size {}, current segment size is {}",
+                    path.native(), size, segment_size));
+        }
+        watermark = segment_sequence(read_le<uint64_t>(header.get() + 16));
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        co_await in.close();
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_return index_checkpoint_reader(std::move(in), *watermark);
+}
+
+future<std::optional<index_checkpoint_chunk>> index_checkpoint_reader::read_chunk() {
+    if (_eof) {
+        co_return std::nullopt;
+    }
+    auto frame = co_await _in.read_exactly(frame_header_size);
+    if (frame.size() != frame_header_size) {
+        throw std::runtime_error("Truncated index checkpoint");
+    }
+    auto size = read_le<uint32_t>(frame.get());
+    auto crc = read_le<uint32_t>(frame.get() + sizeof(uint32_t));
+    if (size == 0) {
+        if (crc != _chunk_count) {
+            throw std::runtime_error(fmt::format("Index checkpoint ends after {} chunks, expected {}", _chunk_count, crc));
+        }
+        _eof = true;
+        co_return std::nullopt;
+    }
+    if (size > max_chunk_size) {
+        throw std::runtime_error(fmt::format("Invalid index checkpoint chunk size {}", size));
+    }
+    auto payload = co_await _in.read_exactly(size);
+    if (payload.size() != size) {
+        throw std::runtime_error("Truncated index checkpoint");
+    }
+    if (checksum(payload.get(), payload.size()) != crc) {
+        throw std::runtime_error(fmt::format("Checksum mismatch in chunk {} of index checkpoint", _chunk_count));
+    }
+    ++_chunk_count;
+    co_return ser::deserialize_from_buffer(payload, std::type_identity<index_checkpoint_chunk>{});
+}
+
+future<> index_checkpoint_reader::close() {
+    return _in.close();
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+#include <seastar/core/fstream.hh>
+
+#include "replica/logstor/types.hh"
+
+namespace replica::logstor {
+
+// A checkpoint of the primary indexes of all logstor tables of a shard, so
+// that recovery doesn't need to scan every segment to rebuild them.
+//
+// The checkpoint holds the index entries which point to segments with a
+// sequence number lower than the checkpoint's watermark. The segments with a
+// higher sequence number were open, or opened later, when the checkpoint was
+// taken, and recovery replays them on top of the checkpoint.
+//
+// Layout:
+//
+//   header: magic, version, segment size, watermark, crc
+//   chunks: size, crc, IDL-serialized index_checkpoint_chunk
+//   end:    zero size, number of chunks
+//
+// The checkpoint is written to a temporary file which is renamed over the
+// previous checkpoint when complete, so a crash leaves either one of them.
+class index_checkpoint_writer {
+    std::filesystem::path _path;
+    output_stream<char> _out;
+    uint32_t _chunk_count = 0;
+    size_t _entry_count = 0;
+
+    index_checkpoint_writer(std::filesystem::path path, output_stream<char> out);
+public:
+    index_checkpoint_writer(index_checkpoint_writer&&) noexcept = default;
+
+    static future<index_checkpoint_writer> create(std::filesystem::path path, size_t segment_size, segment_sequence watermark);
+
+    future<> write(const index_checkpoint_chunk& chunk);
+
+    // Makes the checkpoint durable and replaces the previous one with it.
+    future<> commit();
+
+    // Discards the checkpoint being written.
+    future<> abort() noexcept;
+
+    size_t entry_count() const noexcept { return _entry_count; }
+};
+
+class index_checkpoint_reader {
+    input_stream<char> _in;
+    segment_sequence _watermark;
+    uint32_t _chunk_count = 0;
+    bool _eof = false;
+
+    index_checkpoint_reader(input_stream<char> in, segment_sequence watermark);
+public:
+    index_checkpoint_reader(index_checkpoint_reader&&) noexcept = default;
+
+    // Throws if the checkpoint is corrupted or was written with a different
+    // segment size.
+    static future<index_checkpoint_reader> open(std::filesystem::path path, size_t segment_size);
+
+    segment_sequence watermark() const noexcept { return _watermark; }
+
+    // Returns the next chunk of entries, or nullopt at the end of the checkpoint.
+    // Throws if the checkpoint is corrupted.
+    future<std::optional<index_checkpoint_chunk>> read_chunk();
+
+    future<> close();
+};
+
+}
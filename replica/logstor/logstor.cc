@@ -9,6 +9,7 @@
 #include <seastar/core/coroutine.hh>
 #include <seastar/util/log.hh>
 #include <seastar/core/future.hh>
+#include "db/cache_tracker.hh"
 #include "readers/from_mutations.hh"
 #include "keys/keys.hh"
 #include "replica/logstor/segment_manager.hh"
@@ -16,12 +17,15 @@
 #include "utils/managed_bytes.hh"
 #include <openssl/ripemd.h>
 #include <openssl/evp.h>
+#include <deque>
 
 namespace replica::logstor {
 
 seastar::logger logstor_logger("logstor");
 
-static api::timestamp_type extract_logstor_record_timestamp(const mutation& m) {
+// Returns the timestamp of the full record of a mutation which replaces the
+// partition, or nullopt if it's a partial update, written as a delta record.
+static std::optional<api::timestamp_type> extract_logstor_record_timestamp(const mutation& m) {
     const auto& partition = m.partition();
 
     for (const auto& row_entry : partition.clustered_rows()) {
@@ -37,12 +41,59 @@ static api::timestamp_type extract_logstor_record_timestamp(const mutation& m) {
         return partition_tombstone.timestamp;
     }
 
-    throw std::runtime_error("logstor mutation has no row marker or partition tombstone timestamp");
+    return std::nullopt;
 }
 
-logstor::logstor(logstor_config config)
+static void update_max_timestamp(api::timestamp_type& max_ts, const schema& s, const row& r, column_kind kind) {
+    r.for_each_cell([&] (column_id id, const atomic_cell_or_collection& item) {
+        auto& col = s.column_at(kind, id);
+        if (col.is_atomic()) {
+            max_ts = std::max(max_ts, item.as_atomic_cell(col).timestamp());
+        } else {
+            auto cmv = item.as_collection_mutation();
+            if (cmv.tomb()) {
+                max_ts = std::max(max_ts, cmv.tomb().timestamp);
+            }
+            for (auto& entry : cmv) {
+                max_ts = std::max(max_ts, entry.second.timestamp());
+            }
+        }
+    });
+}
+
+// The timestamp of a delta record is the latest timestamp of the write.
+static api::timestamp_type extract_logstor_delta_timestamp(const mutation& m) {
+    const auto& s = *m.schema();
+    const auto& partition = m.partition();
+    api::timestamp_type max_ts = api::missing_timestamp;
+
+    update_max_timestamp(max_ts, s, partition.static_row().get(), column_kind::static_column);
+    for (const auto& row_entry : partition.clustered_rows()) {
+        const auto& row = row_entry.row();
+        if (auto t = row.deleted_at().tomb()) {
+            max_ts = std::max(max_ts, t.timestamp);
+        }
+        update_max_timestamp(max_ts, s, row.cells(), column_kind::regular_column);
+    }
+    for (const auto& rt : partition.row_tombstones()) {
+        max_ts = std::max(max_ts, rt.tombstone().tomb.timestamp);
+    }
+
+    if (max_ts == api::missing_timestamp) {
+        throw std::runtime_error("logstor mutation has no row marker, partition tombstone or cell timestamp");
+    }
+    return max_ts;
+}
+
+logstor::logstor(logstor_config config, cache_tracker& tracker)
     : _segment_manager(config.segment_manager_cfg)
-    , _write_buffer(_segment_manager, config.flush_sg) {
+    , _write_buffer(_segment_manager, config.flush_sg)
+    , _record_cache(tracker.get_lru(), tracker.region(), std::move(config.enable_record_cache))
+    , _compact_index(config.compact_index)
+    , _scan_readahead_partitions(std::move(config.scan_readahead_partitions))
+    , _scan_readahead_kb(std::move(config.scan_readahead_kb))
+    , _scan_max_concurrent_reads(std::move(config.scan_max_concurrent_reads))
+    , _max_delta_chain_length(std::move(config.max_delta_chain_length)) {
 }
 
 future<> logstor::do_recovery(replica::database& db) {
@@ -91,56 +142,179 @@ future<> logstor::write(const mutation& m, compaction_group& cg, seastar::gate::
     primary_index_key key(m.decorated_key());
     table_id table = m.schema()->id();
     auto& index = cg.get_logstor_index();
+    auto& gc_stats = cg.get_logstor_gc_stats();
 
-    const auto ts = extract_logstor_record_timestamp(m);
+    // A write which doesn't replace the partition is appended as a delta
+    // record, rather than read, merged and written in full.
+    const auto full_ts = extract_logstor_record_timestamp(m);
+    const bool delta = !full_ts;
+    const auto ts = delta ? extract_logstor_delta_timestamp(m) : *full_ts;
 
     log_record record {
         .header = {
             .key = key,
             .timestamp = ts,
             .table = table,
+            .delta = delta,
         },
         .mut = canonical_mutation(m)
     };
 
-    return _write_buffer.write(std::move(record), &cg, std::move(cg_holder)).then_unpack([this, &index, ts, key = std::move(key)]
-            (log_location location, seastar::gate::holder op) {
+    // Keep the record to update the record cache with, if the key is cached.
+    std::optional<log_record> cached_record;
+    if (!delta && _record_cache.enabled() && _record_cache.contains(table, key.dk)) {
+        cached_record = record;
+    }
+
+    // Held by the background fold of the chain of the key, if the write
+    // makes it too long, until it's done.
+    auto fold_holder = delta ? cg_holder : seastar::gate::holder();
+
+    return _write_buffer.write(std::move(record), &cg, std::move(cg_holder)).then_unpack([this, &cg, &index, &gc_stats, ts, delta, table, key = std::move(key),
+            cached_record = std::move(cached_record), fold_holder = std::move(fold_holder)] (log_location location, seastar::gate::holder op) mutable {
+        gc_stats.bytes_written += location.size;
         index_entry new_entry {
             .location = location,
             .timestamp = ts,
+            .delta = delta,
         };
 
-        auto [inserted, prev_entry] = index.insert(key, std::move(new_entry));
+        auto [inserted, prev_entry, dropped_deltas] = index.insert(key, std::move(new_entry));
 
         if (!inserted) {
             // A newer entry already exists; free the record we just wrote.
             _segment_manager.free_record(location);
-        } else if (prev_entry) {
-            // Overwrote an older entry; free it.
-            _segment_manager.free_record(prev_entry->location);
+        } else {
+            if (prev_entry) {
+                // Overwrote an older entry; free it.
+                _segment_manager.free_record(prev_entry->location);
+            }
+            for (const auto& e : dropped_deltas) {
+                _segment_manager.free_record(e.location);
+            }
+            // The key may have been cached by a read since the write started,
+            // with a record of the same timestamp.
+            if (cached_record && !index.get_deltas(key)) {
+                _record_cache.update(*cached_record);
+            } else {
+                _record_cache.remove(table, key.dk);
+            }
+            // The chain is folded in the background, so that the write
+            // completes once its delta record is durable. Folding only at
+            // multiples of the limit keeps the writes which extend the chain
+            // while it is folded from starting more folds of it.
+            const auto max_chain_length = std::max<uint32_t>(_max_delta_chain_length(), 1);
+            if (delta) {
+                if (auto chain = index.get_deltas(key); chain && chain->size() % max_chain_length == 0) {
+                    (void)fold_deltas(cg, std::move(key), std::move(fold_holder));
+                }
+            }
         }
+        return make_ready_future<>();
     }).handle_exception([] (std::exception_ptr ep) {
         logstor_logger.error("Error writing mutation: {}", ep);
         return make_exception_future<>(ep);
     });
 }
 
+future<> logstor::fold_deltas(compaction_group& cg, primary_index_key key, seastar::gate::holder cg_holder) noexcept {
+    try {
+        auto& index = cg.get_logstor_index();
+        auto base = index.get(key);
+        auto chain = index.get_deltas(key);
+        if (!base || !chain) {
+            co_return;
+        }
+        // Copied, since the chain may change while the records are read.
+        const auto deltas = *chain;
+        const auto fold_ts = primary_index::fold_timestamp(*base, deltas);
+
+        std::optional<log_record> folded;
+        {
+            // Keeps the records of the chain from being freed until they are read.
+            auto op = index.start_read();
+            auto record = co_await _segment_manager.read(base->location);
+            if (!index.verify_key(key, record.header)) {
+                co_return;
+            }
+            folded = co_await merge_deltas(index.schema(), std::move(record), deltas);
+        }
+        folded->header.timestamp = fold_ts;
+        folded->header.delta = false;
+
+        auto [location, op] = co_await _write_buffer.write(std::move(*folded), &cg, std::move(cg_holder));
+        cg.get_logstor_gc_stats().bytes_written += location.size;
+        if (index.fold(key, *base, deltas, index_entry{.location = location, .timestamp = fold_ts})) {
+            _segment_manager.free_record(base->location);
+            for (const auto& e : deltas) {
+                _segment_manager.free_record(e.location);
+            }
+            _record_cache.remove(index.schema()->id(), key.dk);
+        } else {
+            // The chain changed meanwhile; a later write folds it.
+            _segment_manager.free_record(location);
+        }
+    } catch (...) {
+        // The chain stays as is, and is folded by a later write or by compaction.
+        logstor_logger.warn("Failed to fold delta records of {}: {}", key.dk, std::current_exception());
+    }
+}
+
+static bool same_deltas(const primary_index::delta_chain* chain, const primary_index::delta_chain& deltas) {
+    return chain ? std::ranges::equal(*chain, deltas) : deltas.empty();
+}
+
+future<log_record> logstor::merge_deltas(schema_ptr s, log_record record, primary_index::delta_chain deltas) {
+    auto reads = deltas | std::views::transform([this] (const index_entry& e) {
+        return _segment_manager.read(e.location);
+    }) | std::ranges::to<std::vector<future<log_record>>>();
+    auto delta_records = co_await when_all_succeed(reads.begin(), reads.end());
+    auto m = record.mut.to_mutation(s);
+    for (auto& d : delta_records) {
+        // Applying a mutation is commutative, so the order of the deltas doesn't matter.
+        m.apply(d.mut.to_mutation(s));
+    }
+    record.mut = canonical_mutation(m);
+    co_return record;
+}
+
 future<std::optional<log_record>> logstor::read(const primary_index& index, primary_index_key key) {
     auto op = index.start_read();
 
     auto entry_opt = index.get(key);
     if (!entry_opt.has_value()) {
-        return make_ready_future<std::optional<log_record>>(std::nullopt);
+        co_return std::nullopt;
     }
 
-    const auto& entry = *entry_opt;
+    const auto entry = *entry_opt;
+    // Copied, since the chain may change while the records are read.
+    primary_index::delta_chain deltas;
+    if (auto chain = index.get_deltas(key)) {
+        deltas = *chain;
+    }
 
-    return _segment_manager.read(entry.location).then([key = std::move(key), op = std::move(op)] (log_record record) {
-        return std::optional<log_record>(std::move(record));
-    }).handle_exception([] (std::exception_ptr ep) {
-        logstor_logger.error("Error reading record: {}", ep);
-        return make_exception_future<std::optional<log_record>>(ep);
-    });
+    if (auto record = _record_cache.lookup(index.schema()->id(), key.dk, entry.timestamp, deltas.size())) {
+        co_return std::move(record);
+    }
+
+    try {
+        auto record = co_await _segment_manager.read(entry.location);
+        if (!index.verify_key(key, record.header)) {
+            // Another key with the same token and fingerprint in a compact index.
+            co_return std::nullopt;
+        }
+        if (!deltas.empty()) {
+            record = co_await merge_deltas(index.schema(), std::move(record), deltas);
+        }
+        // Don't cache a record which was overwritten during the read.
+        if (auto current = index.get(key); current && current->location == entry.location && same_deltas(index.get_deltas(key), deltas)) {
+            _record_cache.populate(record, deltas.size());
+        }
+        co_return std::move(record);
+    } catch (...) {
+        logstor_logger.error("Error reading record: {}", std::current_exception());
+        throw;
+    }
 }
 
 future<std::optional<canonical_mutation>> logstor::read(const schema& s, const primary_index& index, const dht::decorated_key& dk) {
@@ -177,6 +351,11 @@ mutation_reader logstor::make_reader(schema_ptr schema,
         query::partition_slice _slice;
         tracing::trace_state_ptr _trace_state;
         std::optional<dht::decorated_key> _last_key; // owns the key, safe across yields
+        std::optional<int64_t> _last_token; // compact index mode
+        std::deque<canonical_mutation> _pending; // partitions read ahead, in ring order
+        // Memory of the partitions in _pending, accounted to the permit.
+        size_t _pending_memory = 0;
+        reader_permit::resource_units _pending_units;
         mutation_reader_opt _current_partition_reader;
         dht::ring_position_comparator _cmp;
 
@@ -208,6 +387,192 @@ mutation_reader logstor::make_reader(schema_ptr schema,
             return _pr.end()->is_inclusive() ? c > 0 : c >= 0;
         }
 
+        // Applies the delta records read with a record, which follow it in records.
+        void merge_deltas(log_record& record, std::vector<log_record>::iterator& next, size_t deltas) const {
+            if (!deltas) {
+                return;
+            }
+            auto m = record.mut.to_mutation(_schema);
+            for (size_t i = 0; i < deltas; ++i, ++next) {
+                m.apply(next->mut.to_mutation(_schema));
+            }
+            record.mut = canonical_mutation(m);
+        }
+
+        void push_pending(canonical_mutation mut) {
+            _pending_memory += mut.representation().size();
+            _pending.push_back(std::move(mut));
+        }
+
+        canonical_mutation pop_pending() {
+            auto mut = std::move(_pending.front());
+            _pending.pop_front();
+            _pending_memory -= mut.representation().size();
+            _pending_units.reset_to(reader_resources::with_memory(_pending_memory));
+            return mut;
+        }
+
+        void clear_pending() noexcept {
+            _pending.clear();
+            _pending_memory = 0;
+            _pending_units.reset_to_zero();
+        }
+
+        // Reads the partitions of the next keys in range into _pending, in
+        // ring order. Returns false past the end of the range.
+        //
+        // The records of up to logstor_scan_readahead_partitions keys, and
+        // logstor_scan_readahead_kb of records, are read together, by location
+        // rather than in key order, so a scan reads the segments in order,
+        // with one read for nearby records, instead of a random read per key.
+        // The records are accounted to the permit from before they are read
+        // until their partition is consumed.
+        future<bool> read_next_window() {
+            if (_pr.is_singular() && _pr.start()->value().has_key()) {
+                // Looked up by key, which also goes through the record cache.
+                if (_last_token) {
+                    co_return false;
+                }
+                auto dk = _pr.start()->value().as_decorated_key();
+                _last_token = dk.token().raw();
+                std::optional<canonical_mutation> cmut;
+                {
+                    auto guard = reader_permit::awaits_guard(_permit);
+                    cmut = co_await _logstor->read(*_schema, _index, dk);
+                }
+                if (cmut) {
+                    push_pending(std::move(*cmut));
+                    _pending_units = _permit.consume_memory(_pending_memory);
+                }
+                co_return true;
+            }
+            if (_index.is_compact()) {
+                co_return co_await read_next_tokens();
+            }
+
+            struct window_key {
+                dht::decorated_key key;
+                size_t deltas;
+            };
+            std::vector<window_key> keys;
+            std::vector<log_location> locations;
+
+            // Keeps the records of the entries from being moved and freed until they are read.
+            auto op = _index.start_read();
+            auto window = _logstor->scan_readahead_partitions();
+            auto max_bytes = _logstor->scan_readahead_bytes();
+            size_t bytes = 0;
+            for (auto it = find_next(); it != _index.end() && !exceeds_range_end(*it) && keys.size() < window
+                    && (keys.empty() || bytes < max_bytes); ++it) {
+                locations.push_back(it->entry().location);
+                bytes += it->entry().location.size;
+                size_t deltas = 0;
+                if (auto chain = _index.get_deltas(primary_index_key{it->key()})) {
+                    for (const auto& e : *chain) {
+                        locations.push_back(e.location);
+                        bytes += e.location.size;
+                    }
+                    deltas = chain->size();
+                }
+                keys.push_back(window_key{it->key(), deltas});
+            }
+            if (keys.empty()) {
+                co_return false;
+            }
+            _last_key = keys.back().key;
+
+            _pending_units = co_await _permit.request_memory(bytes);
+            std::vector<log_record> records;
+            {
+                auto guard = reader_permit::awaits_guard(_permit);
+                records = co_await _logstor->get_segment_manager().read_many(std::move(locations), _logstor->scan_max_concurrent_reads());
+            }
+            auto next = records.begin();
+            for (const auto& k : keys) {
+                auto& record = *next++;
+                merge_deltas(record, next, k.deltas);
+                tracing::trace(_trace_state, "logstor_range_reader: fetched key {}", k.key);
+                push_pending(std::move(record.mut));
+            }
+            records.clear();
+            _pending_units.reset_to(reader_resources::with_memory(_pending_memory));
+            co_return true;
+        }
+
+        // Like read_next_window(), in compact index mode, for whole tokens.
+        // The index doesn't keep the keys, so they are taken from the records,
+        // and sorted since the index orders the keys of a token by fingerprint.
+        future<bool> read_next_tokens() {
+            auto start = dht::ring_position_view::for_range_start(_pr);
+            auto end = dht::ring_position_view::for_range_end(_pr);
+            auto end_bound = compact_index_key::bound(end, 1);
+
+            std::vector<index_entry> entries;
+            std::vector<log_record> records;
+            {
+                // Keeps the records of the entries from being moved and freed until they are read.
+                auto op = _index.start_read();
+                auto window = _logstor->scan_readahead_partitions();
+                auto max_bytes = _logstor->scan_readahead_bytes();
+                size_t bytes = 0;
+                while (entries.size() < window && (entries.empty() || bytes < max_bytes)) {
+                    auto next = _index.token_entries(_last_token ? compact_index_key{*_last_token, 0, 1} : compact_index_key::bound(start, -1));
+                    if (!next) {
+                        break;
+                    }
+                    auto& [token, token_entries] = *next;
+                    if (auto c = dht::tri_compare_raw(token, end_bound.token); c > 0 || (c == 0 && end_bound.weight < 0)) {
+                        break;
+                    }
+                    _last_token = token;
+                    for (const auto& e : token_entries) {
+                        entries.push_back(e);
+                        bytes += e.location.size;
+                    }
+                }
+                if (entries.empty()) {
+                    co_return false;
+                }
+                _pending_units = co_await _permit.request_memory(bytes);
+                auto guard = reader_permit::awaits_guard(_permit);
+                records = co_await _logstor->get_segment_manager().read_many(
+                        entries | std::views::transform(&index_entry::location) | std::ranges::to<std::vector<log_location>>(),
+                        _logstor->scan_max_concurrent_reads());
+            }
+
+            std::vector<log_record> in_range;
+            for (size_t i = 0; i < records.size(); ++i) {
+                auto& record = records[i];
+                const auto& dk = record.header.key.dk;
+                if (_cmp(dk, start) < 0 || _cmp(dk, end) >= 0) {
+                    continue;
+                }
+                auto current = _index.get(record.header.key);
+                if (!current) {
+                    continue; // removed since the index was read
+                }
+                if (current->location != entries[i].location || _index.get_deltas(record.header.key)) {
+                    // Overwritten since the index was read, or with delta records.
+                    auto guard = reader_permit::awaits_guard(_permit);
+                    auto latest = co_await _logstor->read(_index, record.header.key);
+                    if (!latest) {
+                        continue;
+                    }
+                    record = std::move(*latest);
+                }
+                in_range.push_back(std::move(record));
+            }
+            std::ranges::sort(in_range, [this] (const log_record& a, const log_record& b) {
+                return _cmp(a.header.key.dk, b.header.key.dk) < 0;
+            });
+            for (auto& record : in_range) {
+                tracing::trace(_trace_state, "logstor_range_reader: fetched key {}", record.header.key.dk);
+                push_pending(std::move(record.mut));
+            }
+            _pending_units.reset_to(reader_resources::with_memory(_pending_memory));
+            co_return true;
+        }
+
     public:
         logstor_range_reader(schema_ptr s, const primary_index& idx, reader_permit p,
                     logstor* ls, dht::partition_range pr,
@@ -215,6 +580,7 @@ mutation_reader logstor::make_reader(schema_ptr schema,
             : impl(std::move(s), std::move(p))
             , _logstor(ls), _index(idx), _pr(std::move(pr))
             , _slice(std::move(slice)), _trace_state(std::move(ts))
+            , _pending_units(_permit.consume_memory())
             , _cmp(*_schema)
         {}
 
@@ -229,34 +595,18 @@ mutation_reader logstor::make_reader(schema_ptr schema,
                     }
                     co_await _current_partition_reader->close();
                     _current_partition_reader = std::nullopt;
-                    // _last_key was already set when we opened the reader
                 }
 
-                // Find next key in range (safe after co_await since we use _last_key)
-                auto it = find_next();
-                if (it == _index.end() || exceeds_range_end(*it)) {
+                if (_pending.empty() && !co_await read_next_window()) {
                     _end_of_stream = true;
                     break;
                 }
-
-                // Snapshot the key before yielding
-                auto current_key = it->key();
-
-                auto guard = reader_permit::awaits_guard(_permit);
-                auto cmut = co_await _logstor->read(*_schema, _index, current_key);
-
-                _last_key = current_key; // mark as visited even if not found (tombstoned)
-
-                if (!cmut) {
-                    continue; // key was removed between index lookup and read
+                if (!_pending.empty()) {
+                    _current_partition_reader = make_mutation_reader_from_mutations(
+                        _schema, _permit, pop_pending().to_mutation(_schema),
+                        _slice, streamed_mutation::forwarding::no
+                    );
                 }
-
-                tracing::trace(_trace_state, "logstor_range_reader: fetched key {}", current_key);
-
-                _current_partition_reader = make_mutation_reader_from_mutations(
-                    _schema, _permit, cmut->to_mutation(_schema),
-                    _slice, streamed_mutation::forwarding::no
-                );
             }
         }
 
@@ -277,6 +627,8 @@ mutation_reader logstor::make_reader(schema_ptr schema,
             _end_of_stream = false;
             _pr = pr;
             _last_key = std::nullopt;      // re-position from new range start
+            _last_token = std::nullopt;
+            clear_pending();
             if (_current_partition_reader) {
                 auto fut = _current_partition_reader->close();
                 _current_partition_reader = std::nullopt;
@@ -15,11 +15,14 @@
 #include "replica/compaction_group.hh"
 #include "types.hh"
 #include "index.hh"
+#include "record_cache.hh"
 #include "segment_manager.hh"
 #include "write_buffer.hh"
 #include "mutation/mutation.hh"
 #include "dht/decorated_key.hh"
 
+class cache_tracker;
+
 namespace replica {
 
 class compaction_group;
@@ -32,16 +35,38 @@ extern seastar::logger logstor_logger;
 struct logstor_config {
     segment_manager_config segment_manager_cfg;
     seastar::scheduling_group flush_sg;
+    // Whether the primary indexes of tables are created in compact mode.
+    bool compact_index = false;
+    utils::updateable_value<bool> enable_record_cache{true};
+    // Number of partitions whose records range scans read together.
+    utils::updateable_value<uint32_t> scan_readahead_partitions{256};
+    // Maximum size of the records range scans read together.
+    utils::updateable_value<uint32_t> scan_readahead_kb{1024};
+    // Maximum number of disk reads in flight for a range scan.
+    utils::updateable_value<uint32_t> scan_max_concurrent_reads{8};
+    // Number of delta records of a key above which a write folds them into a full record.
+    utils::updateable_value<uint32_t> max_delta_chain_length{16};
 };
 
 class logstor {
 
     segment_manager _segment_manager;
     buffered_writer _write_buffer;
+    record_cache _record_cache;
+    bool _compact_index;
+    utils::updateable_value<uint32_t> _scan_readahead_partitions;
+    utils::updateable_value<uint32_t> _scan_readahead_kb;
+    utils::updateable_value<uint32_t> _scan_max_concurrent_reads;
+    utils::updateable_value<uint32_t> _max_delta_chain_length;
+
+    // Rewrites the record and delta records of key as a single full record.
+    // Runs in the background, under the gate of the compaction group.
+    future<> fold_deltas(compaction_group&, primary_index_key, seastar::gate::holder cg_holder) noexcept;
 
 public:
 
-    explicit logstor(logstor_config);
+    // Records are cached in the region of the row cache tracker.
+    logstor(logstor_config, cache_tracker&);
 
     logstor(const logstor&) = delete;
     logstor& operator=(const logstor&) = delete;
@@ -53,9 +78,29 @@ class logstor {
 
     size_t get_memory_usage() const;
 
+    bool compact_index() const noexcept {
+        return _compact_index;
+    }
+
+    size_t scan_readahead_partitions() const noexcept {
+        return std::max<uint32_t>(_scan_readahead_partitions(), 1);
+    }
+
+    size_t scan_readahead_bytes() const noexcept {
+        return size_t(_scan_readahead_kb()) * 1024;
+    }
+
+    size_t scan_max_concurrent_reads() const noexcept {
+        return std::max<uint32_t>(_scan_max_concurrent_reads(), 1);
+    }
+
     segment_manager& get_segment_manager() noexcept;
     const segment_manager& get_segment_manager() const noexcept;
 
+    record_cache& get_record_cache() noexcept {
+        return _record_cache;
+    }
+
     compaction_manager& get_compaction_manager() noexcept;
     const compaction_manager& get_compaction_manager() const noexcept;
 
@@ -63,6 +108,11 @@ class logstor {
 
     future<std::optional<log_record>> read(const primary_index&, primary_index_key);
 
+    // Applies the delta records of the chain of a key to its record. The
+    // caller holds a read operation of the index, so the records aren't freed
+    // while they are read.
+    future<log_record> merge_deltas(schema_ptr, log_record, primary_index::delta_chain);
+
     future<std::optional<canonical_mutation>> read(const schema&, const primary_index&, const dht::decorated_key&);
 
     /// Create a mutation reader for a specific key
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include "replica/logstor/record_cache.hh"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/coroutine/maybe_yield.hh>
+#include <seastar/util/log.hh>
+
+#include "dht/ring_position.hh"
+#include "utils/fragment_range.hh"
+
+namespace replica::logstor {
+
+extern seastar::logger logstor_logger;
+
+static managed_bytes to_managed_bytes(const bytes_ostream& data) {
+    managed_bytes b(managed_bytes::initialized_later(), data.size());
+    managed_bytes_mutable_view out(b);
+    for (bytes_view frag : data) {
+        write_fragmented(out, single_fragmented_view(frag));
+    }
+    return b;
+}
+
+record_cache::entry::entry(record_cache* parent, const log_record& record, uint32_t deltas)
+    : _parent(parent)
+    , _table(record.header.table)
+    , _key(record.header.key.dk)
+    , _timestamp(record.header.timestamp)
+    , _deltas(deltas)
+    , _mutation(to_managed_bytes(record.mut.representation()))
+{ }
+
+size_t record_cache::entry::size_in_allocator() const noexcept {
+    return sizeof(entry) + _key.external_memory_usage() + _mutation.external_memory_usage();
+}
+
+log_record record_cache::entry::to_record() const {
+    bytes_ostream data;
+    for (bytes_view frag : fragment_range(managed_bytes_view(_mutation))) {
+        data.write(frag);
+    }
+    return log_record {
+        .header = {
+            .key = primary_index_key{_key},
+            .timestamp = _timestamp,
+            .table = _table,
+        },
+        .mut = canonical_mutation(std::move(data)),
+    };
+}
+
+void record_cache::entry::on_evicted() noexcept {
+    auto& parent = *_parent;
+    ++parent._stats.evictions;
+    --parent._stats.entries;
+    parent._stats.used_bytes -= size_in_allocator();
+    cache_type::iterator it(this);
+    it.erase(dht::raw_token_less_comparator{});
+}
+
+std::strong_ordering record_cache::compare::operator()(const entry& e, const key_view& k) const noexcept {
+    if (auto c = dht::tri_compare_raw(e._key.token().raw(), k.dk.token().raw()); c != 0) {
+        return c;
+    }
+    if (auto c = e._table <=> k.table; c != 0) {
+        return c;
+    }
+    return compare_unsigned(e._key.key().representation(), k.dk.key().representation());
+}
+
+record_cache::record_cache(lru& lru_, logalloc::region& r, utils::updateable_value<bool> enabled)
+    : _cache(dht::raw_token_less_comparator{})
+    , _region(r)
+    , _lru(lru_)
+    , _enabled(std::move(enabled))
+{
+    setup_metrics();
+}
+
+record_cache::~record_cache() {
+    with_allocator(_region.allocator(), [&] {
+        _cache.clear_and_dispose([this] (entry* e) noexcept {
+            on_removed(*e);
+        });
+    });
+}
+
+void record_cache::setup_metrics() {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("logstor_record_cache", {
+        sm::make_counter("hits", _stats.hits,
+                         sm::description("Counts reads of logstor records served from the record cache.")),
+        sm::make_counter("misses", _stats.misses,
+                         sm::description("Counts reads of logstor records which had to read the record from disk.")),
+        sm::make_counter("populations", _stats.populations,
+                         sm::description("Counts records inserted into the record cache by reads.")),
+        sm::make_counter("updates", _stats.updates,
+                         sm::description("Counts cached records replaced by writes.")),
+        sm::make_counter("evictions", _stats.evictions,
+                         sm::description("Counts records evicted from the record cache under memory pressure.")),
+        sm::make_counter("removals", _stats.removals,
+                         sm::description("Counts records removed from the record cache because they became stale or were invalidated.")),
+        sm::make_gauge("entries", _stats.entries,
+                       sm::description("Holds the number of records in the record cache.")),
+        sm::make_gauge("bytes", _stats.used_bytes,
+                       sm::description("Holds the amount of memory used by the record cache.")),
+    });
+}
+
+void record_cache::on_removed(entry& e) noexcept {
+    if (e.is_linked()) {
+        _lru.remove(e);
+    }
+    ++_stats.removals;
+    --_stats.entries;
+    _stats.used_bytes -= e.size_in_allocator();
+}
+
+void record_cache::replace(entry& e, const log_record& record, uint32_t deltas) {
+    auto mutation = to_managed_bytes(record.mut.representation());
+    _stats.used_bytes -= e.size_in_allocator();
+    e._mutation = std::move(mutation);
+    e._timestamp = record.header.timestamp;
+    e._deltas = deltas;
+    _stats.used_bytes += e.size_in_allocator();
+    _lru.touch(e);
+}
+
+std::optional<log_record> record_cache::lookup(table_id table, const dht::decorated_key& key, api::timestamp_type timestamp, size_t deltas) {
+    if (!enabled()) {
+        return std::nullopt;
+    }
+    try {
+        return _as(_region, [&] () -> std::optional<log_record> {
+            auto it = _cache.find(key_view{table, key}, compare{});
+            if (it == _cache.end()) {
+                ++_stats.misses;
+                return std::nullopt;
+            }
+            if (it->_timestamp != timestamp || it->_deltas != deltas) {
+                // The index points to other records now.
+                ++_stats.misses;
+                with_allocator(_region.allocator(), [&] {
+                    on_removed(*it);
+                    it.erase(dht::raw_token_less_comparator{});
+                });
+                return std::nullopt;
+            }
+            auto record = it->to_record();
+            _lru.touch(*it);
+            ++_stats.hits;
+            return record;
+        });
+    } catch (...) {
+        // The record is read from disk instead.
+        logstor_logger.debug("Failed to read cached record of {}: {}", key, std::current_exception());
+        return std::nullopt;
+    }
+}
+
+void record_cache::populate(const log_record& record, size_t deltas) {
+    if (!enabled()) {
+        return;
+    }
+    try {
+        _as(_region, [&] {
+            with_allocator(_region.allocator(), [&] {
+                const auto& dk = record.header.key.dk;
+                cache_type::bound_hint hint;
+                auto it = _cache.lower_bound(key_view{record.header.table, dk}, compare{}, hint);
+                if (hint.match) {
+                    if (std::tie(it->_timestamp, it->_deltas) < std::tuple(record.header.timestamp, deltas)) {
+                        replace(*it, record, deltas);
+                    }
+                    return;
+                }
+                it = _cache.emplace_before(it, dk.token().raw(), hint, this, record, uint32_t(deltas));
+                _lru.add(*it);
+                ++_stats.populations;
+                ++_stats.entries;
+                _stats.used_bytes += it->size_in_allocator();
+            });
+        });
+    } catch (...) {
+        // The record is read again on the next miss.
+        logstor_logger.debug("Failed to cache record of {}: {}", record.header.key, std::current_exception());
+    }
+}
+
+bool record_cache::contains(table_id table, const dht::decorated_key& key) const noexcept {
+    return _cache.find(key_view{table, key}, compare{}) != _cache.end();
+}
+
+void record_cache::update(const log_record& record) {
+    if (!enabled()) {
+        // Don't keep a record which is not going to be read.
+        remove(record.header.table, record.header.key.dk);
+        return;
+    }
+    try {
+        _as(_region, [&] {
+            with_allocator(_region.allocator(), [&] {
+                auto it = _cache.find(key_view{record.header.table, record.header.key.dk}, compare{});
+                if (it != _cache.end()) {
+                    replace(*it, record, 0);
+                    ++_stats.updates;
+                }
+            });
+        });
+    } catch (...) {
+        // The cached record may have the same timestamp as the new one.
+        remove(record.header.table, record.header.key.dk);
+        logstor_logger.debug("Failed to update cached record of {}: {}", record.header.key, std::current_exception());
+    }
+}
+
+void record_cache::remove(table_id table, const dht::decorated_key& key) noexcept {
+    with_allocator(_region.allocator(), [&] {
+        auto it = _cache.find(key_view{table, key}, compare{});
+        if (it != _cache.end()) {
+            on_removed(*it);
+            it.erase(dht::raw_token_less_comparator{});
+        }
+    });
+}
+
+future<> record_cache::invalidate(const schema& s, const dht::partition_range& pr) {
+    auto start = dht::ring_position_view::for_range_start(pr);
+    auto end = dht::ring_position_view::for_range_end(pr);
+    dht::ring_position_comparator cmp(s);
+    auto end_token = end.token().raw();
+    // Iterators are invalidated when the region is compacted, so the
+    // iteration resumes from the next token after preemption.
+    std::optional<int64_t> next_token = start.token().raw();
+    while (next_token) {
+        auto token = *next_token;
+        next_token.reset();
+        with_allocator(_region.allocator(), [&] {
+            logalloc::reclaim_lock rl(_region);
+            auto it = _cache.lower_bound(token, compare{});
+            while (it != _cache.end()) {
+                auto t = it->_key.token().raw();
+                if (dht::tri_compare_raw(t, end_token) > 0) {
+                    break;
+                }
+                if (t != token && need_preempt()) {
+                    next_token = t;
+                    break;
+                }
+                token = t;
+                if (it->_table == s.id() && cmp(it->_key, start) >= 0 && cmp(it->_key, end) < 0) {
+                    on_removed(*it);
+                    it = it.erase(dht::raw_token_less_comparator{});
+                } else {
+                    ++it;
+                }
+            }
+        });
+        if (next_token) {
+            co_await coroutine::maybe_yield();
+        }
+    }
+}
+
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include <optional>
+
+#include <seastar/core/future.hh>
+#include <seastar/core/metrics_registration.hh>
+
+#include "dht/decorated_key.hh"
+#include "dht/i_partitioner_fwd.hh"
+#include "replica/logstor/types.hh"
+#include "utils/double-decker.hh"
+#include "utils/logalloc.hh"
+#include "utils/lru.hh"
+#include "utils/managed_bytes.hh"
+#include "utils/updateable_value.hh"
+
+namespace replica::logstor {
+
+// A per-shard cache of the latest records of logstor tables, keyed by table
+// and partition key.
+//
+// Logstor tables don't use the row cache, so without it every read goes to
+// the segments on disk, even for hot keys. Entries are allocated in the
+// region of the row cache tracker and linked in its LRU, so they take memory
+// from the same pool as the row cache and are evicted with it under memory
+// pressure.
+//
+// The cache is populated by reads and updated by writes of cached keys. An
+// entry remembers the timestamp of its record and the number of delta records
+// merged into it, and is used only while the primary index still points to a
+// record with the same timestamp and chains as many delta records, so a read
+// racing with a write, a record received by streaming, or a key removed from
+// the index never returns a stale record. Writes of delta records remove the
+// key. Records moved by compaction keep their timestamp and stay cached.
+class record_cache {
+public:
+    struct stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t populations = 0;
+        uint64_t updates = 0;
+        uint64_t evictions = 0;
+        uint64_t removals = 0;
+        uint64_t entries = 0;
+        uint64_t used_bytes = 0;
+    };
+private:
+    // Allocated inside LSA
+    class entry final : public evictable {
+        record_cache* _parent;
+        table_id _table;
+        dht::decorated_key _key;
+        api::timestamp_type _timestamp;
+        uint32_t _deltas;
+        managed_bytes _mutation;
+        struct {
+            bool _head : 1;
+            bool _tail : 1;
+            bool _train : 1;
+        } _flags{};
+    public:
+        entry(record_cache* parent, const log_record& record, uint32_t deltas);
+        entry(entry&&) noexcept = default;
+
+        bool is_head() const noexcept { return _flags._head; }
+        void set_head(bool v) noexcept { _flags._head = v; }
+        bool is_tail() const noexcept { return _flags._tail; }
+        void set_tail(bool v) noexcept { _flags._tail = v; }
+        bool with_train() const noexcept { return _flags._train; }
+        void set_train(bool v) noexcept { _flags._train = v; }
+
+        table_id table() const noexcept { return _table; }
+        const dht::decorated_key& key() const noexcept { return _key; }
+        api::timestamp_type timestamp() const noexcept { return _timestamp; }
+
+        // Returns the amount of memory owned by this entry.
+        size_t size_in_allocator() const noexcept;
+
+        // Copies the record out of LSA.
+        log_record to_record() const;
+
+        virtual void on_evicted() noexcept override;
+
+        virtual bool is_logstor_record() const noexcept override {
+            return true;
+        }
+
+        friend class record_cache;
+    };
+
+    // Orders the entries of a token by table and partition key bytes, which
+    // is enough for lookups and doesn't need the schema.
+    struct key_view {
+        table_id table;
+        const dht::decorated_key& dk;
+
+        const dht::token& token() const noexcept { return dk.token(); }
+    };
+    struct compare {
+        std::strong_ordering operator()(const entry& e, const key_view& k) const noexcept;
+        std::strong_ordering operator()(const key_view& k, const entry& e) const noexcept {
+            return 0 <=> (*this)(e, k);
+        }
+        std::strong_ordering operator()(const entry& a, const entry& b) const noexcept {
+            return (*this)(a, key_view{b._table, b._key});
+        }
+        // A raw token positions before all the entries of the token.
+        std::strong_ordering operator()(const entry& e, int64_t token) const noexcept {
+            auto c = dht::tri_compare_raw(e._key.token().raw(), token);
+            return c == 0 ? std::strong_ordering::greater : c;
+        }
+        std::strong_ordering operator()(int64_t token, const entry& e) const noexcept {
+            return 0 <=> (*this)(e, token);
+        }
+    };
+
+    using cache_type = double_decker<int64_t, entry,
+                            dht::raw_token_less_comparator, compare,
+                            16, bplus::key_search::linear>;
+
+    cache_type _cache;
+    logalloc::region& _region;
+    logalloc::allocating_section _as;
+    lru& _lru;
+    utils::updateable_value<bool> _enabled;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+
+    void setup_metrics();
+    // Unlinks e from the LRU, if it's linked, and accounts for its removal.
+    void on_removed(entry& e) noexcept;
+    void replace(entry& e, const log_record& record, uint32_t deltas);
+public:
+    // Create a cache with a given LRU attached.
+    record_cache(lru& lru_, logalloc::region& r, utils::updateable_value<bool> enabled);
+    ~record_cache();
+
+    record_cache(const record_cache&) = delete;
+    record_cache(record_cache&&) = delete;
+
+    bool enabled() const noexcept {
+        return _enabled();
+    }
+
+    // Returns the cached record of a key if its timestamp is the given one,
+    // which is the timestamp of the index entry of the key, and it was merged
+    // with the given number of delta records. Caching is best effort, so this
+    // and populate() don't fail.
+    std::optional<log_record> lookup(table_id table, const dht::decorated_key& key, api::timestamp_type timestamp, size_t deltas);
+
+    // Inserts or replaces the cached record of its key, merged with the given
+    // number of delta records, after a read.
+    void populate(const log_record& record, size_t deltas);
+
+    bool contains(table_id table, const dht::decorated_key& key) const noexcept;
+
+    // Replaces the cached record of its key, if cached, after a write of a
+    // full record which left no delta records in the chain of the key.
+    void update(const log_record& record);
+
+    // Removes the cached record of a key, if cached.
+    void remove(table_id table, const dht::decorated_key& key) noexcept;
+
+    // Removes the cached records of the keys of a table in a range.
+    future<> invalidate(const schema& s, const dht::partition_range& pr);
+
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+}
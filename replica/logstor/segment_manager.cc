@@ -12,9 +12,12 @@
 #include "replica/logstor/logstor.hh"
 #include "replica/logstor/types.hh"
 #include "replica/logstor/compaction.hh"
+#include "replica/logstor/index_checkpoint.hh"
 #include <absl/container/flat_hash_map.h>
+#include <boost/intrusive/list.hpp>
 #include <chrono>
 #include <linux/if_link.h>
+#include <unordered_set>
 #include <seastar/core/file.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/fstream.hh>
@@ -57,6 +60,9 @@ class segment {
 
     future<log_record> read(log_location);
 
+    // Reads size bytes from offset.
+    future<temporary_buffer<char>> read_range(uint32_t offset, size_t size);
+
     log_segment_id id() const noexcept { return _id; }
     seastar::file& get_file() noexcept { return _file; }
 
@@ -76,6 +82,10 @@ class writeable_segment : public segment {
     future<> do_write(log_location , bytes_view data);
 
 public:
+    // links the segment into segment_manager_impl::_open_segments while it's alive.
+    using open_list_hook = boost::intrusive::list_member_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+    open_list_hook _open_hook;
+
     using segment::segment;
 
     void start(segment_ref, segment_sequence);
@@ -125,6 +135,14 @@ future<log_record> segment::read(log_location loc) {
     });
 }
 
+future<temporary_buffer<char>> segment::read_range(uint32_t offset, size_t size) {
+    if (offset + size > _max_size) [[unlikely]] {
+        throw std::runtime_error(fmt::format("Read beyond end of segment {}: offset {} + size {} > max_size {}",
+                                             _id, offset, size, _max_size));
+    }
+    return _file.dma_read_exactly<char>(absolute_offset(offset), size);
+}
+
 void writeable_segment::start(segment_ref seg_ref, segment_sequence seq_num) {
     _seg_ref = std::move(seg_ref);
     _seq_num = seq_num;
@@ -365,6 +383,7 @@ class compaction_manager_impl : public compaction_manager {
         seastar::scheduling_group compaction_sg;
         utils::updateable_value<float> compaction_static_shares;
         seastar::scheduling_group separator_sg;
+        utils::updateable_value<bool> segregate_cold_data;
     };
 
 private:
@@ -378,6 +397,9 @@ class compaction_manager_impl : public compaction_manager {
         uint64_t compaction_segments_freed{0};
         uint64_t compaction_records_skipped{0};
         uint64_t compaction_records_rewritten{0};
+        uint64_t compaction_deltas_folded{0};
+        uint64_t compaction_hot_bytes_written{0};
+        uint64_t compaction_cold_bytes_written{0};
         uint64_t separator_buffer_flushed{0};
         uint64_t separator_segments_freed{0};
     } _stats;
@@ -393,6 +415,10 @@ class compaction_manager_impl : public compaction_manager {
     seastar::semaphore _separator_flush_sem{0};
     seastar::semaphore _compaction_sem{1};
 
+    // Compaction victims are chosen by cost-benefit among this many times
+    // max_segments_per_compaction of the emptiest segments.
+    static constexpr size_t cost_benefit_pool_factor = 4;
+
     struct group_compaction_state {
         bool running{false};
         shared_future<> completion{make_ready_future<>()};
@@ -434,9 +460,9 @@ class compaction_manager_impl : public compaction_manager {
 
 private:
 
-    std::vector<log_segment_id> select_segments_for_compaction(const segment_descriptor_hist&);
+    std::vector<compaction_candidate> select_segments_for_compaction(const segment_descriptor_hist&);
     future<> do_compact(compaction_group&, abort_source&);
-    future<> compact_segments(compaction_group&, std::vector<log_segment_id>);
+    future<> compact_segments(compaction_group&, std::vector<compaction_candidate>);
 
     void adjust_shares() {
         if (auto static_shares = _cfg.compaction_static_shares.get(); static_shares != 0) {
@@ -559,6 +585,8 @@ class segment_manager_impl {
         std::array<uint64_t, write_source_count> bytes_written{0};
         std::array<uint64_t, write_source_count> data_bytes_written{0};
         uint64_t bytes_read{0};
+        uint64_t coalesced_reads{0};
+        uint64_t coalesced_records_read{0};
         uint64_t bytes_freed{0};
         uint64_t segments_allocated{0};
         uint64_t segments_freed{0};
@@ -566,6 +594,8 @@ class segment_manager_impl {
         uint64_t compaction_data_bytes_written{0};
         uint64_t separator_bytes_written{0};
         uint64_t separator_data_bytes_written{0};
+        uint64_t index_checkpoints{0};
+        uint64_t index_checkpoint_entries{0};
     };
 
     file_manager _file_mgr;
@@ -588,6 +618,19 @@ class segment_manager_impl {
     std::optional<shared_future<>> _switch_segment_fut;
     segment_sequence _next_segment_seq{1};
 
+    // Segments which were started for writing and are still alive, in
+    // sequence order. Any of them may still receive writes.
+    using open_segment_list = boost::intrusive::list<writeable_segment,
+            boost::intrusive::member_hook<writeable_segment, writeable_segment::open_list_hook, &writeable_segment::_open_hook>,
+            boost::intrusive::constant_time_size<false>>;
+    open_segment_list _open_segments;
+
+    replica::database* _db = nullptr;
+    seastar::abort_source _checkpoint_as;
+    future<> _index_checkpointer{make_ready_future<>()};
+    segment_sequence _checkpointed_seq{0};
+    static constexpr size_t checkpoint_chunk_entries = 1024;
+
     seastar::gate _async_gate;
     future<> _reserve_replenisher{make_ready_future<>()};
     seastar::condition_variable _segment_freed_cv;
@@ -622,10 +665,13 @@ class segment_manager_impl {
     future<> stop();
 
     future<> write(write_buffer&);
-    future<> write_full_segment(write_buffer&, compaction_group&, write_source);
+    // data_seq defaults to the sequence number of the new segment.
+    future<> write_full_segment(write_buffer&, compaction_group&, write_source, std::optional<segment_sequence> data_seq = std::nullopt);
 
     future<log_record> read(log_location);
 
+    future<std::vector<log_record>> read_many(std::vector<log_location>, size_t max_concurrency);
+
     void free_record(log_location);
 
     future<> for_each_record(log_segment_id segment_id,
@@ -646,6 +692,8 @@ class segment_manager_impl {
         }
     }
 
+    future<> write_index_checkpoint();
+
     future<> load_segment(replica::database&, log_segment_id);
     future<> recover_segment(replica::database&, log_segment_id, primary_index::entry_cmp_fn cmp, std::function<void(const segment_header&)> on_header);
     future<> add_segment_to_compaction_group(replica::database&, segment_descriptor&);
@@ -714,6 +762,21 @@ class segment_manager_impl {
 
     future<std::optional<segment_header>> read_segment_header(log_segment_id);
 
+    std::filesystem::path index_checkpoint_path() const {
+        return _cfg.base_dir / fmt::format("{}Index.db", file_manager::get_file_name_prefix());
+    }
+
+    // Segments with a sequence number lower than the watermark are closed,
+    // so the index entries pointing to them can't be replaced by writes to them.
+    segment_sequence checkpoint_watermark() const noexcept {
+        return _open_segments.empty() ? _next_segment_seq : _open_segments.front().seq_num();
+    }
+
+    future<> run_index_checkpoints();
+    future<> checkpoint_table_index(index_checkpoint_writer&, table_id, const primary_index&, segment_sequence watermark);
+    future<std::optional<segment_sequence>> recover_index_checkpoint(replica::database&,
+            std::vector<segment_sequence>& segment_seqs, const primary_index::entry_cmp_fn& cmp);
+
     // Sequentially scans one segment and invokes callbacks for the decoded
     // contents.
     //
@@ -747,6 +810,9 @@ class segment_manager_impl {
     future<seg_ptr> get_segment(write_source src) {
         seg_ptr seg = co_await _segment_pool.get_segment(src);
         seg->start(make_segment_ref(seg->id()), allocate_segment_seq());
+        get_segment_descriptor(seg->id()).seq = seg->seq_num();
+        get_segment_descriptor(seg->id()).data_seq = seg->seq_num();
+        _open_segments.push_back(*seg);
         _stats.segments_in_use++;
         co_return seg;
     }
@@ -766,6 +832,17 @@ class segment_manager_impl {
         return log_segment_id(index);
     }
 
+    // Age of the data in a segment, in segments written since.
+    uint64_t data_age(const segment_descriptor& desc) const noexcept {
+        return _next_segment_seq.value - std::min(desc.data_seq.value, _next_segment_seq.value);
+    }
+
+    // Data is cold once it outlived the writing of as many segments as are
+    // in use, that is a full pass over the live data.
+    bool is_cold(const segment_descriptor& desc) const noexcept {
+        return data_age(desc) >= std::max<uint64_t>(_stats.segments_in_use, 1);
+    }
+
     struct segment_location {
         size_t file_id;
         size_t file_offset;
@@ -804,7 +881,8 @@ segment_manager_impl::segment_manager_impl(segment_manager_config config)
             .max_segments_per_compaction = config.max_segments_per_compaction,
             .compaction_sg = config.compaction_sg,
             .compaction_static_shares = config.compaction_static_shares,
-            .separator_sg = config.separator_sg
+            .separator_sg = config.separator_sg,
+            .segregate_cold_data = config.compaction_segregate_cold_data,
         })
     , _cfg(config)
     , _segments_per_file(config.file_size / config.segment_size)
@@ -817,7 +895,7 @@ segment_manager_impl::segment_manager_impl(segment_manager_config config)
 
     // pre-allocate write buffers for compaction
     // at most a single compaction/split running at a time
-    // and at most two buffers used at a time by split.
+    // and at most two buffers used at a time by either of them.
     size_t compaction_buffer_count = 2;
     _available_compaction_buffers.reserve(compaction_buffer_count);
     _compaction_buffer_pool.reserve(compaction_buffer_count);
@@ -860,6 +938,10 @@ segment_manager_impl::segment_manager_impl(segment_manager_config config)
                        sm::description("Counts number of data bytes written to the disk.")),
         sm::make_counter("bytes_read", _stats.bytes_read,
                        sm::description("Counts number of bytes read from the disk.")),
+        sm::make_counter("coalesced_reads", _stats.coalesced_reads,
+                       sm::description("Counts number of disk reads issued by batched record reads, such as range scans.")),
+        sm::make_counter("coalesced_records_read", _stats.coalesced_records_read,
+                       sm::description("Counts number of records read by batched record reads, which may share a disk read.")),
         sm::make_counter("bytes_freed", _stats.bytes_freed,
                        sm::description("Counts number of data bytes freed.")),
         sm::make_counter("segments_allocated", _stats.segments_allocated,
@@ -880,6 +962,12 @@ segment_manager_impl::segment_manager_impl(segment_manager_config config)
                        sm::description("Counts number of records skipped during compaction.")),
         sm::make_counter("compaction_records_rewritten", _compaction_mgr.get_stats().compaction_records_rewritten,
                        sm::description("Counts number of records rewritten during compaction.")),
+        sm::make_counter("compaction_deltas_folded", _compaction_mgr.get_stats().compaction_deltas_folded,
+                       sm::description("Counts number of delta records folded into full records during compaction.")),
+        sm::make_counter("compaction_hot_bytes_written", _compaction_mgr.get_stats().compaction_hot_bytes_written,
+                       sm::description("Counts number of record bytes rewritten by compaction to segments of hot data.")),
+        sm::make_counter("compaction_cold_bytes_written", _compaction_mgr.get_stats().compaction_cold_bytes_written,
+                       sm::description("Counts number of record bytes rewritten by compaction to segments of cold data.")),
         sm::make_counter("separator_bytes_written", _stats.bytes_written[static_cast<size_t>(write_source::separator)],
                        sm::description("Counts number of bytes written to the separator.")),
         sm::make_counter("separator_data_bytes_written", _stats.data_bytes_written[static_cast<size_t>(write_source::separator)],
@@ -890,6 +978,10 @@ segment_manager_impl::segment_manager_impl(segment_manager_config config)
                        sm::description("Counts number of segments freed by the separator.")),
         sm::make_gauge("separator_flow_control_delay", [this]() { return calculate_separator_delay().count(); },
                        sm::description("Current delay applied to writes to control separator debt in microseconds.")),
+        sm::make_counter("index_checkpoints", _stats.index_checkpoints,
+                       sm::description("Counts number of index checkpoints written.")),
+        sm::make_gauge("index_checkpoint_entries", _stats.index_checkpoint_entries,
+                       sm::description("Number of index entries in the last index checkpoint.")),
     });
 }
 
@@ -905,6 +997,12 @@ future<> segment_manager_impl::start() {
 
     _compaction_mgr.enable_separator_flush(separator_flush_max_concurrency);
 
+    if (_db) {
+        _index_checkpointer = with_scheduling_group(_cfg.compaction_sg, [this] {
+            return run_index_checkpoints();
+        });
+    }
+
     logstor_logger.info("Segment manager started with base directory {}", _cfg.base_dir.string());
 }
 
@@ -914,6 +1012,9 @@ future<> segment_manager_impl::stop() {
     }
     logstor_logger.info("Stopping segment manager");
 
+    _checkpoint_as.request_abort();
+    co_await std::move(_index_checkpointer);
+
     co_await _async_gate.close();
 
     if (_active_segment) {
@@ -996,7 +1097,7 @@ future<> segment_manager_impl::write(write_buffer& wb) {
     }
 }
 
-future<> segment_manager_impl::write_full_segment(write_buffer& wb, compaction_group& cg, write_source source) {
+future<> segment_manager_impl::write_full_segment(write_buffer& wb, compaction_group& cg, write_source source, std::optional<segment_sequence> data_seq) {
     auto holder = _async_gate.hold();
 
     const auto sealed_size = wb.sealed_size(block_alignment);
@@ -1007,6 +1108,9 @@ future<> segment_manager_impl::write_full_segment(write_buffer& wb, compaction_g
 
     auto seg = co_await get_segment(source);
     auto& desc = get_segment_descriptor(seg->id());
+    if (data_seq) {
+        desc.data_seq = *data_seq;
+    }
 
     logstor_logger.trace("Write full segment {} seq {} from {}", seg->id(), seg->seq_num(), write_source_to_string(source));
 
@@ -1045,6 +1149,57 @@ future<log_record> segment_manager_impl::read(log_location location) {
     co_return std::move(record);
 }
 
+// Records closer than this in a segment are read with a single read, which
+// is cheaper than a read per record for the small gaps between the records
+// of a scan, e.g. of overwritten records.
+static constexpr uint32_t max_coalesced_read_gap = 16 * 1024;
+
+future<std::vector<log_record>> segment_manager_impl::read_many(std::vector<log_location> locations, size_t max_concurrency) {
+    auto holder = _async_gate.hold();
+
+    struct coalesced_read {
+        log_segment_id segment;
+        uint32_t offset;
+        uint32_t end;
+        // Positions of the records in locations.
+        utils::small_vector<size_t, 4> records;
+    };
+
+    auto order = std::views::iota(size_t(0), locations.size()) | std::ranges::to<std::vector<size_t>>();
+    std::ranges::sort(order, [&] (size_t a, size_t b) {
+        return std::tie(locations[a].segment, locations[a].offset) < std::tie(locations[b].segment, locations[b].offset);
+    });
+    std::vector<coalesced_read> reads;
+    for (auto i : order) {
+        const auto& loc = locations[i];
+        if (!reads.empty()) {
+            auto& r = reads.back();
+            if (r.segment == loc.segment && loc.offset <= r.end + max_coalesced_read_gap) {
+                r.end = std::max(r.end, loc.offset + loc.size);
+                r.records.push_back(i);
+                continue;
+            }
+        }
+        reads.push_back(coalesced_read{loc.segment, loc.offset, loc.offset + loc.size, {i}});
+    }
+
+    std::vector<std::optional<log_record>> records(locations.size());
+    co_await max_concurrent_for_each(reads, std::max<size_t>(max_concurrency, 1), [&] (const coalesced_read& r) -> future<> {
+        auto [file_id, file_offset] = segment_id_to_file_location(r.segment);
+        auto file = co_await _file_mgr.get_file_for_read(file_id);
+        segment seg(r.segment, file, file_offset, _cfg.segment_size);
+        auto buf = co_await seg.read_range(r.offset, r.end - r.offset);
+        for (auto i : r.records) {
+            const auto& loc = locations[i];
+            records[i] = deserialize_log_record(simple_memory_input_stream(buf.get() + (loc.offset - r.offset), loc.size));
+        }
+        _stats.bytes_read += r.end - r.offset;
+        _stats.coalesced_reads++;
+        _stats.coalesced_records_read += r.records.size();
+    });
+    co_return records | std::views::transform([] (std::optional<log_record>& r) { return std::move(*r); }) | std::ranges::to<std::vector<log_record>>();
+}
+
 future<> segment_manager_impl::request_segment_switch() {
     if (!_switch_segment_fut) {
         auto f = switch_active_segment();
@@ -1296,43 +1451,87 @@ compaction_reenabler compaction_manager_impl::disable_compaction_no_wait(compact
     });
 }
 
-std::vector<log_segment_id> compaction_manager_impl::select_segments_for_compaction(const segment_descriptor_hist& segments) {
-    size_t accum_net_data_size = 0;
-    size_t accum_record_count = 0;
+std::vector<compaction_candidate> select_compaction_victims(std::vector<compaction_candidate> pool,
+        size_t segment_size, size_t max_segments, bool segregate) {
+    if (segregate) {
+        // Cost-benefit selection, as in LFS: the benefit of compacting a
+        // segment is its free space weighted by the age of its data, and the
+        // cost is reading it and writing its live data. Old data is unlikely
+        // to be overwritten, so its segments won't get emptier by waiting,
+        // while young data may still free its segment by itself.
+        auto cost_benefit = [&] (const compaction_candidate& c) {
+            auto u = double(c.desc->net_data_size(segment_size)) / segment_size;
+            return (1 - u) * (c.data_age + 1) / (1 + u);
+        };
+        std::ranges::stable_sort(pool, std::greater<>(), cost_benefit);
+    }
+
+    // Hot and cold records are written to separate segments.
+    struct accumulated {
+        size_t net_data_size = 0;
+        size_t record_count = 0;
+
+        size_t required_segments(size_t segment_size) const {
+            return record_count ? raw_write_buffer::estimate_required_segments(net_data_size, record_count, segment_size) : 0;
+        }
+    };
+    std::array<accumulated, 2> accum;
     ssize_t max_gain = 0;
     size_t best_count = 0;
-    std::vector<log_segment_id> candidates;
-    const auto segment_size = _sm.get_segment_size();
+    size_t count = 0;
 
-    for (const auto& desc : segments) {
-        if (candidates.size() >= _cfg.max_segments_per_compaction) {
+    for (const auto& c : pool) {
+        if (count >= max_segments) {
             break;
         }
+        ++count;
 
-        auto seg_id = _sm.desc_to_segment_id(desc);
-        candidates.push_back(seg_id);
+        auto& acc = accum[segregate && c.cold];
+        acc.net_data_size += c.desc->net_data_size(segment_size);
+        acc.record_count += c.desc->record_count;
 
-        accum_net_data_size += desc.net_data_size(segment_size);
-        accum_record_count += desc.record_count;
+        auto required_segments = accum[0].required_segments(segment_size) + accum[1].required_segments(segment_size);
 
-        auto required_segments = raw_write_buffer::estimate_required_segments(
-            accum_net_data_size, accum_record_count, segment_size);
+        logstor_logger.trace("Evaluating compaction candidate {} with net data size {} age {} required segments {}",
+                           c.id, c.desc->net_data_size(segment_size), c.data_age, required_segments);
 
-        logstor_logger.trace("Evaluating compaction candidate {} with net data size {} accumulated {} required segments {}",
-                           seg_id, desc.net_data_size(segment_size), accum_net_data_size, required_segments);
-
-        auto gain = ssize_t(candidates.size()) - ssize_t(required_segments);
+        auto gain = ssize_t(count) - ssize_t(required_segments);
         if (gain > max_gain) {
             max_gain = gain;
-            best_count = candidates.size();
+            best_count = count;
         }
     }
 
     logstor_logger.debug("Selected {} segments for compaction for estimated gain of {} segments", best_count, max_gain);
 
-    return candidates
-            | std::views::take(best_count)
-            | std::ranges::to<std::vector<log_segment_id>>();
+    pool.resize(best_count);
+    return pool;
+}
+
+size_t compaction_buffer_index(std::span<const compaction_candidate> victims, log_segment_id seg_id) {
+    auto it = std::ranges::find(victims, seg_id, &compaction_candidate::id);
+    return it != victims.end() && it->cold;
+}
+
+std::vector<compaction_candidate> compaction_manager_impl::select_segments_for_compaction(const segment_descriptor_hist& segments) {
+    const bool segregate = _cfg.segregate_cold_data();
+
+    // The emptiest segments, from which the victims are chosen.
+    std::vector<compaction_candidate> pool;
+    const size_t pool_size = _cfg.max_segments_per_compaction * (segregate ? cost_benefit_pool_factor : 1);
+    for (const auto& desc : segments) {
+        if (pool.size() >= pool_size) {
+            break;
+        }
+        pool.push_back(compaction_candidate{
+            .id = _sm.desc_to_segment_id(desc),
+            .desc = &desc,
+            .data_age = _sm.data_age(desc),
+            .cold = segregate && _sm.is_cold(desc),
+        });
+    }
+
+    return select_compaction_victims(std::move(pool), _sm.get_segment_size(), _cfg.max_segments_per_compaction, segregate);
 }
 
 future<> compaction_manager_impl::do_compact(compaction_group& cg, abort_source& as) {
@@ -1364,6 +1563,10 @@ struct compaction_buffer {
     compaction_group& cg;
     std::vector<future<>> pending_updates;
     size_t flush_count{0};
+    size_t bytes_rewritten{0};
+    // For the data_seq of the segment, averaged over the records in the buffer.
+    uint64_t data_seq_sum{0};
+    uint64_t data_seq_bytes{0};
 
     explicit compaction_buffer(segment_manager_impl& sm, compaction_group& cg)
         : sm(sm), cg(cg)
@@ -1377,7 +1580,8 @@ struct compaction_buffer {
 
     compaction_buffer(compaction_buffer&& o) noexcept
         : sm(o.sm), buf(std::exchange(o.buf, nullptr)), cg(o.cg)
-        , pending_updates(std::move(o.pending_updates)), flush_count(o.flush_count) {}
+        , pending_updates(std::move(o.pending_updates)), flush_count(o.flush_count), bytes_rewritten(o.bytes_rewritten)
+        , data_seq_sum(o.data_seq_sum), data_seq_bytes(o.data_seq_bytes) {}
 
     ~compaction_buffer() {
         if (buf) {
@@ -1391,13 +1595,15 @@ struct compaction_buffer {
     future<> flush() {
         if (buf->has_data()) {
             flush_count++;
-            co_await sm.write_full_segment(*buf, cg, write_source::compaction);
+            co_await sm.write_full_segment(*buf, cg, write_source::compaction, segment_sequence(data_seq_sum / std::max<uint64_t>(data_seq_bytes, 1)));
             logstor_logger.trace("Compaction buffer flushed with {} bytes", buf->net_data_size());
         }
         co_await when_all_succeed(pending_updates.begin(), pending_updates.end());
         co_await buf->close();
         buf->reset();
         pending_updates.clear();
+        data_seq_sum = 0;
+        data_seq_bytes = 0;
     }
 
     future<> close() {
@@ -1418,6 +1624,9 @@ struct compaction_buffer {
             co_await flush();
         }
 
+        data_seq_sum += sm.get_segment_descriptor(read_location).data_seq.value * read_location.size;
+        data_seq_bytes += read_location.size;
+
         auto write_and_update_index = buf->write(std::move(writer)).then_unpack(
                 [this, &index, key = std::move(key), read_location, &records_rewritten, &records_skipped]
                 (log_location new_location, seastar::gate::holder op) {
@@ -1425,6 +1634,7 @@ struct compaction_buffer {
             if (index.update_record_location(key, read_location, new_location)) {
                 sm.free_record(read_location);
                 records_rewritten++;
+                bytes_rewritten += new_location.size;
             } else {
                 // another write updated this key
                 sm.free_record(new_location);
@@ -1434,35 +1644,156 @@ struct compaction_buffer {
 
         pending_updates.push_back(std::move(write_and_update_index));
     }
+
+    // Rewrite the records of a key with delta records, one of which is the
+    // live record at read_location, as a single full record merged from them.
+    // The index is updated only if the chain didn't change in the meantime
+    // (see primary_index::fold()), and fold_failed is set otherwise, since the
+    // records of the chain which are still alive must then be rewritten one
+    // by one. Returns false, without writing anything, if the merged record
+    // can't be written.
+    future<bool> fold_chain(primary_index& index, log_location read_location, const log_record& record,
+                            index_entry base, primary_index::delta_chain deltas,
+                            size_t& deltas_folded, bool& fold_failed) {
+        const auto& key = record.header.key;
+        auto s = cg.schema();
+        const auto fold_ts = primary_index::fold_timestamp(base, deltas);
+        std::vector<future<log_record>> reads;
+        auto read_other = [&] (const index_entry& e) {
+            if (e.location != read_location) {
+                reads.push_back(sm.read(e.location));
+            }
+        };
+        std::vector<log_record> records;
+        {
+            // Keeps the records of the chain from being freed until they are read.
+            auto op = index.start_read();
+            read_other(base);
+            std::ranges::for_each(deltas, read_other);
+            records = co_await when_all_succeed(reads.begin(), reads.end());
+        }
+        // The entry may point to a record of another key in a compact index.
+        if (!std::ranges::all_of(records, [&] (const log_record& r) { return index.verify_key(key, r.header); })) {
+            co_return false;
+        }
+        auto m = record.mut.to_mutation(s);
+        for (auto& r : records) {
+            m.apply(r.mut.to_mutation(s));
+        }
+        log_record_writer writer(log_record{
+            .header = {
+                .key = key,
+                .timestamp = fold_ts,
+                .table = record.header.table,
+            },
+            .mut = canonical_mutation(m),
+        });
+        if (writer.size() > buf->max_record_size()) {
+            co_return false;
+        }
+        if (!buf->can_fit(writer)) {
+            co_await flush();
+        }
+
+        data_seq_sum += sm.get_segment_descriptor(read_location).data_seq.value * read_location.size;
+        data_seq_bytes += read_location.size;
+
+        auto write_and_update_index = buf->write(std::move(writer)).then_unpack(
+                [this, &index, key, base, deltas = std::move(deltas), fold_ts, &deltas_folded, &fold_failed]
+                (log_location new_location, seastar::gate::holder op) {
+            if (index.fold(key, base, deltas, index_entry{.location = new_location, .timestamp = fold_ts})) {
+                sm.free_record(base.location);
+                for (const auto& e : deltas) {
+                    sm.free_record(e.location);
+                }
+                deltas_folded += deltas.size() + base.delta;
+                bytes_rewritten += new_location.size;
+            } else {
+                sm.free_record(new_location);
+                fold_failed = true;
+            }
+        });
+        pending_updates.push_back(std::move(write_and_update_index));
+        co_return true;
+    }
 };
 
-future<> compaction_manager_impl::compact_segments(compaction_group& cg, std::vector<log_segment_id> segments) {
+future<> compaction_manager_impl::compact_segments(compaction_group& cg, std::vector<compaction_candidate> victims) {
+    auto segments = victims
+            | std::views::transform(&compaction_candidate::id)
+            | std::ranges::to<std::vector<log_segment_id>>();
     logstor_logger.trace("Starting compaction of segments {} in compaction group {}:{}", segments, cg.schema()->id(), cg.group_id());
 
-    compaction_buffer cb(_sm, cg);
+    // Records are rewritten to segments of hot or cold data, by the age of
+    // the segment they are in, so that the cold ones aren't rewritten again
+    // every time the hot ones next to them are overwritten.
+    std::array<compaction_buffer, 2> bufs{compaction_buffer{_sm, cg}, compaction_buffer{_sm, cg}};
+    auto& hot = bufs[0];
+    auto& cold = bufs[1];
+    auto cold_segments = std::ranges::count_if(victims, &compaction_candidate::cold);
 
     size_t records_rewritten = 0;
     size_t records_skipped = 0;
+    size_t deltas_folded = 0;
+    bool fold_failed = false;
 
     auto& index = cg.get_logstor_index();
 
-    co_await _sm.for_each_record(segments,
-        [&index, &records_skipped] (log_location read_location, const log_record_header& record_header) -> want_data {
-            if (!index.is_record_alive(record_header.key, read_location)) {
-                records_skipped++;
-                return want_data::no;
+    // Records of keys with delta records are folded into a full record with
+    // the rest of their chain, and the other records of the chain in the
+    // segments are skipped.
+    auto location_key = [] (log_location loc) { return (uint64_t(loc.segment.value) << 32) | loc.offset; };
+    std::unordered_set<uint64_t> folded_locations;
+
+    auto compact_records = [&] (bool fold) {
+        return _sm.for_each_record(segments,
+            [&] (log_location read_location, const log_record_header& record_header) -> want_data {
+                if (!index.is_record_alive(record_header.key, read_location)
+                        || (fold && folded_locations.contains(location_key(read_location)))) {
+                    records_skipped++;
+                    return want_data::no;
+                }
+                return want_data::yes;
+            },
+            [&] (log_location read_location, log_record record) -> future<> {
+                auto& cb = bufs[compaction_buffer_index(victims, read_location.segment)];
+                auto base = index.get(record.header.key);
+                auto deltas = index.get_deltas(record.header.key);
+                if (fold && base && deltas && index.is_record_alive(record.header.key, read_location)) {
+                    auto chain = *deltas;
+                    chain.push_back(*base);
+                    for (const auto& e : chain) {
+                        folded_locations.insert(location_key(e.location));
+                    }
+                    if (co_await cb.fold_chain(index, read_location, record, *base, *deltas, deltas_folded, fold_failed)) {
+                        co_return;
+                    }
+                    for (const auto& e : chain) {
+                        folded_locations.erase(location_key(e.location));
+                    }
+                }
+                co_await cb.rewrite_record(index, read_location, std::move(record), records_rewritten, records_skipped);
             }
-            return want_data::yes;
-        },
-        [&index, &records_rewritten, &records_skipped, &cb] (log_location read_location, log_record record) -> future<> {
-            co_await cb.rewrite_record(index, read_location, std::move(record), records_rewritten, records_skipped);
+        );
+    };
+
+    co_await compact_records(true);
+    if (fold_failed) {
+        // The chain of a key changed while it was folded, so some of the
+        // records skipped for it may still be alive.
+        for (auto& cb : bufs) {
+            co_await cb.flush();
         }
-    );
+        co_await compact_records(false);
+    }
 
-    co_await cb.close();
+    for (auto& cb : bufs) {
+        co_await cb.close();
+    }
+    auto flush_count = hot.flush_count + cold.flush_count;
 
-    logstor_logger.debug("Compaction complete: {} records rewritten, {} skipped from {} segments, flushed {} times",
-                       records_rewritten, records_skipped, segments.size(), cb.flush_count);
+    logstor_logger.debug("Compaction complete: {} records rewritten, {} skipped, {} delta records folded from {} segments ({} cold), flushed {} times",
+                       records_rewritten, records_skipped, deltas_folded, segments.size(), cold_segments, flush_count);
 
     // wait for read operations that use the old locations
     co_await index.await_pending_reads();
@@ -1479,13 +1810,17 @@ future<> compaction_manager_impl::compact_segments(compaction_group& cg, std::ve
         }
     }
 
-    size_t new_segments = segments.size() > cb.flush_count ? segments.size() - cb.flush_count : 0;
+    size_t new_segments = segments.size() > flush_count ? segments.size() - flush_count : 0;
     _stats.segments_compacted += segments.size();
     _stats.compaction_segments_freed += new_segments;
     _stats.compaction_records_rewritten += records_rewritten;
     _stats.compaction_records_skipped += records_skipped;
+    _stats.compaction_deltas_folded += deltas_folded;
+    _stats.compaction_hot_bytes_written += hot.bytes_rewritten;
+    _stats.compaction_cold_bytes_written += cold.bytes_rewritten;
+    cg.get_logstor_gc_stats().compaction_bytes_written += hot.bytes_rewritten + cold.bytes_rewritten;
 
-    _controller.update(cb.flush_count, new_segments);
+    _controller.update(flush_count, new_segments);
 }
 
 void compaction_manager_impl::controller::update(size_t segment_write_count, size_t new_segments) {
@@ -1667,7 +2002,7 @@ future<> compaction_manager_impl::flush_separator_buffer(separator_buffer buf, c
     if (buf.buf->has_data()) {
         auto sem_units = co_await get_units(_separator_flush_sem, 1);
         co_await with_scheduling_group(_cfg.separator_sg, [&] {
-            return _sm.write_full_segment(*buf.buf, cg, write_source::separator);
+            return _sm.write_full_segment(*buf.buf, cg, write_source::separator, buf.min_seq_num);
         });
         _stats.separator_buffer_flushed++;
     }
@@ -1700,6 +2035,7 @@ std::chrono::microseconds segment_manager_impl::calculate_separator_delay() cons
 future<> segment_manager_impl::do_recovery(replica::database& db) {
     logstor_logger.info("Starting recovery for shard {} in directory {}", this_shard_id(), _cfg.base_dir.string());
 
+    _db = &db;
     co_await _file_mgr.start();
 
     // Scan the base directory for all files belonging to this shard.
@@ -1758,17 +2094,33 @@ future<> segment_manager_impl::do_recovery(replica::database& db) {
         return old_entry.location.offset <=> candidate.location.offset;
     };
 
-    for (auto file_id : found_file_ids) {
-        logstor_logger.info("Recovering segments from file {}: {}%", _file_mgr.get_file_path(file_id).string(), (file_id + 1) * 100 / found_file_ids.size());
-        co_await max_concurrent_for_each(segments_in_file(file_id), 32,
-            [this, &db, &cmp_with_seq, &segment_seqs, &max_segment_seq] (log_segment_id seg_id) {
-                return recover_segment(db, seg_id, cmp_with_seq,
-                    [seg_id, &segment_seqs, &max_segment_seq] (const segment_header& seg_hdr) {
-                        segment_seqs[seg_id.value] = seg_hdr.segment_seq;
-                        max_segment_seq = std::max(max_segment_seq, seg_hdr.segment_seq);
-                    });
+    auto recover = [this, &db, &cmp_with_seq, &segment_seqs, &max_segment_seq] (log_segment_id seg_id) {
+        return recover_segment(db, seg_id, cmp_with_seq,
+            [seg_id, &segment_seqs, &max_segment_seq] (const segment_header& seg_hdr) {
+                segment_seqs[seg_id.value] = seg_hdr.segment_seq;
+                max_segment_seq = std::max(max_segment_seq, seg_hdr.segment_seq);
+            });
+    };
+
+    if (auto watermark = co_await recover_index_checkpoint(db, segment_seqs, cmp_with_seq)) {
+        // The checkpoint holds the live records of the segments below the
+        // watermark, replay only the segments written since.
+        std::vector<log_segment_id> replayed_segments;
+        for (size_t seg_idx = 0; seg_idx < allocated_segment_count; ++seg_idx) {
+            if (segment_seqs[seg_idx] >= *watermark) {
+                replayed_segments.push_back(log_segment_id(seg_idx));
             }
-        );
+            max_segment_seq = std::max(max_segment_seq, segment_seqs[seg_idx]);
+        }
+        logstor_logger.info("Recovery: replaying {} of {} segments written after the index checkpoint", replayed_segments.size(), allocated_segment_count);
+        co_await max_concurrent_for_each(replayed_segments, 32, recover);
+        // Don't reuse sequence numbers of discarded segments, the checkpoint may refer to them.
+        max_segment_seq = std::max(max_segment_seq, segment_sequence(watermark->value - 1));
+    } else {
+        for (auto file_id : found_file_ids) {
+            logstor_logger.info("Recovering segments from file {}: {}%", _file_mgr.get_file_path(file_id).string(), (file_id + 1) * 100 / found_file_ids.size());
+            co_await max_concurrent_for_each(segments_in_file(file_id), 32, recover);
+        }
     }
 
     // go over the index and mark all segments that have live data as used.
@@ -1779,10 +2131,20 @@ future<> segment_manager_impl::do_recovery(replica::database& db) {
             co_return;
         }
         logstor_logger.info("Table {}.{} has {} entries in logstor index", tp->schema()->ks_name(), tp->schema()->cf_name(), tp->logstor_index().get_key_count());
-        for (const auto& entry : tp->logstor_index()) {
-            used_segments.set(entry.entry().location.segment.value);
+        std::optional<primary_index::position> pos;
+        do {
+            pos = tp->logstor_index().visit_after(pos, checkpoint_chunk_entries, [&] (const primary_index::entry_view& e) {
+                used_segments.set(e.entry.location.segment.value);
+            });
             co_await coroutine::maybe_yield();
-        }
+        } while (pos);
+        std::optional<dht::decorated_key> delta_pos;
+        do {
+            delta_pos = tp->logstor_index().visit_deltas_after(delta_pos, checkpoint_chunk_entries, [&] (const dht::decorated_key&, const index_entry& e) {
+                used_segments.set(e.location.segment.value);
+            });
+            co_await coroutine::maybe_yield();
+        } while (delta_pos);
     });
 
     // put used segments in compaction groups, and put the rest in the free list.
@@ -1791,6 +2153,8 @@ future<> segment_manager_impl::do_recovery(replica::database& db) {
     for (size_t seg_idx = 0; seg_idx < allocated_segment_count; ++seg_idx) {
         co_await coroutine::maybe_yield();
         log_segment_id seg_id(seg_idx);
+        get_segment_descriptor(seg_id).seq = segment_seqs[seg_idx];
+        get_segment_descriptor(seg_id).data_seq = segment_seqs[seg_idx];
         if (!used_segments.test(seg_idx)) {
             _free_segments.push_back(seg_id);
             free_segment_count++;
@@ -1840,7 +2204,8 @@ future<> segment_manager_impl::recover_segment(replica::database& db, log_segmen
 
             index_entry new_entry {
                 .location = loc,
-                .timestamp = header.timestamp
+                .timestamp = header.timestamp,
+                .delta = header.delta,
             };
 
             try {
@@ -1848,11 +2213,14 @@ future<> segment_manager_impl::recover_segment(replica::database& db, log_segmen
                 if (!t.uses_logstor()) {
                     return want_data::no;
                 }
-                auto [inserted, prev_entry] = t.logstor_index().insert(header.key, new_entry, cmp);
-                if (inserted) {
+                auto res = t.logstor_index().insert(header.key, new_entry, cmp);
+                if (res.inserted) {
                     desc.on_write(loc);
-                    if (prev_entry) {
-                        get_segment_descriptor(prev_entry->location).on_free(prev_entry->location);
+                    if (res.prev_entry) {
+                        get_segment_descriptor(res.prev_entry->location).on_free(res.prev_entry->location);
+                    }
+                    for (const auto& e : res.dropped_deltas) {
+                        get_segment_descriptor(e.location).on_free(e.location);
                     }
                 }
             } catch (const replica::no_such_column_family&) {
@@ -1867,6 +2235,217 @@ future<> segment_manager_impl::recover_segment(replica::database& db, log_segmen
         });
 }
 
+future<std::optional<segment_sequence>> segment_manager_impl::recover_index_checkpoint(replica::database& db,
+        std::vector<segment_sequence>& segment_seqs, const primary_index::entry_cmp_fn& cmp) {
+    auto path = index_checkpoint_path();
+    if (!co_await file_exists(path.native())) {
+        co_return std::nullopt;
+    }
+
+    for (size_t seg_idx = 0; seg_idx < segment_seqs.size(); ++seg_idx) {
+        get_segment_descriptor(log_segment_id(seg_idx)).reset(_cfg.segment_size);
+    }
+
+    std::optional<index_checkpoint_reader> reader;
+    std::exception_ptr ex;
+    try {
+        reader.emplace(co_await index_checkpoint_reader::open(path, _cfg.segment_size));
+        logstor_logger.info("Recovery: loading index checkpoint {} with watermark {}", path.native(), reader->watermark());
+
+        // Only the first block of each segment is read, to find the segments
+        // written since the checkpoint, and the ones the checkpoint refers to
+        // which were discarded or reused since.
+        co_await max_concurrent_for_each(std::views::iota(size_t(0), segment_seqs.size()), 32, [this, &segment_seqs] (size_t seg_idx) -> future<> {
+            auto header = co_await read_segment_header(log_segment_id(seg_idx));
+            segment_seqs[seg_idx] = header ? header->segment_seq : segment_sequence(0);
+        });
+
+        size_t loaded = 0;
+        size_t skipped = 0;
+        while (auto chunk = co_await reader->read_chunk()) {
+            primary_index* index = nullptr;
+            try {
+                auto& t = db.find_column_family(chunk->table);
+                if (t.uses_logstor()) {
+                    index = &t.logstor_index();
+                }
+            } catch (const replica::no_such_column_family&) {
+                // ignore entries of dropped tables
+            }
+            if (!index) {
+                skipped += chunk->entries.size() + chunk->compact_entries.size() + chunk->delta_entries.size();
+                continue;
+            }
+            if (!chunk->compact_entries.empty() && !index->is_compact()) {
+                throw std::runtime_error(fmt::format("Index checkpoint has compact entries for table {}, whose index is not compact", chunk->table));
+            }
+            auto load = [&] (const index_entry& entry, segment_sequence segment_seq, auto&& key) {
+                auto seg_idx = entry.location.segment.value;
+                if (seg_idx >= segment_seqs.size() || segment_seqs[seg_idx] != segment_seq || segment_seq >= reader->watermark()) {
+                    skipped++;
+                    return;
+                }
+                auto res = index->insert(key, entry, cmp);
+                if (res.inserted) {
+                    get_segment_descriptor(entry.location).on_write(entry.location);
+                    if (res.prev_entry) {
+                        get_segment_descriptor(res.prev_entry->location).on_free(res.prev_entry->location);
+                    }
+                    for (const auto& e : res.dropped_deltas) {
+                        get_segment_descriptor(e.location).on_free(e.location);
+                    }
+                }
+                loaded++;
+            };
+            for (auto& e : chunk->entries) {
+                load(e.entry, e.segment_seq, e.key);
+                co_await coroutine::maybe_yield();
+            }
+            for (auto& e : chunk->compact_entries) {
+                load(e.entry, e.segment_seq, compact_index_key{e.token, e.fingerprint});
+                co_await coroutine::maybe_yield();
+            }
+            for (auto& e : chunk->delta_entries) {
+                load(e.entry, e.segment_seq, e.key);
+                co_await coroutine::maybe_yield();
+            }
+        }
+        logstor_logger.info("Recovery: loaded {} index entries from checkpoint, skipped {}", loaded, skipped);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (reader) {
+        co_await reader->close();
+    }
+
+    if (ex) {
+        logstor_logger.warn("Failed to load index checkpoint {}, recovering from all segments: {}", path.native(), ex);
+        co_await db.get_tables_metadata().for_each_table_gently([] (table_id, lw_shared_ptr<table> tp) -> future<> {
+            if (tp->uses_logstor()) {
+                tp->logstor_index().clear();
+            }
+            return make_ready_future<>();
+        });
+        std::ranges::fill(segment_seqs, segment_sequence(0));
+        // Sequence numbers are derived from the segments after a full recovery,
+        // and may be reused by segments the checkpoint doesn't know about.
+        co_await remove_file(path.native());
+        co_return std::nullopt;
+    }
+    co_return reader->watermark();
+}
+
+future<> segment_manager_impl::run_index_checkpoints() {
+    while (!_checkpoint_as.abort_requested()) {
+        // An interval of 0 disables checkpoints, but it is live-updateable, so keep polling.
+        auto interval = std::chrono::seconds(_cfg.index_checkpoint_interval_in_s());
+        try {
+            co_await sleep_abortable(interval.count() ? interval : std::chrono::seconds(60), _checkpoint_as);
+        } catch (const sleep_aborted&) {
+            break;
+        }
+        if (!_cfg.index_checkpoint_interval_in_s()) {
+            continue;
+        }
+        try {
+            co_await write_index_checkpoint();
+        } catch (const abort_requested_exception&) {
+            break;
+        } catch (...) {
+            logstor_logger.warn("Failed to write index checkpoint: {}", std::current_exception());
+        }
+    }
+}
+
+future<> segment_manager_impl::write_index_checkpoint() {
+    auto holder = _async_gate.hold();
+
+    auto watermark = checkpoint_watermark();
+    if (watermark == _checkpointed_seq) {
+        // No segment was closed since the last checkpoint, so recovery would
+        // replay the same segments with either of them.
+        co_return;
+    }
+
+    auto w = co_await index_checkpoint_writer::create(index_checkpoint_path(), _cfg.segment_size, watermark);
+    std::exception_ptr ex;
+    try {
+        co_await _db->get_tables_metadata().for_each_table_gently([this, &w, watermark] (table_id tid, lw_shared_ptr<table> tp) -> future<> {
+            if (tp->uses_logstor()) {
+                co_await checkpoint_table_index(w, tid, tp->logstor_index(), watermark);
+            }
+        });
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        co_await w.abort();
+        co_await coroutine::return_exception_ptr(std::move(ex));
+    }
+    co_await w.commit();
+
+    _checkpointed_seq = watermark;
+    _stats.index_checkpoints++;
+    _stats.index_checkpoint_entries = w.entry_count();
+    logstor_logger.debug("Wrote index checkpoint with {} entries and watermark {}", w.entry_count(), watermark);
+}
+
+future<> segment_manager_impl::checkpoint_table_index(index_checkpoint_writer& w, table_id tid, const primary_index& index, segment_sequence watermark) {
+    // The index may change while a chunk is written, so continue from the
+    // position of the last entry rather than from an iterator.
+    std::optional<primary_index::position> pos;
+    do {
+        _checkpoint_as.check();
+
+        index_checkpoint_chunk chunk{.table = tid};
+        pos = index.visit_after(pos, checkpoint_chunk_entries, [&] (const primary_index::entry_view& v) {
+            auto seq = get_segment_descriptor(v.entry.location).seq;
+            // Records in open segments are replayed by recovery.
+            if (seq >= watermark) {
+                return;
+            }
+            if (v.key) {
+                chunk.entries.push_back(index_checkpoint_entry{
+                    .key = primary_index_key{*v.key},
+                    .entry = v.entry,
+                    .segment_seq = seq,
+                });
+            } else {
+                chunk.compact_entries.push_back(compact_index_checkpoint_entry{
+                    .token = v.compact_key.token,
+                    .fingerprint = v.compact_key.fingerprint,
+                    .entry = v.entry,
+                    .segment_seq = seq,
+                });
+            }
+        });
+        if (!chunk.entries.empty() || !chunk.compact_entries.empty()) {
+            co_await w.write(chunk);
+        }
+    } while (pos);
+
+    std::optional<dht::decorated_key> delta_pos;
+    do {
+        _checkpoint_as.check();
+
+        index_checkpoint_chunk chunk{.table = tid};
+        delta_pos = index.visit_deltas_after(delta_pos, checkpoint_chunk_entries, [&] (const dht::decorated_key& key, const index_entry& e) {
+            auto seq = get_segment_descriptor(e.location).seq;
+            if (seq >= watermark) {
+                return;
+            }
+            chunk.delta_entries.push_back(index_checkpoint_entry{
+                .key = primary_index_key{key},
+                .entry = e,
+                .segment_seq = seq,
+            });
+        });
+        if (!chunk.delta_entries.empty()) {
+            co_await w.write(chunk);
+        }
+    } while (delta_pos);
+}
+
 future<> segment_manager_impl::add_segment_to_compaction_group(replica::database& db, segment_descriptor& desc) {
     auto seg_id = desc_to_segment_id(desc);
     auto maybe_header = co_await read_segment_header(seg_id);
@@ -1981,6 +2560,10 @@ future<log_record> segment_manager::read(log_location location) {
     return _impl->read(location);
 }
 
+future<std::vector<log_record>> segment_manager::read_many(std::vector<log_location> locations, size_t max_concurrency) {
+    return _impl->read_many(std::move(locations), max_concurrency);
+}
+
 void segment_manager::free_record(log_location location) {
     _impl->free_record(location);
 }
@@ -52,6 +52,10 @@ struct segment_manager_config {
     seastar::scheduling_group separator_sg;
     uint32_t separator_delay_limit_ms;
     size_t max_separator_memory = 1 * 1024 * 1024;
+    // Interval between index checkpoints, 0 disables them.
+    utils::updateable_value<uint32_t> index_checkpoint_interval_in_s;
+    // Whether compaction writes cold records to separate segments.
+    utils::updateable_value<bool> compaction_segregate_cold_data{true};
 };
 
 struct table_segment_histogram_bucket {
@@ -121,6 +125,11 @@ class segment_manager {
 
     future<log_record> read(log_location location);
 
+    // Reads the records at the given locations, returned in the same order.
+    // Records close to each other in a segment share a single read, and at
+    // most max_concurrency reads are in flight at a time.
+    future<std::vector<log_record>> read_many(std::vector<log_location> locations, size_t max_concurrency);
+
     void free_record(log_location location);
 
     compaction_manager& get_compaction_manager() noexcept;
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 #include <fmt/format.h>
 #include "dht/decorated_key.hh"
 #include "mutation/canonical_mutation.hh"
@@ -37,6 +38,8 @@ struct primary_index_key {
 struct index_entry {
     log_location location;
     api::timestamp_type timestamp;
+    // The record is a delta record.
+    bool delta = false;
 
     bool operator==(const index_entry& other) const noexcept = default;
 };
@@ -45,6 +48,9 @@ struct log_record_header {
     primary_index_key key;
     api::timestamp_type timestamp;
     table_id table;
+    // A delta record holds only the cells written by a partial update of the
+    // partition, which are applied on top of its full record on read.
+    bool delta = false;
 };
 
 struct log_record {
@@ -74,6 +80,31 @@ struct segment_sequence {
     }
 };
 
+// An index entry saved in an index checkpoint, with the sequence number of
+// the segment it points to, so that recovery can tell if the segment was
+// reused since the checkpoint was written.
+struct index_checkpoint_entry {
+    primary_index_key key;
+    index_entry entry;
+    segment_sequence segment_seq;
+};
+
+// An index_checkpoint_entry of a compact index, which doesn't keep the key.
+struct compact_index_checkpoint_entry {
+    int64_t token;
+    uint32_t fingerprint;
+    index_entry entry;
+    segment_sequence segment_seq;
+};
+
+struct index_checkpoint_chunk {
+    table_id table;
+    std::vector<index_checkpoint_entry> entries;
+    std::vector<compact_index_checkpoint_entry> compact_entries;
+    // Delta records chained to the entries, with their key in both modes.
+    std::vector<index_checkpoint_entry> delta_entries;
+};
+
 enum class segment_kind : uint8_t {
     mixed = 0,
     full = 1,
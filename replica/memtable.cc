@@ -770,6 +770,9 @@ memtable::update(db::rp_handle&& h) {
     if (_replay_position < rp) {
         _replay_position = rp;
     }
+    if (rp.valid() && (!_lowest_replay_position.valid() || rp < _lowest_replay_position)) {
+        _lowest_replay_position = rp;
+    }
     _rp_set.put(std::move(h));
 }
 
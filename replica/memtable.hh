@@ -123,6 +123,8 @@ class memtable final
     partitions_type partitions;
     size_t nr_partitions = 0;
     db::replay_position _replay_position;
+    // Oldest replay position of the writes held by this memtable.
+    db::replay_position _lowest_replay_position;
     db::rp_set _rp_set;
     // mutation source to which reads fall-back after mark_flushed()
     // so that memtable contents can be moved away while there are
@@ -343,6 +345,12 @@ class memtable final
     const db::replay_position& replay_position() const noexcept {
         return _replay_position;
     }
+    const db::replay_position& lowest_replay_position() const noexcept {
+        return _lowest_replay_position;
+    }
+    const db::rp_set& rp_set() const noexcept {
+        return _rp_set;
+    }
     /**
      * Returns the current rp_set, and resets the
      * stored one to empty. Only used for flushing
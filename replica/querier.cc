@@ -429,6 +429,13 @@ std::optional<shard_mutation_querier> querier_cache::lookup_shard_mutation_queri
             std::move(trace_state), timeout);
 }
 
+future<> querier_base::fill_buffer() {
+    if (auto* reader = std::get_if<mutation_reader>(&_reader); reader && !reader->is_buffer_full()) {
+        return reader->fill_buffer();
+    }
+    return make_ready_future<>();
+}
+
 future<> querier_base::close() noexcept {
     struct variant_closer {
         querier_base& q;
@@ -120,6 +120,11 @@ class querier_base {
         return _permit.consumed_resources().memory;
     }
 
+    // Reads ahead into the reader's buffer, so that the I/O for the start
+    // of the range overlaps with whatever the caller is doing meanwhile.
+    // Must not be called while consume_page() is running.
+    future<> fill_buffer();
+
     future<> close() noexcept;
 };
 
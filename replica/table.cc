@@ -384,7 +384,9 @@ future<std::vector<locked_cell>> table::lock_counter_cells(const mutation& m, db
 
 void table::for_each_active_memtable(noncopyable_function<void(memtable&)> action) {
     for_each_compaction_group([&] (compaction_group& cg) {
-        action(cg.memtables()->active_memtable());
+        for (auto& mt : cg.memtables()->active_memtables()) {
+            action(*mt);
+        }
     });
 }
 
@@ -1913,19 +1915,32 @@ class database_sstable_write_monitor : public permit_monitor, public compaction:
     }
 };
 
+future<>
+table::seal_active_memtable(compaction_group& cg, flush_permit&& flush_permit, std::vector<shared_memtable> memtables) noexcept {
+    auto permit = std::move(flush_permit);
+    if (memtables.size() < cg.memtables()->sub_ranges()) {
+        _config.cf_stats->sub_range_memtables_flushes++;
+    }
+    // Empty sub-ranges have nothing to flush.
+    if (std::ranges::any_of(memtables, [] (const shared_memtable& mt) { return !mt->empty(); })) {
+        std::erase_if(memtables, [] (const shared_memtable& mt) { return mt->empty(); });
+    }
+    for (auto& old : memtables) {
+        co_await seal_memtable(cg, std::move(old), permit);
+    }
+}
+
 // The function never fails.
 // It either succeeds eventually after retrying or aborts.
 future<>
-table::seal_active_memtable(compaction_group& cg, flush_permit&& flush_permit) noexcept {
-    auto old = cg.memtables()->back();
+table::seal_memtable(compaction_group& cg, shared_memtable old, flush_permit& permit) noexcept {
     tlogger.debug("Sealing active memtable of {}.{}, partitions: {}, occupancy: {}", _schema->ks_name(), _schema->cf_name(), old->partition_count(), old->occupancy());
 
-    if (old->empty()) {
-        tlogger.debug("Memtable is empty");
+    if (old->empty() || !cg.memtables()->is_active(old)) {
+        tlogger.debug("Memtable is empty or already sealed");
         co_return co_await _flush_barrier.advance_and_await();
     }
 
-    auto permit = std::move(flush_permit);
     auto r = exponential_backoff_retry(100ms, 10s);
     // Try flushing for around half an hour (30 minutes every 10 seconds)
     int default_retries = 30 * 60 / 10;
@@ -1981,14 +1996,19 @@ table::seal_active_memtable(compaction_group& cg, flush_permit&& flush_permit) n
         }
     };
 
+    bool sealed_concurrently = false;
     co_await with_retry([&] {
         tlogger.debug("seal_active_memtable: adding memtable");
         utils::get_local_injector().inject("table_seal_active_memtable_add_memtable", []() {
             throw std::bad_alloc();
         });
 
-        cg.memtables()->add_memtable();
-        _highest_flushed_rp = std::max(_highest_flushed_rp, old->replay_position());
+        if (!cg.memtables()->replace_active_memtable(old)) {
+            // Another flush sealed it while we were retrying.
+            sealed_concurrently = true;
+            return make_ready_future<>();
+        }
+        _highest_flushed_rp = std::max(_highest_flushed_rp, flushed_replay_position_bound(*old));
 
         // no exceptions allowed (nor expected) from this point on
         _stats.memtable_switch_count++;
@@ -2002,6 +2022,9 @@ table::seal_active_memtable(compaction_group& cg, flush_permit&& flush_permit) n
         }();
         return make_ready_future<>();
     });
+    if (sealed_concurrently) {
+        co_return co_await _flush_barrier.advance_and_await();
+    }
 
     co_await with_retry([&] {
         previous_flush = _flush_barrier.advance_and_await();
@@ -2043,6 +2066,7 @@ table::seal_active_memtable(compaction_group& cg, flush_permit&& flush_permit) n
     });
 
     undo_stats.reset();
+    _config.cf_stats->flushed_memtables_bytes += memtable_size;
 
     if (_commitlog) {
         _commitlog->discard_completed_segments(_schema->id(), old->get_and_discard_rp_set());
@@ -2205,6 +2229,8 @@ void table::set_metrics() {
                 ms::make_counter("memtable_rows_compacted_with_tombstones", _stats.memtable_app_stats.rows_compacted_with_tombstones, ms::description("Number of rows scanned during write of a tombstone for the purpose of compaction in memtables"))(cf)(ks).set_skip_when_empty(),
                 ms::make_counter("memtable_range_tombstone_reads", _stats.memtable_range_tombstone_reads, ms::description("Number of range tombstones read from memtables"))(cf)(ks).set_skip_when_empty(),
                 ms::make_counter("memtable_row_tombstone_reads", _stats.memtable_row_tombstone_reads, ms::description("Number of row tombstones read from memtables"))(cf)(ks),
+                ms::make_counter("query_prefetched_ranges", _stats.query_prefetched_ranges, ms::description("Number of ranges of multi-partition queries read ahead"))(cf)(ks).set_skip_when_empty(),
+                ms::make_counter("query_prefetched_ranges_dropped", _stats.query_prefetched_ranges_dropped, ms::description("Number of ranges read ahead and dropped unread because the page ended"))(cf)(ks).set_skip_when_empty(),
                 ms::make_gauge("pending_tasks", ms::description("Estimated number of tasks pending for this column family"), _stats.pending_flushes)(cf)(ks),
                 ms::make_gauge("live_disk_space", ms::description("Live disk space used"), _stats.live_disk_space_used.on_disk)(cf)(ks),
                 ms::make_gauge("total_disk_space", ms::description("Total disk space used"), _stats.total_disk_space_used.on_disk)(cf)(ks),
@@ -2241,6 +2267,15 @@ void table::set_metrics() {
             });
         }
 
+        if (_schema->logstor_enabled()) {
+            _metrics.add_group("column_family", {
+                ms::make_counter("logstor_bytes_written", ms::description("Record bytes written to logstor by writes"), _logstor_gc_stats.bytes_written)(cf)(ks),
+                ms::make_counter("logstor_compaction_bytes_written", ms::description("Record bytes rewritten by logstor compaction"), _logstor_gc_stats.compaction_bytes_written)(cf)(ks),
+                ms::make_gauge("logstor_compaction_write_amplification", ms::description("Ratio of the record bytes written by writes and compaction to the ones written by writes"),
+                        [this] { return _logstor_gc_stats.write_amplification(); })(cf)(ks)
+            });
+        }
+
         if (!is_internal_keyspace(_schema->ks_name())) {
             _metrics.add_group("column_family", {
                     ms::make_summary("read_latency_summary", ms::description("Read latency summary"), [this] {return to_metrics_summary(_stats.reads.summary());})(cf)(ks).set_skip_when_empty(),
@@ -3025,13 +3060,16 @@ table::make_memory_only_memtable_list() {
 
 lw_shared_ptr<memtable_list>
 table::make_memtable_list(compaction_group& cg) {
-    auto seal = [this, &cg] (flush_permit&& permit) -> future<> {
+    auto seal = [this, &cg] (flush_permit&& permit, std::vector<shared_memtable> memtables) -> future<> {
         gate::holder holder = cg.flush_gate().hold();
-        co_await seal_active_memtable(cg, std::move(permit));
+        co_await seal_active_memtable(cg, std::move(permit), std::move(memtables));
     };
     auto get_schema = [this] { return schema(); };
+    // With tablets every compaction group already covers a single tablet, so
+    // memtables are split into token sub-ranges only for vnode tables.
+    auto sub_ranges_log2 = uses_tablets() ? 0 : _config.memtable_sub_ranges_log2;
     return make_lw_shared<memtable_list>(std::move(seal), std::move(get_schema), _config.dirty_memory_manager, _memtable_shared_data, _stats, _config.memory_compaction_scheduling_group,
-        &get_compaction_manager().get_shared_tombstone_gc_state());
+        &get_compaction_manager().get_shared_tombstone_gc_state(), sub_ranges_log2);
 }
 
 class compaction_group::compaction_group_view : public compaction::compaction_group_view {
@@ -3927,6 +3965,24 @@ db::replay_position table::highest_flushed_replay_position() const {
     return _highest_flushed_rp;
 }
 
+db::replay_position table::flushed_replay_position_bound(const memtable& sealed) {
+    // Sealing one token sub-range (or one compaction group) leaves writes
+    // older than sealed's replay position in the other memtables. Callers
+    // use highest_flushed_replay_position() to drop commitlog entries for
+    // whole token ranges, so it must stay below the oldest write that is
+    // not flushed yet.
+    auto rp = sealed.replay_position();
+    for_each_compaction_group([&] (compaction_group& cg) {
+        for (auto& mt : *cg.memtables()) {
+            auto low = mt->lowest_replay_position();
+            if (mt.get() != &sealed && low.valid() && low <= rp) {
+                rp = db::replay_position(low.id, low.pos - 1);
+            }
+        }
+    });
+    return rp;
+}
+
 struct snapshot_tablet_info {
     size_t id;
     dht::token first_token, last_token;
@@ -4621,6 +4677,12 @@ bool compaction_group::needs_flush() const {
     return _memtables->needs_flush();
 }
 
+bool compaction_group::has_commitlog_data_before(const db::replay_position& rp) const {
+    return std::ranges::any_of(*_memtables, [&rp] (const shared_memtable& mt) {
+        return mt->rp_set().has_positions_before(rp);
+    });
+}
+
 lw_shared_ptr<memtable_list>& compaction_group::memtables() noexcept {
     return _memtables;
 }
@@ -4650,6 +4712,18 @@ future<> table::flush(std::optional<db::replay_position> pos) {
         co_return;
     }
     auto op = _pending_flushes_phaser.start();
+    if (pos) {
+        // Requested by the commitlog to release the segments before pos.
+        // Only the compaction groups holding data in those segments are
+        // flushed, so that a tablet which keeps old segments in use doesn't
+        // cause a flush of the memtables of all the tablets of the table.
+        auto rp = *pos;
+        co_await parallel_foreach_compaction_group([rp] (compaction_group& cg) {
+            return cg.has_commitlog_data_before(rp) ? cg.flush() : make_ready_future<>();
+        });
+        _flush_rp = std::max(_flush_rp, rp);
+        co_return;
+    }
     auto fp = _highest_rp;
     co_await parallel_foreach_compaction_group(std::mem_fn(&compaction_group::flush));
     _flush_rp = std::max(_flush_rp, fp);
@@ -4801,6 +4875,7 @@ future<> table::discard_logstor_segments() {
     }
 
     _logstor_index->clear();
+    co_await _logstor->get_record_cache().invalidate(*_schema, dht::partition_range::make_open_ended_both_sides());
 
     co_await parallel_foreach_compaction_group([] (compaction_group& cg) {
         return cg.discard_logstor_segments();
@@ -4819,7 +4894,7 @@ void table::mark_ready_for_writes(db::commitlog* cl) {
 
 void table::init_logstor(logstor::logstor* ls) {
     _logstor = ls;
-    _logstor_index = std::make_unique<logstor::primary_index>(_schema);
+    _logstor_index = std::make_unique<logstor::primary_index>(_schema, ls->compact_index());
 }
 
 size_t table::get_logstor_memory_usage() const {
@@ -5077,6 +5152,14 @@ db::replay_position table::set_low_replay_position_mark() {
     return _lowest_allowed_rp;
 }
 
+static memtable& active_memtable_for(memtable_list& mtl, const mutation& m, auto&&...) {
+    return mtl.active_memtable(m.token());
+}
+
+static memtable& active_memtable_for(memtable_list& mtl, const frozen_mutation& m, const schema_ptr& m_schema, auto&&...) {
+    return mtl.active_memtable(*m_schema, m.key());
+}
+
 template<typename... Args>
 void table::do_apply(compaction_group& cg, db::rp_handle&& h, Args&&... args) {
     utils::latency_counter lc;
@@ -5084,7 +5167,7 @@ void table::do_apply(compaction_group& cg, db::rp_handle&& h, Args&&... args) {
     db::replay_position rp = h;
     check_valid_rp(rp);
     try {
-        cg.memtables()->active_memtable().apply(std::forward<Args>(args)..., std::move(h));
+        active_memtable_for(*cg.memtables(), args...).apply(std::forward<Args>(args)..., std::move(h));
         _highest_rp = std::max(_highest_rp, rp);
     } catch (...) {
         _failed_counter_applies_to_memtable++;
@@ -5217,24 +5300,79 @@ table::query(schema_ptr query_schema,
         }
     });
 
+    auto make_querier = [&] (const dht::partition_range& range) {
+        querier_base::querier_config conf(_config.tombstone_warn_threshold);
+        return querier(as_mutation_source(), query_schema, permit, range, qs.cmd.slice, trace_state, get_tombstone_gc_state(), conf);
+    };
+
+    // With multiple ranges (e.g. an IN query on the partition key), the reads
+    // of the next few ranges are started while the current one is consumed,
+    // so that their index and data reads are in flight concurrently instead
+    // of being waited for one range after the other. Results are still
+    // consumed range by range, in order. Read-ahead is bounded by the number
+    // of ranges and by the memory the read's buffers use. It also stays
+    // within the row and partition limits of the page: every range read
+    // ahead is expected to yield a row, so ranges the page cannot reach are
+    // not read only to be dropped when it ends.
+    struct prefetched_querier {
+        querier q;
+        future<> fill;
+    };
+    std::deque<prefetched_querier> prefetched;
+    const size_t prefetch_window = partition_ranges.size() > 1 ? _config.query_prefetch_partitions() : 0;
+    const uint64_t prefetch_memory_limit = permit.max_result_size().soft_limit;
+    auto prefetch_next = qs.current_partition_range;
+
+    std::exception_ptr ex;
+  try {
     while (!qs.done()) {
         auto&& range = *qs.current_partition_range++;
+        prefetch_next = std::max(prefetch_next, qs.current_partition_range);
 
+        if (!querier_opt && !prefetched.empty()) {
+            auto p = std::move(prefetched.front());
+            prefetched.pop_front();
+            querier_opt = std::move(p.q);
+            co_await std::move(p.fill);
+        }
         if (!querier_opt) {
-            querier_base::querier_config conf(_config.tombstone_warn_threshold);
-            querier_opt = querier(as_mutation_source(), query_schema, permit, range, qs.cmd.slice, trace_state, get_tombstone_gc_state(), conf);
+            querier_opt = make_querier(range);
+        }
+        auto page_window = std::min<uint64_t>(qs.remaining_rows(), qs.remaining_partitions()) - 1;
+        while (prefetched.size() < std::min<uint64_t>(prefetch_window, page_window) && prefetch_next != qs.range_end
+                && permit.consumed_resources().memory < prefetch_memory_limit) {
+            auto pq = make_querier(*prefetch_next++);
+            auto fill = pq.fill_buffer();
+            prefetched.push_back(prefetched_querier{std::move(pq), std::move(fill)});
+            ++_stats.query_prefetched_ranges;
         }
         auto& q = *querier_opt;
 
-        future<> fut = co_await coroutine::as_future(q.consume_page(query_result_builder(*query_schema, qs.builder), qs.remaining_rows(), qs.remaining_partitions(), qs.cmd.timestamp, trace_state));
+        co_await q.consume_page(query_result_builder(*query_schema, qs.builder), qs.remaining_rows(), qs.remaining_partitions(), qs.cmd.timestamp, trace_state);
 
-        if (fut.failed() || !qs.done()) {
+        if (!qs.done()) {
             co_await q.close();
             querier_opt = {};
         }
-        if (fut.failed()) {
-            co_return coroutine::exception(fut.get_exception());
+    }
+  } catch (...) {
+    ex = std::current_exception();
+  }
+
+    // Ranges read ahead but not reached, because the page is full or the
+    // read failed, are dropped; the next page will read them again.
+    _stats.query_prefetched_ranges_dropped += prefetched.size();
+    for (auto& p : prefetched) {
+        auto fill = co_await coroutine::as_future(std::move(p.fill));
+        fill.ignore_ready_future();
+        co_await p.q.close();
+    }
+    if (ex) {
+        if (querier_opt) {
+            co_await querier_opt->close();
+            querier_opt = {};
         }
+        co_return coroutine::exception(std::move(ex));
     }
 
     std::optional<full_position> last_pos;
@@ -5614,6 +5752,10 @@ logstor::primary_index& compaction_group::get_logstor_index() noexcept {
     return _t.logstor_index();
 }
 
+logstor::table_gc_stats& compaction_group::get_logstor_gc_stats() noexcept {
+    return _t.logstor_gc_stats();
+}
+
 compaction::compaction_group_view& compaction_group::as_view_for_static_sharding() const {
     return view_for_unrepaired_data();
 }
@@ -5769,6 +5911,7 @@ future<> compaction_group::cleanup() {
 
     if (_t.uses_logstor()) {
         co_await _t.logstor_index().erase(p_range);
+        co_await _t._logstor->get_record_cache().invalidate(*_t.schema(), p_range);
         co_await discard_logstor_segments();
     }
 
@@ -12,8 +12,8 @@
 #include "exceptions/exceptions.hh"
 #include "utils/rjson.hh"
 
-caching_options::caching_options(sstring k, sstring r, bool enabled)
-        : _key_cache(k), _row_cache(r), _enabled(enabled) {
+caching_options::caching_options(sstring k, sstring r, bool enabled, bool frequency_admission)
+        : _key_cache(k), _row_cache(r), _enabled(enabled), _frequency_admission(frequency_admission) {
     if ((k != "ALL") && (k != "NONE")) {
         throw exceptions::configuration_exception("Invalid key value: " + k); 
     }
@@ -40,6 +40,9 @@ caching_options::to_map() const {
     if (!_enabled) {
         res.insert({"enabled", "false"});
     }
+    if (_frequency_admission) {
+        res.insert({"admission", "FREQUENCY"});
+    }
     return res;
 }
 
@@ -58,6 +61,7 @@ caching_options::from_map(const std::map<sstring, sstring>& map) {
     sstring k = default_key;
     sstring r = default_row;
     bool e = true;
+    bool f = false;
 
     for (auto& p : map) {
         if (p.first == "keys") {
@@ -66,11 +70,17 @@ caching_options::from_map(const std::map<sstring, sstring>& map) {
             r = p.second;
         } else if (p.first == "enabled") {
             e = p.second == "true";
+        } else if (p.first == "admission") {
+            if (p.second == "FREQUENCY") {
+                f = true;
+            } else if (p.second != "ALL") {
+                throw exceptions::configuration_exception(format("Invalid admission value: {}", p.second));
+            }
         } else {
             throw exceptions::configuration_exception(format("Invalid caching option: {}", p.first));
         }
     }
-    return caching_options(k, r, e);
+    return caching_options(k, r, e, f);
 }
 
 caching_options
@@ -25,7 +25,10 @@ class caching_options {
     sstring _key_cache;
     sstring _row_cache;
     bool _enabled = true;
-    caching_options(sstring k, sstring r, bool enabled);
+    // When set, partitions missing in cache are populated by reads only if
+    // they were accessed frequently enough recently (see cache_tracker::admit()).
+    bool _frequency_admission = false;
+    caching_options(sstring k, sstring r, bool enabled, bool frequency_admission = false);
 
     friend class schema;
     caching_options();
@@ -37,6 +40,10 @@ class caching_options {
         return _enabled;
     }
 
+    bool frequency_admission() const {
+        return _frequency_admission;
+    }
+
     std::map<sstring, sstring> to_map() const;
 
     sstring to_sstring() const;
@@ -598,6 +598,7 @@ bool operator==(const schema::user_properties& lhs, const schema::user_propertie
         && lhs.compaction_strategy_options == rhs.compaction_strategy_options
         && lhs.compaction_enabled == rhs.compaction_enabled
         && lhs.storage_engine == rhs.storage_engine
+        && lhs.sstable_filter_format == rhs.sstable_filter_format
         && lhs.caching_options == rhs.caching_options
         && lhs.tablet_options == rhs.tablet_options
         && lhs.get_paxos_grace_seconds() == rhs.get_paxos_grace_seconds()
@@ -713,6 +714,11 @@ table_schema_version schema::calculate_digest(const schema::raw_schema& r) {
 
     feed_hash(h, r._props.tablet_options);
     feed_hash(h, r._large_data_guardrails_enabled);
+    // Hashed only when set, so that the version of tables which don't use it
+    // is the same as on nodes which don't know it.
+    if (!r._props.sstable_filter_format.empty()) {
+        feed_hash(h, r._props.sstable_filter_format);
+    }
 
     return table_schema_version(utils::UUID_gen::get_name_UUID(h.finalize()));
 }
@@ -898,6 +904,9 @@ auto fmt::formatter<schema>::format(const schema& s, fmt::format_context& ctx) c
     if (s.storage_engine() != storage_engine_type::normal) {
         out = fmt::format_to(out, ",storage_engine={}", storage_engine_type_to_sstring(s.storage_engine()));
     }
+    if (!s.sstable_filter_format().empty()) {
+        out = fmt::format_to(out, ",sstable_filter_format={}", s.sstable_filter_format());
+    }
     out = fmt::format_to(out, ",tablets={{");
     if (s._raw._props.tablet_options) {
         n = 0;
@@ -1245,6 +1254,9 @@ fragmented_ostringstream& schema::schema_properties(const schema_describe_helper
     if (storage_engine() != storage_engine_type::normal) {
         os << "\n    AND storage_engine = '" << storage_engine_type_to_sstring(storage_engine()) << "'";
     }
+    if (!sstable_filter_format().empty()) {
+        os << "\n    AND sstable_filter_format = '" << sstable_filter_format() << "'";
+    }
 
     if (has_tablet_options()) {
         os << "\n    AND tablets = {";
@@ -577,6 +577,9 @@ class schema final : public enable_lw_shared_from_this<schema> {
         std::map<sstring, sstring> compaction_strategy_options;
         bool compaction_enabled = true;
         storage_engine_type storage_engine = storage_engine_type::normal;
+        // Format of the sstable partition key filter, see utils::filter_format_from_string().
+        // Empty means the node's sstable_filter_format configuration.
+        sstring sstable_filter_format;
         ::caching_options caching_options;
         std::optional<std::map<sstring, sstring>> tablet_options;
 
@@ -801,6 +804,10 @@ class schema final : public enable_lw_shared_from_this<schema> {
         return _raw._props.storage_engine == storage_engine_type::logstor;
     }
 
+    const sstring& sstable_filter_format() const {
+        return _raw._props.sstable_filter_format;
+    }
+
     const cdc::options& cdc_options() const {
         return _raw._props.get_cdc_options();
     }
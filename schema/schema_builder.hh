@@ -279,6 +279,11 @@ struct schema_builder {
         return *this;
     }
 
+    schema_builder& set_sstable_filter_format(sstring format) {
+        _raw._props.sstable_filter_format = std::move(format);
+        return *this;
+    }
+
     class default_names {
     public:
         default_names(const schema_builder&);
@@ -8,12 +8,18 @@
 
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <variant>
 
 #include <seastar/core/align.hh>
 #include <seastar/core/bitops.hh>
 #include <seastar/core/byteorder.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/coroutine/exception.hh>
 #include <seastar/core/fstream.hh>
 #include <seastar/core/on_internal_error.hh>
+#include <seastar/core/smp.hh>
 
 #include "compress.hh"
 #include "compressor.hh"
@@ -23,6 +29,7 @@
 #include "utils/assert.hh"
 #include "utils/class_registrator.hh"
 #include "reader_permit.hh"
+#include "reader_concurrency_semaphore.hh"
 #include "data_source_types.hh"
 
 namespace sstables {
@@ -233,7 +240,7 @@ void compression::set_compressor(compressor_ptr c) {
             }
         }
     }
-    _compressor = std::move(c);
+    _compressor = make_lw_shared<compressor_ptr>(std::move(c));
 }
 
 void compression::discard_hidden_options() {
@@ -251,8 +258,13 @@ void compression::discard_hidden_options() {
 }
 
 compressor& compression::get_compressor() const {
-    SCYLLA_ASSERT(_compressor);
-    return *_compressor.get();
+    SCYLLA_ASSERT(_compressor && *_compressor);
+    return **_compressor;
+}
+
+lw_shared_ptr<const compressor_ptr> compression::hold_compressor() const {
+    SCYLLA_ASSERT(_compressor && *_compressor);
+    return _compressor;
 }
 
 void compression::update(uint64_t compressed_file_length) {
@@ -302,6 +314,42 @@ enum class compressed_checksum_mode {
     checksum_all,
 };
 
+namespace {
+
+// A buffer compressed chunks are uncompressed into.
+//
+// Each chunk read from a compressed sstable is uncompressed into a buffer of
+// the chunk length, which the consumer frees as soon as it is done parsing it.
+// Recycling these buffers through the reader concurrency semaphore spares the
+// allocator a large allocation and free per chunk in scans and compaction.
+// The semaphore accounts the buffers it keeps, and frees them when it needs
+// the memory for reads.
+class chunk_buffer {
+    reader_concurrency_semaphore& _semaphore;
+    std::unique_ptr<char[]> _data;
+    size_t _size;
+public:
+    chunk_buffer(reader_concurrency_semaphore& semaphore, size_t size)
+            : _semaphore(semaphore)
+            , _data(_semaphore.take_cached_buffer(size))
+            , _size(size) {
+        if (!_data) {
+            _data.reset(new char[size]);
+        }
+    }
+    chunk_buffer(chunk_buffer&& o) noexcept : _semaphore(o._semaphore), _data(std::move(o._data)), _size(o._size) { }
+    chunk_buffer& operator=(chunk_buffer&&) = delete;
+    ~chunk_buffer() {
+        if (_data) {
+            _semaphore.cache_buffer(std::move(_data), _size);
+        }
+    }
+    char* get() const noexcept { return _data.get(); }
+    size_t size() const noexcept { return _size; }
+};
+
+}
+
 template <ChecksumUtils ChecksumType, bool check_digest, compressed_checksum_mode mode>
 class compressed_file_data_source_impl : public data_source_impl {
     std::function<future<input_stream<char>>()> _stream_creator;
@@ -314,6 +362,33 @@ class compressed_file_data_source_impl : public data_source_impl {
     uint64_t _pos;
     uint64_t _beg_pos;
     uint64_t _end_pos;
+    // Holds a compressed chunk which straddles two buffers of the input
+    // stream, reused for all such chunks of this reader.
+    temporary_buffer<char> _straddling_chunk;
+
+    // Reads the next compressed chunk. Usually it is a view into a buffer of
+    // the input stream, and only a chunk split between two of its buffers is
+    // copied. A shorter buffer is returned at end of stream.
+    future<temporary_buffer<char>> read_chunk(size_t len) {
+        auto buf = co_await _input_stream->read_up_to(len);
+        if (buf.size() == len || buf.empty()) {
+            co_return buf;
+        }
+        if (_straddling_chunk.size() < len) {
+            _straddling_chunk = temporary_buffer<char>();
+            _straddling_chunk = make_new_tracked_temporary_buffer(len, _permit);
+        }
+        size_t pos = 0;
+        while (!buf.empty()) {
+            std::memcpy(_straddling_chunk.get_write() + pos, buf.get(), buf.size());
+            pos += buf.size();
+            if (pos == len) {
+                break;
+            }
+            buf = co_await _input_stream->read_up_to(len - pos);
+        }
+        co_return _straddling_chunk.share(0, pos);
+    }
 public:
     compressed_file_data_source_impl(sstables::stream_creator_fn stream_creator, sstables::compression* cm,
                 uint64_t pos, size_t len, file_input_stream_options options,
@@ -375,7 +450,7 @@ class compressed_file_data_source_impl : public data_source_impl {
         if (!addr.chunk_len) {
             sstables::throw_malformed_sstable_exception(format("compressed chunk_len must be greater than zero, chunk_start={}", addr.chunk_start));
         }
-        auto buf = co_await _input_stream->read_exactly(addr.chunk_len);
+        auto buf = co_await read_chunk(addr.chunk_len);
         if (buf.size() != addr.chunk_len) {
             sstables::throw_malformed_sstable_exception(format("compressed reader hit premature end-of-file at file offset {}, expected chunk_len={}, actual={}", _underlying_pos, addr.chunk_len, buf.size()));
         }
@@ -404,16 +479,19 @@ class compressed_file_data_source_impl : public data_source_impl {
 
         // We know that the uncompressed data will take exactly
         // chunk_length bytes (or less, if reading the last chunk).
-        temporary_buffer<char> out(
-                _compression_metadata->uncompressed_chunk_length());
+        auto out = chunk_buffer(_permit.semaphore(), _compression_metadata->uncompressed_chunk_length());
         // The compressed data is the whole chunk, minus the last 4
         // bytes (which contain the checksum verified above).
 
-        auto len = _compression_metadata->get_compressor().uncompress(buf.get(), compressed_len, out.get_write(), out.size());
+        auto len = _compression_metadata->get_compressor().uncompress(buf.get(), compressed_len, out.get(), out.size());
+        buf = {};
+        if (addr.offset > len) {
+            sstables::throw_malformed_sstable_exception(format("compressed chunk at file offset {} uncompressed to {} bytes, expected at least {}", _underlying_pos, len, addr.offset));
+        }
 
-        out.trim(len);
-        out.trim_front(addr.offset);
-        _pos += out.size();
+        auto data = out.get() + addr.offset;
+        auto size = len - addr.offset;
+        _pos += size;
         _underlying_pos += addr.chunk_len;
 
         if constexpr (check_digest) {
@@ -423,7 +501,8 @@ class compressed_file_data_source_impl : public data_source_impl {
                 sstables::throw_malformed_sstable_exception(seastar::format("Digest mismatch: expected={}, actual={}", _digests.expected_digest, _digests.actual_digest));
             }
         }
-        co_return make_tracked_temporary_buffer(std::move(out), std::move(res_units));
+        // The buffer goes back to the semaphore before the permit's memory is released.
+        co_return temporary_buffer<char>(data, size, make_object_deleter(std::make_pair(std::move(res_units), std::move(out))));
     }
 
     virtual future<> close() override {
@@ -607,16 +686,53 @@ class compressed_file_data_sink_impl : public data_sink_impl {
     sstables::compression::segmented_offsets::writer _offsets;
     size_t _pos = 0;
     uint32_t _full_checksum;
+    // Set until the compressor is chosen; see compressor_from_sample.
+    std::optional<sstables::compressor_from_sample> _from_sample;
+    std::vector<temporary_buffer<char>> _sample;
+    size_t _sample_bytes = 0;
+
+    // A compressed chunk, followed by space for its checksum.
+    struct compressed_chunk {
+        temporary_buffer<char> buf;
+        size_t uncompressed_len;
+        size_t len;
+        uint32_t checksum;
+    };
+    sstables::compression_offload* _offload;
+    // Chunks being compressed, in file order, when compression is offloaded.
+    std::deque<future<compressed_chunk>> _in_flight;
 public:
-    compressed_file_data_sink_impl(output_stream<char> out, sstables::compression* cm)
+    compressed_file_data_sink_impl(output_stream<char> out, sstables::compression* cm,
+                std::optional<sstables::compressor_from_sample> from_sample = std::nullopt,
+                sstables::compression_offload* offload = nullptr)
             : _out(std::move(out))
             , _compression_metadata(cm)
             , _offsets(_compression_metadata->offsets.get_writer())
             , _full_checksum(ChecksumType::init_checksum())
+            , _from_sample(std::move(from_sample))
+            , _offload(offload)
     {}
 
 private:
-    future<> do_put(temporary_buffer<char> buf) {
+    future<> add_to_sample(temporary_buffer<char> buf) {
+        _sample_bytes += buf.size();
+        _sample.push_back(std::move(buf));
+        if (_sample_bytes < _from_sample->sample_size) {
+            return make_ready_future<>();
+        }
+        return compress_sample();
+    }
+
+    future<> compress_sample() {
+        auto from_sample = std::move(*_from_sample);
+        _from_sample.reset();
+        _compression_metadata->set_compressor(co_await from_sample.make(_sample));
+        for (auto& buf : std::exchange(_sample, {})) {
+            co_await put_chunk(std::move(buf));
+        }
+    }
+
+    compressed_chunk compress(const temporary_buffer<char>& buf) {
         auto output_len = _compression_metadata->get_compressor().compress_max_size(buf.size());
 
         // account space for checksum that goes after compressed data.
@@ -625,19 +741,55 @@ class compressed_file_data_sink_impl : public data_sink_impl {
         // compress flushed data.
         auto len = _compression_metadata->get_compressor().compress(buf.get(), buf.size(), compressed.get_write(), output_len);
         if (len > output_len) {
-            return make_exception_future(std::runtime_error("possible overflow during compression"));
+            throw std::runtime_error("possible overflow during compression");
         }
+        // compute 32-bit checksum for compressed data.
+        uint32_t per_chunk_checksum = ChecksumType::checksum(compressed.get(), len);
+        return compressed_chunk{std::move(compressed), buf.size(), len, per_chunk_checksum};
+    }
+
+    // Compresses the chunk on another shard, in its current scheduling group,
+    // into a buffer allocated here. The coroutine frame keeps both buffers
+    // and the compressor alive until the remote shard is done with them, so
+    // that a chunk abandoned with the sink doesn't leave the remote shard
+    // with dangling pointers; the offload outlives it, and nothing else of
+    // the sink is used after the remote shard is done. Compressors keep
+    // their compression contexts per shard, so the remote shard uses its
+    // own; it only reads the compressor's parameters and dictionary.
+    future<compressed_chunk> compress_on(shard_id shard, temporary_buffer<char> buf) {
+        auto holder = _compression_metadata->hold_compressor();
+        const compressor* compressor = holder->get();
+        auto output_len = compressor->compress_max_size(buf.size());
+        temporary_buffer<char> compressed(output_len + 4);
+
+        size_t len = 0;
+        uint32_t checksum = 0;
+        noncopyable_function<void ()> compress = [&] {
+            len = compressor->compress(buf.get(), buf.size(), compressed.get_write(), output_len);
+            if (len > output_len) {
+                throw std::runtime_error("possible overflow during compression");
+            }
+            checksum = ChecksumType::checksum(compressed.get(), len);
+        };
+        if (!co_await _offload->compress_on(shard, compress)) {
+            compress();
+        }
+        co_return compressed_chunk{std::move(compressed), buf.size(), len, checksum};
+    }
+
+    future<> write(compressed_chunk chunk) {
+        auto& compressed = chunk.buf;
+        auto len = chunk.len;
+        auto per_chunk_checksum = chunk.checksum;
 
         // total length of the uncompressed data.
-        _compression_metadata->set_uncompressed_file_length(_compression_metadata->uncompressed_file_length() + buf.size());
+        _compression_metadata->set_uncompressed_file_length(_compression_metadata->uncompressed_file_length() + chunk.uncompressed_len);
 
         _offsets.push_back(_pos);
         // account compressed data + 32-bit checksum.
         _pos += len + 4;
         _compression_metadata->set_compressed_file_length(_pos);
 
-        // compute 32-bit checksum for compressed data.
-        uint32_t per_chunk_checksum = ChecksumType::checksum(compressed.get(), len);
         _full_checksum = checksum_combine_or_feed<ChecksumType>(_full_checksum, per_chunk_checksum, compressed.get(), len);
 
         // write checksum into buffer after compressed data.
@@ -656,15 +808,90 @@ class compressed_file_data_sink_impl : public data_sink_impl {
         auto f = _out.write(compressed.get(), compressed.size());
         return f.then([compressed = std::move(compressed)] {});
     }
+
+    future<> write_oldest_in_flight() {
+        auto f = std::move(_in_flight.front());
+        _in_flight.pop_front();
+        co_await write(co_await std::move(f));
+    }
+
+    // Waits for the chunks in flight without writing them, after a failure.
+    // Remote shards may still be writing into their buffers.
+    future<> discard_in_flight() noexcept {
+        while (!_in_flight.empty()) {
+            auto f = std::move(_in_flight.front());
+            _in_flight.pop_front();
+            co_await std::move(f).discard_result().handle_exception([] (std::exception_ptr) {});
+        }
+    }
+
+    future<> put_chunk(temporary_buffer<char> buf) {
+        if (!_offload) {
+            return futurize_invoke([&] { return write(compress(buf)); });
+        }
+        return put_offloaded_chunk(std::move(buf));
+    }
+
+    future<> put_offloaded_chunk(temporary_buffer<char> buf) {
+        if (auto shard = _offload->pick_shard()) {
+            _in_flight.push_back(compress_on(*shard, std::move(buf)));
+        } else {
+            _in_flight.push_back(futurize_invoke([&] { return compress(buf); }));
+        }
+        std::exception_ptr ex;
+        try {
+            while (!_in_flight.empty() && (_in_flight.size() > _offload->max_chunks_in_flight() || _in_flight.front().available())) {
+                co_await write_oldest_in_flight();
+            }
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        if (ex) {
+            // The sink may be destroyed without being closed after a failed put().
+            co_await discard_in_flight();
+            co_await coroutine::return_exception_ptr(std::move(ex));
+        }
+    }
 public:
+    ~compressed_file_data_sink_impl() {
+        // Only reached with chunks in flight if the sink wasn't closed. Their
+        // coroutines keep what the remote shards use alive, and the offload
+        // waits for them before it goes away, so just make sure their
+        // failures aren't reported as ignored.
+        for (auto& f : _in_flight) {
+            (void)std::move(f).discard_result().handle_exception([] (std::exception_ptr) {});
+        }
+    }
+
     virtual future<> put(std::span<temporary_buffer<char>> bufs) override {
         return data_sink_impl::fallback_put(bufs, [this] (temporary_buffer<char>&& buf) {
-            return do_put(std::move(buf));
+            return _from_sample ? add_to_sample(std::move(buf)) : put_chunk(std::move(buf));
         });
     }
 
     virtual future<> close() override {
-        return _out.close();
+        std::exception_ptr ex;
+        if (_from_sample) {
+            try {
+                co_await compress_sample();
+            } catch (...) {
+                ex = std::current_exception();
+            }
+        }
+        // Remote shards may still be writing into the buffers of chunks in
+        // flight, so wait for all of them even after a failure.
+        while (!ex && !_in_flight.empty()) {
+            try {
+                co_await write_oldest_in_flight();
+            } catch (...) {
+                ex = std::current_exception();
+            }
+        }
+        co_await discard_in_flight();
+        co_await _out.close();
+        if (ex) {
+            co_await coroutine::return_exception_ptr(std::move(ex));
+        }
     }
 
     virtual size_t buffer_size() const noexcept override {
@@ -676,9 +903,11 @@ template <typename ChecksumType, compressed_checksum_mode mode>
 requires ChecksumUtils<ChecksumType>
 class compressed_file_data_sink : public data_sink {
 public:
-    compressed_file_data_sink(output_stream<char> out, sstables::compression* cm)
+    compressed_file_data_sink(output_stream<char> out, sstables::compression* cm,
+            std::optional<sstables::compressor_from_sample> from_sample = std::nullopt,
+            sstables::compression_offload* offload = nullptr)
         : data_sink(std::make_unique<compressed_file_data_sink_impl<ChecksumType, mode>>(
-                std::move(out), cm)) {}
+                std::move(out), cm, std::move(from_sample), offload)) {}
 };
 
 template <typename ChecksumType, compressed_checksum_mode mode>
@@ -686,8 +915,14 @@ requires ChecksumUtils<ChecksumType>
 inline output_stream<char> make_compressed_file_output_stream(output_stream<char> out,
          sstables::compression* cm,
          const compression_parameters& cp,
-         compressor_ptr p) {
-    cm->set_compressor(std::move(p));
+         std::variant<compressor_ptr, sstables::compressor_from_sample> p,
+         sstables::compression_offload* offload) {
+    std::optional<sstables::compressor_from_sample> from_sample;
+    if (auto* c = std::get_if<compressor_ptr>(&p)) {
+        cm->set_compressor(std::move(*c));
+    } else {
+        from_sample = std::move(std::get<sstables::compressor_from_sample>(p));
+    }
     // buffer of output stream is set to chunk length, because flush must
     // happen every time a chunk was filled up.
     cm->set_uncompressed_chunk_length(cp.chunk_length());
@@ -696,7 +931,7 @@ inline output_stream<char> make_compressed_file_output_stream(output_stream<char
     // defaults to 1.0.
     cm->options.elements.push_back({{"crc_check_chance"}, {"1.0"}});
 
-    return output_stream<char>(compressed_file_data_sink<ChecksumType, mode>(std::move(out), cm));
+    return output_stream<char>(compressed_file_data_sink<ChecksumType, mode>(std::move(out), cm, std::move(from_sample), offload));
 }
 
 input_stream<char> sstables::make_compressed_file_k_l_format_input_stream(stream_creator_fn stream_creator,
@@ -719,9 +954,19 @@ input_stream<char> sstables::make_compressed_file_m_format_input_stream(stream_c
 output_stream<char> sstables::make_compressed_file_m_format_output_stream(output_stream<char> out,
         sstables::compression* cm,
         const compression_parameters& cp,
-        compressor_ptr p) {
+        compressor_ptr p,
+        compression_offload* offload) {
+    return make_compressed_file_output_stream<crc32_utils, compressed_checksum_mode::checksum_all>(
+            std::move(out), cm, cp, std::move(p), offload);
+}
+
+output_stream<char> sstables::make_compressed_file_m_format_output_stream(output_stream<char> out,
+        sstables::compression* cm,
+        const compression_parameters& cp,
+        compressor_from_sample from_sample,
+        compression_offload* offload) {
     return make_compressed_file_output_stream<crc32_utils, compressed_checksum_mode::checksum_all>(
-            std::move(out), cm, cp, std::move(p));
+            std::move(out), cm, cp, std::move(from_sample), offload);
 }
 
 input_stream<char> sstables::make_compressed_raw_file_input_stream(sstables::stream_creator_fn stream_creator, sstables::compression *cm,
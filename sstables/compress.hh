@@ -38,11 +38,14 @@
 #include <cstdint>
 #include <iterator>
 #include <deque>
+#include <chrono>
+#include <optional>
 
 #include <seastar/core/file.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/fstream.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include "types/types.hh"
 #include "sstables/types.hh"
@@ -300,11 +303,17 @@ struct compression {
     // accessed via uncompressed_chunk_length()/set_uncompressed_chunk_length().
     uint32_t chunk_len = 0;
     uint32_t _full_checksum = 0;
-    compressor_ptr _compressor;
+    // Shared so that chunks compressed asynchronously keep their compressor
+    // alive until they are done, see hold_compressor().
+    lw_shared_ptr<compressor_ptr> _compressor;
 public:
     // Set the compressor algorithm, please check the definition of enum compressor.
     void set_compressor(compressor_ptr c);
     compressor& get_compressor() const;
+    // Keeps the current compressor alive, even if it is replaced by
+    // set_compressor(), until the returned pointer is destroyed. The pointer
+    // must be copied and destroyed on this shard only.
+    lw_shared_ptr<const compressor_ptr> hold_compressor() const;
     void discard_hidden_options();
     // After changing _compression, update() must be called to update
     // additional variables depending on it.    
@@ -385,10 +394,47 @@ input_stream<char> make_compressed_file_m_format_input_stream(stream_creator_fn
 input_stream<char> make_compressed_raw_file_input_stream(sstables::stream_creator_fn stream_creator, sstables::compression *cm,
         file_input_stream_options options, reader_permit permit, std::optional<uint32_t> digest);
 
+// Lets a compressed output stream compress chunks on other shards, when the
+// writer's own shard is the bottleneck (see compaction::cpu_offload).
+// Only compressing and checksumming a chunk runs remotely; chunks are still
+// written, and accounted in the compression metadata, in order on the
+// writer's shard. The offload must outlive the chunks sent to other shards,
+// even those of streams destroyed without being closed.
+class compression_offload {
+public:
+    virtual ~compression_offload() = default;
+    // Returns the shard to compress the next chunk on, or std::nullopt to
+    // compress it locally. A returned shard must be passed to compress_on().
+    virtual std::optional<shard_id> pick_shard() = 0;
+    // Runs `compress` on `shard`, which must not yield, unless the shard
+    // declines it, in which case it resolves to false and the chunk is
+    // compressed locally.
+    virtual future<bool> compress_on(shard_id shard, const noncopyable_function<void ()>& compress) = 0;
+    // How many chunks a stream may have in flight before it waits for the
+    // oldest one to be written.
+    virtual size_t max_chunks_in_flight() const noexcept = 0;
+};
+
+output_stream<char> make_compressed_file_m_format_output_stream(output_stream<char> out,
+                sstables::compression* cm,
+                const compression_parameters& cp,
+                compressor_ptr,
+                compression_offload* offload = nullptr);
+
+// Picks the compressor of a compressed output stream by looking at the data
+// written to it: the stream holds back the first sample_size bytes of
+// uncompressed chunks (or all of them, if it is closed earlier), and passes
+// them to make(), which returns the compressor for the whole stream.
+struct compressor_from_sample {
+    size_t sample_size;
+    noncopyable_function<future<compressor_ptr>(std::span<const temporary_buffer<char>> sample)> make;
+};
+
 output_stream<char> make_compressed_file_m_format_output_stream(output_stream<char> out,
                 sstables::compression* cm,
                 const compression_parameters& cp,
-                compressor_ptr);
+                compressor_from_sample,
+                compression_offload* offload = nullptr);
 
 
 std::map<sstring, sstring> options_from_compression(const compression& c);
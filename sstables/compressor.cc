@@ -17,6 +17,8 @@
 #include <seastar/core/weak_ptr.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/with_timeout.hh>
+#include <seastar/core/coroutine.hh>
 #include "utils/reusable_buffer.hh"
 #include "sstables/compress.hh"
 #include "sstables/exceptions.hh"
@@ -415,6 +417,7 @@ const sstring compression_parameters::SSTABLE_COMPRESSION = "sstable_compression
 const sstring compression_parameters::CHUNK_LENGTH_KB = "chunk_length_in_kb";
 const sstring compression_parameters::CHUNK_LENGTH_KB_ERR = "chunk_length_kb";
 const sstring compression_parameters::CRC_CHECK_CHANCE = "crc_check_chance";
+const sstring compression_parameters::PER_SSTABLE_DICT = "per_sstable_dict";
 
 compression_parameters::compression_parameters()
     : compression_parameters(algorithm::lz4)
@@ -532,6 +535,16 @@ compression_parameters::compression_parameters(const std::map<sstring, sstring>&
     default:
     }
 
+    if (auto v = get_option(PER_SSTABLE_DICT)) {
+        if (*v == "true") {
+            _per_sstable_dict = true;
+        } else if (*v == "false") {
+            _per_sstable_dict = false;
+        } else {
+            throw exceptions::configuration_exception(format("Invalid boolean value {} for {}", *v, PER_SSTABLE_DICT));
+        }
+    }
+
     for (const auto& o : options) {
         if (!used_options.contains(o.first)) {
             throw exceptions::configuration_exception(format("Unknown compression option '{}'.", o.first));
@@ -568,6 +581,10 @@ void compression_parameters::validate(dicts_feature_enabled dicts_enabled) const
     if (_crc_check_chance && (_crc_check_chance.value() < 0.0 || _crc_check_chance.value() > 1.0)) {
         throw exceptions::configuration_exception(sstring(CRC_CHECK_CHANCE) + " must be between 0.0 and 1.0.");
     }
+    if (per_sstable_dict() && !uses_dictionary_compressor()) {
+        throw exceptions::configuration_exception(fmt::format("{} can only be used with a dictionary compressor, not {}",
+                PER_SSTABLE_DICT, algorithm_to_name(_algorithm)));
+    }
     if (_zstd_compression_level) {
         if (*_zstd_compression_level != std::clamp<int>(*_zstd_compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel())) {
             throw exceptions::configuration_exception(fmt::format("{} must be between {} and {}, got {}", ZSTD_minCLevel(), ZSTD_maxCLevel(), COMPRESSION_LEVEL, *_zstd_compression_level));
@@ -589,6 +606,9 @@ std::map<sstring, sstring> compression_parameters::get_options() const {
     if (_crc_check_chance) {
         opts.emplace(sstring(CRC_CHECK_CHANCE), std::to_string(_crc_check_chance.value()));
     }
+    if (_per_sstable_dict) {
+        opts.emplace(sstring(PER_SSTABLE_DICT), *_per_sstable_dict ? "true" : "false");
+    }
     return opts;
 }
 
@@ -702,6 +722,21 @@ compressor_ptr make_lz4_sstable_compressor_for_tests() {
     return std::make_unique<lz4_processor>();
 }
 
+compressor_ptr make_compressor_without_dicts(const compression_parameters& params) {
+    switch (compression_parameters::non_dict_equivalent(params.get_algorithm())) {
+    case compressor::algorithm::lz4:
+        return std::make_unique<lz4_processor>();
+    case compressor::algorithm::zstd:
+        return std::make_unique<zstd_processor>(params, nullptr, nullptr);
+    case compressor::algorithm::snappy:
+        return std::make_unique<snappy_processor>();
+    case compressor::algorithm::deflate:
+        return std::make_unique<deflate_processor>();
+    default:
+        return nullptr;
+    }
+}
+
 size_t deflate_processor::uncompress(const char* input,
                 size_t input_len, char* output, size_t output_len) const {
     z_stream zs;
@@ -991,6 +1026,7 @@ class dictionary_holder : public weakly_referencable<dictionary_holder> {
 
 default_sstable_compressor_factory::default_sstable_compressor_factory(config cfg)
     : _cfg(std::move(cfg))
+    , _dict_training_memory(_cfg.dict_training_memory)
     , _holder(std::make_unique<dictionary_holder>(_cfg))
 {
     for (shard_id i = 0; i < this_smp_shard_count(); ++i) {
@@ -1003,6 +1039,10 @@ default_sstable_compressor_factory::default_sstable_compressor_factory(config cf
 default_sstable_compressor_factory::~default_sstable_compressor_factory() {
 }
 
+future<> default_sstable_compressor_factory::stop() {
+    return _dict_training_gate.close();
+}
+
 std::vector<unsigned> default_sstable_compressor_factory_config::get_default_shard_to_numa_node_mapping() {
     auto sp = local_engine->smp().shard_to_numa_node_mapping();
     return std::vector<unsigned>(sp.begin(), sp.end());
@@ -1106,6 +1146,58 @@ future<compressor_ptr> default_sstable_compressor_factory::make_compressor_for_w
     return make_compressor_for_writing_impl(params, id);
 }
 
+future<compressor_ptr> default_sstable_compressor_factory::make_compressor_for_writing_with_dict(schema_ptr s, std::span<const std::byte> dict) {
+    using algorithm = compression_parameters::algorithm;
+    const auto& params = s->get_compressor_params();
+    const auto algo = params.get_algorithm();
+    if (dict.empty() || !params.uses_dictionary_compressor()) {
+        co_return co_await make_compressor_for_writing_impl(params, s->id());
+    }
+    compressor_factory_logger.debug("make_compressor_for_writing_with_dict: table={} algo={}", s->id(), algo);
+    auto dict_owner = get_dict_owner(local_numa_id(), get_sha256(dict));
+    if (algo == algorithm::lz4_with_dicts) {
+        auto cdict = co_await container().invoke_on(dict_owner, [dict] (self& local) {
+            return local._holder->get_lz4_dict_for_writing(local._holder->get_canonical_ptr(dict));
+        });
+        co_return std::make_unique<lz4_processor>(std::move(cdict), nullptr);
+    }
+    auto level = params.zstd_compression_level().value_or(ZSTD_defaultCLevel());
+    auto cdict = co_await container().invoke_on(dict_owner, [dict, level] (self& local) {
+        return local._holder->get_zstd_dict_for_writing(local._holder->get_canonical_ptr(dict), level);
+    });
+    co_return std::make_unique<zstd_processor>(params, std::move(cdict), nullptr);
+}
+
+future<std::vector<std::byte>> default_sstable_compressor_factory::train_dict(std::span<const temporary_buffer<char>> sample, size_t max_size) {
+    if (!_train_dict) {
+        co_return std::vector<std::byte>();
+    }
+    size_t sample_bytes = 0;
+    for (const auto& buf : sample) {
+        sample_bytes += buf.size();
+    }
+    // Don't queue up behind other trainings, the writer is better off
+    // with the table's dict than holding its chunks for long.
+    auto units = try_get_units(_dict_training_memory, sample_bytes);
+    if (!units) {
+        compressor_factory_logger.debug("train_dict: skipping, {} bytes of samples already queued for training",
+                _cfg.dict_training_memory - size_t(_dict_training_memory.available_units()));
+        co_return std::vector<std::byte>();
+    }
+    std::vector<std::vector<std::byte>> pages;
+    pages.reserve(sample.size());
+    for (const auto& buf : sample) {
+        auto page = std::as_bytes(std::span(buf.get(), buf.size()));
+        pages.emplace_back(page.begin(), page.end());
+    }
+    auto training = _train_dict(std::move(pages), max_size).finally([units = std::move(*units), holder = _dict_training_gate.hold()] {});
+    co_return co_await with_timeout(lowres_clock::now() + _cfg.dict_training_timeout, std::move(training));
+}
+
+void default_sstable_compressor_factory::set_train_dict_callback(train_dict_fn fn) {
+    _train_dict = std::move(fn);
+}
+
 future<compressor_ptr> default_sstable_compressor_factory::make_compressor_for_reading_impl(const compression_parameters& params, std::span<const std::byte> dict) {
     using algorithm = compression_parameters::algorithm;
     const auto algo = params.get_algorithm();
@@ -1275,12 +1367,18 @@ std::unique_ptr<sstable_compressor_factory> make_sstable_compressor_factory_for_
         future<compressor_ptr> make_compressor_for_writing(schema_ptr s) override {
             return _impl.local().make_compressor_for_writing(s);
         }
+        future<compressor_ptr> make_compressor_for_writing_with_dict(schema_ptr s, std::span<const std::byte> d) override {
+            return _impl.local().make_compressor_for_writing_with_dict(s, d);
+        }
         future<compressor_ptr> make_compressor_for_reading(sstables::compression& c) override {
             return _impl.local().make_compressor_for_reading(c);
         }
         future<> set_recommended_dict(table_id t, std::span<const std::byte> d) override {
             return _impl.local().set_recommended_dict(t, d);
         };
+        future<std::vector<std::byte>> train_dict(std::span<const temporary_buffer<char>> sample, size_t max_size) override {
+            return _impl.local().train_dict(sample, max_size);
+        }
         wrapper(wrapper&&) = delete;
         wrapper() {
             _impl.start().get();
@@ -41,6 +41,9 @@ class compressor {
     /**
      * Packs data in "input" to output. If output_len is of insufficient size,
      * exception is thrown. Maximum required size is obtained via "compress_max_size"
+     *
+     * Compression contexts are kept per shard, so compress() may be called
+     * on several shards at once, as long as the compressor outlives the calls.
      */
     virtual size_t compress(const char* input, size_t input_len, char* output,
                     size_t output_len) const = 0;
@@ -70,6 +73,11 @@ using compressor_ptr = compressor::ptr_type;
 
 compressor_ptr make_lz4_sstable_compressor_for_tests();
 
+// Creates a compressor which doesn't use dictionaries, for data kept outside
+// of sstables. Dictionary algorithms are replaced by their plain equivalent.
+// Returns nullptr for algorithm::none.
+compressor_ptr make_compressor_without_dicts(const compression_parameters&);
+
 // Per-table compression options, parsed and validated.
 //
 // Compression options are configured through the JSON-like `compression` entry in the schema.
@@ -89,11 +97,13 @@ class compression_parameters {
     static const sstring CHUNK_LENGTH_KB;
     static const sstring CHUNK_LENGTH_KB_ERR;
     static const sstring CRC_CHECK_CHANCE;
+    static const sstring PER_SSTABLE_DICT;
 private:
     algorithm _algorithm;
     std::optional<int> _chunk_length;
     std::optional<double> _crc_check_chance;
     std::optional<int> _zstd_compression_level;
+    std::optional<bool> _per_sstable_dict;
 public:
     compression_parameters();
     compression_parameters(algorithm);
@@ -104,6 +114,10 @@ class compression_parameters {
     double crc_check_chance() const { return _crc_check_chance.value_or(double(DEFAULT_CRC_CHECK_CHANCE)); }
     algorithm get_algorithm() const { return _algorithm; }
     std::optional<int> zstd_compression_level() const { return _zstd_compression_level; }
+    // Whether compaction should train a dictionary on a sample of each sstable
+    // it writes and compress the sstable with it, instead of using the table's
+    // recommended dictionary. Only valid for dictionary compressors.
+    bool per_sstable_dict() const { return _per_sstable_dict.value_or(false); }
 
     using dicts_feature_enabled = bool_class<struct dicts_feature_enabled_tag>;
     void validate(dicts_feature_enabled) const;
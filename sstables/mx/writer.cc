@@ -554,8 +554,12 @@ class writer : public sstable_writer::writer_impl {
     //
     // (Ideally this mechanism should only be used if the optimal size of the
     // filter can't be well estimated in advance. As of this writing we use
-    // this mechanism every time the Index component isn't being written).
+    // this mechanism every time the Index component isn't being written,
+    // and for static filters, which would otherwise keep all the keys in
+    // memory until the sstable is sealed).
     bool _delayed_filter = true;
+    // The table's sstable_filter_format, or the node's one if it doesn't set it.
+    utils::filter_format _filter_format;
     // The writer of the temporary file used when `_delayed_filter` is true.
     std::unique_ptr<file_writer> _hashes_writer;
     bool _tombstone_written = false;
@@ -669,6 +673,7 @@ class writer : public sstable_writer::writer_impl {
     }
 
     void init_file_writers();
+    future<compressor_ptr> make_compressor_from_sample(std::span<const temporary_buffer<char>> sample);
 
     // Returns the closed writer
     std::unique_ptr<file_writer> close_writer(std::unique_ptr<file_writer>& w);
@@ -876,13 +881,22 @@ class writer : public sstable_writer::writer_impl {
         _sst.open_sstable(cfg.origin);
         _sst.create_data().get();
         _compression_enabled = !_sst.has_component(component_type::CRC);
-        _delayed_filter = _sst.has_component(component_type::Filter) && !_sst.has_component(component_type::Index);
+        _filter_format = _cfg.filter_format;
+        if (!_sst._schema->sstable_filter_format().empty()) {
+            try {
+                _filter_format = utils::filter_format_from_string(_sst._schema->sstable_filter_format());
+            } catch (const std::invalid_argument& e) {
+                slogger.warn("Ignoring sstable_filter_format of {}.{}: {}", _sst._schema->ks_name(), _sst._schema->cf_name(), e.what());
+            }
+        }
+        _delayed_filter = _sst.has_component(component_type::Filter)
+                && (!_sst.has_component(component_type::Index) || _filter_format == utils::filter_format::binary_fuse);
         init_file_writers();
         _sst._shards = { shard };
 
         _cfg.monitor->on_write_started(_data_writer->offset_tracker());
         if (!_delayed_filter) {
-            _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _sst._schema->bloom_filter_fp_chance(), utils::filter_format::m_format);
+            _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _sst._schema->bloom_filter_fp_chance(), _filter_format);
         }
         _pi_write_m.promoted_index_block_size = cfg.promoted_index_block_size;
         _pi_write_m.promoted_index_auto_scale_threshold = cfg.promoted_index_auto_scale_threshold;
@@ -978,11 +992,50 @@ void writer::maybe_add_pi_block() {
     }
 }
 
+// Per-sstable compression dicts are trained on the first chunks of Data.db.
+// Unlike the table's recommended dict, each of them is loaded with its sstable,
+// so they are kept much smaller.
+static constexpr size_t per_sstable_dict_sample_size = 1 << 20;
+static constexpr size_t per_sstable_dict_min_sample_size = 64 << 10;
+static constexpr size_t per_sstable_dict_max_size = 16 << 10;
+
+future<compressor_ptr> writer::make_compressor_from_sample(std::span<const temporary_buffer<char>> sample) {
+    auto& factory = _sst.manager().get_compressor_factory();
+    size_t sample_bytes = 0;
+    for (const auto& buf : sample) {
+        sample_bytes += buf.size();
+    }
+    std::vector<std::byte> dict;
+    // Too small an sstable to be worth its own dict uses the table's one.
+    // So does one whose training fails, is skipped, or times out.
+    if (sample_bytes >= per_sstable_dict_min_sample_size) {
+        try {
+            dict = co_await factory.train_dict(sample, per_sstable_dict_max_size);
+        } catch (...) {
+            slogger.warn("Failed to train a compression dictionary for {}, using the table's dictionary: {}", _sst.get_filename(), std::current_exception());
+        }
+    }
+    co_return co_await factory.make_compressor_for_writing_with_dict(_sst._schema, dict);
+}
+
 void writer::init_file_writers() {
     auto out = _sst._storage->make_data_or_index_sink(_sst, component_type::Data).get();
 
     if (!_compression_enabled) {
         _data_writer = std::make_unique<crc32_checksummed_file_writer>(std::move(out), _sst.sstable_buffer_size, _sst.get_filename());
+    } else if (_cfg.train_compression_dict && _sst._schema->get_compressor_params().per_sstable_dict()) {
+        _data_writer = std::make_unique<file_writer>(
+            make_compressed_file_m_format_output_stream(
+                output_stream<char>(std::move(out)),
+                &_sst._components->compression,
+                _sst._schema->get_compressor_params(),
+                compressor_from_sample{
+                    .sample_size = per_sstable_dict_sample_size,
+                    .make = [this] (std::span<const temporary_buffer<char>> sample) {
+                        return make_compressor_from_sample(sample);
+                    },
+                },
+                _cfg.compression_offload), _sst.get_filename());
     } else {
         auto compressor = _sst.manager().get_compressor_factory().make_compressor_for_writing(_sst._schema).get();
         _data_writer = std::make_unique<file_writer>(
@@ -990,7 +1043,8 @@ void writer::init_file_writers() {
                 output_stream<char>(std::move(out)),
                 &_sst._components->compression,
                 _sst._schema->get_compressor_params(),
-                std::move(compressor)), _sst.get_filename());
+                std::move(compressor),
+                _cfg.compression_offload), _sst.get_filename());
     }
 
     if (_sst.has_component(component_type::Index)) {
@@ -1831,9 +1885,9 @@ void writer::consume_end_of_stream() {
   }
 
     if (_delayed_filter) {
-        _sst.build_delayed_filter(_num_partitions_consumed);
+        _sst.build_delayed_filter(_num_partitions_consumed, _filter_format);
     } else {
-        _sst.maybe_rebuild_filter_from_index(_num_partitions_consumed);
+        _sst.maybe_rebuild_filter_from_index(_num_partitions_consumed, _filter_format);
     }
     _sst.write_filter();
     _sst.write_statistics();
@@ -11,10 +11,15 @@
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/sharded.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
 #include "compress.hh"
 #include "schema/schema_fwd.hh"
 #include "utils/updateable_value.hh"
+#include <chrono>
+#include <functional>
 #include <span>
+#include <vector>
 
 namespace db {
 class config;
@@ -26,8 +31,14 @@ class raw_dict;
 struct sstable_compressor_factory {
     virtual ~sstable_compressor_factory() {}
     virtual future<compressor_ptr> make_compressor_for_writing(schema_ptr) = 0;
+    // Like make_compressor_for_writing(), but uses the given dict instead of
+    // the recommended dict of the table (if the table uses a dictionary compressor).
+    virtual future<compressor_ptr> make_compressor_for_writing_with_dict(schema_ptr, std::span<const std::byte> dict) = 0;
     virtual future<compressor_ptr> make_compressor_for_reading(sstables::compression&) = 0;
     virtual future<> set_recommended_dict(table_id, std::span<const std::byte> dict) = 0;
+    // Trains a dict of at most max_size bytes on the given sample.
+    // Returns an empty dict if training isn't possible.
+    virtual future<std::vector<std::byte>> train_dict(std::span<const temporary_buffer<char>> sample, size_t max_size) = 0;
 };
 
 // Note: I couldn't make this an inner class of default_sstable_compressor_factory,
@@ -43,6 +54,11 @@ struct default_sstable_compressor_factory_config {
     utils::updateable_value<bool> enable_writing_dictionaries{true};
     utils::updateable_value<float> memory_fraction_starting_at_which_we_stop_writing_dicts{1};
     std::vector<unsigned> numa_config{get_default_shard_to_numa_node_mapping()};
+    // Memory for copies of samples of per-sstable dicts which are queued for
+    // or undergoing training, per shard. Trainings which don't fit are skipped.
+    size_t dict_training_memory = 4 << 20;
+    // How long train_dict() waits for the training before giving up.
+    std::chrono::milliseconds dict_training_timeout{std::chrono::seconds(30)};
 
     static default_sstable_compressor_factory_config from_db_config(
         const db::config&,
@@ -65,8 +81,15 @@ struct default_sstable_compressor_factory : peering_sharded_service<default_ssta
 public:
     using self = default_sstable_compressor_factory;
     using config = default_sstable_compressor_factory_config;
+    using train_dict_fn = std::function<future<std::vector<std::byte>>(std::vector<std::vector<std::byte>> sample, size_t max_size)>;
 private:
     config _cfg;
+    // Training is CPU-heavy, so it's plugged in by the owner of a worker thread to run it on.
+    train_dict_fn _train_dict;
+    // Charged with the samples handed to _train_dict, until it's done with them.
+    semaphore _dict_training_memory;
+    // Trainings keep running after train_dict() times out.
+    gate _dict_training_gate;
     // Maps NUMA node ID to the array of shards on that node.
     std::vector<std::vector<shard_id>> _numa_groups;
     // Holds dictionaries owned by this shard.
@@ -87,12 +110,21 @@ struct default_sstable_compressor_factory : peering_sharded_service<default_ssta
 public:
     default_sstable_compressor_factory(config = config{});
     ~default_sstable_compressor_factory();
+    future<> stop();
 
     future<compressor_ptr> make_compressor_for_writing(schema_ptr) override;
     future<compressor_ptr> make_compressor_for_writing_for_tests(const compression_parameters&, table_id);
+    future<compressor_ptr> make_compressor_for_writing_with_dict(schema_ptr, std::span<const std::byte> dict) override;
     future<compressor_ptr> make_compressor_for_reading(sstables::compression&) override;
     future<compressor_ptr> make_compressor_for_reading_for_tests(const compression_parameters&, std::span<const std::byte> dict);
     future<> set_recommended_dict(table_id, std::span<const std::byte> dict) override;
+    // Copies the sample and passes it to the training function, unless the
+    // copies of other samples already take up config::dict_training_memory.
+    // Fails with timed_out_error if the training takes longer than
+    // config::dict_training_timeout.
+    future<std::vector<std::byte>> train_dict(std::span<const temporary_buffer<char>> sample, size_t max_size) override;
+    // Sets the function train_dict() runs. Until it is set, train_dict() returns empty dicts.
+    void set_train_dict_callback(train_dict_fn);
 };
 
 std::unique_ptr<sstable_compressor_factory> make_sstable_compressor_factory_for_tests_in_thread();
@@ -84,6 +84,7 @@ const sstable_version_constants::component_map_t sstable_version_constants_m::cr
     result.emplace(component_type::Index, "Index.db");
     result.emplace(component_type::Summary, "Summary.db");
     result.emplace(component_type::Digest, "Digest.crc32");
+    result.emplace(component_type::TemporaryHashes, "TemporaryHashes.db.tmp");
     return result;
 }
 
@@ -96,7 +97,6 @@ const sstable_version_constants::component_map_t sstable_version_constants_m_bti
     // This means that we allow `ms`-`mt` to have Index.db and Summary.db components.
     result.emplace(component_type::Rows, "Rows.db");
     result.emplace(component_type::Partitions, "Partitions.db");
-    result.emplace(component_type::TemporaryHashes, "TemporaryHashes.db.tmp");
     return result;
 }
 
@@ -61,6 +61,7 @@
 #include "mutation/range_tombstone_list.hh"
 #include "binary_search.hh"
 #include "utils/bloom_filter.hh"
+#include "utils/binary_fuse_filter.hh"
 #include "utils/cached_file.hh"
 #include "utils/stall_free.hh"
 #include "utils/checked-file-impl.hh"
@@ -1837,8 +1838,26 @@ future<> sstable::read_filter(sstable_open_config cfg) {
         sstables::filter filter;
         read_simple_and_verify_digest<component_type::Filter>(filter).get();
         auto nr_bits = filter.buckets.elements.size() * std::numeric_limits<typename decltype(filter.buckets.elements)::value_type>::digits;
+        auto format = get_filter_format(_version);
+        // Binary fuse filters are written with a negative number of hashes,
+        // and split block filters with 0 hashes, which older versions
+        // interpret as a filter which always matches.
+        if (int32_t(filter.hashes) < 0 && _version >= sstable_version_types::mc) {
+            try {
+                _components->filter = std::make_unique<utils::filter::binary_fuse_filter>(-int32_t(filter.hashes), std::move(filter.buckets.elements));
+            } catch (const std::runtime_error& e) {
+                throw_malformed_sstable_exception(e.what(), filename(component_type::Filter));
+            }
+            return;
+        }
+        if (filter.hashes == 0 && nr_bits && _version >= sstable_version_types::mc) {
+            if (nr_bits % utils::filter::split_block_bloom_filter::block_bits) {
+                throw_malformed_sstable_exception(fmt::format("Split block filter has {} bits, not a multiple of the block size", nr_bits), filename(component_type::Filter));
+            }
+            format = utils::filter_format::split_block;
+        }
         large_bitset bs(nr_bits, std::move(filter.buckets.elements));
-        _components->filter = utils::filter::create_filter(filter.hashes, std::move(bs), get_filter_format(_version));
+        _components->filter = utils::filter::create_filter(filter.hashes, std::move(bs), format);
     });
 }
 
@@ -1847,15 +1866,20 @@ void sstable::write_filter() {
         return;
     }
 
-    auto f = downcast_ptr<utils::filter::murmur3_bloom_filter>(_components->filter.get());
-
-    auto&& bs = f->bits();
-    auto filter_ref = sstables::filter_ref(f->num_hashes(), bs.get_storage());
-    auto digest = write_simple_with_digest<component_type::Filter>(filter_ref);
+    _components->filter->seal();
+    auto digest = [&] {
+        if (auto f = dynamic_cast<utils::filter::binary_fuse_filter*>(_components->filter.get())) {
+            auto filter_ref = sstables::filter_ref(-int(f->fingerprint_bits()), f->get_storage());
+            return write_simple_with_digest<component_type::Filter>(filter_ref);
+        }
+        auto f = downcast_ptr<utils::filter::bloom_filter>(_components->filter.get());
+        auto filter_ref = sstables::filter_ref(f->num_hashes(), f->bits().get_storage());
+        return write_simple_with_digest<component_type::Filter>(filter_ref);
+    }();
     _components_digests.map[component_type::Filter] = digest;
 }
 
-void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions) {
+void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions, utils::filter_format format) {
     if (!has_component(component_type::Filter)) {
         return;
     }
@@ -1863,15 +1887,22 @@ void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions) {
         return;
     }
 
+    auto bf = dynamic_cast<utils::filter::bloom_filter*>(_components->filter.get());
+    if (!bf) {
+        // Static filters are built by build_delayed_filter(), so the only
+        // other filter left here is the always present one.
+        return;
+    }
+
     // Skip rebuilding the bloom filter if the false positive rate based
     // on the current bitset size is within 75% to 125% of the configured
     // false positive rate.
-    auto curr_bitset_size = downcast_ptr<utils::filter::bloom_filter>(_components->filter.get())->bits().memory_size();
+    auto curr_bitset_size = bf ? bf->bits().memory_size() : 0;
     auto bitset_size_lower_bound = utils::i_filter::get_filter_size(num_partitions,
-                                                                    _schema->bloom_filter_fp_chance() * 1.25);
+                                                                    _schema->bloom_filter_fp_chance() * 1.25, format);
     auto bitset_size_upper_bound = utils::i_filter::get_filter_size(num_partitions,
-                                                                    _schema->bloom_filter_fp_chance() * 0.75);
-    if (bitset_size_lower_bound <= curr_bitset_size && curr_bitset_size <= bitset_size_upper_bound) {
+                                                                    _schema->bloom_filter_fp_chance() * 0.75, format);
+    if (bf && bitset_size_lower_bound <= curr_bitset_size && curr_bitset_size <= bitset_size_upper_bound) {
         return;
     }
 
@@ -1882,11 +1913,11 @@ void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions) {
     //    - to avoid downsizing when the savings are minimal.
     //    - the fp rate is also already at least at the configured value, so no gain there.
     // 3. Do not resize filters of garbage_collected sstables.
-    const auto optimal_filter_size = utils::i_filter::get_filter_size(num_partitions, _schema->bloom_filter_fp_chance());
+    const auto optimal_filter_size = utils::i_filter::get_filter_size(num_partitions, _schema->bloom_filter_fp_chance(), format);
     const auto filter_size_diff = std::abs<int64_t>(optimal_filter_size - curr_bitset_size);
-    if (filter_size_diff < 1024 || filter_size_diff < 0.1 * curr_bitset_size || // [1]
+    if (bf && (filter_size_diff < 1024 || filter_size_diff < 0.1 * curr_bitset_size || // [1]
             (curr_bitset_size > optimal_filter_size && curr_bitset_size < 16384) || // [2]
-            _origin == "garbage_collection") { // [3]
+            _origin == "garbage_collection")) { // [3]
         return;
     }
 
@@ -1901,9 +1932,9 @@ void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions) {
     };
 
     // Create a new filter that can optimally represent the given num_partitions.
-    auto optimal_filter = utils::i_filter::get_filter(num_partitions, _schema->bloom_filter_fp_chance(), get_filter_format(_version));
+    auto optimal_filter = utils::i_filter::get_filter(num_partitions, _schema->bloom_filter_fp_chance(), format);
     sstlog.info("Rebuilding bloom filter {}: resizing bitset from {} bytes to {} bytes. sstable origin: {}", filename(component_type::Filter), curr_bitset_size,
-                downcast_ptr<utils::filter::bloom_filter>(optimal_filter.get())->bits().memory_size(), _origin);
+                optimal_filter_size, _origin);
 
     auto index_file = open_file(component_type::Index, open_flags::ro).get();
     auto index_file_closer = deferred_action([&index_file] {
@@ -1938,10 +1969,26 @@ void sstable::maybe_rebuild_filter_from_index(uint64_t num_partitions) {
     _components->filter.swap(optimal_filter);
 }
 
-void sstable::build_delayed_filter(uint64_t num_partitions) {
-    auto optimal_filter = utils::i_filter::get_filter(num_partitions, _schema->bloom_filter_fp_chance(), get_filter_format(_version));
+void sstable::build_delayed_filter(uint64_t num_partitions, utils::filter_format format) {
+    // Static filters hold all the keys, and a few times that of temporary
+    // memory, until they are sealed. Reserve it for the whole build, and
+    // fall back to a bloom filter if it doesn't fit in the budget at all.
+    semaphore_units<> build_memory_units;
+    if (format == utils::filter_format::binary_fuse && _schema->bloom_filter_fp_chance() < 1.0) {
+        const auto fingerprint_bits = utils::filter::binary_fuse_filter::fingerprint_bits_for(_schema->bloom_filter_fp_chance());
+        const auto build_memory = utils::filter::binary_fuse_filter::build_memory_for(num_partitions, fingerprint_bits);
+        if (num_partitions > utils::filter::binary_fuse_filter::max_elements || build_memory > _manager.max_filter_build_memory()) {
+            sstlog.info("Building bloom filter {} instead of binary fuse filter: {} partitions need {} bytes to build, out of {} bytes. sstable origin: {}",
+                    filename(component_type::Filter), num_partitions, build_memory, _manager.max_filter_build_memory(), _origin);
+            format = utils::filter_format::m_format;
+        } else {
+            build_memory_units = get_units(_manager.filter_build_memory(), build_memory).get();
+        }
+    }
+
+    auto optimal_filter = utils::i_filter::get_filter(num_partitions, _schema->bloom_filter_fp_chance(), format);
     sstlog.debug("Building delayed bloom filter {}: {} filter bytes. sstable origin: {}", filename(component_type::Filter),
-        downcast_ptr<utils::filter::bloom_filter>(optimal_filter.get())->bits().memory_size(), _origin);
+        utils::i_filter::get_filter_size(num_partitions, _schema->bloom_filter_fp_chance(), format), _origin);
 
     auto hashes_file = open_file(component_type::TemporaryHashes, open_flags::ro).get();
     auto hashes_file_closer = deferred_close(hashes_file);
@@ -1979,6 +2026,7 @@ void sstable::build_delayed_filter(uint64_t num_partitions) {
             filename(component_type::TemporaryHashes), num_partitions, processed_hashes));
     }
 
+    optimal_filter->seal();
     _components->filter.swap(optimal_filter);
     unlink_component(component_type::TemporaryHashes).get();
 }
@@ -3945,6 +3993,8 @@ future<> init_metrics() {
 
         sm::make_gauge("bloom_filter_memory_size", [] { return utils::filter::bloom_filter::get_shard_stats().memory_size; },
             sm::description("Bloom filter memory usage in bytes.")),
+        sm::make_gauge("binary_fuse_filter_memory_size", [] { return utils::filter::binary_fuse_filter::get_shard_stats().memory_size; },
+            sm::description("Binary fuse filter memory usage in bytes.")),
     });
   });
 }
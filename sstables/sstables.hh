@@ -85,6 +85,7 @@ namespace fs = std::filesystem;
 extern logging::logger sstlog;
 class sstable_writer;
 class sstables_manager;
+class compression_offload;
 
 struct foreign_sstable_open_info;
 
@@ -126,6 +127,12 @@ struct sstable_writer_config {
     sstring origin;
     bool correct_pi_block_width = true;
     uint32_t large_data_records_per_sstable = 10;
+    utils::filter_format filter_format = utils::filter_format::m_format;
+    // Train a compression dict on the sstable's own data, if the table's
+    // compression options ask for per-sstable dicts.
+    bool train_compression_dict = false;
+    // If set, lets the Data.db writer compress chunks on other shards.
+    sstables::compression_offload* compression_offload = nullptr;
 
 private:
     explicit sstable_writer_config() {}
@@ -722,9 +729,9 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // partitions, if the partition estimate provided during bloom
     // filter initialisation was not good.
     // This should be called only before an sstable is sealed.
-    void maybe_rebuild_filter_from_index(uint64_t num_partitions);
+    void maybe_rebuild_filter_from_index(uint64_t num_partitions, utils::filter_format format);
 
-    void build_delayed_filter(uint64_t num_partitions);
+    void build_delayed_filter(uint64_t num_partitions, utils::filter_format format);
 
     future<> update_info_for_opened_data(sstable_open_config cfg = {});
 
@@ -51,6 +51,7 @@ sstables_manager::sstables_manager(
         utils::updateable_value(0.0f),
         reader_concurrency_semaphore::register_metrics::no,
         reader_concurrency_semaphore_shared_pool::empty_pool())
+    , _filter_build_memory(max_memory_filter_build(_config.available_memory))
     , _dir_semaphore(dir_sem)
     , _resolve_host_id(std::move(resolve_host_id))
     , _maintenance_sg(std::move(maintenance_sg))
@@ -264,6 +265,7 @@ sstable_writer_config sstables_manager::configure_writer(sstring origin) const {
 
     cfg.origin = std::move(origin);
     cfg.large_data_records_per_sstable = _config.large_data_records_per_sstable();
+    cfg.filter_format = utils::filter_format_from_string(_config.filter_format());
 
     return cfg;
 }
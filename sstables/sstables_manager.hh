@@ -124,6 +124,7 @@ class sstables_manager {
         const std::vector<sstring>& data_file_directories;
         utils::updateable_value<sstring> format = utils::updateable_value<sstring>(fmt::to_string(sstable_version_types::me));
         utils::updateable_value<uint32_t> large_data_records_per_sstable = utils::updateable_value<uint32_t>(10);
+        utils::updateable_value<sstring> filter_format = utils::updateable_value<sstring>("bloom");
         bool ignore_component_digest_mismatch = false;
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
     };
@@ -163,6 +164,9 @@ class sstables_manager {
     cache_tracker& _cache_tracker;
 
     reader_concurrency_semaphore _sstable_metadata_concurrency_sem;
+    // Memory for the temporary structures of static filters, which are
+    // built from all the keys of an sstable when it is sealed.
+    semaphore _filter_build_memory;
     directory_semaphore& _dir_semaphore;
     std::unique_ptr<sstables::sstables_registry> _sstables_registry;
     // This function is bound to token_metadata.get_my_id() in the database constructor,
@@ -246,6 +250,8 @@ class sstables_manager {
     locator::host_id get_local_host_id() const;
 
     reader_concurrency_semaphore& sstable_metadata_concurrency_sem() noexcept { return _sstable_metadata_concurrency_sem; }
+    semaphore& filter_build_memory() noexcept { return _filter_build_memory; }
+    size_t max_filter_build_memory() const noexcept { return max_memory_filter_build(_config.available_memory); }
 
     // Wait until all sstables managed by this sstables_manager instance
     // (previously created by make_sstable()) have been disposed of:
@@ -306,6 +312,8 @@ class sstables_manager {
     static constexpr size_t max_count_sstable_metadata_concurrent_reads{10};
     // Allow at most 10% of memory to be filled with such reads.
     size_t max_memory_sstable_metadata_concurrent_reads(size_t available_memory) { return available_memory * 0.1; }
+    // Allow at most 5% of memory to be used for building static filters.
+    static size_t max_memory_filter_build(size_t available_memory) { return available_memory * 0.05; }
 
     // Increment the _total_reclaimable_memory with the new SSTable's reclaimable memory
     void increment_total_reclaimable_memory(sstable* sst);
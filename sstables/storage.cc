@@ -545,7 +545,7 @@ future<> filesystem_storage::wipe(sstable& sst, const atomic_delete_context* ctx
             // during SSTable writing and removed before sealing.  If the write
             // failed before sealing, the file may still be on disk and must be
             // cleaned up explicitly.
-            // The component is only defined for the `ms` sstable format; for
+            // The component is only defined for the `m` sstable formats; for
             // older formats it is absent from the component map and looking up
             // its filename would throw std::out_of_range.
             // Use file_exists() to avoid a C++ exception on the common path
@@ -6,11 +6,131 @@
  * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
  */
 
+#include <array>
+#include <bit>
+#include <cstring>
 #include "bti_node_reader.hh"
 #include "bti_node_type.hh"
 
+#ifdef __x86_64__
+#include <x86intrin.h>
+#define arch_target(name) [[gnu::target(name)]]
+#else
+#define arch_target(name)
+#endif
+
 namespace sstables::trie {
 
+// Sparse nodes can have up to 256 children, and a binary search over them
+// is a chain of unpredictable branches, and this search runs for
+// every sparse node on the path of every index lookup.
+// Instead, we count the transitions smaller than `key`, a vector of `s` bytes at a time.
+// Since the transitions are sorted, we can stop at the first vector
+// which isn't entirely smaller than `key`.
+//
+// This is the portable version. On x86_64, the SSE4.2 and AVX2 versions
+// below are picked at load time when the CPU supports them.
+int detail::sparse_lower_bound_generic(const std::byte* transitions, int n, std::byte key) {
+    constexpr int s = 16; // Vector size.
+    typedef unsigned char vector1x __attribute__((__vector_size__(s)));
+    vector1x kv;
+    memset(&kv, uint8_t(key), s);
+    for (int i = 0; i < n; i += s) {
+        vector1x v;
+        if (n - i >= s) [[likely]] {
+            memcpy(&v, transitions + i, s);
+        } else {
+            // The node might end near the end of the page, so we mustn't read past the last transition.
+            // 0xff is never smaller than `key`, so the padding doesn't affect the count.
+            memset(&v, 0xff, s);
+            memcpy(&v, transitions + i, n - i);
+        }
+        // Each lane is 0xff if the transition is smaller than `key`, 0x00 otherwise.
+        auto lt = v < kv;
+        uint64_t halves[2];
+        static_assert(sizeof(lt) == sizeof(halves));
+        memcpy(halves, &lt, sizeof(halves));
+        int count = (std::popcount(halves[0]) + std::popcount(halves[1])) / 8;
+        if (count < s) {
+            return i + count;
+        }
+    }
+    return n;
+}
+
+#ifdef __x86_64__
+
+// There are no unsigned byte comparisons before AVX-512,
+// but flipping the top bit maps the unsigned order onto the signed one.
+//
+// Since the transitions are sorted, the comparison mask is a run of ones
+// followed by zeroes, so the count of smaller transitions is the number
+// of trailing ones of the mask.
+[[gnu::target("sse4.2")]] int detail::sparse_lower_bound_sse42(const std::byte* transitions, int n, std::byte key) {
+    constexpr int s = 16;
+    const auto flip = _mm_set1_epi8(char(0x80));
+    const auto k = _mm_set1_epi8(char(uint8_t(key) ^ 0x80));
+    for (int i = 0; i < n; i += s) {
+        __m128i v;
+        if (n - i >= s) [[likely]] {
+            v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(transitions + i));
+        } else {
+            std::array<std::byte, s> tail;
+            tail.fill(std::byte(0xff));
+            memcpy(tail.data(), transitions + i, n - i);
+            v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail.data()));
+        }
+        uint32_t lt = _mm_movemask_epi8(_mm_cmplt_epi8(_mm_xor_si128(v, flip), k));
+        int count = std::countr_one(lt);
+        if (count < s) {
+            return i + count;
+        }
+    }
+    return n;
+}
+
+[[gnu::target("avx2")]] int detail::sparse_lower_bound_avx2(const std::byte* transitions, int n, std::byte key) {
+    constexpr int s = 32;
+    const auto flip = _mm256_set1_epi8(char(0x80));
+    const auto k = _mm256_set1_epi8(char(uint8_t(key) ^ 0x80));
+    for (int i = 0; i < n; i += s) {
+        __m256i v;
+        if (n - i >= s) [[likely]] {
+            v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(transitions + i));
+        } else {
+            std::array<std::byte, s> tail;
+            tail.fill(std::byte(0xff));
+            memcpy(tail.data(), transitions + i, n - i);
+            v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail.data()));
+        }
+        // `key > v` is `v < key`.
+        uint64_t lt = uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(k, _mm256_xor_si256(v, flip))));
+        int count = std::countr_one(lt);
+        if (count < s) {
+            return i + count;
+        }
+    }
+    return n;
+}
+
+#endif
+
+arch_target("default") static int sparse_lower_bound(const std::byte* transitions, int n, std::byte key) {
+    return detail::sparse_lower_bound_generic(transitions, n, key);
+}
+
+#ifdef __x86_64__
+
+arch_target("sse4.2") static int sparse_lower_bound(const std::byte* transitions, int n, std::byte key) {
+    return detail::sparse_lower_bound_sse42(transitions, n, key);
+}
+
+arch_target("avx2") static int sparse_lower_bound(const std::byte* transitions, int n, std::byte key) {
+    return detail::sparse_lower_bound_avx2(transitions, n, key);
+}
+
+#endif
+
 get_child_result bti_get_child(uint64_t pos, const_bytes sp, int child_idx, bool forward) {
     auto type = uint8_t(sp[0]) >> 4;
     trie::get_child_result result;
@@ -220,7 +340,7 @@ node_traverse_result bti_walk_down_along_key(int64_t pos, const_bytes sp, const_
     };
     auto sparse = [&] [[gnu::always_inline]] (int type) {
         int n_children = int(sp[1]);
-        auto idx = std::lower_bound(&sp[2], &sp[2 + n_children], key[0]) - &sp[2];
+        auto idx = sparse_lower_bound(&sp[2], n_children, key[0]);
         result.n_children = n_children;
         result.payload_bits = uint8_t(sp[0]) & 0xf;
         result.found_idx = idx;
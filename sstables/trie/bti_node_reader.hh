@@ -17,6 +17,20 @@ namespace sstables {
 
 namespace sstables::trie {
 
+namespace detail {
+
+// Equivalent to std::lower_bound(transitions, transitions + n, key) - transitions,
+// for the sorted transition bytes of a sparse node.
+// The x86_64 versions may only be called if the CPU supports their instruction set.
+// Exposed for tests.
+int sparse_lower_bound_generic(const std::byte* transitions, int n, std::byte key);
+#ifdef __x86_64__
+int sparse_lower_bound_sse42(const std::byte* transitions, int n, std::byte key);
+int sparse_lower_bound_avx2(const std::byte* transitions, int n, std::byte key);
+#endif
+
+} // namespace detail
+
 // Implementation of concept `node_reader`.
 get_child_result bti_get_child(uint64_t pos, const_bytes sp, int child_idx, bool forward);
 std::byte bti_get_child_transition(uint64_t pos, const_bytes raw, int idx);
@@ -7,6 +7,7 @@
  */
 
 #include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
 
 #include "sstables/sstable_writer.hh"
 #include "test/lib/eventually.hh"
@@ -17,6 +18,7 @@
 
 #include "db/config.hh"
 #include "readers/from_mutations.hh"
+#include "utils/binary_fuse_filter.hh"
 #include "utils/bloom_filter.hh"
 #include "utils/error_injection.hh"
 #include "utils/i_filter.hh"
@@ -506,3 +508,135 @@ SEASTAR_TEST_CASE(test_rebuild_from_temporary_hashes) {
         }
     });
 }
+
+// Writes sstables with a filter of the given format, and checks the filter
+// read back from disk has no false negatives, and about the configured
+// false-positive rate.
+template <typename Filter>
+static void test_filter_format(test_env& env, utils::filter_format format) {
+    for (const auto version : {sstable_version_types::me, sstable_version_types::ms}) {
+        simple_schema ss;
+        auto schema = ss.schema();
+        const auto partition_count = 1000;
+
+        utils::chunked_vector<mutation> mutations;
+        auto pks = ss.make_pkeys(partition_count);
+        for (auto pk : pks) {
+            auto mut = mutation(schema, pk);
+            mut.partition().apply_insert(*schema, ss.make_ckey(1), ss.new_timestamp());
+            mutations.push_back(std::move(mut));
+        }
+
+        auto cfg = env.manager().configure_writer();
+        cfg.filter_format = format;
+        auto sst = make_sstable_easy(env, make_mutation_reader_from_mutations(schema, env.make_reader_permit(), mutations), cfg, version, partition_count);
+
+        // Re-read the filter from disk, it has to be recognized as the right format.
+        sst = env.reusable_sst(sst).get();
+        auto filter = dynamic_cast<Filter*>(sstables::test(sst).get_filter().get());
+        BOOST_REQUIRE(filter);
+
+        // No false negatives.
+        for (const auto& pk : pks) {
+            BOOST_REQUIRE(sst->filter_has_key(*schema, pk.key()));
+        }
+
+        // The false-positive rate is in the ballpark of the configured one.
+        const auto probes = 100000;
+        size_t false_positives = 0;
+        for (int i = 0; i < probes; i++) {
+            false_positives += sst->filter_has_key(*schema, ss.make_pkey(format("not-a-key-{}", i)).key());
+        }
+        BOOST_REQUIRE_LT(double(false_positives) / probes, schema->bloom_filter_fp_chance() * 2);
+    }
+}
+
+SEASTAR_TEST_CASE(test_split_block_bloom_filter) {
+    return test_env::do_with_async([] (test_env& env) {
+        test_filter_format<utils::filter::split_block_bloom_filter>(env, utils::filter_format::split_block);
+    });
+}
+
+SEASTAR_TEST_CASE(test_binary_fuse_filter) {
+    return test_env::do_with_async([] (test_env& env) {
+        test_filter_format<utils::filter::binary_fuse_filter>(env, utils::filter_format::binary_fuse);
+    });
+}
+
+// Binary fuse filters are built from the temporary hashes when the sstable
+// is sealed, within the filter build memory of the sstables_manager, and
+// sstables whose filter doesn't fit in it get a bloom filter instead.
+SEASTAR_TEST_CASE(test_binary_fuse_filter_build_memory) {
+    const auto partition_count = 1000;
+    const auto fingerprint_bits = utils::filter::binary_fuse_filter::fingerprint_bits_for(simple_schema().schema()->bloom_filter_fp_chance());
+    const auto build_memory = utils::filter::binary_fuse_filter::build_memory_for(partition_count, fingerprint_bits);
+    BOOST_REQUIRE_GT(build_memory, utils::filter::binary_fuse_filter::size_for(partition_count, fingerprint_bits));
+
+    return test_env::do_with_async([build_memory] (test_env& env) {
+        simple_schema ss;
+        auto schema = ss.schema();
+        BOOST_REQUIRE_LT(env.manager().max_filter_build_memory(), build_memory);
+
+        for (const auto version : {sstable_version_types::me, sstable_version_types::ms}) {
+            utils::chunked_vector<mutation> mutations;
+            auto pks = ss.make_pkeys(partition_count);
+            for (auto pk : pks) {
+                auto mut = mutation(schema, pk);
+                mut.partition().apply_insert(*schema, ss.make_ckey(1), ss.new_timestamp());
+                mutations.push_back(std::move(mut));
+            }
+
+            auto cfg = env.manager().configure_writer();
+            cfg.filter_format = utils::filter_format::binary_fuse;
+            auto sst = make_sstable_easy(env, make_mutation_reader_from_mutations(schema, env.make_reader_permit(), mutations), cfg, version, partition_count);
+
+            BOOST_REQUIRE_EQUAL(env.manager().filter_build_memory().available_units(), ssize_t(env.manager().max_filter_build_memory()));
+            auto filter = sstables::test(sst).get_filter().get();
+            BOOST_REQUIRE(!dynamic_cast<utils::filter::binary_fuse_filter*>(filter));
+            BOOST_REQUIRE(dynamic_cast<utils::filter::bloom_filter*>(filter));
+            for (const auto& pk : pks) {
+                BOOST_REQUIRE(sst->filter_has_key(*schema, pk.key()));
+            }
+        }
+    }, {
+        // Leaves 5% of it to build filters.
+        .available_memory = build_memory
+    });
+}
+
+SEASTAR_THREAD_TEST_CASE(test_binary_fuse_filter_build) {
+    for (int64_t n : {0, 1, 2, 10, 1000, 100000}) {
+        for (double fp_chance : {0.1, 0.01, 0.001}) {
+            auto filter = utils::i_filter::get_filter(n, fp_chance, utils::filter_format::binary_fuse);
+            std::vector<utils::hashed_key> keys;
+            for (int64_t i = 0; i < n; i++) {
+                keys.emplace_back(std::array<uint64_t, 2>{tests::random::get_int<uint64_t>(), tests::random::get_int<uint64_t>()});
+                filter->add(keys.back());
+            }
+            // Duplicates are allowed.
+            if (n) {
+                filter->add(keys.front());
+            }
+            filter->seal();
+            BOOST_REQUIRE_EQUAL(filter->memory_size(), utils::i_filter::get_filter_size(n, fp_chance, utils::filter_format::binary_fuse));
+
+            auto& fuse = dynamic_cast<utils::filter::binary_fuse_filter&>(*filter);
+            auto reloaded = utils::filter::binary_fuse_filter(fuse.fingerprint_bits(), utils::chunked_vector<uint64_t>(fuse.get_storage()));
+            for (const auto& k : keys) {
+                BOOST_REQUIRE(filter->is_present(k));
+                BOOST_REQUIRE(reloaded.is_present(k));
+            }
+
+            // The keys, and their duplicate, were sorted and solved into
+            // a real filter, not the fallback which matches everything.
+            if (n >= 1000) {
+                const auto probes = 10000;
+                size_t false_positives = 0;
+                for (int i = 0; i < probes; i++) {
+                    false_positives += filter->is_present(utils::hashed_key(std::array<uint64_t, 2>{tests::random::get_int<uint64_t>(), 0}));
+                }
+                BOOST_REQUIRE_LT(double(false_positives) / probes, fp_chance * 2);
+            }
+        }
+    }
+}
@@ -505,6 +505,49 @@ SEASTAR_THREAD_TEST_CASE(test_body_randomized) {
     }
 }
 
+// Checks every version of the sparse node child search which the CPU supports
+// against std::lower_bound, on random sorted transition sets of all sizes.
+SEASTAR_THREAD_TEST_CASE(test_sparse_lower_bound_randomized) {
+    using search_fn = int (*)(const std::byte*, int, std::byte);
+    std::vector<std::pair<std::string_view, search_fn>> versions = {
+        {"generic", detail::sparse_lower_bound_generic},
+    };
+#ifdef __x86_64__
+    if (__builtin_cpu_supports("sse4.2")) {
+        versions.emplace_back("sse4.2", detail::sparse_lower_bound_sse42);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        versions.emplace_back("avx2", detail::sparse_lower_bound_avx2);
+    }
+#endif
+
+    std::array<uint8_t, 256> possible_transitions;
+    std::ranges::iota(possible_transitions, 0);
+
+    for (uint64_t trial = 0; trial < 1337; ++trial) {
+        auto n_children = tests::random::get_int<int>(0, 256, tests::random::gen());
+        std::array<uint8_t, 256> transitions_buf;
+        auto sampled = std::span(transitions_buf.begin(), n_children);
+        std::ranges::sample(possible_transitions, sampled.begin(), sampled.size(), tests::random::gen());
+        std::ranges::sort(sampled);
+        // Exactly sized, so that sanitized builds catch reads past the last transition.
+        std::vector<std::byte> transitions(n_children);
+        std::ranges::transform(sampled, transitions.begin(), [] (uint8_t t) { return std::byte(t); });
+
+        for (int k = 0; k < 256; ++k) {
+            auto key = std::byte(k);
+            int expected = std::ranges::lower_bound(transitions, key) - transitions.begin();
+            for (const auto& [name, search] : versions) {
+                int result = search(transitions.data(), n_children, key);
+                if (result != expected) {
+                    testlog.error("sparse_lower_bound ({}) of {} in {}", name, k, sampled);
+                }
+                REQUIRE_EQUAL(result, expected);
+            }
+        }
+    }
+}
+
 // Tests the encoding of `writer_node`'s "chain"
 // (see the comment at the declaration fo bti_node_sink::write_body for what "chain" means).
 // Tries to cover all BTI node types and interesting node "shapes"
@@ -33,4 +33,21 @@ BOOST_AUTO_TEST_CASE(test_caching_options) {
         sstring in_str = "{\"keys\": \"NONE, }";
         BOOST_REQUIRE_THROW(caching_options::from_sstring(in_str), std::exception);
     }
+    {
+        string_map in_map = { {"keys", "ALL"}, {"rows_per_partition", "ALL"}, {"admission", "FREQUENCY"}};
+        caching_options co = caching_options::from_map(in_map);
+        BOOST_REQUIRE(co.frequency_admission());
+        BOOST_REQUIRE(in_map == co.to_map());
+    }
+    {
+        // The default admission policy is not listed, so that it doesn't change the schema.
+        string_map in_map = { {"keys", "ALL"}, {"rows_per_partition", "ALL"}, {"admission", "ALL"}};
+        caching_options co = caching_options::from_map(in_map);
+        BOOST_REQUIRE(!co.frequency_admission());
+        BOOST_REQUIRE(!co.to_map().contains("admission"));
+    }
+    {
+        string_map in_map = { {"keys", "ALL"}, {"rows_per_partition", "ALL"}, {"admission", "SOME"}};
+        BOOST_REQUIRE_THROW(caching_options::from_map(in_map), std::exception);
+    }
 }
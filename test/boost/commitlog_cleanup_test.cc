@@ -167,6 +167,70 @@ SEASTAR_TEST_CASE(test_commitlog_cleanups) {
     }, cfg);
 }
 
+// Test that flushing a single memtable sub-range doesn't let a cleanup record
+// based on highest_flushed_replay_position() drop the writes of the other
+// sub-ranges, which are still only in the commitlog.
+SEASTAR_TEST_CASE(test_commitlog_cleanup_after_sub_range_flush) {
+    BOOST_REQUIRE_EQUAL(this_smp_shard_count(), 1);
+    auto cfg = cql_test_config();
+    cfg.db_config->auto_snapshot.set(false);
+    cfg.db_config->commitlog_sync.set("batch");
+    cfg.db_config->tablets_mode_for_new_keyspaces.set(db::tablets_mode_t::mode::disabled);
+    cfg.db_config->memtable_flush_sub_ranges.set(2);
+
+    return do_with_cql_env_thread([](cql_test_env& e) {
+        e.execute_cql("create table ks.cf (pk int, ck int, primary key (pk, ck))").get();
+        auto get_num_rows = [&] {
+            auto res = e.execute_cql("select * from ks.cf;").get();
+            auto rows = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(res);
+            BOOST_REQUIRE(rows);
+            return rows->rs().result_set().size();
+        };
+
+        const size_t nr_keys = 20;
+        for (size_t i = 0; i < nr_keys; ++i) {
+            e.execute_cql(fmt::format("insert into ks.cf (pk,ck) values ({}, 0)", i)).get();
+        }
+        BOOST_REQUIRE_EQUAL(get_num_rows(), nr_keys);
+
+        auto& table = e.local_db().find_column_family("ks", "cf");
+        std::vector<replica::shared_memtable> active;
+        table.for_each_active_memtable([&] (replica::memtable& mt) {
+            active.push_back(mt.shared_from_this());
+        });
+        BOOST_REQUIRE_EQUAL(active.size(), 2);
+        BOOST_REQUIRE(!active[0]->empty() && !active[1]->empty());
+
+        // Flush only the sub-range holding the most recent write, so that
+        // its replay position is above writes still held by the other one.
+        if (active[0]->replay_position() > active[1]->replay_position()) {
+            std::swap(active[0], active[1]);
+        }
+        auto& unflushed = *active[0];
+        auto& flushed = *active[1];
+        flushed.get_memtable_list()->flush_sub_range(flushed).get();
+        BOOST_REQUIRE(unflushed.lowest_replay_position() < flushed.replay_position());
+        BOOST_REQUIRE(table.highest_flushed_replay_position() < unflushed.lowest_replay_position());
+
+        // Record a cleanup of the whole token range, as repair does for tables
+        // that were flushed before the cleanup.
+        e.get_system_keyspace().local().save_commitlog_cleanup_record(table.schema()->id(),
+                dht::token_range::make_open_ended_both_sides(), table.highest_flushed_replay_position()).get();
+
+        // Drop the unflushed memtable.
+        table.clear().get();
+        auto unflushed_rows = nr_keys - get_num_rows();
+        BOOST_REQUIRE_GT(unflushed_rows, 0);
+
+        // Commitlog replay must resurrect the writes of the unflushed sub-range.
+        auto cl = e.local_db().commitlog();
+        auto rp = db::commitlog_replayer::create_replayer(e.db(), e.get_system_keyspace(), &e.raft_replay_buffer()).get();
+        auto paths = cl->list_existing_segments().get();
+        rp.recover(paths, db::commitlog::descriptor::FILENAME_PREFIX).get();
+        BOOST_REQUIRE_EQUAL(get_num_rows(), nr_keys);
+    }, cfg);
+}
+
 // Test that commitlog cleanup records are deleted when they become irrelevant.
 SEASTAR_TEST_CASE(test_commitlog_cleanup_record_gc) {
     BOOST_REQUIRE_EQUAL(this_smp_shard_count(), 1);
@@ -113,6 +113,73 @@ SEASTAR_TEST_CASE(test_commitlog_written_to_disk_batch){
         });
 }
 
+// check that concurrent writes in group mode are flushed before they are
+// acknowledged, and can share flushes
+SEASTAR_TEST_CASE(test_commitlog_written_to_disk_group){
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::GROUP;
+    return cl_test(cfg, [](commitlog& log) -> future<> {
+        auto uuid = make_table_id();
+        sstring tmp = "hej bubba cow";
+        constexpr size_t writes = 100;
+        // Issue all writes before waiting for any, so they share syncs.
+        std::vector<future<db::rp_handle>> futures;
+        for (size_t i = 0; i < writes; ++i) {
+            futures.push_back(log.add_mutation(uuid, tmp.size(), db::commitlog::force_sync::no, [&tmp](db::commitlog::output& dst) {
+                dst.write(tmp.data(), tmp.size());
+            }));
+        }
+        auto handles = co_await when_all_succeed(futures.begin(), futures.end());
+        for (auto& h : handles) {
+            BOOST_CHECK_NE(h.rp(), db::replay_position());
+            h.release();
+        }
+        BOOST_REQUIRE_GT(log.get_flush_count(), 0);
+        BOOST_REQUIRE_LT(log.get_flush_count(), writes);
+    });
+}
+
+SEASTAR_TEST_CASE(test_commitlog_group_commit_window){
+    using clock = std::chrono::steady_clock;
+    // Large enough that the window opens regardless of the disk latency.
+    static constexpr auto budget = std::chrono::seconds(1);
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::GROUP;
+    cfg.commitlog_sync_group_latency_budget = budget;
+    return cl_test(cfg, [](commitlog& log) -> future<> {
+        auto uuid = make_table_id();
+        sstring tmp = "hej bubba cow";
+        auto write = [&] {
+            return log.add_mutation(uuid, tmp.size(), db::commitlog::force_sync::no, [&tmp](db::commitlog::output& dst) {
+                dst.write(tmp.data(), tmp.size());
+            }).then([](db::rp_handle h) {
+                h.release();
+            });
+        };
+
+        // Concurrent writers share buffers, which opens the window.
+        co_await parallel_for_each(std::views::iota(0, 50), [&] (int) {
+            return write();
+        });
+        BOOST_REQUIRE_GT(log.get_group_commit_window().count(), 0);
+
+        // A lone write gathers no other write, which closes the window...
+        co_await write();
+        BOOST_REQUIRE_EQUAL(log.get_group_commit_window().count(), 0);
+
+        // ...so a single writer is synced promptly, once per write.
+        constexpr size_t writes = 10;
+        auto flushes = log.get_flush_count();
+        auto start = clock::now();
+        for (size_t i = 0; i < writes; ++i) {
+            co_await write();
+            BOOST_REQUIRE_EQUAL(log.get_group_commit_window().count(), 0);
+        }
+        BOOST_REQUIRE(clock::now() - start < budget);
+        BOOST_REQUIRE_EQUAL(log.get_flush_count() - flushes, writes);
+    });
+}
+
 // check that an entry marked as sync is immediately flushed to a storage
 SEASTAR_TEST_CASE(test_commitlog_written_to_disk_sync){
     commitlog::config cfg;
@@ -690,6 +757,74 @@ SEASTAR_TEST_CASE(test_commitlog_replay_single_large_mutation){
     });
 }
 
+static future<> test_commitlog_compressed_entries(compressor::algorithm algo) {
+    commitlog::config cfg;
+    cfg.commitlog_segment_size_in_mb = 4;
+    cfg.compression = algo;
+
+    return cl_test(cfg, [](commitlog& log) -> future<> {
+        auto uuid = make_table_id();
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<char> dist;
+
+        // Too small to be compressed, spans several compression blocks
+        // and compresses well, doesn't compress, too large to be
+        // compressed, and a last one to find where the previous one ends.
+        std::vector<sstring> entries;
+        entries.emplace_back("hej bubba cow");
+        entries.emplace_back(sstring(100 * 1024, 'x'));
+        entries.emplace_back(sstring(16 * 1024, 0));
+        for (auto& c : entries.back()) {
+            c = dist(gen);
+        }
+        entries.emplace_back(sstring(commitlog::config().compression_max_entry_size + 1, 'y'));
+        entries.emplace_back("hej bubba cow");
+
+        std::vector<replay_position> rps;
+        for (auto& e : entries) {
+            auto h = co_await log.add_mutation(uuid, e.size(), db::commitlog::force_sync::no, [&e](db::commitlog::output& dst) {
+                dst.write(e.data(), e.size());
+            });
+            rps.emplace_back(h.release());
+        }
+
+        BOOST_REQUIRE_EQUAL(rps[1].id, rps[2].id);
+        // The compressible entry takes a fraction of its size on disk.
+        BOOST_REQUIRE_LT(rps[2].pos - rps[1].pos, entries[1].size() / 10);
+        // The one above compression_max_entry_size is written as is.
+        BOOST_REQUIRE_EQUAL(rps[3].id, rps[4].id);
+        BOOST_REQUIRE_GT(rps[4].pos - rps[3].pos, entries[3].size());
+
+        co_await log.sync_all_segments();
+
+        size_t found = 0;
+        for (auto& seg : log.get_active_segment_names()) {
+            co_await db::commitlog::read_log_file(seg, db::commitlog::descriptor::FILENAME_PREFIX, [&](db::commitlog::buffer_and_replay_position buf_rp) {
+                auto i = std::ranges::find(rps, buf_rp.position);
+                BOOST_REQUIRE(i != rps.end());
+                auto& e = entries[i - rps.begin()];
+                auto linearization_buffer = bytes_ostream();
+                auto in = buf_rp.buffer.get_istream();
+                BOOST_REQUIRE_EQUAL(buf_rp.buffer.size_bytes(), e.size());
+                BOOST_REQUIRE(to_string_view(in.read_bytes_view(e.size(), linearization_buffer).value()) == std::string_view(e));
+                ++found;
+                return make_ready_future<>();
+            });
+        }
+        BOOST_REQUIRE_EQUAL(found, entries.size());
+    });
+}
+
+SEASTAR_TEST_CASE(test_commitlog_compressed_entries_lz4) {
+    return test_commitlog_compressed_entries(compressor::algorithm::lz4);
+}
+
+SEASTAR_TEST_CASE(test_commitlog_compressed_entries_zstd) {
+    return test_commitlog_compressed_entries(compressor::algorithm::zstd);
+}
+
 /**
  * Checks same thing as above, but will also ensure the seek mechanism in 
  * replayer is working, since we will span multiple chunks.
@@ -984,6 +1119,55 @@ SEASTAR_TEST_CASE(test_commitlog_replay_invalid_key){
     });
 }
 
+// Checks that the mutations of a segment are all applied on their shards when
+// they are replayed in batches, also when they need more memory than the
+// replay of a shard may hold at once. The replay also fails if the memory of
+// the batches isn't returned once they are applied.
+SEASTAR_TEST_CASE(test_commitlog_replay_batches_on_all_shards) {
+    return do_with_cql_env_thread([] (cql_test_env& env) {
+        env.execute_cql("create table t (pk text primary key, v text)").get();
+
+        auto& db = env.local_db();
+        auto& table = db.find_column_family("ks", "t");
+        auto& cl = *table.commitlog();
+        auto s = table.schema();
+        auto& sharder = table.get_effective_replication_map()->get_sharder(*table.schema());
+
+        // About 20MB, more than the 16MB of batches the replay of a shard holds.
+        constexpr size_t nr_keys = 2000;
+        const auto value = to_bytes(sstring(10 * 1024, 'x'));
+        std::vector<size_t> keys_per_shard(smp::count);
+        for (size_t i = 0; i < nr_keys; ++i) {
+            auto key = partition_key::from_single_value(*s, to_bytes(fmt::format("key{}", i)));
+            auto md = tests::data_model::mutation_description(key.explode());
+            md.add_clustered_cell({}, "v", value);
+            auto m = md.build(s);
+
+            auto fm = freeze(m);
+            commitlog_mutation_entry_writer cew(s, fm, db::commitlog::force_sync::no);
+            cl.add_entry(m.column_family_id(), cew, db::no_timeout).get();
+            ++keys_per_shard[sharder.shard_for_reads(m.token())];
+        }
+        cl.sync_all_segments().get();
+        if (smp::count > 1) {
+            BOOST_REQUIRE(std::ranges::all_of(keys_per_shard, [] (size_t n) { return n > 0; }));
+        }
+
+        auto paths = cl.get_active_segment_names();
+        BOOST_REQUIRE(!paths.empty());
+        auto rp = db::commitlog_replayer::create_replayer(env.db(), env.get_system_keyspace()).get();
+        rp.recover(paths, db::commitlog::descriptor::FILENAME_PREFIX).get();
+
+        env.db().invoke_on_all([&] (replica::database& db) {
+            size_t partitions = 0;
+            for (auto mt : active_memtables(db.find_column_family("ks", "t"))) {
+                partitions += mt->partition_count();
+            }
+            BOOST_REQUIRE_EQUAL(partitions, keys_per_shard[this_shard_id()]);
+        }).get();
+    });
+}
+
 using namespace std::chrono_literals;
 
 SEASTAR_TEST_CASE(test_commitlog_add_entry) {
@@ -2904,4 +3088,18 @@ SEASTAR_TEST_CASE(test_descriptor_roundtrip) {
     return make_ready_future<>();
 }
 
+SEASTAR_TEST_CASE(test_rp_set_has_positions_before) {
+    rp_set set;
+    BOOST_CHECK(!set.has_positions_before(replay_position(10, 0)));
+
+    set.put(replay_position(5, 100));
+    set.put(replay_position(7, 200));
+    BOOST_CHECK(set.has_positions_before(replay_position(6, 0)));
+    BOOST_CHECK(set.has_positions_before(replay_position(5, 1)));
+    BOOST_CHECK(!set.has_positions_before(replay_position(5, 0)));
+    BOOST_CHECK(!set.has_positions_before(replay_position(4, 1000)));
+
+    return make_ready_future<>();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
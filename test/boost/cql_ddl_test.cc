@@ -12,6 +12,7 @@
 #undef SEASTAR_TESTING_MAIN
 #include <seastar/testing/test_case.hh>
 
+#include "exceptions/exceptions.hh"
 #include "test/lib/cql_test_env.hh"
 
 BOOST_AUTO_TEST_SUITE(cql_ddl_test)
@@ -76,4 +77,19 @@ SEASTAR_TEST_CASE(test_writes_with_caching_enabled) {
     return writes_with_caching_toggle(true);
 }
 
+// Frequency-based admission can't be enabled before the whole cluster supports it.
+SEASTAR_TEST_CASE(test_frequency_admission_requires_feature) {
+    cql_test_config cfg;
+    cfg.disabled_features.insert("ROW_CACHE_FREQUENCY_ADMISSION");
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        BOOST_REQUIRE_THROW(e.execute_cql("CREATE TABLE ks.tbl (pk int PRIMARY KEY, v text) WITH CACHING = {'admission': 'FREQUENCY'}").get(),
+                exceptions::configuration_exception);
+        e.execute_cql("CREATE TABLE ks.tbl (pk int PRIMARY KEY, v text)").get();
+        BOOST_REQUIRE_THROW(e.execute_cql("ALTER TABLE ks.tbl WITH CACHING = {'admission': 'FREQUENCY'}").get(),
+                exceptions::configuration_exception);
+        e.execute_cql("ALTER TABLE ks.tbl WITH CACHING = {'admission': 'ALL'}").get();
+        BOOST_REQUIRE(!e.local_db().find_schema("ks", "tbl")->caching_options().frequency_admission());
+    }, cfg);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
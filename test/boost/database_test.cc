@@ -25,6 +25,7 @@
 #include <fmt/std.h>
 
 #include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
 #include "test/lib/result_set_assertions.hh"
 #include "test/lib/log.hh"
 #include "test/lib/random_utils.hh"
@@ -32,6 +33,7 @@
 #include "test/lib/test_utils.hh"
 #include "test/lib/key_utils.hh"
 #include "test/lib/eventually.hh"
+#include "test/boost/sstable_test.hh"
 
 #include "replica/database.hh"
 #include "utils/assert.hh"
@@ -290,6 +292,69 @@ SEASTAR_TEST_CASE(test_querying_with_limits) {
     });
 }
 
+// Multi-partition queries read the next partitions ahead, see query_prefetch_partitions.
+// Check that this doesn't change what is returned, including when the query
+// stops early on a limit, and that read-ahead stays within the limit instead
+// of reading partitions the query doesn't reach.
+SEASTAR_TEST_CASE(test_querying_multiple_partitions_with_prefetch) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (k int, v int, primary key (k));").get();
+        constexpr int nr_keys = 100;
+        std::vector<std::vector<bytes_opt>> expected;
+        for (int i = 0; i < nr_keys; ++i) {
+            e.execute_cql(format("insert into ks.cf (k, v) values ({}, {});", i, i * 10)).get();
+            expected.push_back({int32_type->decompose(i), int32_type->decompose(i * 10)});
+        }
+        e.db().invoke_on_all([] (replica::database& db) {
+            return db.find_column_family("ks", "cf").flush();
+        }).get();
+
+        struct prefetch_stats {
+            uint64_t prefetched = 0;
+            uint64_t dropped = 0;
+        };
+        auto get_prefetch_stats = [&] {
+            return e.db().map_reduce0(
+                [] (replica::database& db) {
+                    auto& stats = db.find_column_family("ks", "cf").get_stats();
+                    return prefetch_stats{stats.query_prefetched_ranges, stats.query_prefetched_ranges_dropped};
+                },
+                prefetch_stats{},
+                [] (prefetch_stats a, prefetch_stats b) {
+                    return prefetch_stats{a.prefetched + b.prefetched, a.dropped + b.dropped};
+                }
+            ).get();
+        };
+
+        auto keys = fmt::format("{}", fmt::join(std::views::iota(0, nr_keys), ", "));
+        for (auto prefetch : {"0", "1", "16", "1000"}) {
+            testlog.info("query_prefetch_partitions={}", prefetch);
+            e.db_config().query_prefetch_partitions.set_value_on_all_shards(prefetch, utils::config_file::config_source::API).get();
+
+            auto before = get_prefetch_stats();
+            assert_that(e.execute_cql(format("select k, v from ks.cf where k in ({});", keys)).get())
+                .is_rows().with_rows_ignore_order(expected);
+            auto after = get_prefetch_stats();
+            if (prefetch == std::string_view("0")) {
+                BOOST_REQUIRE_EQUAL(after.prefetched, before.prefetched);
+            } else {
+                BOOST_REQUIRE_GT(after.prefetched, before.prefetched);
+            }
+            BOOST_REQUIRE_EQUAL(after.dropped, before.dropped);
+
+            // Every key has a row, so no partition is read ahead past the limit.
+            assert_that(e.execute_cql(format("select k, v from ks.cf where k in ({}) limit 7;", keys)).get())
+                .is_rows().with_size(7);
+            auto after_limit = get_prefetch_stats();
+            BOOST_REQUIRE_EQUAL(after_limit.dropped, after.dropped);
+
+            assert_that(e.execute_cql(format("select k, v from ks.cf where k in ({}, {});", keys, nr_keys + 1)).get())
+                .is_rows().with_rows_ignore_order(expected);
+            BOOST_REQUIRE_EQUAL(get_prefetch_stats().dropped, after.dropped);
+        }
+    });
+}
+
 static void test_database(void (*run_tests)(populate_fn_ex, bool)) {
     do_with_cql_env_thread([run_tests] (cql_test_env& e) {
         run_tests([&] (schema_ptr s, const utils::chunked_vector<mutation>& partitions, gc_clock::time_point) -> mutation_source {
@@ -2436,4 +2501,84 @@ SEASTAR_TEST_CASE(replica_read_timeout_no_exception) {
     }, cfg);
 }
 
+// A flush requested by the commitlog to release its segments before a
+// position must flush only the compaction groups holding data in them.
+SEASTAR_TEST_CASE(test_commitlog_flush_of_compaction_groups_pinning_segments) {
+    cql_test_config cfg;
+    cfg.db_config->tablets_mode_for_new_keyspaces(db::tablets_mode_t::mode::enabled);
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE KEYSPACE ks WITH REPLICATION = {'class': 'NetworkTopologyStrategy', 'replication_factor': 1}"
+                " AND tablets = {'initial': 1};").get();
+        e.execute_cql("CREATE TABLE ks.cf (pk int PRIMARY KEY, v int);").get();
+        auto s = e.local_db().find_schema("ks", "cf");
+        auto token_of = [&] (int pk) {
+            return dht::decorate_key(*s, partition_key::from_single_value(*s, int32_type->decompose(pk))).token();
+        };
+        const auto shard = e.local_db().find_column_family(s).shard_for_reads(token_of(0));
+
+        // Split the compaction group of the only tablet, so that the table
+        // has two, and find a key in each.
+        auto keys = smp::submit_to(shard, [&] {
+            return seastar::async([&] {
+                auto& t = e.local_db().find_column_family(s);
+                column_family_test::get_storage_group_manager(t)->split_all_storage_groups(tasks::task_info{}).get();
+                auto& cg0 = column_family_test::compaction_group_for_token(t, token_of(0));
+                for (int pk = 1; ; ++pk) {
+                    if (&column_family_test::compaction_group_for_token(t, token_of(pk)) != &cg0) {
+                        return std::pair(0, pk);
+                    }
+                }
+            });
+        }).get();
+
+        auto on_shard = [&] (auto func) {
+            return smp::submit_to(shard, [&] {
+                return seastar::async([&] {
+                    return func(e.local_db(), e.local_db().find_column_family(s), *e.local_db().commitlog());
+                });
+            }).get();
+        };
+
+        // Start with all data flushed, then write the first key to its own segment.
+        auto old_segment = on_shard([] (replica::database& db, replica::table&, db::commitlog& cl) {
+            db.flush_all_memtables().get();
+            cl.force_new_active_segment().get();
+            return cl.current_position().id;
+        });
+        e.execute_cql(format("INSERT INTO ks.cf (pk, v) VALUES ({}, 0);", keys.first)).get();
+        auto rp = on_shard([&] (replica::database&, replica::table&, db::commitlog& cl) {
+            BOOST_REQUIRE_EQUAL(cl.current_position().id, old_segment);
+            cl.force_new_active_segment().get();
+            return db::replay_position(cl.current_position().id, 0);
+        });
+        BOOST_REQUIRE(rp > db::replay_position(old_segment, 0));
+        e.execute_cql(format("INSERT INTO ks.cf (pk, v) VALUES ({}, 0);", keys.second)).get();
+
+        on_shard([&] (replica::database&, replica::table& t, db::commitlog& cl) {
+            auto& old_cg = column_family_test::compaction_group_for_token(t, token_of(keys.first));
+            auto& new_cg = column_family_test::compaction_group_for_token(t, token_of(keys.second));
+            BOOST_REQUIRE(old_cg.has_commitlog_data_before(rp));
+            BOOST_REQUIRE(!new_cg.has_commitlog_data_before(rp));
+            auto new_cg_data = db::replay_position(rp.id + 1, 0);
+            BOOST_REQUIRE(new_cg.has_commitlog_data_before(new_cg_data));
+
+            t.flush(rp).get();
+
+            BOOST_REQUIRE(!old_cg.has_commitlog_data_before(new_cg_data));
+            BOOST_REQUIRE(new_cg.has_commitlog_data_before(new_cg_data));
+            BOOST_REQUIRE(column_family_test::flush_rp(t) >= rp);
+
+            // Nothing else uses the old segment, so it is released.
+            auto old_segment_name = db::commitlog::descriptor(db::replay_position(old_segment, 0)).filename();
+            REQUIRE_EVENTUALLY_EQUAL<bool>([&] {
+                return std::ranges::none_of(cl.get_active_segment_names(), [&] (const sstring& name) {
+                    return name.ends_with(old_segment_name);
+                });
+            }, true);
+        });
+
+        assert_that(e.execute_cql("SELECT pk FROM ks.cf;").get()).is_rows().with_size(2);
+    }, std::move(cfg));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include "utils/frequency_sketch.hh"
+
+BOOST_AUTO_TEST_CASE(test_frequency_is_counted_and_saturates) {
+    utils::frequency_sketch sketch(1000);
+    const uint64_t hot = 42;
+
+    BOOST_REQUIRE_EQUAL(sketch.frequency(hot), 0);
+    for (unsigned i = 1; i <= 10; ++i) {
+        sketch.increment(hot);
+        // Count-min sketches may only overestimate.
+        BOOST_REQUIRE_GE(sketch.frequency(hot), i);
+    }
+    for (unsigned i = 0; i < 20; ++i) {
+        sketch.increment(hot);
+    }
+    BOOST_REQUIRE_EQUAL(sketch.frequency(hot), 15);
+
+    unsigned others = 0;
+    for (uint64_t h = 1000; h < 1100; ++h) {
+        others += sketch.frequency(h);
+    }
+    BOOST_REQUIRE_LT(others, 100);
+}
+
+BOOST_AUTO_TEST_CASE(test_frequency_is_aged) {
+    utils::frequency_sketch sketch(1000);
+    const uint64_t hot = 42;
+
+    for (unsigned i = 0; i < 15; ++i) {
+        sketch.increment(hot);
+    }
+    BOOST_REQUIRE_EQUAL(sketch.frequency(hot), 15);
+
+    // Aging starts once sample_size() accesses were recorded, and halves
+    // the table a few words per access.
+    const auto max_accesses = sketch.sample_size() + sketch.memory_usage() / sizeof(uint64_t);
+    bool aged = false;
+    for (uint64_t h = 1; !aged; ++h) {
+        BOOST_REQUIRE_LE(h, max_accesses);
+        aged = sketch.increment(h << 20);
+    }
+    BOOST_REQUIRE_LE(sketch.frequency(hot), 7);
+    BOOST_REQUIRE_GE(sketch.frequency(hot), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_usage_is_bounded) {
+    utils::frequency_sketch small(0);
+    BOOST_REQUIRE_EQUAL(small.memory_usage(), 16 * sizeof(uint64_t));
+
+    utils::frequency_sketch sketch(1 << 20);
+    BOOST_REQUIRE_LE(sketch.memory_usage(), (1 << 20) * sizeof(uint64_t) / 4);
+    BOOST_REQUIRE_EQUAL(sketch.sample_size(), 10 << 20);
+}
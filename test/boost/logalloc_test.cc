@@ -521,6 +521,140 @@ SEASTAR_TEST_CASE(test_zone_reclaiming_preserves_free_size) {
     });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_huge_page_statistics) {
+    auto check_stats = [] {
+        auto stats = logalloc::shard_tracker().huge_page_statistics();
+        testlog.info("owned_segments = {}, fully_owned_huge_pages = {}, partially_owned_huge_pages = {}",
+                stats.owned_segments, stats.fully_owned_huge_pages, stats.partially_owned_huge_pages);
+        BOOST_REQUIRE_LE(stats.fully_owned_huge_pages, stats.owned_segments);
+        BOOST_REQUIRE_LE(stats.partially_owned_huge_pages, stats.owned_segments);
+        BOOST_REQUIRE_LE(stats.owned_segments, (stats.fully_owned_huge_pages + stats.partially_owned_huge_pages) * segments_per_huge_page);
+        return stats;
+    };
+
+    logalloc::shard_tracker().reclaim_all_free_segments();
+    auto initial = check_stats();
+
+    region r;
+    with_allocator(r.allocator(), [&] {
+        chunked_fifo<managed_bytes> objs;
+        while (logalloc::shard_tracker().region_occupancy().used_space() < 4 * huge_page_size) {
+            objs.emplace_back(managed_bytes(managed_bytes::initialized_later(), 1024));
+        }
+        auto filled = check_stats();
+        BOOST_REQUIRE_GE(filled.owned_segments, initial.owned_segments);
+        BOOST_REQUIRE_GE(filled.owned_segments, 4 * segments_per_huge_page);
+
+        objs.clear();
+        logalloc::shard_tracker().reclaim_all_free_segments();
+        auto released = check_stats();
+        BOOST_REQUIRE_LT(released.owned_segments, filled.owned_segments);
+    });
+}
+
+// A reclaim whose target ends in the middle of a huge page releases the
+// rest of its free segments too, so that the page isn't left shared with
+// the general allocator.
+SEASTAR_THREAD_TEST_CASE(test_reclaim_releases_whole_huge_pages) {
+    logalloc::shard_tracker().reclaim_all_free_segments();
+
+    {
+        region r;
+        with_allocator(r.allocator(), [&] {
+            chunked_fifo<managed_bytes> objs;
+            while (logalloc::shard_tracker().region_occupancy().used_space() < 4 * huge_page_size) {
+                objs.emplace_back(managed_bytes(managed_bytes::initialized_later(), 1024));
+            }
+        });
+    }
+    // All the segments of the region are free now, and stay owned by LSA.
+    auto before = logalloc::shard_tracker().huge_page_statistics();
+    BOOST_REQUIRE_GE(before.fully_owned_huge_pages, 3);
+
+    const size_t target = segments_per_huge_page / 2;
+    BOOST_REQUIRE_GE(logalloc::shard_tracker().reclaim(target * segment_size), target * segment_size);
+    auto after = logalloc::shard_tracker().huge_page_statistics();
+    testlog.info("before: owned_segments = {}, fully_owned_huge_pages = {}, partially_owned_huge_pages = {}",
+            before.owned_segments, before.fully_owned_huge_pages, before.partially_owned_huge_pages);
+    testlog.info("after: owned_segments = {}, fully_owned_huge_pages = {}, partially_owned_huge_pages = {}",
+            after.owned_segments, after.fully_owned_huge_pages, after.partially_owned_huge_pages);
+
+    // The reclaim went on past the target, up to the end of a huge page,
+    // but not into the next one.
+    const auto released = before.owned_segments - after.owned_segments;
+    BOOST_REQUIRE_GT(released, target);
+    BOOST_REQUIRE_LT(released, target + segments_per_huge_page);
+    // Released huge pages are released whole.
+    BOOST_REQUIRE_LE(after.partially_owned_huge_pages, before.partially_owned_huge_pages);
+    BOOST_REQUIRE_LT(after.fully_owned_huge_pages + after.partially_owned_huge_pages,
+            before.fully_owned_huge_pages + before.partially_owned_huge_pages);
+    BOOST_REQUIRE_GE(after.fully_owned_huge_pages, before.fully_owned_huge_pages - 1);
+
+    logalloc::shard_tracker().reclaim_all_free_segments();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_sync_reclaim_stalls_are_recorded) {
+    auto before = logalloc::shard_tracker().sync_reclaim_stalls().count();
+    logalloc::shard_tracker().reclaim_all_free_segments();
+    BOOST_REQUIRE_GT(logalloc::shard_tracker().sync_reclaim_stalls().count(), before);
+
+    // Preemptible reclaims don't stall the allocating task.
+    before = logalloc::shard_tracker().sync_reclaim_stalls().count();
+    logalloc::shard_tracker().compact_and_evict(0, logalloc::segment_size, is_preemptible::yes);
+    BOOST_REQUIRE_EQUAL(logalloc::shard_tracker().sync_reclaim_stalls().count(), before);
+}
+
+SEASTAR_TEST_CASE(test_background_reclaim_threshold) {
+    constexpr size_t min = 1000;
+    constexpr size_t max = 10000;
+    constexpr auto period = 1s;
+
+    // Without a lead time, the threshold stays at the minimum.
+    {
+        background_reclaim_threshold t(min, max, 0ms, 0);
+        t.update(1'000'000, period);
+        BOOST_REQUIRE_EQUAL(t.allocation_rate(), 1'000'000);
+        BOOST_REQUIRE_EQUAL(t.get(), min);
+    }
+
+    background_reclaim_threshold t(min, max, 100ms, 0);
+    BOOST_REQUIRE_EQUAL(t.get(), min);
+
+    // Follows the rate, with the lead time's worth of allocations.
+    t.update(50'000, period);
+    BOOST_REQUIRE_EQUAL(t.allocation_rate(), 50'000);
+    BOOST_REQUIRE_EQUAL(t.get(), 5000);
+
+    // Without allocations, the rate decays rather than dropping to 0.
+    t.update(50'000, period);
+    BOOST_REQUIRE_EQUAL(t.allocation_rate(), 45'000);
+    BOOST_REQUIRE_EQUAL(t.get(), 4500);
+
+    // A slower rate doesn't undercut the decaying peak.
+    t.update(60'000, period);
+    BOOST_REQUIRE_EQUAL(t.allocation_rate(), 40'500);
+
+    // Bursts are followed immediately, up to the maximum.
+    t.update(1'060'000, period);
+    BOOST_REQUIRE_EQUAL(t.allocation_rate(), 1'000'000);
+    BOOST_REQUIRE_EQUAL(t.get(), max);
+
+    // And forgotten slowly, down to the minimum.
+    t.update(1'060'000, period);
+    BOOST_REQUIRE_EQUAL(t.get(), max);
+    for (int i = 0; i < 100; ++i) {
+        t.update(1'060'000, period);
+        BOOST_REQUIRE_GE(t.get(), min);
+    }
+    BOOST_REQUIRE_EQUAL(t.get(), min);
+
+    // The rate is relative to the period.
+    t.update(1'061'000, 10ms);
+    BOOST_REQUIRE_EQUAL(t.allocation_rate(), 100'000);
+    BOOST_REQUIRE_EQUAL(t.get(), max);
+    return make_ready_future<>();
+}
+
 // Tests the intended usage of hold_reserve.
 //
 // Sets up a reserve, exhausts memory, opens the reserve,
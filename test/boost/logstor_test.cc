@@ -8,21 +8,30 @@
 #include <boost/test/unit_test.hpp>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <ranges>
 #include <vector>
 #include <seastar/core/temporary_buffer.hh>
 #include <seastar/util/memory-data-source.hh>
 #include <seastar/util/defer.hh>
+#include <seastar/util/file.hh>
 
+#include "replica/logstor/compaction.hh"
 #include "replica/logstor/ondisk.hh"
 #include "replica/logstor/write_buffer.hh"
 #include <seastar/testing/thread_test_case.hh>
 
 #include "idl/logstor.dist.hh"
 #include "idl/logstor.dist.impl.hh"
+#include "replica/logstor/index.hh"
+#include "replica/logstor/index_checkpoint.hh"
+#include "replica/logstor/record_cache.hh"
 #include "replica/logstor/segment_io.hh"
 #include "schema/schema_builder.hh"
+#include "db/cache_tracker.hh"
 #include <seastar/core/simple-stream.hh>
 #include "test/lib/mutation_assertions.hh"
+#include "test/lib/tmpdir.hh"
 
 using namespace replica::logstor;
 
@@ -135,6 +144,50 @@ rewritten_stream_result rewrite_streamed_segment(log_segment_id segment_id, segm
     return rewritten_stream_result{.data = std::move(out), .write_count = write_count};
 }
 
+index_checkpoint_chunk make_checkpoint_chunk(schema_ptr schema, size_t first, size_t count) {
+    index_checkpoint_chunk chunk{.table = schema->id()};
+    for (size_t i = first; i < first + count; ++i) {
+        auto m = make_kv_mutation(schema, fmt::format("pk{}", i), "v");
+        chunk.entries.push_back(index_checkpoint_entry{
+            .key = primary_index_key{m.decorated_key()},
+            .entry = index_entry{
+                .location = log_location{log_segment_id(i % 7), uint32_t(i * 64), 64},
+                .timestamp = api::timestamp_type(i),
+            },
+            .segment_seq = segment_sequence(100 + i % 7),
+        });
+    }
+    return chunk;
+}
+
+void write_checkpoint(const std::filesystem::path& path, size_t segment_size, segment_sequence watermark, const std::vector<index_checkpoint_chunk>& chunks) {
+    auto w = index_checkpoint_writer::create(path, segment_size, watermark).get();
+    for (const auto& chunk : chunks) {
+        w.write(chunk).get();
+    }
+    w.commit().get();
+}
+
+std::vector<index_checkpoint_chunk> read_checkpoint(const std::filesystem::path& path, size_t segment_size) {
+    auto r = index_checkpoint_reader::open(path, segment_size).get();
+    auto close_reader = defer([&r] { r.close().get(); });
+    std::vector<index_checkpoint_chunk> chunks;
+    while (auto chunk = r.read_chunk().get()) {
+        chunks.push_back(std::move(*chunk));
+    }
+    return chunks;
+}
+
+void modify_file(const std::filesystem::path& path, std::function<void(sstring&)> modify) {
+    auto content = seastar::util::read_entire_file_contiguous(path).get();
+    modify(content);
+    auto f = open_file_dma(path.native(), open_flags::wo | open_flags::truncate).get();
+    auto out = make_file_output_stream(std::move(f)).get();
+    out.write(content.data(), content.size()).get();
+    out.flush().get();
+    out.close().get();
+}
+
 }
 
 // Checks that sealing a full raw write buffer writes the expected header fields.
@@ -604,3 +657,450 @@ SEASTAR_THREAD_TEST_CASE(test_logstor_streamed_segment_rewriter_rejects_truncate
 
     BOOST_REQUIRE_THROW(rewrite_streamed_segment(log_segment_id{41}, segment_sequence{341}, std::span(&truncated, 1)), std::runtime_error);
 }
+
+// Checks that index checkpoint entries are read back as written, with the watermark.
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_checkpoint_round_trip) {
+    auto schema = make_kv_schema();
+    tmpdir tmp;
+    auto path = tmp.path() / "ls_0-Index.db";
+
+    std::vector<index_checkpoint_chunk> chunks{make_checkpoint_chunk(schema, 0, 1000), make_checkpoint_chunk(schema, 1000, 1)};
+    write_checkpoint(path, 128 * 1024, segment_sequence(107), chunks);
+
+    auto r = index_checkpoint_reader::open(path, 128 * 1024).get();
+    BOOST_REQUIRE_EQUAL(r.watermark().value, 107u);
+    r.close().get();
+
+    auto read = read_checkpoint(path, 128 * 1024);
+    BOOST_REQUIRE_EQUAL(read.size(), chunks.size());
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        BOOST_REQUIRE_EQUAL(read[c].table, schema->id());
+        BOOST_REQUIRE_EQUAL(read[c].entries.size(), chunks[c].entries.size());
+        for (size_t i = 0; i < chunks[c].entries.size(); ++i) {
+            const auto& expected = chunks[c].entries[i];
+            const auto& actual = read[c].entries[i];
+            BOOST_REQUIRE(actual.key.dk.equal(*schema, expected.key.dk));
+            BOOST_REQUIRE(actual.entry == expected.entry);
+            BOOST_REQUIRE_EQUAL(actual.segment_seq.value, expected.segment_seq.value);
+        }
+    }
+
+    // A new checkpoint replaces the previous one, an aborted one doesn't.
+    write_checkpoint(path, 128 * 1024, segment_sequence(108), {make_checkpoint_chunk(schema, 0, 3)});
+    auto w = index_checkpoint_writer::create(path, 128 * 1024, segment_sequence(109)).get();
+    w.write(make_checkpoint_chunk(schema, 0, 5)).get();
+    w.abort().get();
+
+    read = read_checkpoint(path, 128 * 1024);
+    BOOST_REQUIRE_EQUAL(read.size(), 1u);
+    BOOST_REQUIRE_EQUAL(read[0].entries.size(), 3u);
+    BOOST_REQUIRE(!file_exists((tmp.path() / "ls_0-Index.db.tmp").native()).get());
+}
+
+// Checks that corrupted, truncated or incompatible index checkpoints are rejected.
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_checkpoint_rejects_corruption) {
+    auto schema = make_kv_schema();
+    tmpdir tmp;
+    auto path = tmp.path() / "ls_0-Index.db";
+
+    write_checkpoint(path, 128 * 1024, segment_sequence(107), {make_checkpoint_chunk(schema, 0, 100), make_checkpoint_chunk(schema, 100, 100)});
+    auto size = seastar::util::read_entire_file_contiguous(path).get().size();
+
+    BOOST_REQUIRE_THROW(index_checkpoint_reader::open(path, 64 * 1024).get(), std::runtime_error);
+
+    modify_file(path, [] (sstring& content) { content[20] ^= 1; });
+    BOOST_REQUIRE_THROW(index_checkpoint_reader::open(path, 128 * 1024).get(), std::runtime_error);
+    modify_file(path, [] (sstring& content) { content[20] ^= 1; });
+
+    modify_file(path, [size] (sstring& content) { content[size / 2] ^= 1; });
+    BOOST_REQUIRE_THROW(read_checkpoint(path, 128 * 1024), std::runtime_error);
+    modify_file(path, [size] (sstring& content) { content[size / 2] ^= 1; });
+    BOOST_REQUIRE_EQUAL(read_checkpoint(path, 128 * 1024).size(), 2u);
+
+    // Without the end marker.
+    modify_file(path, [] (sstring& content) { content.resize(content.size() - 8); });
+    BOOST_REQUIRE_THROW(read_checkpoint(path, 128 * 1024), std::runtime_error);
+}
+
+// Checks that a compact index finds, updates and erases the same entries as a
+// full one, in less memory.
+SEASTAR_THREAD_TEST_CASE(test_logstor_compact_primary_index) {
+    auto schema = make_kv_schema();
+    primary_index full(schema);
+    primary_index compact(schema, true);
+    BOOST_REQUIRE(compact.is_compact());
+
+    std::vector<dht::decorated_key> keys;
+    auto location_of = [] (size_t i) { return log_location{log_segment_id(i), 0, 64}; };
+    for (size_t i = 0; i < 1000; ++i) {
+        keys.push_back(make_kv_mutation(schema, fmt::format("a-somewhat-long-partition-key-{}", i), "v").decorated_key());
+        for (auto* index : {&full, &compact}) {
+            auto res = index->insert(primary_index_key{keys.back()}, index_entry{.location = location_of(i), .timestamp = api::timestamp_type(i)});
+            BOOST_REQUIRE(res.inserted && !res.prev_entry);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(compact.get_key_count(), keys.size());
+    BOOST_REQUIRE_LT(compact.get_memory_usage(), full.get_memory_usage());
+    for (const auto& dk : keys) {
+        BOOST_REQUIRE(compact.get(primary_index_key{dk}) == full.get(primary_index_key{dk}));
+    }
+
+    // An older entry doesn't replace a newer one.
+    auto res = compact.insert(primary_index_key{keys[0]}, index_entry{.location = location_of(5000), .timestamp = api::timestamp_type(-1)});
+    BOOST_REQUIRE(!res.inserted);
+    BOOST_REQUIRE(res.prev_entry->location == location_of(0));
+
+    BOOST_REQUIRE(compact.update_record_location(primary_index_key{keys[1]}, location_of(1), location_of(5001)));
+    BOOST_REQUIRE(!compact.is_record_alive(primary_index_key{keys[1]}, location_of(1)));
+    BOOST_REQUIRE(compact.is_record_alive(primary_index_key{keys[1]}, location_of(5001)));
+
+    BOOST_REQUIRE(!compact.erase(primary_index_key{keys[2]}, location_of(3)));
+    BOOST_REQUIRE(compact.erase(primary_index_key{keys[2]}, location_of(2)));
+    BOOST_REQUIRE(!compact.get(primary_index_key{keys[2]}));
+
+    // The key of a record is verified only in compact mode.
+    log_record_header other{.key = primary_index_key{keys[3]}, .timestamp = 0, .table = schema->id()};
+    BOOST_REQUIRE(!compact.verify_key(primary_index_key{keys[4]}, other));
+    BOOST_REQUIRE(compact.verify_key(primary_index_key{keys[3]}, other));
+    BOOST_REQUIRE(full.verify_key(primary_index_key{keys[4]}, other));
+
+    // Iteration resumes from a position, in token order.
+    std::vector<int64_t> tokens;
+    std::optional<primary_index::position> pos;
+    do {
+        pos = compact.visit_after(pos, 100, [&] (const primary_index::entry_view& v) {
+            BOOST_REQUIRE(!v.key);
+            tokens.push_back(v.compact_key.token);
+        });
+    } while (pos);
+    BOOST_REQUIRE_EQUAL(tokens.size(), keys.size() - 1);
+    BOOST_REQUIRE(std::ranges::is_sorted(tokens));
+
+    auto entries = compact.token_entries(compact_index_key::from(keys[5]));
+    BOOST_REQUIRE(entries);
+    BOOST_REQUIRE_EQUAL(entries->first, keys[5].token().raw());
+    BOOST_REQUIRE_EQUAL(entries->second.size(), 1u);
+    BOOST_REQUIRE(entries->second[0].location == location_of(5));
+
+    auto mid = dht::token::from_int64(0);
+    compact.erase(dht::partition_range::make_ending_with({dht::ring_position::ending_at(mid), true})).get();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(bool(compact.get(primary_index_key{keys[i]})), i != 2 && keys[i].token() > mid);
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_delta_records) {
+    auto schema = make_kv_schema();
+    auto location_of = [] (size_t i) { return log_location{log_segment_id(i), 0, 64}; };
+    auto full_entry = [&] (size_t i, api::timestamp_type ts) { return index_entry{.location = location_of(i), .timestamp = ts}; };
+    auto delta_entry = [&] (size_t i, api::timestamp_type ts) { return index_entry{.location = location_of(i), .timestamp = ts, .delta = true}; };
+
+    for (bool compact_mode : {false, true}) {
+        primary_index index(schema, compact_mode);
+        primary_index_key key{make_kv_mutation(schema, "pk", "v").decorated_key()};
+
+        // A delta record of a key without a full record is its entry.
+        BOOST_REQUIRE(index.insert(key, delta_entry(1, 5)).inserted);
+        BOOST_REQUIRE(index.get(key)->delta);
+        BOOST_REQUIRE(!index.get_deltas(key));
+
+        // An older full record doesn't drop it.
+        auto res = index.insert(key, full_entry(2, 3));
+        BOOST_REQUIRE(res.inserted && !res.prev_entry && res.dropped_deltas.empty());
+        BOOST_REQUIRE(index.get(key) == full_entry(2, 3));
+        BOOST_REQUIRE_EQUAL(index.get_deltas(key)->size(), 1u);
+
+        // A delta record older than the full record is dropped.
+        BOOST_REQUIRE(!index.insert(key, delta_entry(3, 2)).inserted);
+        BOOST_REQUIRE(index.insert(key, delta_entry(4, 7)).inserted);
+        BOOST_REQUIRE_EQUAL(index.get_delta_count(), 2u);
+        BOOST_REQUIRE(index.is_record_alive(key, location_of(1)));
+        BOOST_REQUIRE(index.update_record_location(key, location_of(4), location_of(5)));
+        BOOST_REQUIRE(!index.is_record_alive(key, location_of(4)));
+
+        // A newer full record drops the older delta records.
+        res = index.insert(key, full_entry(6, 6));
+        BOOST_REQUIRE(res.inserted);
+        BOOST_REQUIRE(res.prev_entry == full_entry(2, 3));
+        BOOST_REQUIRE_EQUAL(res.dropped_deltas.size(), 1u);
+        BOOST_REQUIRE(res.dropped_deltas[0] == delta_entry(1, 5));
+        BOOST_REQUIRE_EQUAL(index.get_deltas(key)->size(), 1u);
+
+        size_t visited = 0;
+        std::optional<dht::decorated_key> pos;
+        do {
+            pos = index.visit_deltas_after(pos, 1, [&] (const dht::decorated_key& dk, const index_entry& e) {
+                BOOST_REQUIRE(dk.equal(*schema, key.dk));
+                BOOST_REQUIRE(e == delta_entry(5, 7));
+                ++visited;
+            });
+        } while (pos);
+        BOOST_REQUIRE_EQUAL(visited, 1u);
+
+        // A fold replaces the chain only if it didn't change since it was read.
+        auto base = *index.get(key);
+        auto deltas = *index.get_deltas(key);
+        BOOST_REQUIRE(index.insert(key, delta_entry(7, 8)).inserted);
+        auto fold_ts = primary_index::fold_timestamp(base, deltas);
+        BOOST_REQUIRE_EQUAL(fold_ts, 7);
+        BOOST_REQUIRE(!index.fold(key, full_entry(2, 3), deltas, full_entry(8, fold_ts)));
+        BOOST_REQUIRE(index.fold(key, base, deltas, full_entry(8, fold_ts)));
+        BOOST_REQUIRE(index.get(key) == full_entry(8, 7));
+        BOOST_REQUIRE_EQUAL(index.get_deltas(key)->size(), 1u);
+        BOOST_REQUIRE((*index.get_deltas(key))[0] == delta_entry(7, 8));
+
+        index.erase(dht::partition_range::make_open_ended_both_sides()).get();
+        BOOST_REQUIRE(index.empty());
+        BOOST_REQUIRE(!index.get_deltas(key));
+        BOOST_REQUIRE_EQUAL(index.get_delta_count(), 0u);
+    }
+}
+
+// Checks that a full record with a timestamp within the range of a folded
+// chain doesn't replace the folded record, which would lose the newer delta
+// records folded into it.
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_fold_keeps_newer_deltas) {
+    auto schema = make_kv_schema();
+    auto location_of = [] (size_t i) { return log_location{log_segment_id(i), 0, 64}; };
+    auto full_entry = [&] (size_t i, api::timestamp_type ts) { return index_entry{.location = location_of(i), .timestamp = ts}; };
+    auto delta_entry = [&] (size_t i, api::timestamp_type ts) { return index_entry{.location = location_of(i), .timestamp = ts, .delta = true}; };
+
+    for (bool compact_mode : {false, true}) {
+        primary_index index(schema, compact_mode);
+        primary_index_key key{make_kv_mutation(schema, "pk", "v").decorated_key()};
+
+        BOOST_REQUIRE(index.insert(key, full_entry(1, 10)).inserted);
+        BOOST_REQUIRE(index.insert(key, delta_entry(2, 20)).inserted);
+        BOOST_REQUIRE(index.insert(key, delta_entry(3, 30)).inserted);
+
+        auto base = *index.get(key);
+        auto deltas = *index.get_deltas(key);
+        auto fold_ts = primary_index::fold_timestamp(base, deltas);
+        BOOST_REQUIRE_EQUAL(fold_ts, 30);
+        BOOST_REQUIRE(index.fold(key, base, deltas, full_entry(4, fold_ts)));
+        BOOST_REQUIRE(!index.get_deltas(key));
+
+        auto res = index.insert(key, full_entry(5, 25));
+        BOOST_REQUIRE(!res.inserted);
+        BOOST_REQUIRE(res.prev_entry == full_entry(4, 30));
+        BOOST_REQUIRE(res.dropped_deltas.empty());
+        BOOST_REQUIRE(!index.insert(key, delta_entry(6, 25)).inserted);
+        BOOST_REQUIRE(index.get(key) == full_entry(4, 30));
+
+        // A fold fails if a delta record older than the folded record was
+        // inserted while the chain was read, since it would be dropped by the
+        // folded record on recovery.
+        BOOST_REQUIRE(index.insert(key, delta_entry(7, 40)).inserted);
+        base = *index.get(key);
+        deltas = *index.get_deltas(key);
+        BOOST_REQUIRE(index.insert(key, delta_entry(8, 35)).inserted);
+        BOOST_REQUIRE(!index.fold(key, base, deltas, full_entry(9, primary_index::fold_timestamp(base, deltas))));
+        BOOST_REQUIRE(index.get(key) == full_entry(4, 30));
+        BOOST_REQUIRE_EQUAL(index.get_deltas(key)->size(), 2u);
+    }
+}
+
+// Checks that erasing a range of the index drops the delta records of the
+// keys in the range only.
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_erase_range_with_deltas) {
+    auto schema = make_kv_schema();
+    primary_index index(schema);
+
+    constexpr size_t nr_keys = 1000;
+    std::vector<dht::decorated_key> keys;
+    for (size_t i = 0; i < nr_keys; ++i) {
+        auto key = make_kv_mutation(schema, fmt::format("pk{}", i), "v").decorated_key();
+        index.insert(primary_index_key{key}, index_entry{.location = log_location{log_segment_id(i), 0, 64}, .timestamp = 1});
+        index.insert(primary_index_key{key}, index_entry{.location = log_location{log_segment_id(i), 64, 64}, .timestamp = 2, .delta = true});
+        keys.push_back(std::move(key));
+    }
+    std::ranges::sort(keys, dht::decorated_key::less_comparator(schema));
+    BOOST_REQUIRE_EQUAL(index.get_delta_count(), nr_keys);
+
+    auto& mid = keys[nr_keys / 2];
+    index.erase(dht::partition_range::make_ending_with({dht::ring_position(mid), false})).get();
+    BOOST_REQUIRE_EQUAL(index.get_delta_count(), nr_keys - nr_keys / 2);
+    for (size_t i = 0; i < nr_keys; ++i) {
+        BOOST_REQUIRE_EQUAL(bool(index.get_deltas(primary_index_key{keys[i]})), i >= nr_keys / 2);
+    }
+}
+
+// Checks that compact index entries are saved in checkpoints.
+SEASTAR_THREAD_TEST_CASE(test_logstor_index_checkpoint_compact_entries) {
+    auto schema = make_kv_schema();
+    tmpdir tmp;
+    auto path = tmp.path() / "ls_0-Index.db";
+
+    auto chunk = make_checkpoint_chunk(schema, 0, 10);
+    for (const auto& e : chunk.entries) {
+        auto key = compact_index_key::from(e.key.dk);
+        chunk.compact_entries.push_back(compact_index_checkpoint_entry{
+            .token = key.token,
+            .fingerprint = key.fingerprint,
+            .entry = e.entry,
+            .segment_seq = e.segment_seq,
+        });
+    }
+    chunk.entries.clear();
+    write_checkpoint(path, 128 * 1024, segment_sequence(107), {chunk});
+
+    auto read = read_checkpoint(path, 128 * 1024);
+    BOOST_REQUIRE_EQUAL(read.size(), 1u);
+    BOOST_REQUIRE(read[0].entries.empty());
+    BOOST_REQUIRE_EQUAL(read[0].compact_entries.size(), chunk.compact_entries.size());
+    for (size_t i = 0; i < chunk.compact_entries.size(); ++i) {
+        const auto& expected = chunk.compact_entries[i];
+        const auto& actual = read[0].compact_entries[i];
+        BOOST_REQUIRE_EQUAL(actual.token, expected.token);
+        BOOST_REQUIRE_EQUAL(actual.fingerprint, expected.fingerprint);
+        BOOST_REQUIRE(actual.entry == expected.entry);
+        BOOST_REQUIRE_EQUAL(actual.segment_seq.value, expected.segment_seq.value);
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_logstor_record_cache) {
+    auto schema = make_kv_schema();
+    cache_tracker tracker;
+    record_cache cache(tracker.get_lru(), tracker.region(), utils::updateable_value<bool>(true));
+    auto table = schema->id();
+
+    auto r1 = make_log_record(schema, "k1", "v1", 1);
+    auto r2 = make_log_record(schema, "k2", "v2", 1);
+    const auto& k1 = r1.header.key.dk;
+    const auto& k2 = r2.header.key.dk;
+
+    BOOST_REQUIRE(!cache.lookup(table, k1, 1, 0));
+    cache.populate(r1, 0);
+    cache.populate(r2, 0);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().entries, 2);
+
+    auto hit = cache.lookup(table, k1, 1, 0);
+    BOOST_REQUIRE(hit);
+    BOOST_REQUIRE(hit->header.key.dk.equal(*schema, k1));
+    assert_that(hit->mut.to_mutation(schema)).is_equal_to(r1.mut.to_mutation(schema));
+    // Another table doesn't see the record.
+    BOOST_REQUIRE(!cache.lookup(table_id::create_random_id(), k1, 1, 0));
+
+    // A write replaces the cached record.
+    auto r1_new = make_log_record(schema, "k1", "v1-new", 2);
+    cache.update(r1_new);
+    hit = cache.lookup(table, k1, 2, 0);
+    BOOST_REQUIRE(hit);
+    assert_that(hit->mut.to_mutation(schema)).is_equal_to(r1_new.mut.to_mutation(schema));
+
+    // A record with a timestamp other than the index's one is stale, and removed.
+    BOOST_REQUIRE(!cache.lookup(table, k2, 2, 0));
+    BOOST_REQUIRE(!cache.contains(table, k2));
+    BOOST_REQUIRE_EQUAL(cache.get_stats().hits, 2);
+
+    // So is a record merged with another number of delta records.
+    cache.populate(r2, 1);
+    BOOST_REQUIRE(!cache.lookup(table, k2, 1, 2));
+    BOOST_REQUIRE(!cache.contains(table, k2));
+
+    cache.populate(r2, 0);
+    cache.invalidate(*schema, dht::partition_range::make_singular(k2)).get();
+    BOOST_REQUIRE(!cache.contains(table, k2));
+    BOOST_REQUIRE(cache.contains(table, k1));
+
+    // Records are evicted with the row cache.
+    tracker.clear();
+    BOOST_REQUIRE(!cache.contains(table, k1));
+    BOOST_REQUIRE_EQUAL(cache.get_stats().evictions, 1);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().entries, 0);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().used_bytes, 0);
+}
+
+namespace {
+
+constexpr size_t test_segment_size = 128 * 1024;
+
+// A segment with the given percentage of live data, whose data is
+// data_age segments old.
+struct test_segment {
+    segment_descriptor desc;
+    uint32_t id;
+    uint64_t data_age;
+    bool cold;
+
+    test_segment(uint32_t id, size_t live_percent, uint64_t data_age, bool cold)
+        : id(id), data_age(data_age), cold(cold)
+    {
+        desc.reset(test_segment_size);
+        desc.on_write(test_segment_size * live_percent / 100, 10);
+    }
+
+    compaction_candidate candidate(bool segregate) const {
+        return compaction_candidate{
+            .id = log_segment_id(id),
+            .desc = &desc,
+            .data_age = data_age,
+            .cold = segregate && cold,
+        };
+    }
+};
+
+std::vector<compaction_candidate> make_pool(const std::vector<std::unique_ptr<test_segment>>& segments, bool segregate) {
+    return segments
+            | std::views::transform([&] (const auto& s) { return s->candidate(segregate); })
+            | std::ranges::to<std::vector<compaction_candidate>>();
+}
+
+std::vector<uint32_t> victim_ids(const std::vector<compaction_candidate>& victims) {
+    return victims
+            | std::views::transform([] (const compaction_candidate& c) { return c.id.value; })
+            | std::ranges::to<std::vector<uint32_t>>();
+}
+
+} // anonymous namespace
+
+SEASTAR_THREAD_TEST_CASE(test_logstor_compaction_selects_emptiest_segments) {
+    std::vector<std::unique_ptr<test_segment>> segments;
+    segments.push_back(std::make_unique<test_segment>(1, 10, 1, false));
+    segments.push_back(std::make_unique<test_segment>(2, 20, 1, false));
+    segments.push_back(std::make_unique<test_segment>(3, 30, 1, false));
+    segments.push_back(std::make_unique<test_segment>(4, 90, 1, false));
+
+    // The live data of the first three segments fits in a single segment,
+    // while adding the fourth one doesn't free another one.
+    auto victims = select_compaction_victims(make_pool(segments, false), test_segment_size, 4, false);
+    BOOST_REQUIRE((victim_ids(victims) == std::vector<uint32_t>{1, 2, 3}));
+    for (const auto& v : victims) {
+        BOOST_REQUIRE_EQUAL(compaction_buffer_index(victims, v.id), 0);
+    }
+
+    victims = select_compaction_victims(make_pool(segments, false), test_segment_size, 2, false);
+    BOOST_REQUIRE((victim_ids(victims) == std::vector<uint32_t>{1, 2}));
+
+    // Compacting full segments frees nothing.
+    std::vector<std::unique_ptr<test_segment>> full;
+    full.push_back(std::make_unique<test_segment>(1, 95, 1, false));
+    full.push_back(std::make_unique<test_segment>(2, 95, 1, false));
+    BOOST_REQUIRE(select_compaction_victims(make_pool(full, false), test_segment_size, 4, false).empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_logstor_compaction_segregates_cold_segments) {
+    std::vector<std::unique_ptr<test_segment>> segments;
+    segments.push_back(std::make_unique<test_segment>(10, 20, 1, false));
+    segments.push_back(std::make_unique<test_segment>(11, 30, 1, false));
+    segments.push_back(std::make_unique<test_segment>(12, 50, 100, true));
+
+    // By free space alone, the fuller cold segment is left out.
+    auto victims = select_compaction_victims(make_pool(segments, false), test_segment_size, 3, false);
+    BOOST_REQUIRE((victim_ids(victims) == std::vector<uint32_t>{10, 11}));
+
+    // By cost-benefit, the cold segment goes first, as its data won't get
+    // overwritten by waiting, and its live records are rewritten apart from
+    // the hot ones.
+    victims = select_compaction_victims(make_pool(segments, true), test_segment_size, 3, true);
+    BOOST_REQUIRE((victim_ids(victims) == std::vector<uint32_t>{12, 10, 11}));
+    BOOST_REQUIRE_EQUAL(compaction_buffer_index(victims, log_segment_id(12)), 1);
+    BOOST_REQUIRE_EQUAL(compaction_buffer_index(victims, log_segment_id(10)), 0);
+    BOOST_REQUIRE_EQUAL(compaction_buffer_index(victims, log_segment_id(11)), 0);
+    BOOST_REQUIRE_EQUAL(compaction_buffer_index(victims, log_segment_id(13)), 0);
+
+    // Hot and cold records need a segment each, so a cold segment which
+    // doesn't fill one alone isn't worth compacting with a single hot one.
+    victims = select_compaction_victims(make_pool(segments, true), test_segment_size, 2, true);
+    BOOST_REQUIRE(victims.empty());
+}
@@ -353,6 +353,82 @@ SEASTAR_TEST_CASE(test_unspooled_dirty_accounting_on_flush) {
     });
 }
 
+SEASTAR_TEST_CASE(test_memtable_list_sub_ranges) {
+    return seastar::async([] {
+        schema_ptr s = schema_builder(this_smp_shard_count(), "ks", "cf")
+                .with_column("pk", bytes_type, column_kind::partition_key)
+                .with_column("col", bytes_type, column_kind::regular_column)
+                .build();
+
+        replica::dirty_memory_manager mgr;
+        replica::memtable_table_shared_data table_shared_data;
+        replica::table_stats tbl_stats;
+
+        std::vector<std::vector<replica::shared_memtable>> sealed;
+        auto seal = [&sealed] (replica::flush_permit&&, std::vector<replica::shared_memtable> memtables) {
+            sealed.push_back(std::move(memtables));
+            return make_ready_future<>();
+        };
+        constexpr unsigned sub_ranges_log2 = 2;
+        auto mtl = make_lw_shared<replica::memtable_list>(seal, [s] { return s; }, &mgr, table_shared_data, tbl_stats,
+                current_scheduling_group(), nullptr, sub_ranges_log2);
+        BOOST_REQUIRE_EQUAL(mtl->sub_ranges(), 4);
+        BOOST_REQUIRE_EQUAL(mtl->active_memtables().size(), 4);
+        BOOST_REQUIRE_EQUAL(mtl->size(), 4);
+
+        utils::chunked_vector<mutation> ring = make_ring(s, 64);
+        for (auto&& m : ring) {
+            m.set_clustered_cell(clustering_key::make_empty(), to_bytes("col"), data_value(bytes(bytes::initialized_later(), 1024)), next_timestamp());
+            auto& mt = mtl->active_memtable(m.token());
+            BOOST_REQUIRE_EQUAL(&mt, &mtl->active_memtable(*s, m.key()));
+            mt.apply(m);
+        }
+
+        // Each partition lands in the memtable of the sub-range owning its token.
+        size_t partitions = 0;
+        for (size_t i = 0; i < mtl->active_memtables().size(); ++i) {
+            auto& mt = mtl->active_memtables()[i];
+            BOOST_REQUIRE(!mt->empty());
+            partitions += mt->partition_count();
+        }
+        BOOST_REQUIRE_EQUAL(partitions, ring.size());
+        for (auto&& m : ring) {
+            auto i = dht::compaction_group_of(sub_ranges_log2, m.token());
+            BOOST_REQUIRE(mtl->active_memtables()[i]->contains_partition(m.decorated_key()));
+        }
+
+        // Sealing a single sub-range hands only its memtable to the seal function.
+        auto largest = *std::ranges::max_element(mtl->active_memtables(), std::less<>(), [] (const replica::shared_memtable& mt) {
+            return mt->occupancy().used_space();
+        });
+        mgr.flush_one(*mtl, mgr.get_flush_permit().get(), largest.get()).get();
+        BOOST_REQUIRE_EQUAL(sealed.size(), 1);
+        BOOST_REQUIRE_EQUAL(sealed.back().size(), 1);
+        BOOST_REQUIRE(sealed.back().front() == largest);
+
+        // Replacing the sealed memtable keeps the other sub-ranges active.
+        BOOST_REQUIRE(mtl->replace_active_memtable(largest));
+        BOOST_REQUIRE(!mtl->is_active(largest));
+        BOOST_REQUIRE(!mtl->replace_active_memtable(largest));
+        BOOST_REQUIRE_EQUAL(mtl->active_memtables().size(), 4);
+        BOOST_REQUIRE_EQUAL(mtl->size(), 5);
+        BOOST_REQUIRE_EQUAL(std::ranges::count_if(mtl->active_memtables(), std::mem_fn(&replica::memtable::empty)), 1);
+
+        // A memtable which is no longer active falls back to sealing all sub-ranges.
+        mgr.flush_one(*mtl, mgr.get_flush_permit().get(), largest.get()).get();
+        BOOST_REQUIRE_EQUAL(sealed.size(), 2);
+        BOOST_REQUIRE(sealed.back() == mtl->active_memtables());
+
+        mtl->erase(largest);
+        for (auto& mt : mtl->clear_and_add()) {
+            mt->clear_gently().get();
+        }
+        BOOST_REQUIRE_EQUAL(mtl->active_memtables().size(), 4);
+        BOOST_REQUIRE(mtl->empty());
+        largest->clear_gently().get();
+    });
+}
+
 // Reproducer for #1753
 SEASTAR_TEST_CASE(test_partition_version_consistency_after_lsa_compaction_happens) {
     return seastar::async([] {
@@ -2708,6 +2708,49 @@ SEASTAR_THREAD_TEST_CASE(test_cell_equals) {
     BOOST_REQUIRE(!c4.equals(*bytes_type, c1));
 }
 
+SEASTAR_THREAD_TEST_CASE(test_cell_inline_storage) {
+    auto now = gc_clock::now();
+    auto ttl = gc_clock::duration(3600);
+    auto s = schema_builder(this_smp_shard_count(), some_keyspace, some_column_family)
+            .with_column("pk", bytes_type, column_kind::partition_key)
+            .with_column("v", bytes_type)
+            .build();
+    auto& cdef = *s->get_column_definition(to_bytes("v"));
+
+    auto check = [&cdef] (atomic_cell ac) {
+        auto expected = atomic_cell_or_collection(atomic_cell(*bytes_type, ac));
+        auto size = atomic_cell_view(ac).serialize().size();
+        auto cell = atomic_cell_or_collection(std::move(ac));
+        // Cells of up to 23 bytes are stored without an external allocation.
+        BOOST_REQUIRE_EQUAL(cell.external_memory_usage(*bytes_type) == 0, size <= 23);
+        BOOST_REQUIRE(cell.equals(*bytes_type, expected));
+
+        auto copy = cell.copy(*bytes_type);
+        BOOST_REQUIRE(copy.equals(*bytes_type, cell));
+
+        auto moved = std::move(cell);
+        BOOST_REQUIRE(!cell);
+        BOOST_REQUIRE(moved.equals(*bytes_type, copy));
+
+        copy = std::move(moved);
+        BOOST_REQUIRE(!moved);
+        BOOST_REQUIRE(copy.equals(*bytes_type, expected));
+
+        copy.as_mutable_atomic_cell(cdef).set_timestamp(42);
+        BOOST_REQUIRE_EQUAL(copy.as_atomic_cell(cdef).timestamp(), 42);
+    };
+
+    for (size_t value_size : {0, 1, 4, 6, 7, 8, 14, 15, 16, 32, 1024}) {
+        check(atomic_cell::make_live(*bytes_type, 1, bytes(value_size, 'a')));
+        check(atomic_cell::make_live(*bytes_type, 1, bytes(value_size, 'a'), now + ttl, ttl));
+    }
+    check(atomic_cell::make_dead(1, now));
+    check(atomic_cell::make_live_counter_update(1, 2));
+
+    BOOST_REQUIRE(!atomic_cell_or_collection());
+    BOOST_REQUIRE(atomic_cell_or_collection().equals(*bytes_type, atomic_cell_or_collection()));
+}
+
 // Global to avoid elimination by the compiler; see below for use
 thread_local data_type force_type_thread_local_init_evaluation [[gnu::used]];
 
@@ -129,6 +129,48 @@ SEASTAR_THREAD_TEST_CASE(test_reader_concurrency_semaphore_destroyed_permit_rele
     BOOST_REQUIRE_EQUAL(semaphore.available_resources(), initial_resources);
 }
 
+SEASTAR_THREAD_TEST_CASE(test_reader_concurrency_semaphore_cached_buffers) {
+    const auto initial_resources = reader_concurrency_semaphore::resources{1, 1024 * 1024};
+    reader_concurrency_semaphore semaphore(reader_concurrency_semaphore::for_tests{}, get_name(), initial_resources.count, initial_resources.memory);
+    const size_t size = 32 * 1024;
+    auto make_buffer = [] (size_t size) { return std::unique_ptr<char[]>(new char[size]); };
+
+    // Kept buffers consume memory of the semaphore, up to a 16th of it.
+    semaphore.cache_buffer(make_buffer(size), size);
+    semaphore.cache_buffer(make_buffer(size), size);
+    BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), 2 * size);
+    BOOST_REQUIRE_EQUAL(semaphore.available_resources().memory, initial_resources.memory - 2 * size);
+    semaphore.cache_buffer(make_buffer(size), size);
+    semaphore.cache_buffer(make_buffer(1000), 1000);
+    BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), 2 * size);
+
+    BOOST_REQUIRE(semaphore.take_cached_buffer(size));
+    BOOST_REQUIRE(!semaphore.take_cached_buffer(size / 2));
+    BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), size);
+    BOOST_REQUIRE_EQUAL(semaphore.available_resources().memory, initial_resources.memory - size);
+
+    // Kept buffers are freed when a read has to wait, and none are kept while it does.
+    {
+        reader_permit_opt permit1 = semaphore.obtain_permit(nullptr, get_name(), 1024, db::no_timeout, {}).get();
+        auto permit2_fut = semaphore.obtain_permit(nullptr, get_name(), 1024, db::no_timeout, {});
+        BOOST_REQUIRE_EQUAL(semaphore.get_stats().waiters, 1);
+        BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), 0);
+        semaphore.cache_buffer(make_buffer(size), size);
+        BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), 0);
+        BOOST_REQUIRE_EQUAL(semaphore.available_resources().memory, initial_resources.memory - 1024);
+        permit1 = {};
+        permit2_fut.get();
+    }
+    BOOST_REQUIRE_EQUAL(semaphore.available_resources(), initial_resources);
+
+    // And when the semaphore is stopped.
+    semaphore.cache_buffer(make_buffer(size), size);
+    BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), size);
+    semaphore.stop().get();
+    BOOST_REQUIRE_EQUAL(semaphore.cached_buffer_bytes(), 0);
+    BOOST_REQUIRE_EQUAL(semaphore.available_resources(), initial_resources);
+}
+
 SEASTAR_THREAD_TEST_CASE(test_reader_concurrency_semaphore_abandoned_handle_closes_reader) {
     simple_schema s;
     reader_concurrency_semaphore semaphore(reader_concurrency_semaphore::no_limits{}, get_name(), reader_concurrency_semaphore::register_metrics::no);
@@ -856,6 +856,51 @@ SEASTAR_TEST_CASE(test_eviction) {
     });
 }
 
+SEASTAR_TEST_CASE(test_hottest_partitions) {
+    return seastar::async([] {
+        auto s = make_schema();
+        tests::reader_concurrency_semaphore_wrapper semaphore;
+        auto mt = make_lw_shared<replica::memtable>(s);
+
+        cache_tracker tracker;
+        row_cache cache(s, snapshot_source_from_snapshot(mt->as_data_source()), tracker);
+
+        std::vector<mutation> muts;
+        for (int i = 0; i < 10; i++) {
+            muts.push_back(make_new_mutation(s));
+            cache.populate(muts.back());
+        }
+
+        for (auto i : {3, 7}) {
+            auto pr = dht::partition_range::make_singular(muts[i].decorated_key());
+            assert_that(cache.make_reader(s, semaphore.make_permit(), pr))
+                .produces(muts[i])
+                .produces_end_of_stream();
+        }
+
+        auto hot = tracker.hottest_partitions(2, 1000).get();
+        BOOST_REQUIRE_EQUAL(hot.size(), 2);
+        BOOST_REQUIRE(hot[0].table == s->id());
+        BOOST_REQUIRE(hot[0].key.equal(*s, muts[7].decorated_key()));
+        BOOST_REQUIRE(hot[1].key.equal(*s, muts[3].decorated_key()));
+
+        // Every partition is reported once, no matter how many of its rows are cached.
+        BOOST_REQUIRE_EQUAL(tracker.hottest_partitions(100, 1000).get().size(), muts.size());
+
+        BOOST_REQUIRE(tracker.hottest_partitions(100, 0).get().empty());
+        BOOST_REQUIRE(tracker.hottest_partitions(0, 1000).get().empty());
+
+        // Walks spanning many batches see every partition, in LRU order.
+        for (int i = 0; i < 1000; i++) {
+            muts.push_back(make_new_mutation(s));
+            cache.populate(muts.back());
+        }
+        hot = tracker.hottest_partitions(10000, 100000).get();
+        BOOST_REQUIRE_EQUAL(hot.size(), muts.size());
+        BOOST_REQUIRE(hot[0].key.equal(*s, muts.back().decorated_key()));
+    });
+}
+
 #ifndef SEASTAR_DEFAULT_ALLOCATOR // Depends on eviction, which is absent with the std allocator
 
 SEASTAR_TEST_CASE(test_eviction_from_invalidated) {
@@ -5642,4 +5687,63 @@ SEASTAR_THREAD_TEST_CASE(test_cache_read_concurrent_to_nonpopulating_reader) {
         .produces_end_of_stream();
 }
 
+SEASTAR_THREAD_TEST_CASE(test_frequency_admission) {
+    auto s = schema_builder(make_schema())
+        .set_caching_options(caching_options::from_map({{"admission", "FREQUENCY"}}))
+        .build();
+    tests::reader_concurrency_semaphore_wrapper semaphore;
+
+    utils::chunked_vector<mutation> mutations = make_ring(s, 4);
+    auto mt = make_memtable(s, mutations).get();
+
+    cache_tracker tracker;
+    row_cache cache(s, snapshot_source_from_snapshot(mt->as_data_source()), tracker);
+
+    auto read = [&] (const dht::partition_range& pr, std::vector<mutation> expected) {
+        auto rd = assert_that(cache.make_reader(s, semaphore.make_permit(), pr));
+        for (auto& m : expected) {
+            rd.produces(m);
+        }
+        rd.produces_end_of_stream();
+    };
+    auto singular = [] (const mutation& m) {
+        return dht::partition_range::make_singular(m.decorated_key());
+    };
+    auto& stats = tracker.get_stats();
+
+    // Everything is admitted until cache starts evicting.
+    read(singular(mutations[0]), {mutations[0]});
+    BOOST_REQUIRE_EQUAL(stats.partitions, 1);
+    BOOST_REQUIRE_EQUAL(stats.partition_admissions, 1);
+
+    ++stats.row_evictions;
+
+    // A partition read for the first time is not admitted...
+    read(singular(mutations[1]), {mutations[1]});
+    BOOST_REQUIRE_EQUAL(stats.partitions, 1);
+    BOOST_REQUIRE_EQUAL(stats.partition_rejections, 1);
+
+    // ...but it is on the next read.
+    read(singular(mutations[1]), {mutations[1]});
+    BOOST_REQUIRE_EQUAL(stats.partitions, 2);
+    BOOST_REQUIRE_EQUAL(stats.partition_admissions, 2);
+
+    // A scan reads every partition, but populates only those accessed before.
+    auto rejections = stats.partition_rejections;
+    read(query::full_partition_range, {mutations.begin(), mutations.end()});
+    BOOST_REQUIRE_EQUAL(stats.partition_rejections, rejections + 2);
+    BOOST_REQUIRE_EQUAL(stats.partitions, 2);
+
+    // Tables without frequency admission populate everything.
+    auto s2 = make_schema();
+    auto mutations2 = make_ring(s2, 2);
+    auto mt2 = make_memtable(s2, mutations2).get();
+    row_cache cache2(s2, snapshot_source_from_snapshot(mt2->as_data_source()), tracker);
+    assert_that(cache2.make_reader(s2, semaphore.make_permit(), query::full_partition_range))
+        .produces(mutations2[0])
+        .produces(mutations2[1])
+        .produces_end_of_stream();
+    BOOST_REQUIRE_EQUAL(stats.partitions, 4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,8 +11,15 @@
 #include <seastar/util/defer.hh>
 #include <seastar/testing/thread_test_case.hh>
 #include "sstables/sstable_compressor_factory.hh"
+#include <seastar/core/shared_future.hh>
+#include "schema/schema_builder.hh"
+#include "test/lib/eventually.hh"
 #include "test/lib/log.hh"
+#include "test/lib/mutation_reader_assertions.hh"
 #include "test/lib/random_utils.hh"
+#include "test/lib/reader_concurrency_semaphore.hh"
+#include "test/lib/sstable_test_env.hh"
+#include "test/lib/sstable_utils.hh"
 #include "test/lib/test_utils.hh"
 
 BOOST_AUTO_TEST_SUITE(sstable_compressor_factory_test)
@@ -135,4 +142,151 @@ SEASTAR_THREAD_TEST_CASE(test_numa_awareness) {
     }
 }
 
+// Per-sstable dicts: the writer passes its own dict instead of the table's recommended one.
+SEASTAR_THREAD_TEST_CASE(test_compressor_for_writing_with_dict) {
+    sharded<default_sstable_compressor_factory> sstable_compressor_factory;
+    sstable_compressor_factory.start().get();
+    auto stop_compressor_factory = defer([&sstable_compressor_factory] { sstable_compressor_factory.stop().get(); });
+    auto& local = sstable_compressor_factory.local();
+
+    // Without a training function plugged in, there is no dict to use.
+    tests::require(local.train_dict({}, 1024).get().empty());
+
+    auto message = tests::random::get_sstring(4096);
+    auto dict_view = std::as_bytes(std::span(message));
+    for (const auto algo : {compressor::algorithm::lz4_with_dicts, compressor::algorithm::zstd_with_dicts}) {
+        auto params = compression_parameters(algo);
+        auto s = schema_builder(this_smp_shard_count(), "ks", "cf")
+                .with_column("pk", bytes_type, column_kind::partition_key)
+                .set_compressor_params(params)
+                .build();
+        // The table has no recommended dict, so a small compressed size proves the given dict is used.
+        auto compressor = local.make_compressor_for_writing_with_dict(s, dict_view).get();
+        auto decompressor = local.make_compressor_for_reading_for_tests(params, dict_view).get();
+
+        auto compressed = std::vector<char>(compressor->compress_max_size(message.size()));
+        compressed.resize(compressor->compress(message.data(), message.size(), compressed.data(), compressed.size()));
+        tests::require_less(compressed.size(), message.size() / 10);
+
+        auto decompressed = std::vector<char>(message.size());
+        decompressed.resize(decompressor->uncompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+        tests::require(std::equal(message.begin(), message.end(), decompressed.begin(), decompressed.end()));
+
+        // An empty dict falls back to the recommended one, of which there is none.
+        compressor = local.make_compressor_for_writing_with_dict(s, {}).get();
+        compressed.resize(compressor->compress_max_size(message.size()));
+        compressed.resize(compressor->compress(message.data(), message.size(), compressed.data(), compressed.size()));
+        tests::require_greater_equal(compressed.size(), message.size());
+    }
+}
+
+// Per-sstable dict training doesn't queue up: samples which don't fit in the
+// training memory are skipped, and trainings which take too long time out.
+SEASTAR_THREAD_TEST_CASE(test_train_dict_is_bounded) {
+    auto config = default_sstable_compressor_factory::config{
+        .dict_training_memory = 64 << 10,
+        .dict_training_timeout = std::chrono::milliseconds(100),
+    };
+    sharded<default_sstable_compressor_factory> sstable_compressor_factory;
+    sstable_compressor_factory.start(std::cref(config)).get();
+    auto stop_compressor_factory = defer([&sstable_compressor_factory] { sstable_compressor_factory.stop().get(); });
+    auto& local = sstable_compressor_factory.local();
+
+    shared_promise<> release;
+    size_t trainings = 0;
+    local.set_train_dict_callback([&] (std::vector<std::vector<std::byte>> sample, size_t max_size) {
+        ++trainings;
+        return release.get_shared_future().then([] {
+            return std::vector<std::byte>(16);
+        });
+    });
+
+    std::vector<temporary_buffer<char>> sample;
+    sample.emplace_back(48 << 10);
+
+    BOOST_REQUIRE_THROW(local.train_dict(sample, 1024).get(), seastar::timed_out_error);
+    tests::require_equal(trainings, size_t(1));
+
+    // The timed out training still holds the memory of its sample.
+    tests::require(local.train_dict(sample, 1024).get().empty());
+    tests::require_equal(trainings, size_t(1));
+
+    release.set_value();
+    BOOST_REQUIRE(eventually_true([&] {
+        return !local.train_dict(sample, 1024).get().empty();
+    }));
+}
+
+// The writer compresses the sstable with its own dict if training succeeds,
+// and falls back to the table's dict (here: none) if it fails or is too slow.
+SEASTAR_THREAD_TEST_CASE(test_writer_falls_back_from_per_sstable_dict) {
+    auto config = default_sstable_compressor_factory::config{
+        .dict_training_timeout = std::chrono::milliseconds(100),
+    };
+    sharded<default_sstable_compressor_factory> sstable_compressor_factory;
+    sstable_compressor_factory.start(std::cref(config)).get();
+    auto stop_compressor_factory = defer([&sstable_compressor_factory] { sstable_compressor_factory.stop().get(); });
+    auto& local = sstable_compressor_factory.local();
+
+    test_env env({}, local);
+    auto stop_env = defer([&env] { env.stop().get(); });
+    tests::reader_concurrency_semaphore_wrapper semaphore;
+
+    auto s = schema_builder("ks", "cf")
+            .with_column("pk", int32_type, column_kind::partition_key)
+            .with_column("v", utf8_type)
+            .set_compressor_params(compression_parameters({
+                {compression_parameters::SSTABLE_COMPRESSION, "ZstdWithDictsCompressor"},
+                {compression_parameters::PER_SSTABLE_DICT, "true"},
+            }))
+            .build();
+    // Enough repetitive data to be sampled for training.
+    utils::chunked_vector<mutation> muts;
+    for (int32_t pk = 0; pk < 256; ++pk) {
+        mutation m(s, partition_key::from_single_value(*s, int32_type->decompose(pk)));
+        m.set_clustered_cell(clustering_key::make_empty(), "v", data_value(fmt::format("{:>1024}", pk)), api::new_timestamp());
+        muts.push_back(std::move(m));
+    }
+    std::ranges::sort(muts, mutation_decorated_key_less_comparator());
+
+    auto has_dict = [] (const sstables::shared_sstable& sst) {
+        return std::ranges::any_of(sst->get_compression().options.elements, [] (const auto& o) {
+            return std::string_view(reinterpret_cast<const char*>(o.key.value.data()), o.key.value.size()).starts_with(".dictionary.");
+        });
+    };
+
+    shared_promise<> release;
+    auto stop_training = defer([&release] { release.set_value(); });
+    enum class outcome { trained, failed, timed_out };
+    for (auto result : {outcome::trained, outcome::failed, outcome::timed_out}) {
+        size_t trainings = 0;
+        local.set_train_dict_callback([&] (std::vector<std::vector<std::byte>> sample, size_t max_size) -> future<std::vector<std::byte>> {
+            ++trainings;
+            switch (result) {
+            case outcome::trained: {
+                auto dict = std::span(sample.front()).first(std::min(max_size, sample.front().size()));
+                return make_ready_future<std::vector<std::byte>>(std::vector<std::byte>(dict.begin(), dict.end()));
+            }
+            case outcome::failed:
+                return make_exception_future<std::vector<std::byte>>(std::runtime_error("injected training failure"));
+            case outcome::timed_out:
+                return release.get_shared_future().then([] { return std::vector<std::byte>(); });
+            }
+            std::abort();
+        });
+
+        auto cfg = env.manager().configure_writer();
+        cfg.train_compression_dict = true;
+        auto sst = make_sstable_easy(env, make_memtable(s, muts).get(), cfg);
+        tests::require_equal(trainings, size_t(1));
+        tests::require_equal(has_dict(sst), result == outcome::trained);
+
+        auto rd = assert_that(sst->as_mutation_source().make_mutation_reader(s, semaphore.make_permit()));
+        for (const auto& m : muts) {
+            rd.produces(m);
+        }
+        rd.produces_end_of_stream();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
 #include <seastar/core/smp.hh>
 #include <seastar/util/short_streams.hh>
 #include <seastar/util/closeable.hh>
+#include <seastar/util/file.hh>
 
 #include "sstables/checksum_utils.hh"
 #include "sstables/generation_type.hh"
@@ -764,6 +765,231 @@ SEASTAR_TEST_CASE(test_skipping_in_compressed_stream) {
     });
 }
 
+// Chunks of incompressible data are larger than the buffers of the underlying
+// file stream, so they straddle them and are read through the reader's
+// reusable chunk buffer, while the uncompressed chunks come from the per-shard
+// buffer pool. Keep the returned buffers alive while reading more, to check
+// that neither reuses memory still referenced by the consumer.
+SEASTAR_TEST_CASE(test_compressed_stream_with_chunks_straddling_buffers) {
+    return seastar::async([] {
+        tests::reader_concurrency_semaphore_wrapper semaphore;
+
+        tmpdir tmp;
+        auto file_path = (tmp.path() / "test").string();
+        file f = open_file_dma(file_path, open_flags::create | open_flags::wo).get();
+
+        file_input_stream_options opts;
+        opts.buffer_size = 4096;
+        opts.read_ahead = 1;
+
+        compression_parameters cp({
+            { compression_parameters::SSTABLE_COMPRESSION, "LZ4Compressor" },
+            { compression_parameters::CHUNK_LENGTH_KB, "16" },
+        });
+
+        sstables::compression c;
+        auto os = make_file_output_stream(f, file_output_stream_options()).get();
+        auto out = make_compressed_file_m_format_output_stream(std::move(os), &c, cp, make_lz4_sstable_compressor_for_tests());
+        auto data = tests::random::get_bytes(c.uncompressed_chunk_length() * 8 + 1000);
+        out.write(reinterpret_cast<const char*>(data.data()), data.size()).get();
+        out.close().get();
+        c.update(seastar::file_size(file_path).get());
+
+        auto read_back = [&] (uint64_t pos) {
+            f = open_file_dma(file_path, open_flags::ro).get();
+            auto stream_creator = [f] (uint64_t pos, uint64_t len, file_input_stream_options options) -> future<input_stream<char>> {
+                co_return input_stream<char>(make_file_data_source(std::move(f), pos, len, std::move(options)));
+            };
+            auto in = make_compressed_file_m_format_input_stream(stream_creator, &c, pos, data.size() - pos, opts, semaphore.make_permit(), std::nullopt);
+            auto close_in = deferred_close(in);
+            std::vector<temporary_buffer<char>> bufs;
+            bytes result;
+            while (auto buf = in.read().get()) {
+                result.append(reinterpret_cast<const bytes::value_type*>(buf.get()), buf.size());
+                bufs.push_back(std::move(buf));
+            }
+            BOOST_REQUIRE(result == bytes_view(data).substr(pos));
+            size_t total = 0;
+            for (const auto& buf : bufs) {
+                BOOST_REQUIRE(bytes_view(reinterpret_cast<const bytes::value_type*>(buf.get()), buf.size()) == bytes_view(data).substr(pos + total, buf.size()));
+                total += buf.size();
+            }
+        };
+
+        read_back(0);
+        read_back(c.uncompressed_chunk_length() / 2);
+        read_back(c.uncompressed_chunk_length() * 3);
+        read_back(data.size() - 10);
+    });
+}
+
+// A compressed stream whose compressor is chosen from a sample of its data
+// must pass it the first chunks, and compress them and the rest with the
+// compressor it returns. The sample is cut short by close() for small streams.
+SEASTAR_TEST_CASE(test_compressed_stream_with_compressor_from_sample) {
+    return seastar::async([] {
+        tests::reader_concurrency_semaphore_wrapper semaphore;
+        tmpdir tmp;
+
+        compression_parameters cp({
+            { compression_parameters::SSTABLE_COMPRESSION, "LZ4Compressor" },
+            { compression_parameters::CHUNK_LENGTH_KB, "4" },
+        });
+        const size_t chunk_size = cp.chunk_length();
+
+        for (size_t data_size : {size_t(0), chunk_size / 2, chunk_size * 3, chunk_size * 20 + 100}) {
+            testlog.info("data_size={}", data_size);
+            auto file_path = (tmp.path() / fmt::format("test-{}", data_size)).string();
+            file f = open_file_dma(file_path, open_flags::create | open_flags::wo).get();
+            auto data = tests::random::get_bytes(data_size);
+
+            sstables::compression c;
+            bytes sample;
+            auto os = make_file_output_stream(f, file_output_stream_options()).get();
+            auto out = make_compressed_file_m_format_output_stream(std::move(os), &c, cp, sstables::compressor_from_sample{
+                .sample_size = chunk_size * 4,
+                .make = [&] (std::span<const temporary_buffer<char>> bufs) {
+                    for (const auto& buf : bufs) {
+                        sample.append(reinterpret_cast<const bytes::value_type*>(buf.get()), buf.size());
+                    }
+                    return make_ready_future<compressor_ptr>(make_lz4_sstable_compressor_for_tests());
+                },
+            });
+            out.write(reinterpret_cast<const char*>(data.data()), data.size()).get();
+            out.close().get();
+            c.update(seastar::file_size(file_path).get());
+
+            BOOST_REQUIRE(sample == bytes_view(data).substr(0, chunk_size * 4));
+            BOOST_REQUIRE_EQUAL(c.uncompressed_file_length(), data.size());
+
+            f = open_file_dma(file_path, open_flags::ro).get();
+            auto stream_creator = [f] (uint64_t pos, uint64_t len, file_input_stream_options options) -> future<input_stream<char>> {
+                co_return input_stream<char>(make_file_data_source(std::move(f), pos, len, std::move(options)));
+            };
+            auto in = make_compressed_file_m_format_input_stream(stream_creator, &c, 0, data.size(), file_input_stream_options{}, semaphore.make_permit(), std::nullopt);
+            auto close_in = deferred_close(in);
+            auto result = in.read_exactly(data.size()).get();
+            BOOST_REQUIRE(bytes_view(reinterpret_cast<const bytes::value_type*>(result.get()), result.size()) == bytes_view(data));
+        }
+    });
+}
+
+// Compresses chunks on other shards (or on this one, if there are no other),
+// alternating with chunks compressed locally.
+class test_compression_offload : public sstables::compression_offload {
+    unsigned _next = 0;
+public:
+    unsigned in_flight = 0;
+    unsigned offloaded = 0;
+
+    virtual std::optional<shard_id> pick_shard() override {
+        if (++_next % 3 == 0) {
+            return std::nullopt;
+        }
+        ++in_flight;
+        return (this_shard_id() + _next) % smp::count;
+    }
+    virtual future<bool> compress_on(shard_id shard, const noncopyable_function<void ()>& compress) override {
+        co_await smp::submit_to(shard, [&compress] { compress(); }).finally([this] { --in_flight; });
+        ++offloaded;
+        co_return true;
+    }
+    virtual size_t max_chunks_in_flight() const noexcept override {
+        return 4;
+    }
+};
+
+// A compressed stream which offloads compression must write the same file
+// and metadata as one which doesn't.
+SEASTAR_TEST_CASE(test_compressed_stream_with_offloaded_compression) {
+    return seastar::async([] {
+        tmpdir tmp;
+        compression_parameters cp({
+            { compression_parameters::SSTABLE_COMPRESSION, "LZ4Compressor" },
+            { compression_parameters::CHUNK_LENGTH_KB, "4" },
+        });
+        const size_t chunk_size = cp.chunk_length();
+
+        auto write = [&] (const bytes& data, sstables::compression& c, sstables::compression_offload* offload) {
+            auto file_path = (tmp.path() / fmt::format("test-{}-{}", data.size(), offload ? "offloaded" : "local")).string();
+            file f = open_file_dma(file_path, open_flags::create | open_flags::wo).get();
+            auto os = make_file_output_stream(f, file_output_stream_options()).get();
+            auto out = make_compressed_file_m_format_output_stream(std::move(os), &c, cp, make_lz4_sstable_compressor_for_tests(), offload);
+            out.write(reinterpret_cast<const char*>(data.data()), data.size()).get();
+            out.close().get();
+            return util::read_entire_file_contiguous(file_path).get();
+        };
+
+        for (size_t data_size : {size_t(0), chunk_size / 2, chunk_size * 3, chunk_size * 50 + 100}) {
+            testlog.info("data_size={}", data_size);
+            // Compressible, so that chunks have different compressed sizes.
+            bytes data(bytes::initialized_later(), data_size);
+            for (size_t i = 0; i < data_size; ++i) {
+                data[i] = tests::random::get_int<int>(0, i % 7);
+            }
+
+            sstables::compression local;
+            auto expected = write(data, local, nullptr);
+            sstables::compression offloaded;
+            test_compression_offload offload;
+            auto written = write(data, offloaded, &offload);
+
+            BOOST_REQUIRE_EQUAL(offload.in_flight, 0);
+            BOOST_REQUIRE(data_size < chunk_size * 2 || offload.offloaded > 0);
+            BOOST_REQUIRE(written == expected);
+            BOOST_REQUIRE_EQUAL(offloaded.uncompressed_file_length(), local.uncompressed_file_length());
+            BOOST_REQUIRE_EQUAL(offloaded.compressed_file_length(), local.compressed_file_length());
+            BOOST_REQUIRE_EQUAL(offloaded.get_full_checksum(), local.get_full_checksum());
+            BOOST_REQUIRE_EQUAL(offloaded.offsets.size(), local.offsets.size());
+        }
+    });
+}
+
+// A sink which fails every write.
+class failing_data_sink : public data_sink_impl {
+public:
+    virtual future<> put(std::span<temporary_buffer<char>>) override {
+        return make_exception_future<>(std::runtime_error("injected write failure"));
+    }
+    virtual future<> flush() override {
+        return make_ready_future<>();
+    }
+    virtual future<> close() override {
+        return make_ready_future<>();
+    }
+    virtual size_t buffer_size() const noexcept override {
+        return 4096;
+    }
+};
+
+// A failed write of a compressed stream must wait for the chunks being
+// compressed on other shards before failing, since the stream may be
+// destroyed, with the compression metadata, right after it.
+SEASTAR_TEST_CASE(test_compressed_stream_with_offloaded_compression_write_failure) {
+    return seastar::async([] {
+        compression_parameters cp({
+            { compression_parameters::SSTABLE_COMPRESSION, "LZ4Compressor" },
+            { compression_parameters::CHUNK_LENGTH_KB, "4" },
+        });
+        const size_t data_size = cp.chunk_length() * 50;
+        bytes data(bytes::initialized_later(), data_size);
+        for (size_t i = 0; i < data_size; ++i) {
+            data[i] = tests::random::get_int<int>(0, 255);
+        }
+
+        test_compression_offload offload;
+        {
+            auto c = std::make_unique<sstables::compression>();
+            auto out = make_compressed_file_m_format_output_stream(output_stream<char>(data_sink(std::make_unique<failing_data_sink>())),
+                    c.get(), cp, make_lz4_sstable_compressor_for_tests(), &offload);
+            BOOST_REQUIRE_THROW(out.write(reinterpret_cast<const char*>(data.data()), data.size()).get(), std::runtime_error);
+            BOOST_REQUIRE_EQUAL(offload.in_flight, 0);
+            out.close().handle_exception([] (std::exception_ptr) {}).get();
+        }
+        BOOST_REQUIRE_EQUAL(offload.in_flight, 0);
+    });
+}
+
 // Test that sstables::key_view::tri_compare(const schema& s, partition_key_view other)
 // should correctly compare empty keys. The fact we did this incorrectly was
 // noticed while fixing #9375, and a separate issue on it is #10178.
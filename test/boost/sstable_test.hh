@@ -54,6 +54,14 @@ class column_family_test {
     static const std::unique_ptr<replica::storage_group_manager>& get_storage_group_manager(replica::column_family& cf) {
         return cf._sg_manager;
     }
+
+    static replica::compaction_group& compaction_group_for_token(replica::column_family& cf, dht::token token) {
+        return cf.compaction_group_for_token(token);
+    }
+
+    static db::replay_position flush_rp(const replica::column_family& cf) {
+        return cf._flush_rp;
+    }
 };
 
 namespace sstables {
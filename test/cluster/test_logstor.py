@@ -5,6 +5,7 @@
 #
 
 import asyncio
+import os
 import random
 import time
 from test.pylib.manager_client import ManagerClient
@@ -142,6 +143,31 @@ async def test_range_read(manager: ManagerClient):
         assert len(rows) == 3
         assert [row.tok for row in rows] == tokens[2:5]
 
+async def test_range_read_bounded_readahead(manager: ManagerClient):
+    """
+    Test range scans whose readahead is capped by the size of the records
+    rather than by the number of partitions, so each window holds a single
+    large record.
+    """
+    cmdline = ['--logger-log-level', 'logstor=debug']
+    cfg = {'experimental_features': ['logstor'], 'logstor_scan_readahead_kb': 8}
+    await manager.servers_add(1, cmdline=cmdline, config=cfg)
+    cql = manager.get_cql()
+
+    async with new_test_keyspace(manager, "") as ks:
+        await cql.run_async(f"CREATE TABLE {ks}.test (pk int PRIMARY KEY, v text) WITH storage_engine = 'logstor'")
+        value_size = 20 * 1024
+        nrows = 20
+        for i in range(nrows):
+            await cql.run_async(f"INSERT INTO {ks}.test (pk, v) VALUES ({i}, '{str(i) * value_size}')")
+
+        rows = await cql.run_async(f"SELECT pk, v, token(pk) AS tok FROM {ks}.test")
+        assert sorted([row.pk for row in rows]) == list(range(nrows))
+        for row in rows:
+            assert row.v == str(row.pk) * value_size
+        tokens = [row.tok for row in rows]
+        assert tokens == sorted(tokens)
+
 async def test_parallel_writes(manager: ManagerClient):
     cmdline = ['--logger-log-level', 'logstor=debug']
     cfg = {'experimental_features': ['logstor']}
@@ -179,6 +205,45 @@ async def test_overwrites(manager: ManagerClient):
         assert rows[0].pk == pk
         assert rows[0].v == 99
 
+async def test_delta_chain_fold(manager: ManagerClient):
+    """
+    Partial updates are written as delta records, and the chain of a key is
+    folded into a full record once it gets longer than
+    logstor_max_delta_chain_length. A full write with a timestamp between
+    those of the folded records must not lose the newer updates.
+    """
+    cmdline = ['--logger-log-level', 'logstor=debug']
+    cfg = {'experimental_features': ['logstor'], 'logstor_max_delta_chain_length': 2}
+    servers = await manager.servers_add(1, cmdline=cmdline, config=cfg)
+    cql = manager.get_cql()
+
+    async with new_test_keyspace(manager, "") as ks:
+        await cql.run_async(f"CREATE TABLE {ks}.test (pk int PRIMARY KEY, a int, b int, c int) WITH storage_engine = 'logstor'")
+
+        await cql.run_async(f"INSERT INTO {ks}.test (pk, a, b, c) VALUES (1, 1, 1, 1) USING TIMESTAMP 10")
+        await cql.run_async(f"UPDATE {ks}.test USING TIMESTAMP 20 SET a = 2 WHERE pk = 1")
+        # Makes the chain long enough to be folded.
+        await cql.run_async(f"UPDATE {ks}.test USING TIMESTAMP 30 SET b = 3 WHERE pk = 1")
+        rows = await cql.run_async(f"SELECT a, b, c FROM {ks}.test WHERE pk = 1")
+        assert (rows[0].a, rows[0].b, rows[0].c) == (2, 3, 1)
+
+        await cql.run_async(f"INSERT INTO {ks}.test (pk, a, c) VALUES (1, 4, 4) USING TIMESTAMP 25")
+        rows = await cql.run_async(f"SELECT b FROM {ks}.test WHERE pk = 1")
+        assert rows[0].b == 3
+
+        # Updates written while the chain is folded in the background stay.
+        for i in range(10):
+            await cql.run_async(f"UPDATE {ks}.test USING TIMESTAMP {100 + i} SET c = {100 + i} WHERE pk = 1")
+        rows = await cql.run_async(f"SELECT b, c FROM {ks}.test WHERE pk = 1")
+        assert (rows[0].b, rows[0].c) == (3, 109)
+
+        await manager.server_stop_gracefully(servers[0].server_id)
+        await manager.server_start(servers[0].server_id)
+        cql, _ = await manager.get_ready_cql(servers)
+
+        rows = await cql.run_async(f"SELECT b, c FROM {ks}.test WHERE pk = 1")
+        assert (rows[0].b, rows[0].c) == (3, 109)
+
 async def test_parallel_big_writes(manager: ManagerClient):
     """
     Perform multiple writes in parallel with large values and validate to test segment switching.
@@ -356,6 +421,110 @@ async def test_recovery_with_segment_reuse(manager: ManagerClient):
             assert len(rows) == 1, f"Key {pk} not found after recovery"
             assert rows[0].v == expected_v, f"Key {pk} value mismatch after recovery"
 
+@pytest.mark.parametrize("checkpoint", ["valid", "corrupt", "missing"])
+async def test_recovery_with_index_checkpoint(manager: ManagerClient, checkpoint: str):
+    """
+    Test recovery from an index checkpoint, and the fallback to replaying all
+    segments when the checkpoint is corrupt or missing.
+
+    This test:
+    1. Writes to a few keys until an index checkpoint is written, then disables checkpoints
+    2. Overwrites the keys until the disk is filled twice, so that compaction
+       frees and reuses the segments the checkpoint refers to
+    3. Corrupts or removes the checkpoint, if requested, and restarts the server
+    4. Verifies the last values are recovered
+    5. Writes more and restarts again, so that a segment written after the
+       recovery which reused a sequence number below the checkpoint's
+       watermark would be missed
+    """
+    disk_size_mb = 4
+    file_size_mb = 1
+    value_size = 50 * 1024
+    num_keys = 10
+
+    cmdline = ['--logger-log-level', 'logstor=debug', '--smp=1']
+    cfg = {
+        'logstor_disk_size_in_mb': disk_size_mb,
+        'logstor_file_size_in_mb': file_size_mb,
+        'logstor_index_checkpoint_interval_in_s': 1,
+        'experimental_features': ['logstor']
+    }
+    servers = await manager.servers_add(1, cmdline=cmdline, config=cfg)
+    server = servers[0]
+    cql = manager.get_cql()
+    checkpoint_path = os.path.join(await manager.server_get_workdir(server.server_id), "logstor", "ls_0-Index.db")
+
+    async with new_test_keyspace(manager, "") as ks:
+        await cql.run_async(f"CREATE TABLE {ks}.test (pk int PRIMARY KEY, v text) WITH storage_engine = 'logstor'")
+
+        last_values = {}
+        write_count = 0
+        async def write(n):
+            nonlocal write_count
+            for _ in range(n):
+                pk = write_count % num_keys
+                value = f"value_{write_count}_" + ('x' * (value_size - 20))
+                await cql.run_async(f"INSERT INTO {ks}.test (pk, v) VALUES ({pk}, '{value}')")
+                last_values[pk] = value
+                write_count += 1
+
+        async def verify(when):
+            for pk, expected_v in last_values.items():
+                rows = await cql.run_async(f"SELECT v FROM {ks}.test WHERE pk = {pk}")
+                assert len(rows) == 1, f"Key {pk} not found {when}"
+                assert rows[0].v == expected_v, f"Key {pk} value mismatch {when}"
+
+        async def restart():
+            await manager.server_stop_gracefully(server.server_id)
+            await manager.server_start(server.server_id)
+            return (await manager.get_ready_cql(servers))[0]
+
+        await write(4 * num_keys)
+
+        async def checkpoint_written():
+            metrics = await manager.metrics.query(server.ip_addr)
+            if (metrics.get("scylla_logstor_sm_index_checkpoints") or 0) > 0:
+                return True
+            await write(1)
+        await wait_for(checkpoint_written, time.time() + 60)
+        await manager.server_update_config(server.server_id, "logstor_index_checkpoint_interval_in_s", 0)
+
+        writes_to_fill_disk = disk_size_mb * 1024 * 1024 // (value_size + 100)
+        await write(2 * writes_to_fill_disk)
+        metrics = await manager.metrics.query(server.ip_addr)
+        assert (metrics.get("scylla_logstor_sm_segments_compacted") or 0) > 0, "Compaction should have run when filling disk twice"
+        await verify("before restart")
+
+        await manager.server_stop_gracefully(server.server_id)
+        assert os.path.exists(checkpoint_path)
+        if checkpoint == "corrupt":
+            with open(checkpoint_path, "r+b") as f:
+                f.truncate(os.path.getsize(checkpoint_path) // 2)
+        elif checkpoint == "missing":
+            os.remove(checkpoint_path)
+        log = await manager.server_open_log(server.server_id)
+        mark = await log.mark()
+        await manager.server_start(server.server_id)
+        cql, _ = await manager.get_ready_cql(servers)
+
+        if checkpoint == "valid":
+            matches = await log.grep(r"Recovery: loaded (\d+) index entries from checkpoint, skipped (\d+)", from_mark=mark)
+            assert len(matches) == 1
+            # The checkpointed records of the keys were all overwritten, and
+            # most of their segments reused.
+            assert int(matches[0][1].group(2)) > 0
+            assert not await log.grep("Failed to load index checkpoint", from_mark=mark)
+        elif checkpoint == "corrupt":
+            assert await log.grep("Failed to load index checkpoint", from_mark=mark)
+            assert not os.path.exists(checkpoint_path)
+        else:
+            assert not await log.grep("Recovery: loading index checkpoint", from_mark=mark)
+        await verify("after recovery")
+
+        await write(num_keys)
+        cql = await restart()
+        await verify("after writes following the recovery")
+
 async def test_compaction(manager: ManagerClient):
     """
     Test log compaction by creating dead data and verifying space reclamation.
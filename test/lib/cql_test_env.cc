@@ -699,6 +699,7 @@ class single_node_cql_env : public cql_test_env {
                     .max_shares = cfg->compaction_max_shares,
                     .throughput_mb_per_sec = cfg->compaction_throughput_mb_per_sec,
                     .flush_all_tables_before_major = cfg->compaction_flush_all_tables_before_major_seconds() * 1s,
+                    .cpu_offload_shards = cfg->compaction_cpu_offload_shards,
                 };
             });
             _cm.start(std::move(get_cm_cfg), std::ref(abort_sources), std::ref(_task_manager)).get();
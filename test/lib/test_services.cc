@@ -264,6 +264,7 @@ test_env::impl::impl(test_env_config cfg, sstable_compressor_factory& scfarg, ss
                 .data_file_directories = db_config->data_file_directories(),
                 .format = db_config->sstable_format,
                 .large_data_records_per_sstable = db_config->compaction_large_data_records_per_sstable,
+                .filter_format = db_config->sstable_filter_format,
             },
             feature_service,
             cache_tracker,
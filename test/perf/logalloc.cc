@@ -11,13 +11,18 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/util/defer.hh>
 
 #include <fmt/core.h>
+#include <algorithm>
+#include <deque>
 #include <random>
 
 #include "utils/allocation_strategy.hh"
 #include "utils/logalloc.hh"
 #include "utils/log.hh"
+#include "utils/managed_bytes.hh"
 #include "test/perf/perf.hh"
 
 class piggie {
@@ -32,11 +37,89 @@ static constexpr unsigned nr_seq_allocations = 1024;
 static constexpr unsigned nr_iterations = 20000;
 static constexpr unsigned nr_sizes = 32;
 
+// Keeps allocating into an evictable region which fills all of memory, like
+// the cache does under a stream of misses, and reports the latency of
+// individual allocations once eviction has started.
+static void run_allocation_under_pressure(std::chrono::seconds duration, size_t object_size) {
+    logalloc::region reg;
+    std::deque<managed_bytes> objects;
+    uint64_t evictions = 0;
+
+    reg.make_evictable([&] {
+        if (objects.empty()) {
+            return memory::reclaiming_result::reclaimed_nothing;
+        }
+        with_allocator(reg.allocator(), [&] {
+            objects.pop_front();
+        });
+        ++evictions;
+        return memory::reclaiming_result::reclaimed_something;
+    });
+
+    logalloc::allocating_section as;
+    std::vector<uint64_t> latencies_ns;
+    auto stalls_before = logalloc::shard_tracker().sync_reclaim_stalls().count();
+    auto deadline = std::chrono::steady_clock::now() + duration;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto start = std::chrono::steady_clock::now();
+        as(reg, [&] {
+            with_allocator(reg.allocator(), [&] {
+                objects.emplace_back(managed_bytes(managed_bytes::initialized_later(), object_size));
+            });
+        });
+        if (evictions) {
+            latencies_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+        // Let the background reclaimer run, as request processing would.
+        thread::maybe_yield();
+    }
+
+    with_allocator(reg.allocator(), [&] {
+        objects.clear();
+    });
+
+    if (latencies_ns.empty()) {
+        fmt::print("Memory was not filled within {} s, increase the duration\n", duration.count());
+        return;
+    }
+    std::ranges::sort(latencies_ns);
+    auto percentile = [&] (double p) {
+        return latencies_ns[std::min(latencies_ns.size() - 1, size_t(latencies_ns.size() * p))] / 1000.0;
+    };
+    fmt::print("Allocations under pressure: {}, evictions: {}, synchronous reclaims: {}\n",
+            latencies_ns.size(), evictions, logalloc::shard_tracker().sync_reclaim_stalls().count() - stalls_before);
+    fmt::print("Allocation latency [us]: 50%: {:.3f} 99%: {:.3f} 99.9%: {:.3f} max: {:.3f}\n",
+            percentile(0.5), percentile(0.99), percentile(0.999), latencies_ns.back() / 1000.0);
+}
+
 int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
     app_template app;
-    return app.run(argc, argv, [] {
+    app.add_options()
+        ("pressure-seconds", bpo::value<unsigned>()->default_value(10), "Duration of the allocation under memory pressure scenario [s], 0 to skip it")
+        ("object-size", bpo::value<size_t>()->default_value(1024), "Size of objects allocated under memory pressure [B]")
+        ("reclaim-lead-time-ms", bpo::value<unsigned>()->default_value(0), "Background reclaim lead time (see lsa_background_reclaim_lead_time_ms) [ms]")
+        ;
+    return app.run(argc, argv, [&app] {
         return seastar::async([&] {
             logalloc::prime_segment_pool(memory::stats().total_memory(), memory::min_free_memory()).get();
+
+            auto background_reclaim_scheduling_group = create_scheduling_group("background_reclaim", 100).get();
+            auto kill_sched_group = defer([&] () noexcept {
+                destroy_scheduling_group(background_reclaim_scheduling_group).get();
+            });
+            logalloc::tracker::config st_cfg;
+            st_cfg.defragment_on_idle = false;
+            st_cfg.abort_on_lsa_bad_alloc = false;
+            st_cfg.lsa_reclamation_step = 1;
+            st_cfg.background_reclaim_sched_group = background_reclaim_scheduling_group;
+            st_cfg.background_reclaim_lead_time = std::chrono::milliseconds(app.configuration()["reclaim-lead-time-ms"].as<unsigned>());
+            logalloc::shard_tracker().configure(st_cfg);
+            auto stop_lsa_background_reclaim = defer([&] () noexcept {
+                logalloc::shard_tracker().stop().get();
+            });
+
             logalloc::region reg;
 
             std::array<piggie*, nr_seq_allocations> objects;
@@ -73,6 +156,10 @@ int main(int argc, char** argv) {
             }
 
             fmt::print("Total time: {} s\n", total.count());
+
+            if (auto seconds = app.configuration()["pressure-seconds"].as<unsigned>()) {
+                run_allocation_under_pressure(std::chrono::seconds(seconds), app.configuration()["object-size"].as<size_t>());
+            }
         });
     });
 }
@@ -21,6 +21,7 @@
 #include "sstables/sstables.hh"
 #include "mutation/canonical_mutation.hh"
 #include "utils/chunked_string.hh"
+#include "utils/UUID.hh"
 #include "test/lib/sstable_utils.hh"
 #include "test/lib/test_services.hh"
 #include "test/lib/sstable_test_env.hh"
@@ -218,6 +219,80 @@ static sizes calculate_sizes(cache_tracker& tracker, const mutation_settings& se
     return result;
 }
 
+// A schema shape is a table with column_count regular columns of a single type.
+struct schema_shape {
+    sstring name;
+    data_type type;
+    std::function<data_value()> make_value;
+};
+
+static std::vector<schema_shape> schema_shapes(const mutation_settings& settings) {
+    return {
+        {"int", int32_type, [] { return data_value(int32_t(std::rand())); }},
+        {"bigint", long_type, [] { return data_value(int64_t(std::rand())); }},
+        {"timestamp", timestamp_type, [] { return data_value(db_clock::now()); }},
+        {"double", double_type, [] { return data_value(double(std::rand())); }},
+        {"uuid", uuid_type, [] { return data_value(utils::make_random_uuid()); }},
+        {"text(10)", utf8_type, [] { return data_value(random_name(10)); }},
+        {format("blob({})", settings.data_size), bytes_type, [&settings] { return data_value(random_bytes(settings.data_size)); }},
+    };
+}
+
+// Inline storage of atomic_cell_or_collection before cells could be stored
+// inline in it, i.e. the one of a plain managed_bytes.
+static constexpr size_t managed_bytes_max_inline_size = 15;
+
+// Returns the memory, excluding LSA overhead, which the cells of the row would
+// use if they were stored in plain managed_bytes, minus the one they use now.
+static ssize_t cell_storage_saving(const schema& s, const row& r) {
+    ssize_t saving = 0;
+    r.for_each_cell([&] (column_id id, const atomic_cell_or_collection& cell) {
+        auto& cdef = s.column_at(column_kind::regular_column, id);
+        auto size = cell.as_atomic_cell(cdef).serialize().size();
+        auto old_external = size > managed_bytes_max_inline_size ? sizeof(single_chunk_blob_storage) + size : 0;
+        saving += ssize_t(sizeof(managed_bytes) + old_external) - ssize_t(sizeof(atomic_cell_or_collection) + cell.external_memory_usage(*cdef.type));
+    });
+    return saving;
+}
+
+static void print_schema_shape_sizes(cache_tracker& tracker, const mutation_settings& settings) {
+    std::cout << "cell footprint per schema shape (" << settings.column_count << " columns):\n";
+    for (auto& shape : schema_shapes(settings)) {
+        auto builder = schema_builder(this_smp_shard_count(), "ks", "cf")
+            .with_column("pk", bytes_type, column_kind::partition_key)
+            .with_column("ck", bytes_type, column_kind::clustering_key);
+        for (size_t i = 0; i < settings.column_count; ++i) {
+            builder.with_column(to_bytes(format("c{}", i)), shape.type);
+        }
+        auto s = builder.build();
+        auto mt = make_lw_shared<replica::memtable>(s);
+        row_cache cache(s, make_empty_snapshot_source(), tracker);
+        auto cache_initial_occupancy = tracker.region().occupancy().used_space();
+
+        size_t cells = 0;
+        ssize_t saving = 0;
+        for (size_t i = 0; i < settings.partition_count; ++i) {
+            mutation m(s, partition_key::from_single_value(*s, random_bytes(settings.partition_key_size)));
+            for (size_t j = 0; j < settings.row_count; ++j) {
+                auto ck = clustering_key::from_single_value(*s, random_bytes(settings.clustering_key_size));
+                for (auto&& col : s->regular_columns()) {
+                    m.set_clustered_cell(ck, col, atomic_cell::make_live(*shape.type, 1, shape.type->decompose(shape.make_value())));
+                }
+            }
+            for (auto& r : m.partition().clustered_rows()) {
+                cells += r.row().cells().size();
+                saving += cell_storage_saving(*s, r.row().cells());
+            }
+            mt->apply(m);
+            cache.populate(m);
+        }
+
+        std::cout << format(" - {:<12} memtable: {:>8} cache: {:>8} cells: {:>6} saved by inline cells: {:>6} ({:.1f} per cell)",
+                shape.name, mt->occupancy().used_space(), tracker.region().occupancy().used_space() - cache_initial_occupancy,
+                cells, saving, double(saving) / cells) << "\n";
+    }
+}
+
 int main(int argc, char** argv) {
     namespace bpo = boost::program_options;
     app_template app;
@@ -264,6 +339,9 @@ int main(int argc, char** argv) {
             std::cout << " - canonical:    " << sizes.canonical << "\n";
             std::cout << " - query result: " << sizes.query_result << "\n";
 
+            std::cout << "\n";
+            print_schema_shape_sizes(tracker, settings);
+
             std::cout << "\n";
             size_calculator::print_cache_entry_size();
 
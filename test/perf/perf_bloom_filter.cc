@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include <seastar/testing/perf_tests.hh>
+
+#include "utils/bloom_filter.hh"
+#include "utils/i_filter.hh"
+#include "test/lib/log.hh"
+#include "test/lib/random_utils.hh"
+
+// Compares probes into the classic Bloom filter against the split block
+// one and the binary fuse filter, for a filter much larger than the CPU
+// caches, so that the number of cache lines touched per probe dominates.
+class filter_probe {
+    static constexpr int64_t nr_keys = 4'000'000;
+    static constexpr size_t nr_probes = 1 << 16;
+    static constexpr double fp_chance = 0.01;
+    utils::filter_ptr _filter;
+    std::vector<utils::hashed_key> _present;
+    std::vector<utils::hashed_key> _absent;
+    size_t _next = 0;
+
+    static utils::hashed_key random_key() {
+        return utils::hashed_key({tests::random::get_int<uint64_t>(), tests::random::get_int<uint64_t>()});
+    }
+protected:
+    filter_probe(const char* name, utils::filter_format format)
+        : _filter(utils::i_filter::get_filter(nr_keys, fp_chance, format))
+    {
+        for (int64_t i = 0; i < nr_keys; i++) {
+            auto k = random_key();
+            _filter->add(k);
+            if (_present.size() < nr_probes) {
+                _present.push_back(k);
+            }
+        }
+        _filter->seal();
+        size_t false_positives = 0;
+        for (size_t i = 0; i < nr_probes; i++) {
+            _absent.push_back(random_key());
+            false_positives += _filter->is_present(_absent.back());
+        }
+        testlog.info("{}: {} bytes, {:.2f} bits per key, false positive rate {:.4f}", name, _filter->memory_size(), _filter->memory_size() * 8.0 / nr_keys, double(false_positives) / nr_probes);
+    }
+
+    size_t probe(const std::vector<utils::hashed_key>& keys) {
+        constexpr size_t batch = 1000;
+        size_t hits = 0;
+        for (size_t i = 0; i < batch; i++) {
+            hits += _filter->is_present(keys[_next++ % keys.size()]);
+        }
+        perf_tests::do_not_optimize(hits);
+        return batch;
+    }
+public:
+    size_t probe_present() { return probe(_present); }
+    size_t probe_absent() { return probe(_absent); }
+};
+
+struct bloom_filter_probe : public filter_probe {
+    bloom_filter_probe() : filter_probe("bloom", utils::filter_format::m_format) {}
+};
+
+struct split_block_filter_probe : public filter_probe {
+    split_block_filter_probe() : filter_probe("split_block", utils::filter_format::split_block) {}
+};
+
+struct binary_fuse_filter_probe : public filter_probe {
+    binary_fuse_filter_probe() : filter_probe("binary_fuse", utils::filter_format::binary_fuse) {}
+};
+
+PERF_TEST_F(bloom_filter_probe, present) {
+    return probe_present();
+}
+
+PERF_TEST_F(bloom_filter_probe, absent) {
+    return probe_absent();
+}
+
+PERF_TEST_F(split_block_filter_probe, present) {
+    return probe_present();
+}
+
+PERF_TEST_F(split_block_filter_probe, absent) {
+    return probe_absent();
+}
+
+PERF_TEST_F(binary_fuse_filter_probe, present) {
+    return probe_present();
+}
+
+PERF_TEST_F(binary_fuse_filter_probe, absent) {
+    return probe_absent();
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include <seastar/testing/perf_tests.hh>
+#include <seastar/util/defer.hh>
+
+#include "dht/i_partitioner.hh"
+#include "schema/schema.hh"
+#include "schema/schema_builder.hh"
+#include "sstables/file_writer.hh"
+#include "sstables/trie/bti_index.hh"
+#include "sstables/trie/bti_key_translation.hh"
+#include "sstables/trie/bti_node_reader.hh"
+#include "sstables/trie/trie_traversal.hh"
+#include "test/lib/log.hh"
+#include "test/lib/random_utils.hh"
+#include "utils/i_filter.hh"
+#include "utils/memory_data_sink.hh"
+
+using namespace sstables::trie;
+
+// A node_reader over a Partitions.db held in memory, so that lookups
+// measure only the CPU cost of walking the trie, as they do when the
+// index pages are resident in the cache.
+struct memory_node_reader {
+    const_bytes _buf;
+
+    bool cached(int64_t) const {
+        return true;
+    }
+    future<> load(int64_t, const reader_permit&, const tracing::trace_state_ptr&) {
+        return make_ready_future<>();
+    }
+    load_final_node_result read_node(int64_t pos) {
+        return bti_read_node(pos, _buf.subspan(pos));
+    }
+    node_traverse_result walk_down_along_key(int64_t pos, const_bytes key) {
+        return bti_walk_down_along_key(pos, _buf.subspan(pos), key);
+    }
+    node_traverse_sidemost_result walk_down_leftmost_path(int64_t pos) {
+        return bti_walk_down_leftmost_path(pos, _buf.subspan(pos));
+    }
+    node_traverse_sidemost_result walk_down_rightmost_path(int64_t pos) {
+        return bti_walk_down_rightmost_path(pos, _buf.subspan(pos));
+    }
+    get_child_result get_child(int64_t pos, int child_idx, bool forward) const {
+        return bti_get_child(pos, _buf.subspan(pos), child_idx, forward);
+    }
+    const_bytes get_payload(int64_t pos) const {
+        return bti_get_payload(pos, _buf.subspan(pos));
+    }
+};
+static_assert(node_reader<memory_node_reader>);
+
+// Measures partition key lookups in a large partition index,
+// for keys present in the index and for keys absent from it.
+class bti_partition_index_lookup {
+    static constexpr int64_t nr_keys = 1'000'000;
+    static constexpr size_t nr_lookups = 1 << 16;
+    static constexpr auto sst_ver = sstables::sstable_version_types::ms;
+    schema_ptr _s;
+    std::vector<std::byte> _index;
+    int64_t _root;
+    std::vector<dht::decorated_key> _present;
+    std::vector<dht::decorated_key> _absent;
+    size_t _next = 0;
+
+    dht::decorated_key make_key(int64_t i) const {
+        return dht::decorate_key(*_s, partition_key::from_single_value(*_s, long_type->decompose(i)));
+    }
+public:
+    bti_partition_index_lookup()
+        : _s(schema_builder(this_smp_shard_count(), "ks", "t")
+            .with_column("pk", long_type, column_kind::partition_key)
+            .build())
+    {
+        std::vector<dht::decorated_key> keys;
+        keys.reserve(nr_keys);
+        for (int64_t i = 0; i < nr_keys; ++i) {
+            keys.push_back(make_key(i));
+        }
+        std::ranges::sort(keys, dht::decorated_key::less_comparator(_s));
+
+        memory_data_sink_buffers bufs;
+        {
+            sstables::file_writer fw(data_sink(std::make_unique<memory_data_sink>(bufs)));
+            auto close_fw = seastar::defer([&] { fw.close(); });
+            auto wr = bti_partition_index_writer(sst_ver, fw);
+            int64_t data_pos = 0;
+            for (const auto& dk : keys) {
+                auto pk = sstables::key::from_partition_key(*_s, dk.key());
+                wr.add(*_s, dk, utils::make_hashed_key(bytes_view(pk)), data_pos);
+                data_pos += 100;
+            }
+            auto footer = std::move(wr).finish(
+                sstables::key::from_partition_key(*_s, keys.front().key()),
+                sstables::key::from_partition_key(*_s, keys.back().key()));
+            _root = footer->trie_root_position;
+        }
+        for (const auto& frag : bufs.buffers()) {
+            auto v = std::as_bytes(std::span(frag.get(), frag.size()));
+            _index.insert(_index.end(), v.begin(), v.end());
+        }
+
+        for (size_t i = 0; i < nr_lookups; ++i) {
+            _present.push_back(keys[tests::random::get_int<int64_t>(0, nr_keys - 1)]);
+            _absent.push_back(make_key(nr_keys + i));
+        }
+        testlog.info("Partitions.db: {} keys, {} bytes, {:.2f} bytes per key", nr_keys, _index.size(), double(_index.size()) / nr_keys);
+    }
+
+private:
+    size_t lookup(const std::vector<dht::decorated_key>& keys) {
+        constexpr size_t batch = 1000;
+        auto reader = memory_node_reader{_index};
+        uint64_t sum = 0;
+        for (size_t i = 0; i < batch; ++i) {
+            const auto& dk = keys[_next++ % keys.size()];
+            lazy_comparable_bytes_from_ring_position key(sst_ver, *_s, dht::ring_position_view(dk));
+            traversal_state state = {.next_pos = _root};
+            traverse_single_page(reader, key.begin(), state);
+            sum += state.trail.back().pos;
+        }
+        perf_tests::do_not_optimize(sum);
+        return batch;
+    }
+public:
+    size_t lookup_present() { return lookup(_present); }
+    size_t lookup_absent() { return lookup(_absent); }
+};
+
+PERF_TEST_F(bti_partition_index_lookup, present) {
+    return lookup_present();
+}
+
+PERF_TEST_F(bti_partition_index_lookup, absent) {
+    return lookup_absent();
+}
@@ -18,8 +18,11 @@
 #include "partition_slice_builder.hh"
 #include "utils/int_range.hh"
 #include "utils/div_ceil.hh"
+#include "types/types.hh"
+#include "cql3/query_processor.hh"
 #include <seastar/core/reactor.hh>
 #include <seastar/util/defer.hh>
+#include <random>
 
 static thread_local bool cancelled = false;
 
@@ -41,6 +44,94 @@ class monotonic_counter {
     }
 };
 
+// Point reads of a small hot set of partitions, interleaved with range scans
+// of the whole table, which is much larger than the cache. Reports the hit
+// ratio of the point reads, which is what scan pollution destroys.
+static void run_scan_mix(cql_test_env& env, unsigned seconds, bool admission, unsigned hot_partitions, unsigned scan_partitions) {
+    env.execute_cql(format("CREATE TABLE ks.mix (pk int, ck int, v text, PRIMARY KEY (pk, ck))"
+            " WITH compaction = {{'class': 'NullCompactionStrategy'}}"
+            " AND caching = {{'keys': 'ALL', 'rows_per_partition': 'ALL', 'admission': '{}'}}",
+            admission ? "FREQUENCY" : "ALL")).get();
+    replica::database& db = env.local_db();
+    auto& tracker = db.row_cache_tracker();
+
+    auto insert = env.prepare("INSERT INTO ks.mix (pk, ck, v) VALUES (?, ?, ?)").get();
+    auto value = cql3::raw_value::make_value(utf8_type->decompose(uninitialized_string(1024)));
+    auto make_int = [] (int32_t v) { return cql3::raw_value::make_value(int32_type->decompose(v)); };
+    for (unsigned pk = 0; pk < hot_partitions + scan_partitions; ++pk) {
+        for (int32_t ck = 0; ck < 4; ++ck) {
+            env.execute_prepared(insert, {make_int(pk), make_int(ck), value}).get();
+        }
+    }
+    env.db().invoke_on_all(&replica::database::flush_all_memtables).get();
+    testlog.info("Populated {} hot and {} scanned partitions, admission: {}", hot_partitions, scan_partitions, admission ? "FREQUENCY" : "ALL");
+
+    uint64_t point_reads = 0;
+    uint64_t scans = 0;
+    monotonic_counter<uint64_t> point_reads_ctr([&] { return point_reads; });
+    monotonic_counter<uint64_t> scans_ctr([&] { return scans; });
+    monotonic_counter<uint64_t> hits_ctr([&] { return tracker.get_stats().partition_hits; });
+    monotonic_counter<uint64_t> misses_ctr([&] { return tracker.get_stats().partition_misses; });
+    monotonic_counter<uint64_t> admissions_ctr([&] { return tracker.get_stats().partition_admissions; });
+    monotonic_counter<uint64_t> rejections_ctr([&] { return tracker.get_stats().partition_rejections; });
+    monotonic_counter<uint64_t> eviction_ctr([&] { return tracker.get_stats().partition_evictions; });
+
+    timer<> stats_printer;
+    stats_printer.set_callback([&] {
+        auto hits = hits_ctr.change();
+        auto misses = misses_ctr.change();
+        std::cout << format("point rd/s: {:d}, scans/s: {:d}, hit ratio: {:.3f}, admitted/s: {:d}, rejected/s: {:d}, ev/s: {:d}, cache: {:d} [MB]",
+            point_reads_ctr.change(),
+            scans_ctr.change(),
+            double(hits) / std::max<uint64_t>(hits + misses, 1),
+            admissions_ctr.change(),
+            rejections_ctr.change(),
+            eviction_ctr.change(),
+            tracker.region().occupancy().used_space() / (1024 * 1024)) << "\n";
+    });
+    stats_printer.arm_periodic(1s);
+
+    timer<> completion_timer;
+    completion_timer.set_callback([&] {
+        testlog.info("Test done.");
+        cancelled = true;
+    });
+    completion_timer.arm(std::chrono::seconds(seconds));
+
+    auto point_reader = seastar::async([&] {
+        auto select = env.prepare("SELECT * FROM ks.mix WHERE pk = ?").get();
+        std::default_random_engine rnd;
+        std::uniform_int_distribution<int32_t> dist(0, hot_partitions - 1);
+        while (!cancelled) {
+            env.execute_prepared(select, {make_int(dist(rnd))}).get();
+            ++point_reads;
+            thread::maybe_yield();
+        }
+    });
+
+    // Scan the ring in slices, so that no single result holds the whole table.
+    auto scanner = seastar::async([&] {
+        auto select = env.prepare("SELECT pk FROM ks.mix WHERE token(pk) > ? AND token(pk) <= ?").get();
+        auto make_token = [] (int64_t v) { return cql3::raw_value::make_value(long_type->decompose(v)); };
+        const uint64_t slices = std::max(scan_partitions / 100, 1u);
+        const uint64_t slice_size = std::numeric_limits<uint64_t>::max() / slices;
+        while (!cancelled) {
+            auto start = std::numeric_limits<int64_t>::min();
+            for (uint64_t i = 0; i < slices && !cancelled; ++i) {
+                auto end = i + 1 == slices ? std::numeric_limits<int64_t>::max() : int64_t(uint64_t(start) + slice_size);
+                env.execute_prepared(select, {make_token(start), make_token(end)}).get();
+                start = end;
+            }
+            ++scans;
+        }
+    });
+
+    point_reader.get();
+    scanner.get();
+    stats_printer.cancel();
+    completion_timer.cancel();
+}
+
 int main(int argc, char** argv) {
     namespace bpo = boost::program_options;
     app_template app;
@@ -48,6 +139,10 @@ int main(int argc, char** argv) {
         ("trace", "Enables trace-level logging for the test actions")
         ("no-reads", "Disable reads during the test")
         ("seconds", bpo::value<unsigned>()->default_value(60), "Duration [s] after which the test terminates with a success")
+        ("scan-mix", "Instead of appending to a single partition, mix point reads of a hot set with full table scans")
+        ("admission", "In --scan-mix, enable frequency-based cache admission for the table")
+        ("hot-partitions", bpo::value<unsigned>()->default_value(1000), "In --scan-mix, the number of partitions read by point reads")
+        ("scan-partitions", bpo::value<unsigned>()->default_value(200000), "In --scan-mix, the number of partitions only read by scans")
         ;
 
     return app.run(argc, argv, [&app] {
@@ -68,6 +163,14 @@ int main(int argc, char** argv) {
             auto reads_enabled = !app.configuration().contains("no-reads");
             auto seconds = app.configuration()["seconds"].as<unsigned>();
 
+            if (app.configuration().contains("scan-mix")) {
+                run_scan_mix(env, seconds,
+                    app.configuration().contains("admission"),
+                    app.configuration()["hot-partitions"].as<unsigned>(),
+                    app.configuration()["scan-partitions"].as<unsigned>());
+                return;
+            }
+
             auto stop_test = defer([] {
                 cancelled = true;
             });
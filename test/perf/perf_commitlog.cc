@@ -30,6 +30,7 @@
 #include "db/extensions.hh"
 #include "db/commitlog/commitlog.hh"
 #include "utils/assert.hh"
+#include "utils/estimated_histogram.hh"
 #include "utils/UUID_gen.hh"
 
 struct test_config {
@@ -112,6 +113,8 @@ struct commitlog_service {
     std::optional<db::commitlog> log;
     std::optional<db::commitlog::flush_handler_anchor> fa;
     timer<> flush_timer;
+    // Time from adding a mutation to its acknowledgement, in microseconds.
+    utils::estimated_histogram_with_max<16777216> write_latency;
 
     commitlog_service(const test_config& c)
         : cfg(c)
@@ -144,9 +147,11 @@ static std::vector<clperf_result> do_commitlog_test(sharded<commitlog_service>&
     return time_parallel_ex<clperf_result>([&] {
         auto& log = cls.local();
         size_t size = log.size_dist(tests::random::gen());
+        auto start = std::chrono::steady_clock::now();
         return log.log->add_mutation(uuid, size, db::commitlog::force_sync::no, [size](db::commitlog::output& dst) {
             dst.fill('1', size);
-        }).then([](db::rp_handle h) {
+        }).then([&log, start](db::rp_handle h) {
+            log.write_latency.add(std::chrono::steady_clock::now() - start);
             h.release();
         });
     }, cfg.concurrency, cfg.duration_in_seconds, cfg.operations_per_shard, true, &clperf_result::update);
@@ -161,10 +166,12 @@ int main(int argc, char** argv) {
         ("concurrency", bpo::value<unsigned>()->default_value(100), "workers per core")
         ("operations-per-shard", bpo::value<unsigned>(), "run this many operations per shard (overrides duration)")
 
-        ("commitlog-sync", bpo::value<sstring>(), "commitlog sync method (pediodic/batch)")
+        ("commitlog-sync", bpo::value<sstring>(), "commitlog sync method (pediodic/batch/group)")
         ("commitlog-segment-size-in-mb", bpo::value<unsigned>(), "commitlog segment size")
         ("commitlog-total-space-in-mb", bpo::value<unsigned>(), "total commitlog size")
         ("commitlog-sync-period-in-ms", bpo::value<unsigned>(), "how long the system waits for other writes before performing a sync in \"periodic\" mode")
+        ("commitlog-sync-group-latency-budget-in-us", bpo::value<unsigned>(), "target time from a write to its sync in \"group\" mode")
+        ("commitlog-compression", bpo::value<sstring>(), "commitlog entry compression (none/lz4/zstd)")
         ("commitlog-use-o-dsync", bpo::value<bool>()->default_value(true), "whether or not to use O_DSYNC mode for commitlog segments io")
         ("commitlog-use-hard-size-limit", bpo::value<bool>()->default_value(true), "whether or not to use a hard size limit for commitlog disk usage")
 
@@ -204,6 +211,12 @@ int main(int argc, char** argv) {
         if (app.configuration().contains("commitlog-sync-period-in-ms")) {
             db_cfg->commitlog_sync_period_in_ms(app.configuration()["commitlog-sync-period-in-ms"].as<unsigned>());
         }
+        if (app.configuration().contains("commitlog-sync-group-latency-budget-in-us")) {
+            db_cfg->commitlog_sync_group_latency_budget_in_us(app.configuration()["commitlog-sync-group-latency-budget-in-us"].as<unsigned>());
+        }
+        if (app.configuration().contains("commitlog-compression")) {
+            db_cfg->commitlog_compression(app.configuration()["commitlog-compression"].as<sstring>());
+        }
         if (app.configuration().contains("commitlog-use-o-dsync")) {
             db_cfg->commitlog_use_o_dsync(app.configuration()["commitlog-use-o-dsync"].as<bool>());
         }
@@ -264,6 +277,16 @@ int main(int argc, char** argv) {
             auto mad = absolute_deviations[results.size() / 2];
             std::cout << format("\nmedian {}\nmedian absolute deviation: {:.2f}\nmaximum: {:.2f}\nminimum: {:.2f}\n", median_result, mad, max, min);
 
+            auto latency = co_await test_commitlog.map_reduce0([] (commitlog_service& cl) { return cl.write_latency; },
+                    utils::estimated_histogram_with_max<16777216>(), utils::estimated_histogram_with_max_merge<16777216>);
+            auto [allocs, flushes] = co_await test_commitlog.map_reduce0([] (commitlog_service& cl) {
+                return std::pair(cl.log->get_completed_tasks(), cl.log->get_flush_count());
+            }, std::pair<uint64_t, uint64_t>(), [] (std::pair<uint64_t, uint64_t> a, std::pair<uint64_t, uint64_t> b) {
+                return std::pair(a.first + b.first, a.second + b.second);
+            });
+            std::cout << format("write latency [us]: mean {} p50 {} p99 {}\nwrites per flush: {:.2f}\n",
+                    latency.mean(), latency.quantile(0.5), latency.quantile(0.99), flushes ? double(allocs) / flushes : 0.0);
+
             if (app.configuration().contains("json-result")) {
                 write_json_result(app.configuration()["json-result"].as<std::string>(), cfg, median_result, mad, max, min);
             }
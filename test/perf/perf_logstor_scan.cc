@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+// Compares the throughput of full scans of a logstor table, with and
+// without readahead, with the one of a table backed by sstables.
+
+#include <ranges>
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/loop.hh>
+
+#include "seastarx.hh"
+#include "db/config.hh"
+#include "replica/database.hh"
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/log.hh"
+#include "transport/messages/result_message.hh"
+
+using namespace std::chrono_literals;
+
+int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
+    app_template app;
+    app.add_options()
+        ("partitions", bpo::value<unsigned>()->default_value(100000), "Number of partitions in each table")
+        ("value-size", bpo::value<unsigned>()->default_value(1024), "Size of the value of each partition [B]")
+        ("iterations", bpo::value<unsigned>()->default_value(3), "Number of scans of each table")
+        ("readahead", bpo::value<unsigned>()->default_value(256), "Number of partitions read ahead by logstor scans")
+        ("concurrency", bpo::value<unsigned>()->default_value(8), "Maximum number of concurrent reads of logstor scans")
+        ;
+
+    return app.run(argc, argv, [&app] {
+        if (this_smp_shard_count() != 1) {
+            throw std::runtime_error("This test has to be run with --smp=1");
+        }
+
+        auto cfg_ptr = make_shared<db::config>();
+        auto& cfg = *cfg_ptr;
+        cfg.enable_commitlog(false);
+        cfg.experimental_features({db::experimental_features_t::feature::LOGSTOR});
+
+        return do_with_cql_env_thread([&app, &cfg] (cql_test_env& env) {
+            auto partitions = app.configuration()["partitions"].as<unsigned>();
+            auto value_size = app.configuration()["value-size"].as<unsigned>();
+            auto iterations = app.configuration()["iterations"].as<unsigned>();
+            auto readahead = app.configuration()["readahead"].as<unsigned>();
+            auto concurrency = app.configuration()["concurrency"].as<unsigned>();
+
+            env.execute_cql("CREATE TABLE ks.logstor (pk int PRIMARY KEY, v text) WITH storage_engine = 'logstor'").get();
+            env.execute_cql("CREATE TABLE ks.sstables (pk int PRIMARY KEY, v text)").get();
+
+            sstring value(value_size, 'x');
+            for (auto table : {"logstor", "sstables"}) {
+                auto id = env.prepare(format("INSERT INTO ks.{} (pk, v) VALUES (?, ?)", table)).get();
+                max_concurrent_for_each(std::views::iota(0u, partitions), 100, [&] (unsigned pk) {
+                    return env.execute_prepared(id, {
+                        cql3::raw_value::make_value(int32_type->decompose(int32_t(pk))),
+                        cql3::raw_value::make_value(utf8_type->decompose(value)),
+                    }).discard_result();
+                }).get();
+            }
+            env.db().invoke_on_all(&replica::database::flush_all_memtables).get();
+
+            auto scan = [&] (sstring name, sstring table) {
+                for (unsigned i = 0; i < iterations; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    auto msg = env.execute_cql(format("SELECT count(*) FROM ks.{} BYPASS CACHE USING TIMEOUT 1h", table)).get();
+                    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    auto rows = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(msg);
+                    auto count = value_cast<int64_t>(long_type->deserialize(*rows->rs().result_set().rows().front().front()));
+                    if (count != partitions) {
+                        throw std::runtime_error(format("Scan of {} returned {} partitions, expected {}", table, count, partitions));
+                    }
+                    std::cout << format("{:<20} {:>12.0f} partitions/s {:>10.1f} MB/s",
+                            name, partitions / elapsed, double(partitions) * value_size / elapsed / (1024 * 1024)) << std::endl;
+                }
+            };
+
+            cfg.logstor_scan_readahead_partitions.set(1);
+            cfg.logstor_scan_max_concurrent_reads.set(1);
+            scan("logstor (per key)", "logstor");
+            cfg.logstor_scan_readahead_partitions.set(readahead);
+            cfg.logstor_scan_max_concurrent_reads.set(concurrency);
+            scan("logstor (readahead)", "logstor");
+            scan("sstables", "sstables");
+        }, cfg_ptr);
+    });
+}
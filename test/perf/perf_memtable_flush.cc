@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+// Measures write throttling under sustained ingest, with the memtables of
+// the written table flushed as a whole and split into token sub-ranges
+// (see memtable_flush_sub_ranges).
+
+#include <ranges>
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/loop.hh>
+
+#include "seastarx.hh"
+#include "db/config.hh"
+#include "replica/database.hh"
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/log.hh"
+#include "test/lib/random_utils.hh"
+#include "utils/estimated_histogram.hh"
+
+using namespace std::chrono_literals;
+
+int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
+    app_template app;
+    app.add_options()
+        ("seconds", bpo::value<unsigned>()->default_value(30), "Duration of the ingest into each table [s]")
+        ("value-size", bpo::value<unsigned>()->default_value(1024), "Size of the value of each written row [B]")
+        ("concurrency", bpo::value<unsigned>()->default_value(100), "Number of concurrent writers")
+        ("sub-ranges", bpo::value<unsigned>()->default_value(16), "Number of memtable token sub-ranges of the split table")
+        ;
+
+    return app.run(argc, argv, [&app] {
+        if (this_smp_shard_count() != 1) {
+            throw std::runtime_error("This test has to be run with --smp=1");
+        }
+
+        auto cfg_ptr = make_shared<db::config>();
+        auto& cfg = *cfg_ptr;
+        cfg.enable_commitlog(false);
+        cfg.enable_cache(false);
+
+        return do_with_cql_env_thread([&app, &cfg] (cql_test_env& env) {
+            auto seconds = app.configuration()["seconds"].as<unsigned>();
+            auto value_size = app.configuration()["value-size"].as<unsigned>();
+            auto concurrency = app.configuration()["concurrency"].as<unsigned>();
+            auto sub_ranges = app.configuration()["sub-ranges"].as<unsigned>();
+
+            env.execute_cql("CREATE KEYSPACE perf WITH replication = {'class': 'NetworkTopologyStrategy', 'replication_factor': 1} AND tablets = {'enabled': false}").get();
+
+            replica::database& db = env.local_db();
+            sstring value(value_size, 'x');
+
+            auto ingest = [&] (sstring table, unsigned table_sub_ranges) {
+                cfg.memtable_flush_sub_ranges.set(table_sub_ranges);
+                env.execute_cql(format("CREATE TABLE perf.{} (pk bigint, ck int, v text, PRIMARY KEY (pk, ck))", table)).get();
+                auto id = env.prepare(format("INSERT INTO perf.{} (pk, ck, v) VALUES (?, ?, ?)", table)).get();
+
+                auto blocked_before = db.dirty_memory_region_group().blocked_requests_counter();
+                auto flushed_before = db.cf_stats()->flushed_memtables_bytes;
+                auto sub_range_flushes_before = db.cf_stats()->sub_range_memtables_flushes;
+
+                uint64_t writes = 0;
+                utils::estimated_histogram latencies;
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+                auto start = std::chrono::steady_clock::now();
+                parallel_for_each(std::views::iota(0u, concurrency), [&] (unsigned) {
+                    return do_until([&] { return std::chrono::steady_clock::now() >= deadline; }, [&] {
+                        auto write_start = std::chrono::steady_clock::now();
+                        return env.execute_prepared(id, {
+                            cql3::raw_value::make_value(long_type->decompose(tests::random::get_int<int64_t>())),
+                            cql3::raw_value::make_value(int32_type->decompose(int32_t(0))),
+                            cql3::raw_value::make_value(utf8_type->decompose(value)),
+                        }).discard_result().then([&, write_start] {
+                            latencies.add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - write_start).count());
+                            ++writes;
+                        });
+                    });
+                }).get();
+                auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << format("{:<10} sub-ranges: {:>4} writes/s: {:>10.0f} blocked: {:>8} flushed: {:>8} [MB] sub-range flushes: {:>6} "
+                                    "latency 50%: {:>8} 99%: {:>8} 99.9%: {:>8} max: {:>8} [us]",
+                        table, table_sub_ranges, writes / elapsed,
+                        db.dirty_memory_region_group().blocked_requests_counter() - blocked_before,
+                        (db.cf_stats()->flushed_memtables_bytes - flushed_before) >> 20,
+                        db.cf_stats()->sub_range_memtables_flushes - sub_range_flushes_before,
+                        latencies.percentile(0.5), latencies.percentile(0.99), latencies.percentile(0.999), latencies.max()) << std::endl;
+
+                db.flush_all_memtables().get();
+            };
+
+            ingest("whole", 1);
+            ingest("split", sub_ranges);
+        }, cfg_ptr);
+    });
+}
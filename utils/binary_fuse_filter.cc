@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <fmt/format.h>
+#include <utility>
+
+#include <seastar/core/thread.hh>
+
+#include "utils/assert.hh"
+#include "utils/binary_fuse_filter.hh"
+
+namespace utils {
+namespace filter {
+
+thread_local binary_fuse_filter::stats binary_fuse_filter::_shard_stats;
+
+// Give up on solving the filter after this many seeds. With distinct keys,
+// each attempt fails with a probability well below 1%.
+static constexpr unsigned max_populate_attempts = 100;
+
+static inline uint64_t mix(uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t splitmix64(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t mulhi(uint64_t a, uint64_t b) noexcept {
+    return (static_cast<unsigned __int128>(a) * b) >> 64;
+}
+
+// The loops over all the keys or slots of the filter yield every this
+// many iterations, so that large filters don't stall the reactor.
+static constexpr size_t yield_interval = 1024;
+
+static void maybe_yield(size_t i) {
+    if (i % yield_interval == 0) {
+        seastar::thread::maybe_yield();
+    }
+}
+
+template <typename T>
+static void resize_gently(utils::chunked_vector<T>& v, size_t n) {
+    v.clear();
+    v.reserve(n);
+    while (v.size() < n) {
+        v.push_back(T{});
+        maybe_yield(v.size());
+    }
+}
+
+template <typename T>
+static void fill_gently(utils::chunked_vector<T>& v, T value) {
+    for (size_t i = 0; i < v.size(); i++) {
+        v[i] = value;
+        maybe_yield(i);
+    }
+}
+
+// LSD radix sort, a byte at a time, so that it can yield in the middle.
+static void sort_gently(utils::chunked_vector<uint64_t>& keys) {
+    utils::chunked_vector<uint64_t> buf;
+    resize_gently(buf, keys.size());
+    auto* from = &keys;
+    auto* to = &buf;
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 256> pos{};
+        for (size_t i = 0; i < from->size(); i++) {
+            pos[((*from)[i] >> shift) & 0xff]++;
+            maybe_yield(i);
+        }
+        size_t sum = 0;
+        for (auto& p : pos) {
+            sum += std::exchange(p, sum);
+        }
+        for (size_t i = 0; i < from->size(); i++) {
+            auto key = (*from)[i];
+            (*to)[pos[(key >> shift) & 0xff]++] = key;
+            maybe_yield(i);
+        }
+        std::swap(from, to);
+    }
+    // After an even number of passes, the sorted keys are back in `keys`.
+}
+
+struct fuse_geometry {
+    uint32_t segment_length;
+    uint32_t segment_count_length;
+    uint32_t array_length;
+};
+
+// The sizing rules of the reference implementation, for 3-wise filters.
+static fuse_geometry compute_geometry(size_t nr_keys) {
+    constexpr int64_t arity = 3;
+    int64_t segment_length = nr_keys == 0 ? 4 : int64_t(1) << int(std::floor(std::log(double(nr_keys)) / std::log(3.33) + 2.25));
+    segment_length = std::min<int64_t>(segment_length, 262144);
+    double size_factor = nr_keys <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(double(nr_keys)));
+    int64_t capacity = nr_keys <= 1 ? 0 : int64_t(std::round(double(nr_keys) * size_factor));
+    int64_t init_segment_count = (capacity + segment_length - 1) / segment_length - (arity - 1);
+    int64_t array_length = (init_segment_count + arity - 1) * segment_length;
+    int64_t segment_count = (array_length + segment_length - 1) / segment_length;
+    segment_count = segment_count <= arity - 1 ? 1 : segment_count - (arity - 1);
+    array_length = (segment_count + arity - 1) * segment_length;
+    return fuse_geometry{
+        .segment_length = uint32_t(segment_length),
+        .segment_count_length = uint32_t(segment_count * segment_length),
+        .array_length = uint32_t(array_length),
+    };
+}
+
+static size_t storage_words(uint32_t array_length, unsigned fingerprint_bits) {
+    return binary_fuse_filter::header_words + (uint64_t(array_length) * fingerprint_bits + 63) / 64;
+}
+
+unsigned binary_fuse_filter::fingerprint_bits_for(double max_false_pos_prob) {
+    auto bits = unsigned(std::ceil(-std::log2(max_false_pos_prob)));
+    return std::clamp(bits, 1u, max_fingerprint_bits);
+}
+
+size_t binary_fuse_filter::size_for(int64_t num_elements, unsigned fingerprint_bits) {
+    return storage_words(compute_geometry(num_elements).array_length, fingerprint_bits) * sizeof(uint64_t);
+}
+
+size_t binary_fuse_filter::build_memory_for(int64_t num_elements, unsigned fingerprint_bits) {
+    const size_t keys = num_elements;
+    const size_t capacity = compute_geometry(num_elements).array_length;
+    // _keys, and the reverse_order and reverse_h arrays of populate(). The
+    // buffer of sorting the keys is smaller, and freed before they are allocated.
+    size_t per_key = keys * sizeof(uint64_t) + (keys + 1) * sizeof(uint64_t) + keys * sizeof(uint8_t);
+    // The t2hash, t2count and alone arrays of populate().
+    size_t per_slot = capacity * (sizeof(uint64_t) + sizeof(uint8_t) + sizeof(uint32_t));
+    return per_key + per_slot + size_for(num_elements, fingerprint_bits);
+}
+
+binary_fuse_filter::binary_fuse_filter(unsigned fingerprint_bits)
+    : _fingerprint_bits(fingerprint_bits)
+{
+}
+
+binary_fuse_filter::binary_fuse_filter(unsigned fingerprint_bits, utils::chunked_vector<uint64_t> storage)
+    : _fingerprint_bits(fingerprint_bits)
+    , _storage(std::move(storage))
+    , _sealed(true)
+{
+    load_header();
+    _stats.memory_size += memory_size();
+}
+
+binary_fuse_filter::~binary_fuse_filter() {
+    _stats.memory_size -= memory_size();
+}
+
+void binary_fuse_filter::set_geometry(size_t nr_keys) {
+    auto g = compute_geometry(nr_keys);
+    _segment_length = g.segment_length;
+    _segment_length_mask = g.segment_length - 1;
+    _segment_count_length = g.segment_count_length;
+    _array_length = g.array_length;
+}
+
+void binary_fuse_filter::load_header() {
+    if (_storage.size() < header_words) {
+        throw std::runtime_error(fmt::format("Binary fuse filter too short: {} words", _storage.size()));
+    }
+    _seed = _storage[0];
+    _segment_length = uint32_t(_storage[1]);
+    _segment_length_mask = _segment_length - 1;
+    _segment_count_length = uint32_t(_storage[1] >> 32);
+    _array_length = uint32_t(_storage[2]);
+    if (_fingerprint_bits == 0 || _fingerprint_bits > max_fingerprint_bits
+            || (_array_length && (std::popcount(_segment_length) != 1 || _segment_count_length > _array_length))
+            || _storage.size() != storage_words(_array_length, _fingerprint_bits)) {
+        throw std::runtime_error(fmt::format("Invalid binary fuse filter: {} bits, segment length {}, array length {}, {} words",
+                _fingerprint_bits, _segment_length, _array_length, _storage.size()));
+    }
+}
+
+void binary_fuse_filter::store_header() {
+    _storage[0] = _seed;
+    _storage[1] = uint64_t(_segment_length) | (uint64_t(_segment_count_length) << 32);
+    _storage[2] = _array_length;
+}
+
+uint32_t binary_fuse_filter::slot(unsigned index, uint64_t hash) const noexcept {
+    uint64_t h = mulhi(hash, _segment_count_length);
+    h += index * _segment_length;
+    uint64_t hh = hash & ((uint64_t(1) << 36) - 1);
+    h ^= (hh >> (36 - 18 * index)) & _segment_length_mask;
+    return uint32_t(h);
+}
+
+uint32_t binary_fuse_filter::fingerprint(uint64_t hash) const noexcept {
+    return uint32_t(hash ^ (hash >> 32)) & uint32_t((uint64_t(1) << _fingerprint_bits) - 1);
+}
+
+// Fingerprints are packed back to back, and may straddle two words.
+uint32_t binary_fuse_filter::get_fingerprint(uint32_t slot) const noexcept {
+    uint64_t bit = uint64_t(slot) * _fingerprint_bits;
+    size_t word = header_words + bit / 64;
+    unsigned offset = bit % 64;
+    uint64_t v = _storage[word] >> offset;
+    if (offset + _fingerprint_bits > 64) {
+        v |= _storage[word + 1] << (64 - offset);
+    }
+    return uint32_t(v) & uint32_t((uint64_t(1) << _fingerprint_bits) - 1);
+}
+
+void binary_fuse_filter::set_fingerprint(uint32_t slot, uint32_t value) noexcept {
+    uint64_t mask = (uint64_t(1) << _fingerprint_bits) - 1;
+    uint64_t bit = uint64_t(slot) * _fingerprint_bits;
+    size_t word = header_words + bit / 64;
+    unsigned offset = bit % 64;
+    _storage[word] = (_storage[word] & ~(mask << offset)) | (uint64_t(value) << offset);
+    if (offset + _fingerprint_bits > 64) {
+        unsigned shift = 64 - offset;
+        _storage[word + 1] = (_storage[word + 1] & ~(mask >> shift)) | (uint64_t(value) >> shift);
+    }
+}
+
+void binary_fuse_filter::add(const bytes_view& key) {
+    add(make_hashed_key(key));
+}
+
+void binary_fuse_filter::add(const hashed_key& key) {
+    _keys.push_back(key.hash()[0]);
+}
+
+bool binary_fuse_filter::is_present(const bytes_view& key) {
+    return is_present(make_hashed_key(key));
+}
+
+bool binary_fuse_filter::is_present(hashed_key key) {
+    if (!_sealed || !_array_length) {
+        return true;
+    }
+    auto hash = mix(key.hash()[0] + _seed);
+    auto f = fingerprint(hash);
+    f ^= get_fingerprint(slot(0, hash)) ^ get_fingerprint(slot(1, hash)) ^ get_fingerprint(slot(2, hash));
+    return f == 0;
+}
+
+void binary_fuse_filter::seal() {
+    if (_sealed) {
+        return;
+    }
+    SCYLLA_ASSERT(seastar::thread::running_in_thread());
+    // Equal keys can't be placed; they need only one slot anyway.
+    sort_gently(_keys);
+    size_t nr_keys = 0;
+    for (size_t i = 0; i < _keys.size(); i++) {
+        if (nr_keys == 0 || _keys[i] != _keys[nr_keys - 1]) {
+            _keys[nr_keys++] = _keys[i];
+        }
+        maybe_yield(i);
+    }
+    _keys.resize(nr_keys);
+
+    set_geometry(_keys.size());
+    resize_gently(_storage, storage_words(_array_length, _fingerprint_bits));
+    if (!populate()) {
+        // Keep a valid filter which reports every key as present.
+        _array_length = 0;
+        _storage.resize(storage_words(0, _fingerprint_bits));
+    }
+    store_header();
+    _keys = {};
+    _sealed = true;
+    _stats.memory_size += memory_size();
+}
+
+// Follows the construction of the reference implementation: keys are
+// spread over the array ordered by their segment, for locality, then the
+// array is peeled by repeatedly taking slots referenced by a single key,
+// and finally the fingerprints are assigned in the reverse peeling order.
+bool binary_fuse_filter::populate() {
+    const size_t size = _keys.size();
+    const size_t capacity = _array_length;
+
+    utils::chunked_vector<uint64_t> reverse_order;
+    resize_gently(reverse_order, size + 1);
+    utils::chunked_vector<uint8_t> reverse_h;
+    resize_gently(reverse_h, size);
+    utils::chunked_vector<uint64_t> t2hash;
+    resize_gently(t2hash, capacity);
+    // Number of keys referencing the slot times 4, plus the xor of the
+    // indexes (0, 1 or 2) under which they reference it.
+    utils::chunked_vector<uint8_t> t2count;
+    resize_gently(t2count, capacity);
+    utils::chunked_vector<uint32_t> alone;
+    resize_gently(alone, capacity);
+
+    unsigned block_bits = 1;
+    while ((size_t(1) << block_bits) < _segment_count_length / _segment_length) {
+        block_bits++;
+    }
+    const size_t block = size_t(1) << block_bits;
+    std::vector<uint32_t> start_pos(block);
+
+    uint64_t rng = 0x726b2b9d438b9d4dULL;
+    std::array<uint32_t, 5> h012;
+    auto hashes_of = [&] (uint64_t hash) {
+        h012[0] = slot(0, hash);
+        h012[1] = slot(1, hash);
+        h012[2] = slot(2, hash);
+        h012[3] = h012[0];
+        h012[4] = h012[1];
+    };
+
+    size_t stack_size = 0;
+    for (unsigned attempt = 0; ; attempt++) {
+        if (attempt == max_populate_attempts) {
+            return false;
+        }
+        _seed = splitmix64(rng);
+        fill_gently<uint64_t>(reverse_order, 0);
+        reverse_order[size] = 1;
+        fill_gently<uint8_t>(t2count, 0);
+        fill_gently<uint64_t>(t2hash, 0);
+
+        for (size_t i = 0; i < block; i++) {
+            start_pos[i] = uint32_t((uint64_t(i) * size) >> block_bits);
+        }
+        for (size_t i = 0; i < size; i++) {
+            uint64_t hash = mix(_keys[i] + _seed);
+            size_t segment_index = hash >> (64 - block_bits);
+            while (reverse_order[start_pos[segment_index]] != 0) {
+                segment_index = (segment_index + 1) & (block - 1);
+            }
+            reverse_order[start_pos[segment_index]] = hash;
+            start_pos[segment_index]++;
+            maybe_yield(i);
+        }
+
+        bool error = false;
+        for (size_t i = 0; i < size; i++) {
+            uint64_t hash = reverse_order[i];
+            hashes_of(hash);
+            for (unsigned j = 0; j < 3; j++) {
+                t2count[h012[j]] += 4;
+                t2count[h012[j]] ^= j;
+                t2hash[h012[j]] ^= hash;
+                error |= t2count[h012[j]] < 4;
+            }
+            maybe_yield(i);
+        }
+        if (error) {
+            continue;
+        }
+
+        size_t queue_size = 0;
+        for (size_t i = 0; i < capacity; i++) {
+            alone[queue_size] = i;
+            queue_size += (t2count[i] >> 2) == 1;
+            maybe_yield(i);
+        }
+        stack_size = 0;
+        while (queue_size > 0) {
+            uint32_t index = alone[--queue_size];
+            if ((t2count[index] >> 2) != 1) {
+                continue;
+            }
+            uint64_t hash = t2hash[index];
+            uint8_t found = t2count[index] & 3;
+            reverse_h[stack_size] = found;
+            reverse_order[stack_size] = hash;
+            stack_size++;
+            hashes_of(hash);
+            for (unsigned j = 1; j < 3; j++) {
+                uint32_t other = h012[found + j];
+                alone[queue_size] = other;
+                queue_size += (t2count[other] >> 2) == 2;
+                t2count[other] -= 4;
+                t2count[other] ^= (found + j) % 3;
+                t2hash[other] ^= hash;
+            }
+            maybe_yield(stack_size);
+        }
+        if (stack_size == size) {
+            break;
+        }
+    }
+
+    for (size_t i = size; i-- > 0; ) {
+        uint64_t hash = reverse_order[i];
+        uint8_t found = reverse_h[i];
+        hashes_of(hash);
+        set_fingerprint(h012[found], fingerprint(hash) ^ get_fingerprint(h012[found + 1]) ^ get_fingerprint(h012[found + 2]));
+        maybe_yield(i);
+    }
+    return true;
+}
+
+void binary_fuse_filter::clear() {
+    _keys = {};
+    if (_storage.size() > header_words) {
+        std::fill(_storage.begin() + header_words, _storage.end(), 0);
+    }
+}
+
+}
+}
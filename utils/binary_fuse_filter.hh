@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include "utils/i_filter.hh"
+#include "utils/chunked_vector.hh"
+
+namespace utils {
+namespace filter {
+
+// Binary fuse filter (see Graf, Lemire: "Binary Fuse Filters: Fast and
+// Smaller Than Xor Filters").
+//
+// Each key is mapped to three slots of an array of k-bit fingerprints, such
+// that the xor of the three slots is the fingerprint of the key. This makes
+// the false-positive probability 2^-k at about 1.125 * k bits per key, where
+// a Bloom filter needs 1.44 * k bits per key.
+//
+// The filter is static: add() only collects the keys, and the array is
+// solved for all of them at once by seal(). This fits sstables, whose
+// key set is known when they are sealed. Until then, is_present() answers
+// true for any key. seal() must run in a seastar thread, since it yields
+// while sorting the keys and solving the array.
+//
+// It is stored in the Filter component, with the fingerprint width stored
+// as a negative number of hashes, followed by the header and the packed
+// fingerprints. Readers which don't know the format treat it as a Bloom
+// filter with no hash functions, which always reports the key as present.
+class binary_fuse_filter : public i_filter {
+public:
+    // Number of 64-bit words of the storage which precede the fingerprints.
+    static constexpr size_t header_words = 3;
+    static constexpr unsigned max_fingerprint_bits = 32;
+    // Above this many keys, building the filter needs too much temporary
+    // memory, and callers should fall back to a Bloom filter. Below it,
+    // callers which bound that memory should use build_memory_for().
+    static constexpr int64_t max_elements = 1 << 22;
+private:
+    unsigned _fingerprint_bits;
+    uint64_t _seed = 0;
+    uint32_t _segment_length = 0;
+    uint32_t _segment_length_mask = 0;
+    uint32_t _segment_count_length = 0;
+    uint32_t _array_length = 0;
+    // The header followed by the fingerprints, as stored on disk.
+    utils::chunked_vector<uint64_t> _storage;
+    // Hashes of the keys added before seal().
+    utils::chunked_vector<uint64_t> _keys;
+    bool _sealed = false;
+
+    static thread_local struct stats {
+        uint64_t memory_size = 0;
+    } _shard_stats;
+    stats& _stats = _shard_stats;
+
+    void set_geometry(size_t nr_keys);
+    void load_header();
+    void store_header();
+    uint32_t slot(unsigned index, uint64_t hash) const noexcept;
+    uint32_t fingerprint(uint64_t hash) const noexcept;
+    uint32_t get_fingerprint(uint32_t slot) const noexcept;
+    void set_fingerprint(uint32_t slot, uint32_t value) noexcept;
+    bool populate();
+public:
+    // Creates an empty filter, to be filled with add() and seal().
+    explicit binary_fuse_filter(unsigned fingerprint_bits);
+    // Creates a sealed filter from its stored representation.
+    binary_fuse_filter(unsigned fingerprint_bits, utils::chunked_vector<uint64_t> storage);
+    ~binary_fuse_filter();
+
+    virtual void add(const bytes_view& key) override;
+    virtual void add(const hashed_key& key) override;
+
+    virtual bool is_present(const bytes_view& key) override;
+    virtual bool is_present(hashed_key key) override;
+
+    virtual void seal() override;
+
+    virtual void clear() override;
+    virtual void close() override { }
+
+    virtual size_t memory_size() override {
+        return _storage.memory_size();
+    }
+
+    unsigned fingerprint_bits() const noexcept {
+        return _fingerprint_bits;
+    }
+    const utils::chunked_vector<uint64_t>& get_storage() const noexcept {
+        return _storage;
+    }
+
+    // Returns the fingerprint width which gives the given false-positive probability.
+    static unsigned fingerprint_bits_for(double max_false_pos_prob);
+    // Returns the size in bytes of the filter for the given number of keys.
+    static size_t size_for(int64_t num_elements, unsigned fingerprint_bits);
+    // Returns the peak memory in bytes needed to add the given number of
+    // keys and seal the filter, including the filter itself.
+    static size_t build_memory_for(int64_t num_elements, unsigned fingerprint_bits);
+
+    static const stats& get_shard_stats() noexcept {
+        return _shard_stats;
+    }
+};
+
+}
+}
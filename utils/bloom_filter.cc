@@ -14,11 +14,21 @@
 #include <seastar/core/align.hh>
 #include <seastar/core/loop.hh>
 #include "utils/large_bitset.hh"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdlib>
+#include <vector>
 #include "utils/bloom_calculations.hh"
 #include "bloom_filter.hh"
 
+#ifdef __x86_64__
+#include <x86intrin.h>
+#define arch_target(name) [[gnu::target(name)]]
+#else
+#define arch_target(name)
+#endif
+
 namespace utils {
 namespace filter {
 
@@ -76,6 +86,145 @@ bool bloom_filter::is_present(const bytes_view& key) {
     return is_present(make_hashed_key(key));
 }
 
+// Odd constants used to derive the bit index within each word of a block
+// from the key, the same as in the Parquet specification.
+static constexpr std::array<uint32_t, 8> split_block_salt = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+// Number of 64-bit ints of the bitset per block.
+static constexpr size_t split_block_ints = split_block_bloom_filter::block_bits / 64;
+
+static inline uint32_t split_block_word_mask(uint32_t key, unsigned word) {
+    return uint32_t(1) << ((key * split_block_salt[word]) >> 27);
+}
+
+// Block i consists of 32-bit words 2*i (low half) and 2*i+1 (high half) of
+// the ints of the block, which is the memory layout of eight consecutive
+// 32-bit words on little-endian machines.
+arch_target("default") bool split_block_check_impl(const uint64_t* block, uint32_t key) {
+    for (unsigned w = 0; w < 8; w++) {
+        uint32_t word = block[w / 2] >> (32 * (w % 2));
+        if (!(word & split_block_word_mask(key, w))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+arch_target("default") void split_block_insert_impl(uint64_t* block, uint32_t key) {
+    for (unsigned w = 0; w < 8; w++) {
+        block[w / 2] |= uint64_t(split_block_word_mask(key, w)) << (32 * (w % 2));
+    }
+}
+
+#ifdef __x86_64__
+
+arch_target("avx2") static inline __m256i split_block_mask(uint32_t key) {
+    // 1. Multiply the key by the salt of each word, and keep the top 5 bits,
+    //    which are the index of the bit to set in each of the 8 words.
+    auto salt = _mm256_setr_epi32(
+            split_block_salt[0], split_block_salt[1], split_block_salt[2], split_block_salt[3],
+            split_block_salt[4], split_block_salt[5], split_block_salt[6], split_block_salt[7]);
+    auto idx = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salt), 27);
+    // 2. Turn the indexes into single-bit masks.
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), idx);
+}
+
+arch_target("avx2") bool split_block_check_impl(const uint64_t* block, uint32_t key) {
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    // Set iff all bits of the mask are set in the block.
+    return _mm256_testc_si256(b, split_block_mask(key));
+}
+
+arch_target("avx2") void split_block_insert_impl(uint64_t* block, uint32_t key) {
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(block), _mm256_or_si256(b, split_block_mask(key)));
+}
+
+#endif
+
+// The block is selected by the first half of the 128-bit hash, mapped onto
+// [0, nr_blocks) by multiplication, and the bits within the block by the
+// second half, so the two are independent.
+static inline size_t split_block_offset(const hashed_key& key, size_t nr_blocks) {
+    auto h = key.hash();
+    return size_t((static_cast<unsigned __int128>(h[0]) * nr_blocks) >> 64) * split_block_ints;
+}
+
+split_block_bloom_filter::split_block_bloom_filter(bitmap&& bs) noexcept
+    : bloom_filter(0, std::move(bs), filter_format::split_block)
+{
+}
+
+void split_block_bloom_filter::add(const bytes_view& key) {
+    add(make_hashed_key(key));
+}
+
+void split_block_bloom_filter::add(const hashed_key& key) {
+    auto nr_blocks = bits().size() / block_bits;
+    split_block_insert_impl(bits().ints_at(split_block_offset(key, nr_blocks)), uint32_t(key.hash()[1]));
+}
+
+bool split_block_bloom_filter::is_present(const bytes_view& key) {
+    return is_present(make_hashed_key(key));
+}
+
+bool split_block_bloom_filter::is_present(hashed_key key) {
+    auto nr_blocks = bits().size() / block_bits;
+    return split_block_check_impl(bits().ints_at(split_block_offset(key, nr_blocks)), uint32_t(key.hash()[1]));
+}
+
+// The false-positive probability of a split block filter, with the number of
+// keys per block following the Poisson distribution, is
+//
+//   sum over i of P(i keys in the block) * (1 - (1 - 1/32)^i)^8
+//
+static double split_block_false_positive_probability(double bits_per_element) {
+    const double lambda = split_block_bloom_filter::block_bits / bits_per_element;
+    double p_keys = std::exp(-lambda);
+    double p_bit_clear = 1;
+    double fp = 0;
+    for (int i = 0; i < 1000; i++) {
+        auto p_bit_set = 1 - p_bit_clear;
+        auto p_bit_set_2 = p_bit_set * p_bit_set;
+        auto p_bit_set_4 = p_bit_set_2 * p_bit_set_2;
+        fp += p_keys * p_bit_set_4 * p_bit_set_4;
+        p_keys *= lambda / (i + 1);
+        p_bit_clear *= 1 - 1.0 / 32;
+    }
+    return fp;
+}
+
+// Split block filters are useless beyond this point.
+static constexpr double split_block_max_bits_per_element = 64;
+static constexpr double split_block_bits_per_element_step = 0.5;
+
+// The false-positive probability of split block filters for bits per element
+// from 1 to split_block_max_bits_per_element, in steps of
+// split_block_bits_per_element_step. It decreases with the bits per element.
+static const std::vector<double>& split_block_false_positive_probabilities() {
+    static const std::vector<double> probs = [] {
+        std::vector<double> probs;
+        for (double bits_per_element = 1; bits_per_element <= split_block_max_bits_per_element; bits_per_element += split_block_bits_per_element_step) {
+            probs.push_back(split_block_false_positive_probability(bits_per_element));
+        }
+        return probs;
+    }();
+    return probs;
+}
+
+size_t get_split_block_bitset_size(int64_t num_elements, double max_false_pos_prob) {
+    auto& probs = split_block_false_positive_probabilities();
+    auto it = std::partition_point(probs.begin(), std::prev(probs.end()), [max_false_pos_prob] (double fp) {
+        return fp > max_false_pos_prob;
+    });
+    double bits_per_element = 1 + (it - probs.begin()) * split_block_bits_per_element_step;
+    auto nr_blocks = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(num_elements * bits_per_element / split_block_bloom_filter::block_bits)));
+    return nr_blocks * split_block_bloom_filter::block_bits;
+}
+
 size_t get_bitset_size(int64_t num_elements, int buckets_per) {
     int64_t num_bits = (num_elements * buckets_per) + bloom_calculations::EXCESS;
     num_bits = align_up<int64_t>(num_bits, 64);  // Seems to be implied in origin
@@ -83,6 +232,9 @@ size_t get_bitset_size(int64_t num_elements, int buckets_per) {
 }
 
 filter_ptr create_filter(int hash, large_bitset&& bitset, filter_format format) {
+    if (format == filter_format::split_block) {
+        return std::make_unique<split_block_bloom_filter>(std::move(bitset));
+    }
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset), format);
 }
 
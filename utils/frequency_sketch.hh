@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026-present ScyllaDB
+ */
+
+/*
+ * SPDX-License-Identifier: LicenseRef-ScyllaDB-Source-Available-1.1
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+#include <seastar/core/bitops.hh>
+
+#include "utils/chunked_vector.hh"
+
+namespace utils {
+
+// Approximate access frequency of items, as used by TinyLFU cache admission
+// (Einziger, Friedman, Manes: "TinyLFU: A Highly Efficient Cache Admission Policy").
+//
+// A count-min sketch of 4-bit counters, which saturate at 15. Each item is
+// counted in 4 counters, one in each of 4 words of the table, and its
+// frequency is estimated as the minimum of them. Once the number of
+// recorded accesses reaches the sample size, all counters are halved, so
+// that the estimates reflect recent popularity rather than all of history.
+// The halving is spread over the following increments, a few words at a
+// time, so that no single access pays for a pass over the whole table.
+//
+// Items are identified by a 64-bit hash, which doesn't need to be well
+// mixed.
+class frequency_sketch {
+    static constexpr unsigned depth = 4;
+    static constexpr uint64_t counter_mask = 0xf;
+    static constexpr uint64_t max_frequency = counter_mask;
+    static constexpr uint64_t one_mask = 0x1111'1111'1111'1111;
+    static constexpr uint64_t reset_mask = 0x7777'7777'7777'7777;
+    // Words halved by each increment while aging is in progress.
+    static constexpr size_t words_aged_per_increment = 16;
+    static constexpr std::array<uint64_t, depth> seeds = {
+        0xc3a5'c85c'97cb'3127, 0xb492'b66f'be98'f273, 0x9ae1'6a3b'2f90'404f, 0xcbf2'9ce4'8422'2325,
+    };
+
+    utils::chunked_vector<uint64_t> _table;
+    uint64_t _table_mask;
+    size_t _sample_size;
+    size_t _additions = 0;
+    // Position of the next word to halve, if aging is in progress.
+    std::optional<size_t> _aging_pos;
+    // Number of odd counters among the words halved so far by the current aging.
+    size_t _aging_odd = 0;
+private:
+    static uint64_t spread(uint64_t hash) noexcept {
+        hash ^= hash >> 33;
+        hash *= 0xff51'afd7'ed55'8ccd;
+        hash ^= hash >> 33;
+        return hash;
+    }
+    size_t index_of(uint64_t hash, unsigned i) const noexcept {
+        auto h = (hash + seeds[i]) * seeds[i];
+        h += h >> 32;
+        return h & _table_mask;
+    }
+    // Each word holds 16 counters, in 4 groups of 4. An item uses the same
+    // group in all of its words and a different counter of the group in each.
+    static unsigned offset_of(uint64_t hash, unsigned i) noexcept {
+        return (((hash & 3) << 2) + i) << 2;
+    }
+    // Halves the next few words. Returns true once the whole table was halved.
+    bool age_some() noexcept {
+        auto end = std::min(*_aging_pos + words_aged_per_increment, _table.size());
+        for (auto i = *_aging_pos; i < end; ++i) {
+            auto& word = _table[i];
+            _aging_odd += std::popcount(word & one_mask);
+            word = (word >> 1) & reset_mask;
+        }
+        if (end < _table.size()) {
+            _aging_pos = end;
+            return false;
+        }
+        // Each addition incremented up to 4 counters, so the halving
+        // truncated about odd / 4 of them.
+        _additions = (_additions - std::min(_additions, _aging_odd / 4)) / 2;
+        _aging_pos.reset();
+        _aging_odd = 0;
+        return true;
+    }
+public:
+    // Sized for tracking the frequency of about expected_items items.
+    explicit frequency_sketch(size_t expected_items)
+        : _table_mask((size_t(1) << seastar::log2ceil(std::max<size_t>(expected_items / 4, 16))) - 1)
+        , _sample_size(10 * std::max<size_t>(expected_items, 16))
+    {
+        _table.resize(_table_mask + 1);
+    }
+
+    // Records an access to the item.
+    // Returns true if aging of the counters completed as a result.
+    bool increment(uint64_t hash) noexcept {
+        hash = spread(hash);
+        bool added = false;
+        for (unsigned i = 0; i < depth; ++i) {
+            auto& word = _table[index_of(hash, i)];
+            auto offset = offset_of(hash, i);
+            if (((word >> offset) & counter_mask) != max_frequency) {
+                word += uint64_t(1) << offset;
+                added = true;
+            }
+        }
+        if (added && ++_additions >= _sample_size && !_aging_pos) {
+            _aging_pos = 0;
+        }
+        return _aging_pos && age_some();
+    }
+
+    // Returns the estimated number of recent accesses to the item, at most 15.
+    unsigned frequency(uint64_t hash) const noexcept {
+        hash = spread(hash);
+        auto freq = max_frequency;
+        for (unsigned i = 0; i < depth; ++i) {
+            freq = std::min(freq, (_table[index_of(hash, i)] >> offset_of(hash, i)) & counter_mask);
+        }
+        return freq;
+    }
+
+    size_t sample_size() const noexcept {
+        return _sample_size;
+    }
+
+    size_t memory_usage() const noexcept {
+        return _table.size() * sizeof(uint64_t);
+    }
+};
+
+} // namespace utils
@@ -9,6 +9,7 @@
 
 #include "utils/log.hh"
 #include "bloom_filter.hh"
+#include "binary_fuse_filter.hh"
 #include "bloom_calculations.hh"
 #include "utils/assert.hh"
 #include "utils/murmur_hash.hh"
@@ -28,22 +29,55 @@ filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_proba
         return std::make_unique<filter::always_present_filter>();
     }
 
+    if (fformat == filter_format::binary_fuse) {
+        if (num_elements <= filter::binary_fuse_filter::max_elements) {
+            return std::make_unique<filter::binary_fuse_filter>(filter::binary_fuse_filter::fingerprint_bits_for(max_false_pos_probability));
+        }
+        fformat = filter_format::m_format;
+    }
+
+    if (fformat == filter_format::split_block) {
+        return filter::create_filter(0, large_bitset(filter::get_split_block_bitset_size(num_elements, max_false_pos_probability)), fformat);
+    }
+
     int buckets_per_element = bloom_calculations::max_buckets_per_element(num_elements);
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element, max_false_pos_probability);
     return filter::create_filter(spec.K, num_elements, spec.buckets_per_element, fformat);
 }
 
-size_t i_filter::get_filter_size(int64_t num_elements, double max_false_pos_probability) {
+size_t i_filter::get_filter_size(int64_t num_elements, double max_false_pos_probability, filter_format fformat) {
     if (max_false_pos_probability >= 1.0) {
         return 0;
     }
 
+    if (fformat == filter_format::binary_fuse) {
+        if (num_elements <= filter::binary_fuse_filter::max_elements) {
+            return filter::binary_fuse_filter::size_for(num_elements, filter::binary_fuse_filter::fingerprint_bits_for(max_false_pos_probability));
+        }
+        fformat = filter_format::m_format;
+    }
+
+    if (fformat == filter_format::split_block) {
+        return filter::get_split_block_bitset_size(num_elements, max_false_pos_probability) / 8;
+    }
+
     int buckets_per_element = bloom_calculations::max_buckets_per_element(num_elements);
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element, max_false_pos_probability);
 
     return filter::get_bitset_size(num_elements, spec.buckets_per_element) / 8;
 }
 
+filter_format filter_format_from_string(std::string_view name) {
+    if (name == "bloom") {
+        return filter_format::m_format;
+    } else if (name == "split_block") {
+        return filter_format::split_block;
+    } else if (name == "binary_fuse") {
+        return filter_format::binary_fuse;
+    }
+    throw std::invalid_argument(fmt::format("Unknown filter format '{}'", name));
+}
+
 hashed_key make_hashed_key(bytes_view b) {
     std::array<uint64_t, 2> h;
     utils::murmur_hash::hash3_x64_128(b, 0, h);
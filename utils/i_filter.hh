@@ -10,6 +10,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include "bytes_fwd.hh"
 
 namespace utils {
@@ -20,8 +21,16 @@ using filter_ptr = std::unique_ptr<i_filter>;
 enum class filter_format {
     k_l_format,
     m_format,
+    // Split block Bloom filter, see filter::split_block_bloom_filter.
+    split_block,
+    // Static filter built at seal time, see filter::binary_fuse_filter.
+    binary_fuse,
 };
 
+// Parses a filter format name, as used in the configuration: "bloom",
+// "split_block" or "binary_fuse". Throws std::invalid_argument on unknown names.
+filter_format filter_format_from_string(std::string_view name);
+
 class hashed_key {
 private:
     std::array<uint64_t, 2> _hash;
@@ -43,6 +52,9 @@ struct i_filter {
     virtual bool is_present(hashed_key) = 0;
     virtual void clear() = 0;
     virtual void close() = 0;
+    // Called once all keys were added. Static filters, which can only be
+    // built from the complete key set, are built here.
+    virtual void seal() { }
 
     virtual size_t memory_size() = 0;
 
@@ -58,6 +70,6 @@ struct i_filter {
     /**
      * @return the size of the smallest filter (in bytes), according to the conditions described at get_filter()
      */
-    static size_t get_filter_size(int64_t num_elements, double max_false_pos_prob);
+    static size_t get_filter_size(int64_t num_elements, double max_false_pos_prob, filter_format format = filter_format::m_format);
 };
 }
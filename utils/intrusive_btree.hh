@@ -827,6 +827,24 @@ class tree {
                 return nullptr;
             }
         }
+
+        /*
+         * Returns pointer on the owning tree. Walks up to the root,
+         * so it costs O(tree height).
+         */
+        tree_ptr tree_of() noexcept {
+            node_base_ptr n = revalidate();
+
+            if (n->is_inline()) {
+                return tree::from_inline(n);
+            }
+
+            node_ptr nd = node::from_base(n);
+            while (!nd->is_root()) {
+                nd = nd->_parent.n;
+            }
+            return nd->_parent.t;
+        }
     };
 
     using iterator_base_const = iterator_base<true, const_iterator>;
@@ -55,6 +55,17 @@ class large_bitset {
     }
     void clear();
 
+    // Returns a pointer to the idx-th int of the storage. The storage is
+    // fragmented, but fragments hold a power-of-two number of ints, so any
+    // group of up to 8 ints starting at an index aligned to its size is
+    // contiguous.
+    const int_type* ints_at(size_t idx) const {
+        return &_storage[idx];
+    }
+    int_type* ints_at(size_t idx) {
+        return &_storage[idx];
+    }
+
     const utils::chunked_vector<int_type>& get_storage() const {
         return _storage;
     }
@@ -35,6 +35,7 @@
 #include "utils/vle.hh"
 #include "utils/coarse_steady_clock.hh"
 #include "utils/labels.hh"
+#include "utils/histogram_metrics_helper.hh"
 
 #include <random>
 #include <chrono>
@@ -399,19 +400,43 @@ static thread_local tracker& tracker_instance = get_tracker_instance();
 
 using clock = std::chrono::steady_clock;
 
+background_reclaim_threshold::background_reclaim_threshold(size_t min, size_t max, std::chrono::milliseconds lead_time, uint64_t allocated_memory) noexcept
+        : _lead_time(lead_time)
+        , _min(min)
+        , _max(std::max(min, max))
+        , _threshold(min)
+        , _last_allocated_memory(allocated_memory) {
+}
+
+void background_reclaim_threshold::update(uint64_t allocated_memory, std::chrono::duration<double> period) noexcept {
+    auto rate = (allocated_memory - std::exchange(_last_allocated_memory, allocated_memory)) / period.count();
+    // Follow bursts immediately, but forget them slowly, so that the
+    // threshold doesn't drop during short lulls in between them.
+    _allocation_rate = std::max(rate, _allocation_rate * 0.9);
+    if (_lead_time.count()) {
+        auto wanted = size_t(_allocation_rate * std::chrono::duration<double>(_lead_time).count());
+        _threshold = std::clamp(wanted, _min, _max);
+    }
+}
+
 class background_reclaimer {
     scheduling_group _sg;
     noncopyable_function<void (size_t target)> _reclaim;
+    // Returns the total amount of memory handed out to LSA regions so far,
+    // other than by segment compaction.
+    noncopyable_function<uint64_t ()> _allocated_memory;
     timer<lowres_clock> _adjust_shares_timer;
     // If engaged, main loop is not running, set_value() to wake it.
     promise<>* _main_loop_wait = nullptr;
-    future<> _done;
     bool _stopping = false;
-    static constexpr size_t free_memory_threshold = background_reclaim_free_memory_threshold;
+    static constexpr auto adjust_shares_period = 50ms;
+    background_reclaim_threshold _threshold;
+    // Initialized last, as it starts the main loop.
+    future<> _done;
 private:
     bool have_work() const {
 #ifndef SEASTAR_DEFAULT_ALLOCATOR
-        return memory::free_memory() < free_memory_threshold;
+        return memory::free_memory() < _threshold.get();
 #else
         return false;
 #endif
@@ -437,14 +462,15 @@ class background_reclaimer {
             if (_stopping) {
                 break;
             }
-            _reclaim(free_memory_threshold - memory::free_memory());
+            _reclaim(_threshold.get() - memory::free_memory());
             co_await coroutine::maybe_yield();
         }
         llogger.debug("background_reclaimer::main_loop: exit");
     }
     void adjust_shares() {
+        _threshold.update(_allocated_memory(), adjust_shares_period);
         if (have_work()) {
-            auto shares = 1 + (1000 * (free_memory_threshold - memory::free_memory())) / free_memory_threshold;
+            auto shares = 1 + (1000 * (_threshold.get() - memory::free_memory())) / _threshold.get();
             _sg.set_shares(shares);
             llogger.trace("background_reclaimer::adjust_shares: {}", shares);
             if (_main_loop_wait) {
@@ -453,15 +479,24 @@ class background_reclaimer {
         }
     }
 public:
-    explicit background_reclaimer(scheduling_group sg, noncopyable_function<void (size_t target)> reclaim)
+    explicit background_reclaimer(scheduling_group sg, noncopyable_function<void (size_t target)> reclaim,
+            noncopyable_function<uint64_t ()> allocated_memory, size_t min_free_memory, std::chrono::milliseconds lead_time)
             : _sg(sg)
             , _reclaim(std::move(reclaim))
+            , _allocated_memory(std::move(allocated_memory))
             , _adjust_shares_timer(default_scheduling_group(), [this] { adjust_shares(); })
+            , _threshold(min_free_memory, memory::stats().total_memory() / 8, lead_time, _allocated_memory())
             , _done(with_scheduling_group(_sg, [this] { return main_loop(); })) {
         if (sg != default_scheduling_group()) {
-            _adjust_shares_timer.arm_periodic(50ms);
+            _adjust_shares_timer.arm_periodic(adjust_shares_period);
         }
     }
+    size_t free_memory_threshold() const noexcept {
+        return _threshold.get();
+    }
+    double allocation_rate() const noexcept {
+        return _threshold.allocation_rate();
+    }
     future<> stop() {
         _stopping = true;
         main_loop_wake();
@@ -477,6 +512,9 @@ struct tracker_stats {
     reclaim_duration reclaim_time;
     reclaim_duration evict_time;
     reclaim_duration compact_time;
+    // Durations of reclaims which couldn't be preempted, i.e. ones which
+    // stalled the allocating task.
+    utils::time_estimated_histogram sync_reclaim_stalls;
 };
 
 class tracker::impl {
@@ -551,12 +589,7 @@ class tracker::impl {
     // Abort on allocation failure from LSA
     void enable_abort_on_bad_alloc() noexcept { _abort_on_bad_alloc = true; }
     bool should_abort_on_bad_alloc() const noexcept { return _abort_on_bad_alloc; }
-    void setup_background_reclaim(scheduling_group sg) {
-        SCYLLA_ASSERT(!_background_reclaimer);
-        _background_reclaimer.emplace(sg, [this] (size_t target) {
-            reclaim(target, is_preemptible::yes);
-        });
-    }
+    void setup_background_reclaim(scheduling_group sg, size_t min_free_memory, std::chrono::milliseconds lead_time);
     // const bool&, so interested parties can save a reference and see updates.
     const bool& sanitizer_report_backtrace() const { return _sanitizer_report_backtrace; }
     void set_sanitizer_report_backtrace(bool rb) { _sanitizer_report_backtrace = rb; }
@@ -800,15 +833,23 @@ class standard_memory_segment_store_backend : public segment_store_backend {
 private:
     static memory::memory_layout allocate_memory(size_t segments) {
         const auto size = segments * segment_size;
-        auto p = mmap(nullptr, size,
+        // Over-allocate by a huge page and trim, so that the area starts at
+        // a huge page boundary and segment zones match transparent huge pages.
+        const auto mapped_size = size + huge_page_size;
+        auto p = mmap(nullptr, mapped_size,
                 PROT_READ | PROT_WRITE,
                 MAP_PRIVATE | MAP_ANONYMOUS,
                 -1, 0);
         if (p == MAP_FAILED) {
             std::abort();
         }
-        madvise(p, size, MADV_HUGEPAGE);
-        auto start = reinterpret_cast<uintptr_t>(p);
+        auto mapped_start = reinterpret_cast<uintptr_t>(p);
+        auto start = align_up(mapped_start, static_cast<uintptr_t>(huge_page_size));
+        if (start != mapped_start) {
+            munmap(p, start - mapped_start);
+        }
+        munmap(reinterpret_cast<void*>(start + size), mapped_start + mapped_size - (start + size));
+        madvise(reinterpret_cast<void*>(start), size, MADV_HUGEPAGE);
         return {start, start + size};
     }
 public:
@@ -892,6 +933,10 @@ class contiguous_memory_segment_store {
     size_t max_segments() const noexcept {
         return (_backend->memory_layout().end - _backend->segments_base()) / segment::size;
     }
+    // Position of the first segment within its huge page.
+    size_t huge_page_offset() const noexcept {
+        return (_backend->segments_base() & (huge_page_size - 1)) / segment::size;
+    }
     bool can_allocate_more_segments() const noexcept {
         return _backend->can_allocate_more_segments(non_lsa_reserve);
     }
@@ -990,6 +1035,13 @@ class segment_store {
         }
         return _std_memory_available / segment::size;
     }
+    // Segments come from the standard allocator, so zones are only emulated.
+    size_t huge_page_offset() const noexcept {
+        if (_delegate_store) {
+            return _delegate_store->huge_page_offset();
+        }
+        return 0;
+    }
     bool can_allocate_more_segments() const noexcept {
         if (_delegate_store) {
             return _delegate_store->can_allocate_more_segments();
@@ -1014,6 +1066,15 @@ class segment_pool {
     utils::dynamic_bitset _lsa_owned_segments_bitmap; // owned by this
     utils::dynamic_bitset _lsa_free_segments_bitmap;  // owned by this, but not in use
     size_t _free_segments = 0;
+    // Number of lsa-owned segments in each huge-page-sized zone.
+    std::vector<uint8_t> _owned_segments_per_huge_page;
+    tracker::huge_page_stats _huge_page_stats;
+    // Number of segments handed out to regions so far, other than those
+    // allocated by segment compaction. Compaction only moves data which is
+    // already allocated, and frees more than it allocates, so counting it
+    // would make the background reclaimer feed its own threshold.
+    uint64_t _segments_allocated = 0;
+    unsigned _compaction_depth = 0;
 
     // Invariant: _free_segments > _current_emergency_reserve_goal.
     // Used to ensure that some critical allocations won't fail.
@@ -1057,6 +1118,9 @@ class segment_pool {
 private:
     segment* allocate_segment(size_t reserve);
     void deallocate_segment(segment* seg) noexcept;
+    void on_segment_owned(size_t idx) noexcept;
+    void on_segment_disowned(size_t idx) noexcept;
+    size_t huge_page_capacity(size_t huge_page) const noexcept;
     friend void* segment::operator new(size_t);
     friend void segment::operator delete(void*);
 
@@ -1073,6 +1137,14 @@ class segment_pool {
     size_t max_segments() const noexcept {
         return _store.max_segments();
     }
+    // Zones are aligned to huge page boundaries in the address space, so the
+    // first and the last one may be cut short by the bounds of the store.
+    size_t huge_page_from_idx(size_t idx) const noexcept {
+        return (_store.huge_page_offset() + idx) / segments_per_huge_page;
+    }
+    size_t max_huge_pages() const noexcept {
+        return max_segments() ? huge_page_from_idx(max_segments() - 1) + 1 : 0;
+    }
     bool can_allocate_more_segments() const noexcept {
         return _allocation_enabled && _store.can_allocate_more_segments();
     }
@@ -1083,6 +1155,14 @@ class segment_pool {
     void prime(size_t available_memory, size_t min_free_memory);
     void use_standard_allocator_segment_pool_backend(size_t available_memory);
     segment* new_segment(region::impl* r);
+    uint64_t segments_allocated() const noexcept { return _segments_allocated; }
+    // Marks the segments allocated during its lifetime as allocated by compaction.
+    class compaction_scope {
+        segment_pool& _pool;
+    public:
+        explicit compaction_scope(segment_pool& pool) noexcept : _pool(pool) { ++_pool._compaction_depth; }
+        ~compaction_scope() { --_pool._compaction_depth; }
+    };
     const segment_descriptor& descriptor(const segment* seg) const noexcept {
         uintptr_t index = idx_from_segment(seg);
         return _segments[index];
@@ -1133,6 +1213,7 @@ class segment_pool {
     inline void on_memory_eviction(size_t size) noexcept;
     size_t unreserved_free_segments() const noexcept { return _free_segments - std::min(_free_segments, _emergency_reserve_max); }
     size_t free_segments() const noexcept { return _free_segments; }
+    const tracker::huge_page_stats& huge_page_statistics() const noexcept { return _huge_page_stats; }
 };
 
 struct reclaim_timer {
@@ -1242,6 +1323,14 @@ tracker::stats tracker::statistics() const {
     return _impl->segment_pool().statistics();
 }
 
+tracker::huge_page_stats tracker::huge_page_statistics() const noexcept {
+    return _impl->segment_pool().huge_page_statistics();
+}
+
+const utils::time_estimated_histogram& tracker::sync_reclaim_stalls() const noexcept {
+    return _impl->stats().sync_reclaim_stalls;
+}
+
 size_t segment_pool::reclaim_segments(size_t target, is_preemptible preempt) {
     // Reclaimer tries to release segments occupying lower parts of the address
     // space.
@@ -1268,12 +1357,23 @@ size_t segment_pool::reclaim_segments(size_t target, is_preemptible preempt) {
     // contiguous memory.
     size_t failed_reclaims_allowance = 10;
 
+    // Once the target is met, keep releasing the free segments of the huge
+    // page containing the last released segment, so that LSA and the general
+    // allocator don't end up sharing it. Live segments past the target are
+    // left alone, since compacting them frees memory nobody asked for, in
+    // the middle of a synchronous reclaim.
+    size_t last_huge_page = utils::dynamic_bitset::npos;
+
     for (size_t src_idx = _lsa_owned_segments_bitmap.find_first_set();
-            reclaimed_segments != target && src_idx != utils::dynamic_bitset::npos
+            src_idx != utils::dynamic_bitset::npos
+                    && (reclaimed_segments < target || huge_page_from_idx(src_idx) == last_huge_page)
                     && _free_segments > _current_emergency_reserve_goal;
             src_idx = _lsa_owned_segments_bitmap.find_next_set(src_idx)) {
         auto src = segment_from_idx(src_idx);
         if (!_lsa_free_segments_bitmap.test(src_idx)) {
+            if (reclaimed_segments >= target) {
+                continue;
+            }
             if (!compact_segment(src)) {
                 if (--failed_reclaims_allowance == 0) {
                     break;
@@ -1283,7 +1383,9 @@ size_t segment_pool::reclaim_segments(size_t target, is_preemptible preempt) {
         }
         _lsa_free_segments_bitmap.clear(src_idx);
         _lsa_owned_segments_bitmap.clear(src_idx);
+        on_segment_disowned(src_idx);
         _store.free_segment(src);
+        last_huge_page = huge_page_from_idx(src_idx);
         ++reclaimed_segments;
         --_free_segments;
         if (preempt && need_preempt()) {
@@ -1327,6 +1429,7 @@ segment* segment_pool::allocate_segment(size_t reserve)
                 continue;
             }
             _lsa_owned_segments_bitmap.set(idx);
+            on_segment_owned(idx);
             return seg;
         }
     } while (_tracker.compact_and_evict(reserve, _tracker.reclamation_step() * segment::size, is_preemptible::no));
@@ -1340,6 +1443,39 @@ void segment_pool::deallocate_segment(segment* seg) noexcept
     _free_segments++;
 }
 
+size_t segment_pool::huge_page_capacity(size_t huge_page) const noexcept {
+    auto offset = _store.huge_page_offset();
+    auto first = std::max(huge_page * segments_per_huge_page, offset) - offset;
+    auto last = std::min((huge_page + 1) * segments_per_huge_page - offset, max_segments());
+    return last - first;
+}
+
+void segment_pool::on_segment_owned(size_t idx) noexcept {
+    auto huge_page = huge_page_from_idx(idx);
+    auto owned = ++_owned_segments_per_huge_page[huge_page];
+    ++_huge_page_stats.owned_segments;
+    if (owned == 1) {
+        ++_huge_page_stats.partially_owned_huge_pages;
+    }
+    if (owned == huge_page_capacity(huge_page)) {
+        --_huge_page_stats.partially_owned_huge_pages;
+        ++_huge_page_stats.fully_owned_huge_pages;
+    }
+}
+
+void segment_pool::on_segment_disowned(size_t idx) noexcept {
+    auto huge_page = huge_page_from_idx(idx);
+    auto owned = _owned_segments_per_huge_page[huge_page]--;
+    --_huge_page_stats.owned_segments;
+    if (owned == huge_page_capacity(huge_page)) {
+        --_huge_page_stats.fully_owned_huge_pages;
+        ++_huge_page_stats.partially_owned_huge_pages;
+    }
+    if (owned == 1) {
+        --_huge_page_stats.partially_owned_huge_pages;
+    }
+}
+
 void segment_pool::refill_emergency_reserve() {
     try {
         ensure_free_segments(_emergency_reserve_max);
@@ -1397,6 +1533,9 @@ segment*
 segment_pool::new_segment(region::impl* r) {
     auto seg = allocate_or_fallback_to_reserve();
     ++_segments_in_use;
+    if (!_compaction_depth) {
+        ++_segments_allocated;
+    }
     segment_descriptor& desc = descriptor(seg);
     desc.set_free_space(segment::size);
     desc.set_kind(segment_kind::regular);
@@ -1420,6 +1559,7 @@ segment_pool::segment_pool(tracker::impl& tracker)
     , _segments(max_segments())
     , _lsa_owned_segments_bitmap(max_segments())
     , _lsa_free_segments_bitmap(max_segments())
+    , _owned_segments_per_huge_page(max_huge_pages())
 {
 }
 
@@ -1451,6 +1591,8 @@ void segment_pool::use_standard_allocator_segment_pool_backend(size_t available_
     _segments = std::vector<segment_descriptor>(max_segments());
     _lsa_owned_segments_bitmap = utils::dynamic_bitset(max_segments());
     _lsa_free_segments_bitmap = utils::dynamic_bitset(max_segments());
+    _owned_segments_per_huge_page = std::vector<uint8_t>(max_huge_pages());
+    _huge_page_stats = {};
 }
 
 inline void segment_pool::on_segment_compaction(size_t used_size) noexcept {
@@ -1546,6 +1688,9 @@ reclaim_timer::~reclaim_timer() {
 
     _duration = clock::now() - _start;
     _total_duration += _duration;
+    if (!_preemptible) {
+        _tracker.stats().sync_reclaim_stalls.add(_duration);
+    }
     _stall_detected = _duration >= _duration_threshold;
     if (_debug_enabled || _stall_detected) {
         sample_stats(_end_stats);
@@ -1918,6 +2063,7 @@ class region_impl final : public basic_region_impl {
     }
 
     void compact_segment_locked(segment* seg, segment_descriptor& desc) noexcept {
+        segment_pool::compaction_scope cs(segment_pool());
         auto seg_occupancy = desc.occupancy();
         llogger.debug("Compacting segment {} from region {}, {}", fmt::ptr(seg), id(), seg_occupancy);
 
@@ -2386,6 +2532,15 @@ bool tracker::should_abort_on_bad_alloc() const noexcept {
     return _impl->should_abort_on_bad_alloc();
 }
 
+void tracker::impl::setup_background_reclaim(scheduling_group sg, size_t min_free_memory, std::chrono::milliseconds lead_time) {
+    SCYLLA_ASSERT(!_background_reclaimer);
+    _background_reclaimer.emplace(sg, [this] (size_t target) {
+        reclaim(target, is_preemptible::yes);
+    }, [this] {
+        return _segment_pool->segments_allocated() * segment::size;
+    }, min_free_memory, lead_time);
+}
+
 void tracker::configure(const config& cfg) {
     if (cfg.defragment_on_idle) {
         engine().set_idle_cpu_handler([this] (reactor::work_waiting_on_reactor check_for_work) {
@@ -2397,7 +2552,7 @@ void tracker::configure(const config& cfg) {
     if (cfg.abort_on_lsa_bad_alloc) {
         _impl->enable_abort_on_bad_alloc();
     }
-    _impl->setup_background_reclaim(cfg.background_reclaim_sched_group);
+    _impl->setup_background_reclaim(cfg.background_reclaim_sched_group, cfg.background_reclaim_min_free_memory, cfg.background_reclaim_lead_time);
     _impl->set_sanitizer_report_backtrace(cfg.sanitizer_report_backtrace);
 }
 
@@ -2868,6 +3023,12 @@ tracker::impl::impl() : _segment_pool(std::make_unique<logalloc::segment_pool>(*
         sm::make_gauge("occupancy", [this] { return region_occupancy().used_fraction() * 100; },
                        sm::description("Holds a current portion (in percents) of the used memory.")),
 
+        sm::make_gauge("fully_owned_huge_pages", [this] { return _segment_pool->huge_page_statistics().fully_owned_huge_pages; },
+                       sm::description("Holds a current number of huge-page-sized zones whose all segments are owned by LSA.")),
+
+        sm::make_gauge("partially_owned_huge_pages", [this] { return _segment_pool->huge_page_statistics().partially_owned_huge_pages; },
+                       sm::description("Holds a current number of huge-page-sized zones shared between LSA and the general allocator.")),
+
         sm::make_counter("segments_compacted", [this] { return _segment_pool->statistics().segments_compacted; },
                         sm::description("Counts a number of compacted segments.")),
 
@@ -2891,6 +3052,15 @@ tracker::impl::impl() : _segment_pool(std::make_unique<logalloc::segment_pool>(*
 
         sm::make_counter("compact_time_ms", [this] { return count_millis(_stats.compact_time); },
                         sm::description("Total time spent in segment compaction, that was not accounted under reclaim_time_ms")),
+
+        sm::make_histogram("sync_reclaim_stalls", [this] { return to_metrics_histogram(_stats.sync_reclaim_stalls); },
+                        sm::description("Histogram of durations of reclaims which ran synchronously with allocation, in microseconds")),
+
+        sm::make_gauge("background_reclaim_free_memory_threshold", [this] { return _background_reclaimer ? _background_reclaimer->free_memory_threshold() : 0; },
+                        sm::description("Holds the current amount of free memory below which the background reclaimer releases memory from LSA.")),
+
+        sm::make_gauge("allocation_rate", [this] { return _background_reclaimer ? _background_reclaimer->allocation_rate() : 0; },
+                        sm::description("Holds a decaying peak of the rate, in bytes per second, at which segments are handed out to regions.")),
     });
 }
 
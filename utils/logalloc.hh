@@ -18,6 +18,7 @@
 #include "utils/entangled.hh"
 #include "utils/memory_limit_reached.hh"
 #include "utils/abstract_formatter.hh"
+#include "utils/estimated_histogram.hh"
 
 namespace logalloc {
 
@@ -29,10 +30,43 @@ class allocating_section;
 constexpr int segment_size_shift = 17; // 128K; see #151, #152
 constexpr size_t segment_size = 1 << segment_size_shift;
 constexpr size_t max_zone_segments = 256;
+// Segments are grouped into huge-page-sized zones. The pool keeps track of
+// how many zones are entirely LSA-owned (and so can be mapped by a single TLB
+// entry without being shared with the general allocator) and the reclaimer
+// returns memory to the general allocator in whole zones.
+constexpr int huge_page_size_shift = 21; // 2M
+constexpr size_t huge_page_size = 1 << huge_page_size_shift;
+constexpr size_t segments_per_huge_page = huge_page_size / segment_size;
 constexpr size_t max_managed_object_size = segment_size * 0.1;
 
 constexpr size_t background_reclaim_free_memory_threshold = 60'000'000;
 
+// Free memory below which the background reclaimer releases memory from LSA.
+// With a non-zero lead time, it follows a decaying peak of the rate at which
+// regions allocate segments, so that this much time worth of allocations can
+// be served without synchronous reclaim, within [min, max]. With a lead time
+// of 0, it stays at min.
+class background_reclaim_threshold {
+    std::chrono::milliseconds _lead_time;
+    size_t _min;
+    size_t _max;
+    size_t _threshold;
+    uint64_t _last_allocated_memory;
+    // Decaying peak of the allocation rate, in bytes per second.
+    double _allocation_rate = 0;
+public:
+    background_reclaim_threshold(size_t min, size_t max, std::chrono::milliseconds lead_time, uint64_t allocated_memory) noexcept;
+    // Accounts the memory allocated since the previous update, which was
+    // `period` ago, given the total memory allocated so far.
+    void update(uint64_t allocated_memory, std::chrono::duration<double> period) noexcept;
+    size_t get() const noexcept {
+        return _threshold;
+    }
+    double allocation_rate() const noexcept {
+        return _allocation_rate;
+    }
+};
+
 //
 // Frees some amount of objects from the region to which it's attached.
 //
@@ -65,6 +99,13 @@ class tracker {
         bool sanitizer_report_backtrace = false; // Better reports but slower
         size_t lsa_reclamation_step;
         scheduling_group background_reclaim_sched_group;
+        // Free memory below which the background reclaimer starts releasing
+        // memory from LSA.
+        size_t background_reclaim_min_free_memory = background_reclaim_free_memory_threshold;
+        // When non-zero, the background reclaimer raises its threshold so that
+        // this much time worth of LSA allocations, at the recent peak rate, can
+        // be served without synchronous reclaim.
+        std::chrono::milliseconds background_reclaim_lead_time{0};
     };
 
     struct stats {
@@ -108,6 +149,23 @@ class tracker {
         }
     };
 
+    // Occupancy of huge-page-sized zones by LSA segments.
+    struct huge_page_stats {
+        // Segments owned by LSA, both in use and free.
+        size_t owned_segments = 0;
+        // Zones all of whose segments are owned by LSA.
+        size_t fully_owned_huge_pages = 0;
+        // Zones shared between LSA and the general allocator.
+        size_t partially_owned_huge_pages = 0;
+
+        huge_page_stats& operator+=(const huge_page_stats& other) {
+            owned_segments += other.owned_segments;
+            fully_owned_huge_pages += other.fully_owned_huge_pages;
+            partially_owned_huge_pages += other.partially_owned_huge_pages;
+            return *this;
+        }
+    };
+
     void configure(const config& cfg);
     future<> stop();
 
@@ -123,6 +181,9 @@ class tracker {
     ~tracker();
 
     stats statistics() const;
+    huge_page_stats huge_page_statistics() const noexcept;
+    // Durations of reclaims which ran synchronously with allocation.
+    const utils::time_estimated_histogram& sync_reclaim_stalls() const noexcept;
 
     //
     // Tries to reclaim given amount of bytes in total using all compactible
@@ -59,6 +59,12 @@ class evictable {
     virtual bool is_index() const noexcept {
         return false;
     }
+
+    // Records of the logstor record cache share the LRU with the row cache,
+    // but don't belong to any of its partitions.
+    virtual bool is_logstor_record() const noexcept {
+        return false;
+    }
 };
 
 // Sstable index cache shares memory with the data cache.
@@ -152,6 +158,19 @@ class lru {
         return do_evict<true>(false);
     }
 
+    // Invokes func on elements less recently used than pos, starting from the
+    // most recent of them, until func returns false or the list is exhausted.
+    // func must not modify the LRU.
+    template <typename Func>
+    requires std::is_invocable_r_v<bool, Func, evictable&>
+    void for_each_less_recent(evictable& pos, Func&& func) {
+        for (auto it = std::make_reverse_iterator(_list.iterator_to(pos)); it != _list.rend(); ++it) {
+            if (!func(*it)) {
+                break;
+            }
+        }
+    }
+
     // Evicts all elements.
     // May stall the reactor, use only in tests.
     void evict_all() {